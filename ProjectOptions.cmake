@@ -4,8 +4,10 @@ else()
     option(MyProject_ENABLE_CACHE "Enable ccache" ON)
 endif()
 
+option(MyProject_ENABLE_BENCHMARKS "Build the benchmarks" OFF)
+
 if(NOT PROJECT_IS_TOP_LEVEL)
-    mark_as_advanced(MyProject_ENABLE_CACHE)
+    mark_as_advanced(MyProject_ENABLE_CACHE MyProject_ENABLE_BENCHMARKS)
 endif()
 
 macro(MyProjectLocalOptions)
@@ -0,0 +1,137 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "Editor/Editor.hpp"
+
+#include "AllocationCounter/AllocationCounter.hpp"
+#include "Editor/Document/Document.hpp"
+#include "Editor/Offset/Offset.hpp"
+#include "Editor/ScreenBuffer/ScreenBuffer.hpp"
+#include "Editor/TextScanner/TextScanner.hpp"
+#include "Memory/Memory.hpp"
+#include "Terminal/Window/Window.hpp"
+#include "Utilities/Constants.hpp"
+#include <benchmark/benchmark.h>
+#include <fmt/format.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace Kilo::editor {
+
+namespace {
+
+auto makeFile(std::size_t lines) -> std::filesystem::path
+{
+  auto path = std::filesystem::temp_directory_path() / fmt::format("kilo-bench-{}.txt", lines);
+
+  if (!std::filesystem::exists(path)) {
+    std::ofstream out(path);
+
+    for (std::size_t i = 0; i < lines; i++) {
+      out << "2024-01-01," << i << ",some,comma,separated,fields\n";
+    }
+  }
+
+  return path;
+}
+
+void BM_Open(benchmark::State& state)
+{
+  auto const lines = static_cast<std::size_t>(state.range(0));
+  auto const path = makeFile(lines);
+
+  auto const globalBefore = support::globalAllocations();
+  auto const storageBefore = memory::lineStorageStats();
+
+  for (auto _ : state) {
+    Document document;
+    Document rendered;
+    TextFormat format;
+    benchmark::DoNotOptimize(open(path, document, rendered, format));
+  }
+
+  auto const storageAfter = memory::lineStorageStats();
+  auto const iterations = static_cast<double>(state.iterations());
+
+  // Measure what an open document costs on top of the text of the file
+  Document document;
+  Document rendered;
+  TextFormat format;
+  auto const inUseBefore = memory::lineStorageStats().requests.bytesInUse;
+  open(path, document, rendered, format);
+  auto const inUse = memory::lineStorageStats().requests.bytesInUse - inUseBefore;
+
+  state.counters["heap_allocs/open"] = static_cast<double>(support::globalAllocations() - globalBefore) / iterations;
+  state.counters["line_requests/open"] =
+    static_cast<double>(storageAfter.requests.allocations - storageBefore.requests.allocations) / iterations;
+  state.counters["pool_refills/open"] =
+    static_cast<double>(storageAfter.upstream.allocations - storageBefore.upstream.allocations) / iterations;
+  state.counters["overhead_bytes/line"] =
+    static_cast<double>(inUse - (document.byteCount() - document.lineCount())) / static_cast<double>(lines);
+}
+
+BENCHMARK(BM_Open)->Arg(10'000)->Arg(1'000'000)->Unit(benchmark::kMillisecond);
+
+void BM_Frame(benchmark::State& state)
+{
+  Terminal::Window const window(Terminal::WindowSize {.cols = 120, .rows = 50});
+  Offset const offset {.row = 1000, .col = 0};
+  Document document;
+
+  for (int i = 0; i < 5000; i++) {
+    document.append(fmt::format("{:>6} the quick brown fox jumps over the lazy dog", i));
+  }
+
+  ScreenBuffer buffer;
+
+  auto const drawFrame = [&] {
+    buffer.write(EscapeSequences::BeginRepaint);
+    drawRows(window, offset, document, buffer, document);
+    buffer.moveCursorTo(12, 40).write(EscapeSequences::ShowTheCursor);
+    benchmark::DoNotOptimize(buffer.c_str());
+    buffer.clear();
+  };
+
+  // Let the screen buffer grow to the size of a frame first
+  drawFrame();
+
+  auto const before = support::globalAllocations();
+
+  for (auto _ : state) {
+    drawFrame();
+  }
+
+  auto const iterations = static_cast<double>(state.iterations());
+
+  state.counters["heap_allocs/frame"] = static_cast<double>(support::globalAllocations() - before) / iterations;
+}
+
+BENCHMARK(BM_Frame);
+
+}   // namespace
+
+}   // namespace Kilo::editor
@@ -0,0 +1,77 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/LineDiff/LineDiff.hpp"
+
+#include "Editor/Document/Document.hpp"
+#include <benchmark/benchmark.h>
+#include <fmt/format.h>
+
+#include <cstdint>
+
+namespace Kilo::editor {
+
+namespace {
+
+// Diff two versions of a log that share most of their lines. The second
+// argument is how many lines apart the changes are, each a line rewritten and
+// another put in after it, or 0 for a single change in the middle, which
+// leaves nothing but the lines around it to diff once the common start and end
+// are skipped
+void BM_DiffLines(benchmark::State& state)
+{
+  auto const lines = state.range(0);
+  auto const spacing = state.range(1) == 0 ? lines : state.range(1);
+  auto const first = state.range(1) == 0 ? lines / 2 : 0;
+  Document left;
+  Document right;
+
+  for (std::int64_t i = 0; i < lines; i++) {
+    auto const line = fmt::format("2024-01-01T00:00:{:08} request {} served in {} ms", i, i % 977, i % 13);
+    left.append(line);
+
+    if (i >= first and (i - first) % spacing == spacing - 1) {
+      right.append(fmt::format("2024-01-01T00:00:{:08} request {} failed", i, i % 977));
+      right.append("retrying");
+    }
+    else {
+      right.append(line);
+    }
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(diffLines(left, right));
+  }
+
+  state.SetItemsProcessed(state.iterations() * lines);
+}
+
+BENCHMARK(BM_DiffLines)
+  ->Args({1'000'000, 0})
+  ->Args({1'000'000, 10'000})
+  ->Args({1'000'000, 1'000})
+  ->Unit(benchmark::kMillisecond);
+
+}   // namespace
+
+}   // namespace Kilo::editor
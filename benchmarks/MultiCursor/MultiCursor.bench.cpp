@@ -0,0 +1,94 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/MultiCursor/MultiCursor.hpp"
+
+#include "Editor/Cursor/Cursor.hpp"
+#include "Editor/Document/Document.hpp"
+#include <benchmark/benchmark.h>
+#include <fmt/format.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Kilo::editor {
+
+namespace {
+
+// Type a character at the same column of every tenth line of a document, the
+// way a column of values is edited at once. The document is copied before
+// each edit, as the undo history does
+void BM_InsertAtCursors(benchmark::State& state)
+{
+  auto const cursorCount = state.range(0);
+  Document document;
+  std::vector<Cursor> cursors;
+
+  for (std::int64_t i = 0; i < cursorCount * 10; i++) {
+    document.append(fmt::format("{:>8},some,comma,separated,fields", i));
+
+    if (i % 10 == 0) {
+      cursors.push_back(Cursor {.x = 8, .y = i});
+    }
+  }
+
+  for (auto _ : state) {
+    auto edited = document;
+    auto moved = cursors;
+    benchmark::DoNotOptimize(insertAt(edited, moved, ";"));
+  }
+
+  state.SetItemsProcessed(state.iterations() * cursorCount);
+}
+
+BENCHMARK(BM_InsertAtCursors)->Arg(1'000)->Arg(10'000)->Unit(benchmark::kMillisecond);
+
+// Delete the character under each cursor, joining lines wherever a cursor is at the end of one
+void BM_EraseAtCursors(benchmark::State& state)
+{
+  auto const cursorCount = state.range(0);
+  Document document;
+  std::vector<Cursor> cursors;
+
+  for (std::int64_t i = 0; i < cursorCount * 10; i++) {
+    document.append(fmt::format("{:>8},some,comma,separated,fields", i));
+
+    if (i % 10 == 0) {
+      cursors.push_back(Cursor {.x = i % 20 == 0 ? 8 : 35, .y = i});
+    }
+  }
+
+  for (auto _ : state) {
+    auto edited = document;
+    auto moved = cursors;
+    benchmark::DoNotOptimize(eraseAt(edited, moved, Direction::Forward));
+  }
+
+  state.SetItemsProcessed(state.iterations() * cursorCount);
+}
+
+BENCHMARK(BM_EraseAtCursors)->Arg(1'000)->Arg(10'000)->Unit(benchmark::kMillisecond);
+
+}   // namespace
+
+}   // namespace Kilo::editor
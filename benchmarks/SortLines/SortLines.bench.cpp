@@ -0,0 +1,110 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/SortLines/SortLines.hpp"
+
+#include "Editor/Document/Document.hpp"
+#include "Editor/WorkerPool/WorkerPool.hpp"
+#include <benchmark/benchmark.h>
+#include <fmt/format.h>
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace Kilo::editor {
+
+namespace {
+
+// Lines in no particular order, a tenth of them repeating one further up
+auto shuffled(std::int64_t lines) -> Document
+{
+  Document document;
+
+  for (std::int64_t i = 0; i < lines; i++) {
+    auto const key = static_cast<std::uint32_t>((i % 10 == 9 ? i / 2 : i) * 2'654'435'761U);
+    document.append(fmt::format("{:08x},some,comma,separated,fields", key));
+  }
+
+  return document;
+}
+
+// Sort views of every line of a document, which is what the sort itself costs
+// without reading the lines or rebuilding the document
+void BM_SortLineViews(benchmark::State& state)
+{
+  auto const document = shuffled(state.range(0));
+  WorkerPool workers;
+  std::vector<std::string_view> views;
+
+  for (std::size_t i = 0; i < document.lineCount(); i++) {
+    views.push_back(document.line(i));
+  }
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto lines = views;
+    state.ResumeTiming();
+
+    sortLines(workers, lines);
+    benchmark::DoNotOptimize(lines.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_SortLineViews)->Arg(1'000'000)->Arg(50'000'000)->Unit(benchmark::kMillisecond);
+
+// Sort, or leave out repeated lines of, a whole document as the editor does,
+// rebuilding the document in the new order
+void BM_ReorderLines(benchmark::State& state)
+{
+  auto const document = shuffled(state.range(0));
+  auto const order = static_cast<LineOrder>(state.range(1));
+  WorkerPool workers;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto edited = document;
+    state.ResumeTiming();
+
+    benchmark::DoNotOptimize(reorderLines(workers, edited, 0, edited.lineCount(), order));
+
+    state.PauseTiming();
+    edited = Document();
+    state.ResumeTiming();
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ReorderLines)
+  ->Args({1'000'000, static_cast<std::int64_t>(LineOrder::Sorted)})
+  ->Args({1'000'000, static_cast<std::int64_t>(LineOrder::Unique)})
+  ->Args({50'000'000, static_cast<std::int64_t>(LineOrder::Sorted)})
+  ->Args({50'000'000, static_cast<std::int64_t>(LineOrder::Unique)})
+  ->Unit(benchmark::kMillisecond);
+
+}   // namespace
+
+}   // namespace Kilo::editor
@@ -8,9 +8,11 @@ class KiloRecipe(ConanFile):
     def requirements(self):
         self.requires("ms-gsl/4.0.0")
         self.requires("fmt/11.0.1")
+        self.requires("zlib/1.3.1")
 
     def build_requirements(self):
         self.test_requires("gtest/1.14.0")
+        self.test_requires("benchmark/1.8.3")
 
     def layout(self):
         cmake_layout(self)
@@ -24,24 +24,67 @@
 #include "Application.hpp"
 
 #include "Editor/Editor.hpp"
+#include "Editor/LineDiff/LineDiff.hpp"
+#include "Editor/LineFilter/LineFilter.hpp"
 #include "File/File.hpp"
 #include "IO/IO.hpp"
 #include "Utilities/Constants.hpp"
 #include "Utilities/Utilities.hpp"
-#include <fmt/format.h>
 #include <system_error>
 
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cerrno>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <iostream>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <span>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
 
 namespace Kilo::editor {
 
+namespace {
+
+// Documents that arrive over time are appended in batches of at most this many bytes, with a repaint in between, so
+// that a fast producer can't keep the screen from updating
+constexpr std::size_t LoadBudget = 4 * 1024 * 1024;
+
+// A replace-all is applied in batches of at most this many lines, with a repaint in between. An edit of more lines than
+// that is cheaper to take in as a whole than line by line
+constexpr std::size_t ReplaceBudget = 64 * 1024;
+
+// Append text of the document, or typed by the user, to the status line. Bytes that would be taken for control
+// sequences are shown as blanks
+void appendPrintable(std::string& status, std::string_view text)
+{
+  for (auto const c : text) {
+    status.push_back((c >= '\0' and c < ' ') or c == '\x7f' ? ' ' : c);
+  }
+}
+
+}   // namespace
+
 /// Default constructor
 Application::Application() noexcept
 try : m_window() {
-  // Nothing to do here...
+  // Start out with an empty buffer, which the first file opened takes over
+  m_buffers.push_back(std::make_unique<Buffer>());
+
+  IO::File terminal;
+  m_capabilities = Terminal::queryCapabilities(terminal);
 }
 catch (std::system_error const& err) {
   std::cerr << err.what() << '\n';
@@ -56,13 +99,101 @@ catch (std::runtime_error const& err) {
   std::exit(EXIT_FAILURE);
 }
 
+Application::Application(Terminal::WindowSize size, int output) : m_window(size), m_writer(output)
+{
+  m_buffers.push_back(std::make_unique<Buffer>());
+}
+
 /**
  * @brief Position the cursor within the visible window
  *
  */
 void Application::scroll() noexcept
 {
-  editor::scroll(m_cursor, m_off, m_window);
+  if (m_window.update() or std::exchange(m_rearrange, false)) {
+    // The last row is kept for the status line, unless it is the only one
+    auto const rows = m_window.rows() > 1 ? m_window.rows() - 1 : m_window.rows();
+    m_layout.arrange(Region {.top = 0, .left = 0, .rows = rows, .cols = m_window.cols()});
+    m_separatorsDrawn = false;
+    m_statusShown.clear();
+  }
+
+  // Panes lined up with the focused one by a diff follow it, with their cursors on the row its cursor is on, or on the
+  // first line below it where they have a gap
+  auto& focused = m_layout.focused();
+  auto const followed = [&focused](Pane const* pane) { return pane != &focused and pane->diff == focused.diff; };
+
+  if (focused.diff) {
+    auto const row = focused.diff->rowOf(focused.side, static_cast<std::size_t>(focused.cursor.y));
+
+    for (auto* pane : m_layout.panes() | std::views::filter(followed)) {
+      auto const& document = m_buffers[pane->buffer]->document;
+      auto const last = std::max(document.lineCount(), std::size_t {1}) - 1;
+      auto const line = std::min(pane->diff->lineAt(pane->side, row), last);
+      auto const length = line < document.lineCount() ? std::ssize(document.line(line)) : std::ptrdiff_t {};
+
+      pane->cursor = Cursor {.x = std::min(pane->cursor.x, length), .y = static_cast<std::int64_t>(line)};
+      pane->cursors.clear();
+    }
+  }
+
+  for (auto* pane : m_layout.panes()) {
+    // The gutter is as wide as the largest line number, so it grows and shrinks as lines are added or removed. It
+    // leaves at least one column for the text
+    auto const& area = pane->area;
+    auto const lines = m_buffers[pane->buffer]->rendered.lineCount();
+    auto const width = m_lineNumbers == LineNumbers::Off ? 0 : Gutter::widthFor(lines);
+    auto const gutter = width < area.cols ? width : 0;
+
+    pane->gutter.place(Region {.top = area.top, .left = area.left, .rows = area.rows, .cols = gutter});
+    pane->region = Region {.top = area.top, .left = area.left + gutter, .rows = area.rows, .cols = area.cols - gutter};
+
+    auto const view = Terminal::Window(Terminal::WindowSize {.cols = pane->region.cols, .rows = pane->region.rows});
+
+    if (pane->wrap) {
+      pane->wrap->setColumns(static_cast<std::size_t>(std::max(pane->region.cols, 1)));
+      editor::scrollWrapped(Cursor {.x = renderedColumn(*pane), .y = pane->cursor.y}, pane->offset, view, *pane->wrap);
+    }
+    else {
+      auto& buffer = *m_buffers[pane->buffer];
+      auto const& folds = buffer.folds;
+      auto& cursor = pane->cursor;
+      auto const line = static_cast<std::size_t>(cursor.y);
+
+      // A cursor on a line that was folded away moves up to the first line of the fold, which is still shown. One on
+      // a line a filter left out moves down to the next line it found, or up to the last one. While nothing has been
+      // found, it stays where it is
+      if (pane->filter and pane->filter->hidden(line)) {
+        auto const& filter = *pane->filter;
+        auto const row = filter.rowOf(line);
+        auto const found = filter.lines().size();
+        cursor.y = row < found ? static_cast<std::int64_t>(filter.lineAt(row))
+                   : found > 0 ? static_cast<std::int64_t>(filter.lineAt(found - 1))
+                               : cursor.y;
+      }
+      else if (!pane->filter and !pane->diff and folds.hidden(line)) {
+        cursor.y = static_cast<std::int64_t>(folds.lineAt(folds.rowOf(line) - 1));
+      }
+
+      if (static_cast<std::size_t>(cursor.y) != line) {
+        cursor.x = std::min(cursor.x, std::ssize(buffer.document.line(static_cast<std::size_t>(cursor.y))));
+      }
+
+      // Horizontal scrolling follows the column the cursor is shown at rather than its byte on the line, and vertical
+      // scrolling the row its line is shown on
+      auto const column = Cursor {.x = renderedColumn(*pane),
+                                  .y = static_cast<std::int64_t>(rowOf(*pane, static_cast<std::size_t>(cursor.y)))};
+      editor::scroll(column, pane->offset, view);
+    }
+  }
+
+  if (focused.diff) {
+    for (auto* pane : m_layout.panes() | std::views::filter(followed)) {
+      pane->offset.row = focused.offset.row;
+    }
+  }
+
+  m_rx = renderedColumn(m_layout.focused());
 }
 
 /**
@@ -72,19 +203,50 @@ void Application::scroll() noexcept
 void Application::refreshScreen()
 {
   /*
-   * Hide the cursor when painting and then move it to the home position
+   * Hide the cursor when painting. Terminals that support it are told to show the frame only once it is complete,
+   * however many writes it takes to get there. Elsewhere we rely on the frame being written all at once
    */
 
-  m_buffer.write(EscapeSequences::HideCursorWhenRepainting).write(EscapeSequences::MoveCursorToHomePosition);
+  // A frame that is still waiting to be written gets replaced by this one, which then has to draw everything that one
+  // did
+  if (m_writer.pending()) {
+    for (auto* pane : m_layout.panes()) {
+      pane->drawn.reset();
+      pane->gutter.invalidate();
+    }
+
+    m_separatorsDrawn = false;
+    m_statusShown.clear();
+  }
+
+  auto const synchronized = m_capabilities.synchronizedOutput;
+  m_buffer.write(synchronized ? EscapeSequences::BeginSynchronizedRepaint : EscapeSequences::HideCursorWhenRepainting);
 
   this->drawRows();
 
-  // We add 1 to cursor.x and cursor.y to convert from 0-indexed values to the
+  // We add 1 to the row and column to convert from 0-indexed values to the
   // 1-indexed values that the terminal uses
-  auto const cursorPos = fmt::format("\x1b[{};{}H", (m_cursor.y - m_off.row) + 1, (m_cursor.x - m_off.col) + 1);
+  auto const& pane = m_layout.focused();
+  auto const& [cursor, offset, region] = std::tie(pane.cursor, pane.offset, pane.region);
+  auto const shown = Cursor {.x = m_rx, .y = cursor.y};
+  auto const row = static_cast<std::int64_t>(pane.wrap ? editor::wrappedRowOf(shown, *pane.wrap)
+                                                       : rowOf(pane, static_cast<std::size_t>(cursor.y)));
+  auto const col = pane.wrap ? static_cast<std::int64_t>(editor::wrappedColumnOf(shown, *pane.wrap)) : m_rx;
+
+  // Text typed into the status line goes after what it already shows
+  if ((m_prompt == Prompt::Pattern or m_prompt == Prompt::Replacement or m_prompt == Prompt::Filter) and
+      m_window.rows() > 1) {
+    auto const last = static_cast<std::size_t>(std::max(m_window.cols() - 1, 0));
+    m_buffer.moveCursorTo(m_window.rows(), static_cast<std::int64_t>(std::min(m_statusLeft, last)) + 1);
+  }
+  else {
+    m_buffer.moveCursorTo(region.top + (row - offset.row) + 1, region.left + (col - offset.col) + 1);
+  }
 
-  IO::File output;
-  m_buffer.write(cursorPos).write(EscapeSequences::ShowTheCursor).flush(output);
+  m_buffer.write(synchronized ? EscapeSequences::EndSynchronizedRepaint : EscapeSequences::ShowTheCursor);
+
+  // The next frame starts from an empty buffer, which has the capacity of an earlier frame
+  m_writer.submit(m_buffer);
 }
 
 /**
@@ -96,26 +258,190 @@ void Application::processKeypress()
   auto const keyPressed = IO::readKey();
 
   if (keyPressed == utilities::ctrlKey('q')) {
-    utilities::clearScreenAndRepositionCursor();
-    std::exit(EXIT_SUCCESS);
+    m_quit = true;
+    return;
+  }
+
+  if (m_prompt != Prompt::None) {
+    promptKey(keyPressed);
+    return;
+  }
+
+  if (keyPressed == utilities::ctrlKey('w')) {
+    toggleSoftWrap();
+    return;
+  }
+
+  if (keyPressed == utilities::ctrlKey('l')) {
+    cycleLineNumbers();
+    return;
+  }
+
+  if (keyPressed == utilities::ctrlKey('t')) {
+    toggleFollow();
+    return;
+  }
+
+  if (keyPressed == utilities::ctrlKey('n') or keyPressed == utilities::ctrlKey('p')) {
+    cycleBuffers(keyPressed == utilities::ctrlKey('n') ? 1 : -1);
+    return;
+  }
+
+  if (keyPressed == utilities::ctrlKey('b') or keyPressed == utilities::ctrlKey('v')) {
+    split(keyPressed == utilities::ctrlKey('b') ? Layout::Split::Horizontal : Layout::Split::Vertical);
+    return;
+  }
+
+  if (keyPressed == utilities::ctrlKey('o')) {
+    m_layout.focusNext();
+    return;
+  }
+
+  if (keyPressed == utilities::ctrlKey('x')) {
+    closePane();
+    return;
+  }
+
+  if (keyPressed == utilities::ctrlKey('z') or keyPressed == utilities::ctrlKey('y')) {
+    stepHistory(keyPressed == utilities::ctrlKey('y'));
+    return;
+  }
+
+  if (keyPressed == static_cast<int>(editor::EditorKey::PasteStart)) {
+    paste();
+    return;
+  }
+
+  if (keyPressed == utilities::ctrlKey('s')) {
+    save();
+    return;
+  }
+
+  if (keyPressed == utilities::ctrlKey('e')) {
+    addCursorBelow();
+    return;
+  }
+
+  if (keyPressed == utilities::ctrlKey('f')) {
+    toggleFold();
+    return;
+  }
+
+  if (keyPressed == utilities::ctrlKey('g')) {
+    toggleAllFolds();
+    return;
+  }
+
+  if (keyPressed == utilities::ctrlKey(']') or keyPressed == utilities::ctrlKey('u')) {
+    jumpToBracket(keyPressed == utilities::ctrlKey('u'));
+    return;
+  }
+
+  if (keyPressed == utilities::ctrlKey('r')) {
+    replaceAll();
+    return;
+  }
+
+  if (keyPressed == utilities::ctrlKey('k')) {
+    filterLines();
+    return;
+  }
+
+  if (keyPressed == utilities::ctrlKey('d')) {
+    dropFilter();
+    return;
+  }
+
+  if (keyPressed == utilities::ctrlKey('a')) {
+    orderLines();
+    return;
+  }
+
+  if (keyPressed == utilities::ctrlKey('c')) {
+    compareBuffers();
+    return;
   }
 
   using enum editor::EditorKey;
   auto const key = static_cast<editor::EditorKey>(keyPressed);
+  auto& pane = m_layout.focused();
 
-  if (key == Home) {
-    m_cursor.x = 0;
+  // Escape goes back to a single cursor
+  if (keyPressed == '\x1b') {
+    pane.cursors.clear();
+    return;
   }
-  else if (key == End) {
-    m_cursor.x = m_window.cols() - 1;
+
+  if (key == Backspace or key == Delete or keyPressed == utilities::ctrlKey('h')) {
+    auto const direction = key == Delete ? Direction::Forward : Direction::Backward;
+    editAtCursors([direction](Document& document, std::span<Cursor> cursors) {
+      return eraseAt(document, cursors, direction);
+    });
+    return;
   }
-  else if (key == PageUp or key == PageDown) {
-    for (std::size_t i = m_window.rows(); i > 0; --i) {
-      moveCursor(key == PageUp ? ArrowUp : ArrowDown, m_cursor, m_row);
-    }
+
+  // Bytes above 127 are passed through, so that UTF-8 can be typed
+  if (keyPressed == '\r' or keyPressed == '\t' or (keyPressed >= ' ' and key < Backspace) or keyPressed < 0) {
+    auto const typed = keyPressed == '\r' ? '\n' : static_cast<char>(keyPressed);
+    editAtCursors([typed](Document& document, std::span<Cursor> cursors) {
+      return insertAt(document, cursors, std::string_view(&typed, 1));
+    });
+    return;
   }
-  else if (key == ArrowLeft or key == ArrowRight or key == ArrowUp or key == ArrowDown) {
-    moveCursor(key, m_cursor, m_row);
+
+  auto const& document = current().document;
+  auto& columns = current().columns;
+
+  // Lines folded away, or left out by a filter, are skipped, up to the line shown above them or down to the one below.
+  // There is no line to go up to above the first line a filter found
+  auto const step = [this, &pane, &document](editor::EditorKey key, Cursor& cursor) {
+    auto const from = cursor.y;
+    moveCursor(key, cursor, document);
+
+    if (pane.wrap or !hidden(pane, static_cast<std::size_t>(cursor.y))) {
+      return;
+    }
+
+    auto const row = rowOf(pane, static_cast<std::size_t>(cursor.y));
+    cursor.y = cursor.y > from ? static_cast<std::int64_t>(lineAt(pane, row))
+               : row > 0       ? static_cast<std::int64_t>(lineAt(pane, row - 1))
+                               : from;
+
+    auto const length = static_cast<std::size_t>(cursor.y) < document.lineCount()
+                          ? std::ssize(document.line(static_cast<std::size_t>(cursor.y)))
+                          : std::ptrdiff_t {};
+    cursor.x = key == ArrowLeft ? length : std::min(cursor.x, length);
+  };
+
+  auto const move = [&pane, key, &document, &columns, &step](Cursor& cursor) {
+    if (key == Home) {
+      cursor.x = 0;
+    }
+    else if (key == End) {
+      auto const line = static_cast<std::size_t>(cursor.y);
+      cursor.x = line < document.lineCount() ? static_cast<std::int64_t>(document.line(line).size()) : 0;
+    }
+    else if ((key == PageUp or key == PageDown) and pane.wrap) {
+      auto const view = Terminal::Window(Terminal::WindowSize {.cols = pane.region.cols, .rows = pane.region.rows});
+      pageWrapped(key, cursor, view, *pane.wrap, document, columns);
+    }
+    else if (key == PageUp or key == PageDown) {
+      for (auto i = pane.region.rows; i > 0; --i) {
+        step(key == PageUp ? ArrowUp : ArrowDown, cursor);
+      }
+    }
+    else if (key == ArrowLeft or key == ArrowRight or key == ArrowUp or key == ArrowDown) {
+      step(key, cursor);
+    }
+  };
+
+  // Every cursor moves the same way. Those that run into each other become one
+  move(pane.cursor);
+
+  if (!pane.cursors.empty()) {
+    std::ranges::for_each(pane.cursors, move);
+    normalize(pane.cursors);
+    std::erase(pane.cursors, pane.cursor);
   }
 }
 
@@ -124,30 +450,1667 @@ void Application::processKeypress()
  */
 void Application::drawRows()
 {
-  editor::drawRows(m_window, m_off, m_row, m_buffer, m_render);
+  if (!std::exchange(m_separatorsDrawn, true)) {
+    for (auto const& separator : m_layout.separators()) {
+      editor::drawSeparator(separator, m_buffer);
+    }
+  }
+
+  // A pane showing the same thing in the same place as last time is already on the screen
+  for (auto* pane : m_layout.panes()) {
+    auto& buffer = *m_buffers[pane->buffer];
+    auto const now = Pane::Drawn {.buffer = pane->buffer,
+                                  .generation = buffer.generation,
+                                  .offset = pane->offset,
+                                  .region = pane->region,
+                                  .wrapped = pane->wrap.has_value()};
+
+    if (pane->drawn == now) {
+      drawMarks(*pane, false, false);
+      continue;
+    }
+
+    auto const before = std::exchange(pane->drawn, now);
+
+    // After an edit that only changed some lines, only the rows showing those lines are drawn
+    if (before and before->generation + 1 == now.generation and !buffer.changedLines.empty()) {
+      auto edited = *before;
+      edited.generation = now.generation;
+
+      if (edited == now) {
+        drawChangedLines(*pane);
+        drawMarks(*pane, true, false);
+        continue;
+      }
+    }
+
+    // A pane that was only scrolled by a few rows is scrolled by the terminal, and only the rows scrolled into view
+    // are drawn. Scrolling bands span whole rows of the screen, so this only works for panes as wide as the screen.
+    // The gutter is scrolled along with the text
+    auto const& region = pane->region;
+    auto const& area = pane->area;
+    auto const scrolled = before ? before->scrolledBy(now) : std::nullopt;
+
+    if (scrolled and std::abs(*scrolled) < region.rows and area.left == 0 and area.cols == m_window.cols()) {
+      editor::scrollRegion(region, *scrolled, m_buffer);
+      pane->gutter.scroll(*scrolled);
+
+      auto const exposed = static_cast<int>(std::abs(*scrolled));
+      drawPaneRows(*pane, *scrolled > 0 ? region.rows - exposed : 0, exposed);
+
+      // The marks of the other cursors moved along with their rows
+      for (auto& mark : pane->marks) {
+        mark.row -= static_cast<int>(*scrolled);
+      }
+
+      std::erase_if(pane->marks, [&region](Pane::Mark const& mark) { return mark.row < 0 or mark.row >= region.rows; });
+      drawMarks(*pane, true, false);
+      continue;
+    }
+
+    drawPaneRows(*pane, 0, region.rows);
+    drawMarks(*pane, true, true);
+  }
+
+  for (auto* pane : m_layout.panes()) {
+    drawGutter(*pane);
+  }
+
+  drawStatusLine();
+}
+
+void Application::drawPaneRows(Pane const& pane, int first, int count)
+{
+  auto& buffer = *m_buffers[pane.buffer];
+
+  auto region = pane.region;
+  region.top += first;
+  region.rows = count;
+
+  auto offset = pane.offset;
+  offset.row += first;
+
+  if (pane.wrap) {
+    editor::drawWrappedRegion(region, m_window.cols(), offset, *pane.wrap, m_buffer, buffer.rendered, buffer.columns);
+  }
+  else if (pane.diff) {
+    editor::drawAlignedRegion(region, m_window.cols(), offset, *pane.diff, pane.side, m_buffer, buffer.rendered,
+                              buffer.columns);
+  }
+  else if (pane.filter) {
+    editor::drawFilteredRegion(region, m_window.cols(), offset, pane.filter->lines(), m_buffer, buffer.rendered,
+                               buffer.columns);
+  }
+  else if (buffer.folds.folded()) {
+    editor::drawFoldedRegion(region, m_window.cols(), offset, buffer.folds, m_buffer, buffer.rendered, buffer.columns);
+  }
+  else {
+    editor::drawRegion(region, m_window.cols(), offset, m_buffer, buffer.rendered, buffer.columns);
+  }
+}
+
+void Application::drawChangedLines(Pane const& pane)
+{
+  auto const& buffer = *m_buffers[pane.buffer];
+  auto const& lines = buffer.changedLines;
+  auto const top = pane.offset.row;
+  auto const rows = static_cast<std::int64_t>(pane.region.rows);
+
+  // The first and last row of the pane each line is shown on
+  auto const rowsOf = [this, &pane](std::size_t line) {
+    if (!pane.wrap) {
+      auto const row = static_cast<std::int64_t>(rowOf(pane, line));
+      return std::pair {row, row};
+    }
+
+    auto const first = static_cast<std::int64_t>(pane.wrap->firstRowOf(line));
+    return std::pair {first, first + static_cast<std::int64_t>(pane.wrap->rowsOf(line)) - 1};
+  };
+
+  // Lines above the pane are skipped with a binary search, so that an edit of thousands of lines costs no more than
+  // the rows that show them
+  auto const row = static_cast<std::size_t>(top);
+  auto const firstLine = !pane.wrap                   ? lineAt(pane, row)
+                         : row < pane.wrap->rowCount() ? pane.wrap->locate(row).line
+                                                       : row;
+
+  for (auto line = std::ranges::lower_bound(lines, firstLine); line != lines.end(); ++line) {
+    // Lines folded away, or left out by a filter, aren't shown anywhere
+    if (!pane.wrap and hidden(pane, *line)) {
+      continue;
+    }
+
+    auto const [first, last] = rowsOf(*line);
+
+    if (first - top >= rows) {
+      break;
+    }
+
+    auto const from = std::max(first - top, std::int64_t {0});
+    auto const to = std::min(last - top, rows - 1);
+    drawPaneRows(pane, static_cast<int>(from), static_cast<int>(to - from + 1));
+  }
+}
+
+void Application::drawGutter(Pane& pane)
+{
+  if (pane.gutter.region().cols == 0) {
+    return;
+  }
+
+  auto const& document = m_buffers[pane.buffer]->rendered;
+  auto const cursor = static_cast<std::size_t>(pane.cursor.y);
+  m_numbers.clear();
+
+  for (auto row = 0; row < pane.region.rows; row++) {
+    auto const visual = static_cast<std::size_t>(pane.offset.row + row);
+    auto line = pane.wrap ? visual : lineAt(pane, visual);
+
+    // Only the first of the rows a line was folded onto is numbered
+    if (pane.wrap) {
+      line = visual < pane.wrap->rowCount() ? pane.wrap->locate(visual).line : document.lineCount();
+
+      if (line < document.lineCount() and pane.wrap->firstRowOf(line) != visual) {
+        line = document.lineCount();
+      }
+    }
+
+    // Gaps across from lines only the other side of a diff has aren't numbered either
+    if (pane.diff and pane.diff->gap(pane.side, visual)) {
+      line = document.lineCount();
+    }
+
+    if (line >= document.lineCount()) {
+      m_numbers.push_back(Gutter::Blank);
+    }
+    else if (m_lineNumbers == LineNumbers::Relative and line != cursor) {
+      m_numbers.push_back(line > cursor ? line - cursor : cursor - line);
+    }
+    else {
+      m_numbers.push_back(line + 1);
+    }
+  }
+
+  pane.gutter.draw(m_numbers, m_buffer);
+}
+
+void Application::drawStatusLine()
+{
+  if (m_window.rows() < 2) {
+    return;
+  }
+
+  // The text is formatted into a string that keeps its capacity from frame to frame
+  m_status.clear();
+  m_statusLeft = m_prompt == Prompt::None ? formatStatistics() : formatPrompt();
+
+  if (m_status == m_statusShown) {
+    return;
+  }
+
+  auto const row = Region {.top = m_window.rows() - 1, .left = 0, .rows = 1, .cols = m_window.cols()};
+  editor::drawStatusLine(row, std::string_view(m_status).substr(0, m_statusLeft),
+                         std::string_view(m_status).substr(m_statusLeft), m_buffer);
+  m_statusShown.assign(m_status);
+}
+
+auto Application::formatStatistics() -> std::size_t
+{
+  auto const& pane = m_layout.focused();
+  auto const& buffer = *m_buffers[pane.buffer];
+  auto const& statistics = buffer.statistics;
+  auto const totals = statistics.totals();
+
+  auto const& path = buffer.path.native();
+  auto const name = path.empty() ? std::string_view("[No Name]") : std::string_view(path).substr(path.rfind('/') + 1);
+
+  auto out = fmt::format_to(std::back_inserter(m_status), " {}", name);
+
+  // The lines a filter found are shown as they come in, along with how far the search has got. They come first, as
+  // they are what the pane shows
+  if (pane.filter) {
+    auto const& filter = *pane.filter;
+    m_status.append(" filtered by");
+
+    for (auto separator = " \""; auto const& pattern : filter.patterns()) {
+      m_status.append(std::exchange(separator, ", \""));
+      appendPrintable(m_status, pattern);
+      m_status.push_back('"');
+    }
+
+    out = fmt::format_to(out, ": {}", filter.lines().size());
+
+    if (!filter.complete()) {
+      auto const chunks = filter.chunkCount();
+      out = fmt::format_to(out, " (searching, {}%)", 100 * (chunks - filter.pending()) / chunks);
+    }
+  }
+
+  // A diff is summed up by how many lines differ on either side
+  if (pane.diff) {
+    auto const& diff = *pane.diff;
+    auto const other = pane.side == DiffSide::Left ? DiffSide::Right : DiffSide::Left;
+    out = fmt::format_to(out, " - {} of diff, {} runs differ ({} lines here, {} there)",
+                         pane.side == DiffSide::Left ? "left" : "right", diff.hunks().size(),
+                         diff.changedLines(pane.side), diff.changedLines(other));
+  }
+
+  out = fmt::format_to(out, "{} {} lines, {} words, {} bytes, longest line {}, {:.1f}% non-ASCII",
+                       pane.filter ? " of" : " -", totals.lines, totals.words, totals.bytes, totals.longestLine,
+                       100.0 * totals.nonAsciiRatio());
+
+  // Counts are shown as they come in, along with how far counting has got
+  if (!statistics.complete()) {
+    auto const chunks = statistics.chunkCount();
+    out = fmt::format_to(out, " (counting, {}%)", 100 * (chunks - statistics.pending()) / chunks);
+  }
+
+  // A file whose lines end in both ways is written back with the ending most of them had, which the user is told
+  if (auto const converted = buffer.format.convertedLines(); converted > 0) {
+    auto const crlf = buffer.format.lineEnding() == LineEnding::CrLf;
+    out = fmt::format_to(out, ", mixed line endings ({} {} saved as {})", converted, crlf ? "LF" : "CRLF",
+                         crlf ? "CRLF" : "LF");
+  }
+
+  // A terminal that can't keep up makes the writer skip frames and wait, which explains a screen that lags behind
+  if (auto const writer = writerStats(); writer.framesDropped > 0 or writer.writeStalls > 0) {
+    out = fmt::format_to(out, ", terminal behind ({} frames dropped, {} write stalls)", writer.framesDropped,
+                         writer.writeStalls);
+  }
+
+  auto const left = m_status.size();
+  fmt::format_to(out, " Ln {}, Col {} ", pane.cursor.y + 1, pane.cursor.x + 1);
+  return left;
+}
+
+auto Application::formatPrompt() -> std::size_t
+{
+  using enum Prompt;
+  auto const cols = static_cast<std::size_t>(m_window.cols());
+  auto const typing = m_prompt == Pattern or m_prompt == Replacement;
+  auto const replaceable = m_prompt == Preview and m_replace.complete() and m_replace.matches() > 0;
+  auto const hint = std::string_view(typing        ? " Enter to go on, Esc to cancel "
+                                     : replaceable ? " Enter to replace, Esc to cancel "
+                                                   : " Esc to cancel ");
+
+  if (m_prompt == Order) {
+    auto const& pane = m_layout.focused();
+    auto out = std::back_inserter(m_status);
+
+    if (pane.cursors.empty()) {
+      out = fmt::format_to(out, " Order all lines:");
+    }
+    else {
+      auto const first = std::min(pane.cursor, pane.cursors.front()).y;
+      auto const last = std::max(pane.cursor, pane.cursors.back()).y;
+      out = fmt::format_to(out, " Order lines {} to {}:", first + 1, last + 1);
+    }
+
+    auto const left = m_status.size();
+    fmt::format_to(out, " s to sort, u to leave out repeats, r to reverse, Esc to cancel ");
+    return left;
+  }
+
+  if (m_prompt == Filter) {
+    m_status.append(" Filter: ");
+    appendPrintable(m_status, m_pattern);
+
+    auto const left = m_status.size();
+    m_status.append(" Enter to filter, Esc to cancel ");
+    return left;
+  }
+
+  m_status.append(m_prompt == Pattern ? " Replace: " : " Replace \"");
+  appendPrintable(m_status, m_pattern);
+
+  if (m_prompt != Pattern) {
+    m_status.append(m_prompt == Replacement ? "\" with: " : "\" with \"");
+    appendPrintable(m_status, m_replacement);
+  }
+
+  // Matches are counted as the chunks of the document come in, along with how far the search has got. The first line
+  // they change is shown as it will be, as far as it fits next to the hint
+  if (!typing) {
+    auto const chunks = m_replace.chunkCount();
+    auto out = fmt::format_to(std::back_inserter(m_status), "\": {} matches on {} lines", m_replace.matches(),
+                              m_replace.lines());
+
+    if (!m_replace.complete()) {
+      out = fmt::format_to(out, " (searching, {}%)", 100 * (chunks - m_replace.pending()) / chunks);
+    }
+    else if (m_prompt == Applying) {
+      out = fmt::format_to(out, " (replacing)");
+    }
+
+    if (auto const preview = m_replace.preview()) {
+      fmt::format_to(out, ", Ln {}: ", preview->line + 1);
+      auto const room = cols > m_status.size() + hint.size() ? cols - m_status.size() - hint.size() : 0;
+      appendPrintable(m_status, preview->text.substr(0, room));
+    }
+  }
+
+  auto const left = m_status.size();
+  m_status.append(hint);
+  return left;
+}
+
+void Application::drawMarks(Pane& pane, bool drawn, bool full)
+{
+  auto& buffer = *m_buffers[pane.buffer];
+  auto const& document = buffer.rendered;
+  m_marks.clear();
+
+  auto const mark = [this, &pane, &buffer, &document](Cursor const& cursor, bool bracket) {
+    auto const line = static_cast<std::size_t>(cursor.y);
+
+    if (!pane.wrap and hidden(pane, line)) {
+      return false;
+    }
+
+    auto const text = line < document.lineCount() ? document.line(line) : std::string_view {};
+    auto const byte = static_cast<std::size_t>(std::clamp<std::int64_t>(cursor.x, 0, std::ssize(text)));
+    auto const column = static_cast<std::int64_t>(buffer.columns.columnOf(line, text, byte));
+    auto const shown = Cursor {.x = column, .y = cursor.y};
+
+    auto const row = pane.wrap ? static_cast<std::int64_t>(editor::wrappedRowOf(shown, *pane.wrap)) - pane.offset.row
+                               : static_cast<std::int64_t>(rowOf(pane, line)) - pane.offset.row;
+    auto const col = pane.wrap ? static_cast<std::int64_t>(editor::wrappedColumnOf(shown, *pane.wrap))
+                               : column - pane.offset.col;
+
+    if (row < 0 or row >= pane.region.rows or col < 0 or col >= pane.region.cols) {
+      return false;
+    }
+
+    // Anything but printable ASCII, e.g. a tab or the end of the line, is shown as a blank
+    auto const c = byte < text.size() ? text[byte] : ' ';
+    m_marks.push_back(Pane::Mark {.row = static_cast<int>(row),
+                                  .col = static_cast<int>(col),
+                                  .shown = c >= ' ' and c < '\x7f' ? c : ' ',
+                                  .bracket = bracket});
+    return true;
+  };
+
+  for (auto const& cursor : pane.cursors) {
+    mark(cursor, false);
+  }
+
+  // The bracket matching the one at the cursor of the focused pane is found through the bracket index, which only
+  // reads the blocks the two brackets are in
+  if (&pane == &m_layout.focused()) {
+    if (auto const match = buffer.brackets.match(buffer.document, pane.cursor); match and mark(*match, true)) {
+      // The marks of the cursors are in order of their rows already, so the match only has to be moved in among them
+      auto const at = std::ranges::upper_bound(m_marks.begin(), m_marks.end() - 1, m_marks.back().row, {},
+                                               &Pane::Mark::row);
+      std::rotate(at, m_marks.end() - 1, m_marks.end());
+    }
+  }
+
+  if (!drawn and m_marks == pane.marks) {
+    return;
+  }
+
+  // Marks are drawn over the rows, so removing one means drawing its row again
+  if (!full) {
+    for (auto row = -1; auto const& mark : pane.marks) {
+      if (std::exchange(row, mark.row) != mark.row) {
+        drawPaneRows(pane, mark.row, 1);
+      }
+    }
+  }
+
+  for (auto const& shown : m_marks) {
+    m_buffer.moveCursorTo(pane.region.top + shown.row + 1, pane.region.left + shown.col + 1);
+
+    if (shown.bracket) {
+      m_buffer.selectGraphicRendition(1, 4);
+    }
+    else {
+      m_buffer.selectGraphicRendition(7);
+    }
+
+    m_buffer.write(std::string_view(&shown.shown, 1)).selectGraphicRendition();
+  }
+
+  pane.marks.swap(m_marks);
 }
 
 /**
- * @brief Open a file and write its contents to memory
+ * @brief Split the focused pane in two
  *
- * @param[in] path The path to the file
- * @return true If the operation was successful
- * @return false If the operation failed
+ * @param[in] how Whether the new pane goes below or to the right of the focused one
  */
-auto Application::open(std::filesystem::path const& path) -> bool
+void Application::split(Layout::Split how)
 {
-  return editor::open(path, m_row, m_render);
+  m_layout.split(how);
+  m_rearrange = true;
 }
 
-void Application::run()
-try {
-  while (true) {
-    scroll();
-    refreshScreen();
-    processKeypress();
-  }
+/**
+ * @brief Close the focused pane, unless it is the only one
+ */
+void Application::closePane()
+{
+  remember(m_layout.focused());
+
+  if (m_layout.close()) {
+    m_rearrange = true;
+  }
+}
+
+/**
+ * @brief Open a file in a new buffer
+ *
+ * @param[in] path The path to the file
+ * @return true If the operation was successful
+ * @return false If the operation failed
+ */
+auto Application::open(std::filesystem::path const& path) -> bool
+{
+  // Named pipes, including the ones the shell creates for process substitution, are streamed in like stdin
+  if (std::filesystem::is_fifo(path)) {
+    auto const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1) {
+      return false;
+    }
+
+    openStream(fd);
+    return true;
+  }
+
+  std::error_code error;
+  auto canonical = std::filesystem::canonical(path, error);
+
+  if (error) {
+    return false;
+  }
+
+  // A file that is already open shares its lines with the new buffer instead of being read again, unless they were
+  // edited since they were read or saved. Copying a document only copies its root
+  auto const open = std::ranges::find_if(m_buffers, [&canonical](auto const& buffer) {
+    return buffer->path == canonical and !buffer->loader and buffer->generation == buffer->savedGeneration;
+  });
+
+  if (open != m_buffers.end()) {
+    auto const& existing = **open;
+    auto& buffer = newBuffer();
+    buffer.document = existing.document;
+    buffer.rendered = existing.rendered;
+    buffer.format = existing.format;
+    buffer.path = std::move(canonical);
+    buffer.readOnly = existing.readOnly;
+    buffer.statistics.replaced(m_workers, buffer.document, 0);
+    buffer.brackets.replaced(m_workers, buffer.document, 0);
+    buffer.folds.replaced(buffer.document, 0);
+    return true;
+  }
+
+  // Compressed files are streamed in too, so the first lines show up while the rest is still being inflated
+  if (std::filesystem::is_regular_file(canonical)) {
+    auto const fd = ::open(canonical.c_str(), O_RDONLY | O_CLOEXEC);
+
+    // Saving would write the lines back uncompressed, so the buffer is only shown
+    if (fd != -1 and GzipReader::isGzip(fd)) {
+      auto& buffer = newBuffer();
+      buffer.path = std::move(canonical);
+      buffer.readOnly = true;
+      auto const stream = buffer.gzip.emplace(fd).release();
+      ::fcntl(stream, F_SETFL, ::fcntl(stream, F_GETFL) | O_NONBLOCK);
+      buffer.loader.emplace(stream);
+      return true;
+    }
+
+    if (fd != -1) {
+      ::close(fd);
+    }
+  }
+
+  Document document;
+  Document rendered;
+  TextFormat format;
+
+  if (!editor::open(canonical, document, rendered, format)) {
+    return false;
+  }
+
+  auto& buffer = newBuffer();
+  buffer.document = std::move(document);
+  buffer.rendered = std::move(rendered);
+  buffer.format = format;
+  buffer.path = std::move(canonical);
+  buffer.statistics.replaced(m_workers, buffer.document, 0);
+  buffer.brackets.replaced(m_workers, buffer.document, 0);
+  buffer.folds.replaced(buffer.document, 0);
+
+  return true;
+}
+
+/**
+ * @brief Load a document from a stream such as a pipe into a new buffer while the editor is already running
+ *
+ * @param[in] fileDescriptor The stream to read from
+ */
+void Application::openStream(int fileDescriptor)
+{
+  // The main loop waits for the stream and the keyboard at once, so reading must never block
+  ::fcntl(fileDescriptor, F_SETFL, ::fcntl(fileDescriptor, F_GETFL) | O_NONBLOCK);
+  newBuffer().loader.emplace(fileDescriptor);
+}
+
+/**
+ * @brief Save the buffer shown in the focused pane to its file
+ *
+ * @return false If the buffer didn't come from a file, can't be written back to it, or the file could not be written
+ */
+auto Application::save() -> bool
+{
+  auto& buffer = current();
+
+  if (buffer.path.empty() or buffer.loader or buffer.readOnly) {
+    return false;
+  }
+
+  if (!editor::save(buffer.path, buffer.document, buffer.format)) {
+    return false;
+  }
+
+  // Every line has been written with the same ending, so there are none left to convert
+  (buffer.format.lineEnding() == LineEnding::CrLf ? buffer.format.lfLines : buffer.format.crlfLines) = 0;
+  buffer.savedGeneration = buffer.generation;
+  return true;
+}
+
+/**
+ * @brief Show the next or previous buffer in the focused pane
+ *
+ * @param[in] step 1 for the next buffer, -1 for the previous one
+ */
+void Application::cycleBuffers(int step) noexcept
+{
+  auto& pane = m_layout.focused();
+
+  if (pane.diff) {
+    dropDiff(pane.diff);
+  }
+
+  remember(pane);
+
+  auto const count = std::ssize(m_buffers);
+  pane.buffer = static_cast<std::size_t>((static_cast<std::ptrdiff_t>(pane.buffer) + step % count + count) % count);
+
+  // Pick up where the buffer was left
+  auto& buffer = current();
+  pane.cursor = buffer.cursor;
+  pane.offset = buffer.offset;
+  pane.wrap = std::move(buffer.wrap);
+  buffer.wrap.reset();
+  pane.filter.reset();
+}
+
+auto Application::renderedColumn(Pane const& pane) -> std::int64_t
+{
+  auto& buffer = *m_buffers[pane.buffer];
+  auto const line = static_cast<std::size_t>(pane.cursor.y);
+
+  if (line >= buffer.rendered.lineCount()) {
+    return 0;
+  }
+
+  auto const text = buffer.rendered.line(line);
+  return static_cast<std::int64_t>(buffer.columns.columnOf(line, text, static_cast<std::size_t>(pane.cursor.x)));
+}
+
+void Application::remember(Pane& pane) noexcept
+{
+  auto& buffer = *m_buffers[pane.buffer];
+  buffer.cursor = pane.cursor;
+  buffer.offset = pane.offset;
+
+  // The filter or the diff stays with the pane, so the buffer keeps the line at the top of it as a row of its folds
+  if (pane.filter or pane.diff) {
+    buffer.offset.row =
+      static_cast<std::int64_t>(buffer.folds.rowOf(lineAt(pane, static_cast<std::size_t>(pane.offset.row))));
+  }
+  buffer.wrap = std::move(pane.wrap);
+  pane.wrap.reset();
+}
+
+auto Application::newBuffer() -> Buffer&
+{
+  if (std::exchange(m_pristine, false)) {
+    return current();
+  }
+
+  return *m_buffers.emplace_back(std::make_unique<Buffer>());
+}
+
+/**
+ * @brief Switch the gutter of every pane from line numbers to relative line numbers to none, and back again
+ */
+void Application::cycleLineNumbers() noexcept
+{
+  using enum LineNumbers;
+  m_lineNumbers = m_lineNumbers == Absolute ? Relative : m_lineNumbers == Relative ? Off : Absolute;
+}
+
+/**
+ * @brief Turn soft-wrap on or off
+ *
+ */
+void Application::toggleSoftWrap()
+{
+  auto& pane = m_layout.focused();
+  auto& offset = pane.offset;
+  auto& wrap = pane.wrap;
+  auto const& rendered = current().rendered;
+  auto const& folds = current().folds;
+
+  // Lines a filter found, or lined up by a diff, are shown without being folded
+  if (pane.filter or pane.diff) {
+    return;
+  }
+
+  // Keep the same line at the top of the pane across the switch. Soft-wrapped panes show every line, folded or not
+  if (wrap) {
+    auto const top = static_cast<std::size_t>(offset.row);
+    offset.row = static_cast<std::int64_t>(
+      folds.rowOf(top < wrap->rowCount() ? wrap->locate(top).line : wrap->lineCount()));
+    wrap.reset();
+  }
+  else {
+    auto const view = Terminal::Window(Terminal::WindowSize {.cols = pane.region.cols, .rows = pane.region.rows});
+    wrap = editor::buildWrapIndex(rendered, view, current().columns);
+    auto const top = std::min(folds.lineAt(static_cast<std::size_t>(offset.row)), rendered.lineCount());
+    offset.row = static_cast<std::int64_t>(wrap->firstRowOf(top));
+  }
+}
+
+auto Application::waitForInput() -> bool
+{
+  // Keys read ahead along with a paste don't make stdin readable again
+  if (IO::hasBufferedInput()) {
+    return true;
+  }
+
+  // Every buffer contributes its stream and its inotify instance. poll() skips entries with a negative file
+  // descriptor, so the positions stay fixed whether or not a buffer is loading or following anything
+  m_pollSet.clear();
+  m_pollSet.push_back({.fd = STDIN_FILENO, .events = POLLIN, .revents = 0});
+
+  // A file that grew by more than one batch doesn't notify us again about the rest, so don't wait for it
+  auto behind = false;
+
+  for (auto const& buffer : m_buffers) {
+    m_pollSet.push_back({.fd = buffer->loader ? buffer->loader->fileDescriptor() : -1, .events = POLLIN, .revents = 0});
+    m_pollSet.push_back(
+      {.fd = buffer->follower ? buffer->follower->fileDescriptor() : -1, .events = POLLIN, .revents = 0});
+    behind = behind or (buffer->follower and !buffer->follower->caughtUp());
+  }
+
+  m_pollSet.push_back({.fd = m_workers.fileDescriptor(), .events = POLLIN, .revents = 0});
+
+  // Neither does a replace-all being applied, which goes on between frames
+  auto const busy = behind or m_prompt == Prompt::Applying;
+
+  while (::poll(m_pollSet.data(), m_pollSet.size(), busy ? 0 : -1) == -1) {
+    if (errno != EINTR) {
+      throw std::system_error(errno, std::system_category(), "Could not wait for input");
+    }
+  }
+
+  for (std::size_t i = 0; i < m_buffers.size(); i++) {
+    auto const& buffer = *m_buffers[i];
+
+    // A closed pipe reports POLLHUP rather than POLLIN, and the read that follows is what tells us the stream ended
+    if (m_pollSet[2 * i + 1].revents != 0) {
+      loadMore(i);
+    }
+
+    if (buffer.follower and (m_pollSet[2 * i + 2].revents != 0 or !buffer.follower->caughtUp())) {
+      followFile(i);
+    }
+  }
+
+  // Workers finished counting some of the documents
+  if (m_pollSet.back().revents != 0) {
+    m_workers.acknowledge();
+
+    for (auto const& buffer : m_buffers) {
+      buffer->statistics.collect();
+      buffer->brackets.collect();
+    }
+
+    m_replace.collect();
+
+    // Panes show the lines their filter found as they come in
+    for (auto* pane : m_layout.panes()) {
+      if (pane->filter and pane->filter->collect()) {
+        for (auto* other : m_layout.panes()) {
+          if (other->filter == pane->filter) {
+            other->drawn.reset();
+          }
+        }
+      }
+    }
+  }
+
+  if (m_prompt == Prompt::Applying) {
+    applyReplacement();
+  }
+
+  return (m_pollSet[0].revents & POLLIN) != 0;
+}
+
+void Application::loadMore(std::size_t index)
+{
+  auto& buffer = *m_buffers[index];
+
+  // The rendered copy shares the last leaf of the document. Dropping it while appending means the leaf is copied at
+  // most once per batch instead of once per line
+  buffer.rendered = Document();
+
+  auto const first = buffer.document.lineCount();
+  buffer.loader->pump(buffer.document, LoadBudget);
+
+  buffer.rendered = buffer.document;
+  buffer.generation++;
+  buffer.changedLines.clear();
+  buffer.statistics.replaced(m_workers, buffer.document, first);
+  buffer.brackets.replaced(m_workers, buffer.document, first);
+  undiff(index);
+  refilter(index, [this, &buffer, first](LineFilter& filter) {
+    filter.replaced(m_workers, buffer.document, first);
+    return true;
+  });
+  refold(index, [&buffer, first] { return buffer.folds.replaced(buffer.document, first); });
+  updateWrapIndices(index, first, false);
+
+  if (buffer.loader->finished()) {
+    buffer.format = buffer.loader->format();
+    buffer.loader.reset();
+    buffer.gzip.reset();
+  }
+}
+
+/**
+ * @brief Turn follow mode on or off
+ *
+ * @return false If follow mode could not be turned on
+ */
+auto Application::toggleFollow() -> bool
+{
+  auto const index = m_layout.focused().buffer;
+  auto& buffer = *m_buffers[index];
+
+  if (buffer.follower) {
+    buffer.follower.reset();
+    return true;
+  }
+
+  if (buffer.path.empty() or buffer.loader or buffer.readOnly) {
+    return false;
+  }
+
+  try {
+    buffer.follower.emplace(buffer.path, buffer.document, buffer.format);
+  }
+  catch (std::system_error const&) {
+    return false;
+  }
+
+  // The follower may have taken back an unfinished last line
+  buffer.rendered = buffer.document;
+  buffer.generation++;
+  buffer.changedLines.clear();
+  buffer.statistics.replaced(m_workers, buffer.document, buffer.document.lineCount());
+  buffer.brackets.replaced(m_workers, buffer.document, buffer.document.lineCount());
+  undiff(index);
+  refilter(index, [this, &buffer](LineFilter& filter) {
+    filter.replaced(m_workers, buffer.document, buffer.document.lineCount());
+    return true;
+  });
+  refold(index, [&buffer] { return buffer.folds.replaced(buffer.document, buffer.document.lineCount()); });
+  buffer.columns.clear();
+  updateWrapIndices(index, 0, true);
+
+  for (auto* pane : m_layout.panes()) {
+    if (pane->buffer == index) {
+      pane->cursor.y = std::min(pane->cursor.y, static_cast<std::int64_t>(buffer.document.lineCount()));
+    }
+  }
+
+  return true;
+}
+
+void Application::followFile(std::size_t index)
+{
+  auto& buffer = *m_buffers[index];
+  auto const lines = static_cast<std::int64_t>(buffer.document.lineCount());
+
+  buffer.rendered = Document();
+
+  auto const update = buffer.follower->update(buffer.document, LoadBudget);
+  auto const reloaded = update == FileFollower::Update::Reloaded;
+
+  buffer.rendered = buffer.document;
+  buffer.generation++;
+  buffer.changedLines.clear();
+  buffer.statistics.replaced(m_workers, buffer.document, reloaded ? 0 : static_cast<std::size_t>(lines));
+  buffer.brackets.replaced(m_workers, buffer.document, reloaded ? 0 : static_cast<std::size_t>(lines));
+  undiff(index);
+  refilter(index, [this, &buffer, reloaded, lines](LineFilter& filter) {
+    filter.replaced(m_workers, buffer.document, reloaded ? 0 : static_cast<std::size_t>(lines));
+    return true;
+  });
+  refold(index, [&buffer, reloaded, lines] {
+    return buffer.folds.replaced(buffer.document, reloaded ? 0 : static_cast<std::size_t>(lines));
+  });
+  updateWrapIndices(index, static_cast<std::size_t>(lines), reloaded);
+
+  if (reloaded) {
+    buffer.columns.clear();
+  }
+
+  auto const now = static_cast<std::int64_t>(buffer.document.lineCount());
+
+  // Panes with the cursor on the last line follow the end of the file, like tail -f does
+  for (auto* pane : m_layout.panes()) {
+    if (pane->buffer != index) {
+      continue;
+    }
+
+    if (reloaded) {
+      pane->cursor.y = std::min(pane->cursor.y, now);
+    }
+    else if (pane->cursor.y >= lines - 1 and now > lines) {
+      pane->cursor.y += now - lines;
+      pane->cursor.x = 0;
+    }
+  }
+}
+
+/**
+ * @brief Insert pasted text at the cursors of the focused pane, as a single edit that is undone in one step
+ */
+void Application::paste()
+{
+  // The whole of the paste has to be read even if it can't be inserted, or it would be taken for typing
+  IO::readPaste(m_paste);
+
+  editAtCursors([this](Document& document, std::span<Cursor> cursors) { return insertAt(document, cursors, m_paste); });
+}
+
+template <typename Edit>
+void Application::editAtCursors(Edit const& edit)
+{
+  auto& pane = m_layout.focused();
+  auto& buffer = *m_buffers[pane.buffer];
+
+  // The cursor of a filtered pane is only on a line it doesn't show while nothing has been found
+  if (!editable(buffer) or (pane.filter and hidden(pane, static_cast<std::size_t>(pane.cursor.y)))) {
+    return;
+  }
+
+  // The cursor the view follows is edited along with the others, in its place among them
+  m_cursors.assign(pane.cursors.begin(), pane.cursors.end());
+  auto const primary = std::ranges::lower_bound(m_cursors, pane.cursor) - m_cursors.begin();
+  m_cursors.insert(m_cursors.begin() + primary, pane.cursor);
+
+  buffer.history.record(buffer.document, pane.cursor);
+  auto const changed = edit(buffer.document, std::span(m_cursors));
+
+  // The cursors are still in order, but those that ran into each other become one
+  pane.cursor = m_cursors[static_cast<std::size_t>(primary)];
+  m_cursors.erase(m_cursors.begin() + primary);
+  std::erase(m_cursors, pane.cursor);
+  normalize(m_cursors);
+  pane.cursors.swap(m_cursors);
+
+  edited(pane.buffer, changed);
+  revealCursors(pane);
+}
+
+void Application::addCursorBelow()
+{
+  auto& pane = m_layout.focused();
+  auto const& document = current().document;
+  auto const last = pane.cursors.empty() ? pane.cursor : std::max(pane.cursor, pane.cursors.back());
+
+  // Lines folded away, or left out by a filter, are skipped
+  auto const below = static_cast<std::size_t>(last.y + 1);
+  auto const line = pane.wrap or !hidden(pane, below) ? below : lineAt(pane, rowOf(pane, below));
+
+  if (line >= document.lineCount()) {
+    return;
+  }
+
+  // The new cursor takes over as the one the view follows, so that adding cursors one after another walks down the
+  // document
+  pane.cursors.insert(std::ranges::upper_bound(pane.cursors, pane.cursor), pane.cursor);
+  pane.cursor = Cursor {.x = std::min(pane.cursor.x, std::ssize(document.line(line))),
+                        .y = static_cast<std::int64_t>(line)};
+}
+
+/**
+ * @brief Undo the last edit of the buffer shown in the focused pane, or redo the last edit undone
+ *
+ * @param[in] forward true to redo, false to undo
+ */
+void Application::stepHistory(bool forward)
+{
+  auto const index = m_layout.focused().buffer;
+  auto& buffer = *m_buffers[index];
+  auto& cursor = m_layout.focused().cursor;
+
+  if (!editable(buffer)) {
+    return;
+  }
+
+  auto const replaced = forward ? buffer.history.redo(buffer.document, cursor)
+                                 : buffer.history.undo(buffer.document, cursor);
+
+  if (replaced) {
+    // Only the cursor the view follows is remembered with an edit
+    m_layout.focused().cursors.clear();
+    edited(index, *replaced);
+    revealCursors(m_layout.focused());
+  }
+}
+
+auto Application::editable(Buffer const& buffer) noexcept -> bool
+{
+  // Lines still arriving are appended to the document as it was, which would undo the edit. Binary files would not
+  // survive being saved as lines
+  return !buffer.loader and !buffer.follower and !buffer.format.binary and !buffer.readOnly;
+}
+
+void Application::edited(std::size_t index)
+{
+  auto& buffer = *m_buffers[index];
+  buffer.statistics.replaced(m_workers, buffer.document, 0);
+  buffer.brackets.replaced(m_workers, buffer.document, 0);
+  undiff(index);
+  refilter(index, [this, &buffer](LineFilter& filter) {
+    filter.replaced(m_workers, buffer.document, 0);
+    return true;
+  });
+  refold(index, [&buffer] { return buffer.folds.replaced(buffer.document, 0); });
+  reindex(index);
+  updateWrapIndices(index, 0, true);
+}
+
+void Application::reindex(std::size_t index)
+{
+  auto& buffer = *m_buffers[index];
+  buffer.rendered = buffer.document;
+  buffer.generation++;
+  buffer.changedLines.clear();
+  buffer.columns.clear();
+
+  // Other panes on the buffer may have had their cursors on lines that are gone now
+  auto const lines = static_cast<std::int64_t>(buffer.document.lineCount());
+
+  for (auto* pane : m_layout.panes()) {
+    if (pane->buffer != index) {
+      continue;
+    }
+
+    pane->cursor.y = std::min(pane->cursor.y, lines);
+
+    for (auto& cursor : pane->cursors) {
+      cursor.y = std::min(cursor.y, lines);
+    }
+
+    normalize(pane->cursors);
+    std::erase(pane->cursors, pane->cursor);
+  }
+
+  buffer.cursor.y = std::min(buffer.cursor.y, lines);
+}
+
+void Application::edited(std::size_t index, Changed const& changed)
+{
+  auto& buffer = *m_buffers[index];
+  buffer.statistics.changed(m_workers, buffer.document, changed);
+  buffer.brackets.changed(m_workers, buffer.document, changed);
+
+  undiff(index);
+
+  // Panes whose filter now shows other lines, or shows them on other rows, are drawn again
+  refilter(index, [this, &buffer, &changed](LineFilter& filter) {
+    return filter.changed(m_workers, buffer.document, changed);
+  });
+
+  // Only the ranges around the lines that changed are worked out again
+  refold(index, [&buffer, &changed] { return buffer.folds.changed(buffer.document, changed); });
+
+  if (changed.lineCount) {
+    reindex(index);
+    spliceWrapIndices(index, changed.runs);
+    return;
+  }
+
+  buffer.rendered = buffer.document;
+  buffer.generation++;
+  buffer.changedLines.assign(changed.lines.begin(), changed.lines.end());
+
+  for (auto const line : changed.lines) {
+    buffer.columns.forget(line);
+  }
+
+  // A line that now takes up a different number of rows moves the rows below it, so panes showing it are drawn again
+  auto const rewrap = [&buffer, &changed](std::optional<WrapIndex>& wrap) {
+    auto moved = false;
+
+    for (auto const line : changed.lines) {
+      auto const rows = wrap->rowsOf(line);
+      wrap->update(line, buffer.columns.width(line, buffer.document.line(line)));
+      moved = moved or wrap->rowsOf(line) != rows;
+    }
+
+    return moved;
+  };
+
+  if (buffer.wrap) {
+    rewrap(buffer.wrap);
+  }
+
+  for (auto* pane : m_layout.panes()) {
+    if (pane->buffer == index and pane->wrap and rewrap(pane->wrap)) {
+      pane->drawn.reset();
+    }
+  }
+}
+
+void Application::edited(std::size_t index, Replaced const& replaced)
+{
+  if (replaced.added > ReplaceBudget) {
+    edited(index);
+  }
+  else {
+    edited(index, changedBy(replaced));
+  }
+}
+
+/**
+ * @brief Move the cursor of the focused pane to the bracket matching the one it is on, or to the bracket that opens
+ * the scope it is in
+ *
+ * @param[in] enclosing Whether to go to the bracket that opens the scope rather than the matching one
+ */
+void Application::jumpToBracket(bool enclosing)
+{
+  auto& pane = m_layout.focused();
+  auto const& buffer = current();
+  auto const& [document, brackets] = std::tie(buffer.document, buffer.brackets);
+  auto const found = enclosing ? brackets.enclosing(document, pane.cursor) : brackets.match(document, pane.cursor);
+
+  if (!found) {
+    return;
+  }
+
+  pane.cursor = *found;
+  std::erase(pane.cursors, pane.cursor);
+  revealCursors(pane);
+}
+
+/**
+ * @brief Ask for a text on the status line, and show only the lines that contain it in the focused pane
+ */
+void Application::filterLines()
+{
+  m_prompt = Prompt::Filter;
+  m_pattern.clear();
+}
+
+void Application::addFilter(std::string const& pattern)
+{
+  auto& pane = m_layout.focused();
+  auto const& document = current().document;
+
+  if (pane.diff) {
+    dropDiff(pane.diff);
+  }
+
+  if (pane.wrap) {
+    toggleSoftWrap();
+  }
+
+  std::vector<std::string> patterns;
+
+  if (pane.filter) {
+    patterns.assign(pane.filter->patterns().begin(), pane.filter->patterns().end());
+  }
+
+  patterns.push_back(pattern);
+
+  // A filter that found all of its lines only has those searched again. The pane gets a filter of its own, so that a
+  // pane it was split from keeps showing the one it shared
+  auto filter = std::make_shared<LineFilter>(std::move(patterns));
+
+  if (pane.filter and pane.filter->complete()) {
+    filter->within(m_workers, document, pane.filter->lines());
+  }
+  else {
+    filter->replaced(m_workers, document, 0);
+  }
+
+  pane.filter = std::move(filter);
+  pane.offset.row = 0;
+  pane.drawn.reset();
+}
+
+/**
+ * @brief Show the lines the focused pane showed before its last filter was added
+ */
+void Application::dropFilter()
+{
+  auto& pane = m_layout.focused();
+  auto const& buffer = current();
+
+  if (!pane.filter) {
+    return;
+  }
+
+  auto const patterns = pane.filter->patterns();
+  auto const top = lineAt(pane, static_cast<std::size_t>(pane.offset.row));
+
+  // The lines of the filters below it were forgotten, and are searched for again
+  if (patterns.size() > 1) {
+    auto filter = std::make_shared<LineFilter>(std::vector<std::string>(patterns.begin(), patterns.end() - 1));
+    filter->replaced(m_workers, buffer.document, 0);
+    pane.filter = std::move(filter);
+    pane.offset.row = 0;
+  }
+  else {
+    pane.filter.reset();
+    pane.offset.row = static_cast<std::int64_t>(buffer.folds.rowOf(top));
+  }
+
+  pane.drawn.reset();
+}
+
+auto Application::rowOf(Pane const& pane, std::size_t line) const noexcept -> std::size_t
+{
+  return pane.diff     ? pane.diff->rowOf(pane.side, line)
+         : pane.filter ? pane.filter->rowOf(line)
+                       : m_buffers[pane.buffer]->folds.rowOf(line);
+}
+
+auto Application::lineAt(Pane const& pane, std::size_t row) const noexcept -> std::size_t
+{
+  return pane.diff     ? pane.diff->lineAt(pane.side, row)
+         : pane.filter ? pane.filter->lineAt(row)
+                       : m_buffers[pane.buffer]->folds.lineAt(row);
+}
+
+auto Application::hidden(Pane const& pane, std::size_t line) const noexcept -> bool
+{
+  return !pane.diff and (pane.filter ? pane.filter->hidden(line) : m_buffers[pane.buffer]->folds.hidden(line));
+}
+
+/**
+ * @brief Ask for a text and what to replace it with on the status line, and replace every match of it in the buffer
+ * shown in the focused pane
+ */
+void Application::replaceAll()
+{
+  if (!editable(current())) {
+    return;
+  }
+
+  m_prompt = Prompt::Pattern;
+  m_pattern.clear();
+  m_replacement.clear();
+  m_replacing = m_layout.focused().buffer;
+}
+
+void Application::promptKey(int keyPressed)
+{
+  using enum Prompt;
+  auto const key = static_cast<editor::EditorKey>(keyPressed);
+
+  // Escape leaves the buffer as it was, whatever was found or replaced so far
+  if (keyPressed == '\x1b') {
+    m_replace.cancel();
+    m_prompt = None;
+    return;
+  }
+
+  if (m_prompt == Preview and keyPressed == '\r' and m_replace.complete() and m_replace.matches() > 0) {
+    m_prompt = Applying;
+    return;
+  }
+
+  if (m_prompt == Order) {
+    auto const order = keyPressed == 's'   ? std::optional(LineOrder::Sorted)
+                       : keyPressed == 'u' ? std::optional(LineOrder::Unique)
+                       : keyPressed == 'r' ? std::optional(LineOrder::Reversed)
+                                           : std::nullopt;
+
+    if (order) {
+      m_prompt = None;
+      reorder(*order);
+    }
+
+    return;
+  }
+
+  if (m_prompt != Pattern and m_prompt != Replacement and m_prompt != Filter) {
+    return;
+  }
+
+  auto& text = m_prompt == Replacement ? m_replacement : m_pattern;
+
+  if (keyPressed == '\r' and m_prompt == Filter) {
+    if (!text.empty()) {
+      addFilter(text);
+    }
+
+    m_prompt = None;
+  }
+  else if (keyPressed == '\r' and m_prompt == Pattern) {
+    m_prompt = text.empty() ? None : Replacement;
+  }
+  else if (keyPressed == '\r') {
+    m_replace.start(m_workers, m_buffers[m_replacing]->document, m_pattern, m_replacement);
+    m_prompt = Preview;
+  }
+  else if (key == editor::EditorKey::PasteStart) {
+    // Only the first line of a paste is taken, as matches never span lines
+    IO::readPaste(m_paste);
+    text.append(std::string_view(m_paste).substr(0, m_paste.find_first_of("\r\n")));
+  }
+  else if (key == editor::EditorKey::Backspace or keyPressed == utilities::ctrlKey('h')) {
+    // A character outside ASCII is taken off along with all of its bytes
+    while (!text.empty() and (static_cast<unsigned char>(text.back()) & 0xC0U) == 0x80U) {
+      text.pop_back();
+    }
+
+    if (!text.empty()) {
+      text.pop_back();
+    }
+  }
+  else if (keyPressed == '\t' or (keyPressed >= ' ' and key < editor::EditorKey::Backspace) or keyPressed < 0) {
+    text.push_back(static_cast<char>(keyPressed));
+  }
+}
+
+void Application::applyReplacement()
+{
+  if (!m_replace.apply(ReplaceBudget)) {
+    return;
+  }
+
+  // The buffer can't have been edited since it was searched, as keys went to the status line
+  auto& buffer = *m_buffers[m_replacing];
+  auto& pane = m_layout.focused();
+
+  buffer.history.record(buffer.document, pane.cursor);
+  auto const changed = m_replace.take(buffer.document);
+  m_prompt = Prompt::None;
+
+  // Cursors past the end of a line that got shorter move back to its end
+  auto const clamp = [&buffer, &changed](Cursor& cursor) {
+    if (std::ranges::binary_search(changed.lines, static_cast<std::size_t>(cursor.y))) {
+      cursor.x = std::min(cursor.x, std::ssize(buffer.document.line(static_cast<std::size_t>(cursor.y))));
+    }
+  };
+
+  for (auto* shown : m_layout.panes()) {
+    if (shown->buffer == m_replacing) {
+      clamp(shown->cursor);
+      std::ranges::for_each(shown->cursors, clamp);
+      normalize(shown->cursors);
+      std::erase(shown->cursors, shown->cursor);
+    }
+  }
+
+  if (changed.lines.size() > ReplaceBudget) {
+    edited(m_replacing);
+  }
+  else {
+    edited(m_replacing, changed);
+  }
+
+  revealCursors(pane);
+}
+
+/**
+ * @brief Ask on the status line how to order the lines of the buffer shown in the focused pane, and sort them, leave
+ * out the lines that repeat one above them, or reverse them
+ */
+void Application::orderLines()
+{
+  if (editable(current())) {
+    m_prompt = Prompt::Order;
+  }
+}
+
+void Application::reorder(LineOrder order)
+{
+  auto& pane = m_layout.focused();
+  auto& buffer = *m_buffers[pane.buffer];
+  auto const lines = buffer.document.lineCount();
+
+  if (lines == 0) {
+    return;
+  }
+
+  auto const first = pane.cursors.empty() ? 0 : static_cast<std::size_t>(std::min(pane.cursor, pane.cursors.front()).y);
+  auto const last = pane.cursors.empty() ? lines - 1
+                                         : static_cast<std::size_t>(std::max(pane.cursor, pane.cursors.back()).y);
+
+  buffer.history.record(buffer.document, pane.cursor);
+  auto const count = reorderLines(m_workers, buffer.document, first, last - first + 1, order);
+
+  // The lines under the cursors have moved, so only the cursor the view follows is kept, at the top of the lines put
+  // in order. Cursors of other panes below lines that were left out move up by as many lines
+  pane.cursors.clear();
+  pane.cursor = Cursor {.x = 0, .y = static_cast<std::int64_t>(first)};
+
+  auto const removed = static_cast<std::int64_t>(last - first + 1 - count);
+  auto const clamp = [&buffer, removed, last](Cursor& cursor) {
+    if (cursor.y > static_cast<std::int64_t>(last)) {
+      cursor.y -= removed;
+    }
+
+    cursor.y = std::min(cursor.y, static_cast<std::int64_t>(buffer.document.lineCount()) - 1);
+    cursor.x = std::min(cursor.x, std::ssize(buffer.document.line(static_cast<std::size_t>(cursor.y))));
+  };
+
+  for (auto* shown : m_layout.panes()) {
+    if (shown != &pane and shown->buffer == pane.buffer) {
+      clamp(shown->cursor);
+      std::ranges::for_each(shown->cursors, clamp);
+      normalize(shown->cursors);
+      std::erase(shown->cursors, shown->cursor);
+    }
+  }
+
+  // Only the lines put in order were replaced, whether they were rewritten in place or the document was rebuilt
+  edited(pane.buffer, Replaced {.first = first, .removed = last - first + 1, .added = count});
+  revealCursors(pane);
+}
+
+/**
+ * @brief Line up the focused pane row for row with the next pane that shows another buffer, showing where their
+ * documents differ, or stop lining them up
+ */
+void Application::compareBuffers()
+{
+  auto& focused = m_layout.focused();
+
+  if (focused.diff) {
+    dropDiff(focused.diff);
+    return;
+  }
+
+  auto const panes = m_layout.panes();
+  auto const at = static_cast<std::size_t>(std::ranges::find(panes, &focused) - panes.begin());
+  auto other = std::size_t {at};
+
+  for (std::size_t i = 1; i < panes.size() and other == at; i++) {
+    if (panes[(at + i) % panes.size()]->buffer != focused.buffer) {
+      other = (at + i) % panes.size();
+    }
+  }
+
+  // Lines still arriving would have to be diffed again and again
+  if (other == at or m_buffers[focused.buffer]->loader or m_buffers[panes[other]->buffer]->loader) {
+    return;
+  }
+
+  // The pane that comes first in the layout, above or to the left of the other, shows the left side
+  auto* const left = panes[std::min(at, other)];
+  auto* const right = panes[std::max(at, other)];
+  auto const diff =
+    std::make_shared<LineDiff>(m_buffers[left->buffer]->document, m_buffers[right->buffer]->document);
+
+  for (auto* pane : {left, right}) {
+    pane->wrap.reset();
+    pane->filter.reset();
+    pane->diff = diff;
+    pane->side = pane == left ? DiffSide::Left : DiffSide::Right;
+    pane->drawn.reset();
+  }
+
+  // The cursor stays in the middle of the pane, and the other pane follows it
+  auto const row = diff->rowOf(focused.side, static_cast<std::size_t>(focused.cursor.y));
+  focused.offset.row = std::max(static_cast<std::int64_t>(row) - focused.region.rows / 2, std::int64_t {0});
+}
+
+void Application::dropDiff(std::shared_ptr<LineDiff> const diff)
+{
+  for (auto* pane : m_layout.panes()) {
+    if (pane->diff != diff) {
+      continue;
+    }
+
+    // The line at the top of the pane stays there
+    auto const top = diff->lineAt(pane->side, static_cast<std::size_t>(pane->offset.row));
+    pane->diff.reset();
+    pane->offset.row = static_cast<std::int64_t>(m_buffers[pane->buffer]->folds.rowOf(top));
+    pane->drawn.reset();
+  }
+}
+
+void Application::undiff(std::size_t index)
+{
+  for (auto* pane : m_layout.panes()) {
+    if (pane->buffer == index and pane->diff) {
+      dropDiff(pane->diff);
+    }
+  }
+}
+
+/**
+ * @brief Fold the range of lines around the cursor of the focused pane, or unfold it
+ */
+void Application::toggleFold()
+{
+  auto& pane = m_layout.focused();
+  auto& buffer = current();
+  auto const line = static_cast<std::size_t>(pane.cursor.y);
+
+  if (pane.wrap or pane.filter or pane.diff or line >= buffer.document.lineCount()) {
+    return;
+  }
+
+  refold(pane.buffer, [&pane, &buffer, line] {
+    if (!buffer.folds.built()) {
+      buffer.folds.build(buffer.document);
+    }
+
+    auto const start = buffer.folds.toggle(line);
+
+    // The cursor moves up to the first line of the range, which stays visible
+    if (start) {
+      pane.cursor.y = static_cast<std::int64_t>(*start);
+      pane.cursor.x = std::min(pane.cursor.x, std::ssize(buffer.document.line(*start)));
+    }
+
+    return start.has_value();
+  });
+}
+
+/**
+ * @brief Fold every range of lines of the buffer shown in the focused pane, or unfold them all if any is folded
+ */
+void Application::toggleAllFolds()
+{
+  auto& buffer = current();
+
+  refold(m_layout.focused().buffer, [&buffer] {
+    if (!buffer.folds.built()) {
+      buffer.folds.build(buffer.document);
+    }
+
+    buffer.folds.foldAll(!buffer.folds.folded());
+    return true;
+  });
+}
+
+template <typename Update>
+void Application::refilter(std::size_t index, Update const& update)
+{
+  auto const panes = m_layout.panes();
+
+  for (std::size_t i = 0; i < panes.size(); i++) {
+    auto const& filter = panes[i]->filter;
+
+    // Panes that were split share their filter, which is only brought up to date once
+    auto const first = std::ranges::find(panes.begin(), panes.begin() + static_cast<std::ptrdiff_t>(i), filter,
+                                         &Pane::filter) == panes.begin() + static_cast<std::ptrdiff_t>(i);
+
+    if (panes[i]->buffer != index or !filter or !first or !update(*filter)) {
+      continue;
+    }
+
+    for (auto* pane : panes) {
+      if (pane->filter == filter) {
+        pane->drawn.reset();
+      }
+    }
+  }
+}
+
+template <typename Change>
+void Application::refold(std::size_t index, Change const& change)
+{
+  auto& buffer = *m_buffers[index];
+  auto const& folds = buffer.folds;
+  auto const panes = m_layout.panes();
+
+  // Panes that soft-wrap count their rows in wrapped lines instead, and those that show a filter in the lines it found
+  m_topLines.clear();
+
+  for (auto const* pane : panes) {
+    auto const shown = pane->buffer == index and !pane->wrap and !pane->filter and !pane->diff;
+    m_topLines.push_back(shown ? folds.lineAt(static_cast<std::size_t>(pane->offset.row)) : 0);
+  }
+
+  auto const top = folds.lineAt(static_cast<std::size_t>(buffer.offset.row));
+
+  if (!change()) {
+    return;
+  }
+
+  for (std::size_t i = 0; i < panes.size(); i++) {
+    if (panes[i]->buffer == index and !panes[i]->wrap and !panes[i]->filter and !panes[i]->diff) {
+      panes[i]->offset.row = static_cast<std::int64_t>(folds.rowOf(m_topLines[i]));
+      panes[i]->drawn.reset();
+    }
+  }
+
+  if (!buffer.wrap) {
+    buffer.offset.row = static_cast<std::int64_t>(folds.rowOf(top));
+  }
+}
+
+void Application::revealCursors(Pane& pane)
+{
+  auto& folds = m_buffers[pane.buffer]->folds;
+
+  if (!folds.folded()) {
+    return;
+  }
+
+  refold(pane.buffer, [&pane, &folds] {
+    auto revealed = folds.reveal(static_cast<std::size_t>(pane.cursor.y));
+
+    for (auto const& cursor : pane.cursors) {
+      revealed = folds.reveal(static_cast<std::size_t>(cursor.y)) or revealed;
+    }
+
+    return revealed;
+  });
+}
+
+void Application::updateWrapIndices(std::size_t index, std::size_t first, bool rebuild)
+{
+  auto& buffer = *m_buffers[index];
+
+  auto update = [&buffer, first, rebuild](std::optional<WrapIndex>& wrap) {
+    if (!wrap) {
+      return;
+    }
+
+    if (rebuild) {
+      auto const columns = static_cast<int>(wrap->columns());
+      auto const view = Terminal::Window(Terminal::WindowSize {.cols = columns, .rows = 1});
+      wrap = editor::buildWrapIndex(buffer.rendered, view, buffer.columns);
+      return;
+    }
+
+    for (auto line = first; line < buffer.document.lineCount(); line++) {
+      wrap->append(buffer.columns.width(line, buffer.document.line(line)));
+    }
+  };
+
+  update(buffer.wrap);
+
+  for (auto* pane : m_layout.panes()) {
+    if (pane->buffer == index) {
+      update(pane->wrap);
+    }
+  }
+}
+
+void Application::spliceWrapIndices(std::size_t index, std::span<Replaced const> runs)
+{
+  auto& buffer = *m_buffers[index];
+
+  if (runs.empty()) {
+    updateWrapIndices(index, 0, true);
+    return;
+  }
+
+  // The runs are spliced in from the top, so each one starts on the line it starts on after the edit
+  std::vector<std::size_t> widths;
+
+  auto splice = [&buffer, runs, &widths](std::optional<WrapIndex>& wrap) {
+    if (!wrap) {
+      return;
+    }
+
+    for (auto const& [first, removed, added] : runs) {
+      widths.clear();
+
+      for (auto line = first; line < first + added; line++) {
+        widths.push_back(buffer.columns.width(line, buffer.document.line(line)));
+      }
+
+      wrap->replace(first, removed, widths);
+    }
+  };
+
+  splice(buffer.wrap);
+
+  for (auto* pane : m_layout.panes()) {
+    if (pane->buffer == index) {
+      splice(pane->wrap);
+    }
+  }
+}
+
+void Application::run()
+try {
+  while (!m_quit) {
+    scroll();
+    refreshScreen();
+
+    if (waitForInput()) {
+      processKeypress();
+    }
+  }
+
+  // Let the writer finish before clearing the screen, or the last frame could end up on top of the cleared screen
+  m_writer.drain();
+  utilities::clearScreenAndRepositionCursor();
 }
 catch (std::system_error const& err) {
+  m_writer.drain();
   utilities::clearScreenAndRepositionCursor();
   std::cerr << err.code() << ": " << err.what() << '\n';
 }
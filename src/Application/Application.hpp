@@ -24,15 +24,29 @@
 #ifndef APPLICATION_HPP
 #define APPLICATION_HPP
 
-#include "Editor/Cursor/Cursor.hpp"
-#include "Editor/Offset/Offset.hpp"
+#include "Editor/Buffer/Buffer.hpp"
+#include "Editor/FrameWriter/FrameWriter.hpp"
+#include "Editor/Gutter/Gutter.hpp"
+#include "Editor/Layout/Layout.hpp"
+#include "Editor/MultiCursor/MultiCursor.hpp"
+#include "Editor/ReplaceAll/ReplaceAll.hpp"
 #include "Editor/ScreenBuffer/ScreenBuffer.hpp"
+#include "Editor/SortLines/SortLines.hpp"
+#include "Editor/WorkerPool/WorkerPool.hpp"
+#include "Terminal/Capabilities/Capabilities.hpp"
 #include "Terminal/Window/Window.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
+#include <poll.h>
+#include <unistd.h>
+
 namespace Kilo::editor {
 class Application
 {
@@ -40,15 +54,22 @@ public:
   /// Default constructor
   explicit Application() noexcept;
 
+  /// Create an application for a window of a fixed size, without querying the terminal
+  /// \param[in] size The size of the window
+  /// \param[in] output The file descriptor frames are written to
+  explicit Application(Terminal::WindowSize size, int output);
+
   /**
    * @brief Position the cursor within the visible window
    *
+   * @details Every pane is scrolled so that its cursor is visible, after the panes have been fitted to the window again
    */
   void scroll() noexcept;
 
   /**
    * @brief Perform a screen refresh
    *
+   * @details Only the panes whose contents or position changed since the last refresh are drawn again
    */
   void refreshScreen();
 
@@ -60,30 +81,371 @@ public:
 
   /**
    * @brief Draw each row of the buffer of text being edited, plus a tilde at the beginning
+   *
+   * @details The last row of the window is the status line, which shows what the document in the focused pane is
+   * made of as far as it has been counted
    */
   void drawRows();
 
   /**
-   * @brief Open a file and write its contents to memory
+   * @brief Split the focused pane in two
    *
+   * @param[in] how Whether the new pane goes below or to the right of the focused one
+   */
+  void split(Layout::Split how);
+
+  /**
+   * @brief Close the focused pane, unless it is the only one
+   */
+  void closePane();
+
+  /**
+   * @brief Open a file in a new buffer
+   *
+   * @details The first file opened replaces the empty buffer the editor starts with. A file that is already open is
+   * not read again; the new buffer shares the lines of the existing one
    * @param[in] path The path to the file
    * @return true If the operation was successful
    * @return false If the operation failed
    */
   auto open(std::filesystem::path const& path) -> bool;
 
+  /**
+   * @brief Load a document from a stream such as a pipe into a new buffer while the editor is already running
+   *
+   * @details Lines are shown as soon as they arrive instead of after the whole stream has been read
+   * @param[in] fileDescriptor The stream to read from. The application takes ownership of it
+   */
+  void openStream(int fileDescriptor);
+
+  /**
+   * @brief Save the buffer shown in the focused pane to its file
+   *
+   * @details The file is written with the line ending and byte order mark it was read with
+   * @return false If the buffer didn't come from a file, can't be written back to it, or the file could not be written
+   */
+  auto save() -> bool;
+
+  /**
+   * @brief Show the next or previous buffer in the focused pane
+   *
+   * @param[in] step 1 for the next buffer, -1 for the previous one. The list wraps around at either end
+   */
+  void cycleBuffers(int step) noexcept;
+
+  /// Get the number of open buffers
+  [[nodiscard]] auto bufferCount() const noexcept -> std::size_t
+  {
+    return m_buffers.size();
+  }
+
+  /// Get the buffer shown in the focused pane
+  [[nodiscard]] auto current() noexcept -> Buffer&
+  {
+    return *m_buffers[m_layout.focused().buffer];
+  }
+
+  /**
+   * @brief Turn soft-wrap on or off
+   *
+   * @details While soft-wrap is on, lines longer than the window is wide are folded onto the following rows instead
+   * of being cut off, and the row offset counts visual rows rather than lines of the document
+   */
+  void toggleSoftWrap();
+
+  /**
+   * @brief Switch the gutter of every pane from line numbers to relative line numbers to none, and back again
+   */
+  void cycleLineNumbers() noexcept;
+
+  /**
+   * @brief Turn follow mode on or off
+   *
+   * @details While follow mode is on, lines appended to the open file are added to the document as they are written,
+   * and a cursor on the last line moves along with them
+   * @return false If follow mode could not be turned on, e.g. because no file is open
+   */
+  auto toggleFollow() -> bool;
+
+  /**
+   * @brief Fold the range of lines around the cursor of the focused pane, or unfold it
+   *
+   * @details A range starts on a line that opens a bracket or is followed by lines indented deeper than it. Only its
+   * first line is shown while it is folded. Panes that soft-wrap show every range unfolded
+   */
+  void toggleFold();
+
+  /**
+   * @brief Fold every range of lines of the buffer shown in the focused pane, or unfold them all if any is folded
+   */
+  void toggleAllFolds();
+
+  /**
+   * @brief Move the cursor of the focused pane to the bracket matching the one it is on, or to the bracket that opens
+   * the scope it is in
+   *
+   * @details Nothing happens until the brackets of the document have been classified, which is done in the
+   * background
+   * @param[in] enclosing Whether to go to the bracket that opens the scope rather than the matching one
+   */
+  void jumpToBracket(bool enclosing);
+
+  /**
+   * @brief Ask for a text and what to replace it with on the status line, and replace every match of it in the buffer
+   * shown in the focused pane
+   *
+   * @details The matches are found in the background and counted on the status line, along with the first line they
+   * change, before anything is replaced. Enter replaces them all as a single edit, which is undone in one step. Escape
+   * leaves the buffer as it was at any point until then
+   */
+  void replaceAll();
+
+  /**
+   * @brief Ask for a text on the status line, and show only the lines that contain it in the focused pane
+   *
+   * @details A pane that already shows only some lines goes on to show only those of them that contain the text as
+   * well. The lines are found in the background, and shown as they come in. The gutter numbers them as the lines of
+   * the document they are
+   */
+  void filterLines();
+
+  /**
+   * @brief Show the lines the focused pane showed before its last filter was added
+   */
+  void dropFilter();
+
+  /**
+   * @brief Ask on the status line how to order the lines of the buffer shown in the focused pane, and sort them, leave
+   * out the lines that repeat one above them, or reverse them
+   *
+   * @details With several cursors, only the lines from the first cursor to the last are put in order, and otherwise
+   * every line is. The lines are sorted on the workers and this thread at once, and put in their new order as a
+   * single edit, which is undone in one step
+   */
+  void orderLines();
+
+  /**
+   * @brief Line up the focused pane row for row with the next pane that shows another buffer, showing where their
+   * documents differ, or stop lining them up
+   *
+   * @details The pane that comes first in the layout shows the left side of the diff. Lines in runs that differ are
+   * coloured, and the rows across from lines only the other side has are filled with dashes. The other pane scrolls
+   * along with the focused one. The panes stop being lined up as soon as either document changes
+   */
+  void compareBuffers();
+
   /// Run the application
   void run();
 
+  /// Block until a key is pressed or more of a document being streamed in has arrived, loading the latter. Whatever
+  /// the workers finished in the meantime is taken in
+  /// \returns true if a key is waiting to be read
+  auto waitForInput() -> bool;
+
+  /// Get how the terminal kept up with the frames written to it
+  [[nodiscard]] auto writerStats() const noexcept -> FrameWriter::Stats
+  {
+    return m_writer.stats();
+  }
+
 private:
+  /// Append whatever has arrived on a buffer's stream to its document
+  void loadMore(std::size_t index);
+
+  /// Bring a buffer up to date with the file it follows
+  void followFile(std::size_t index);
+
+  /// Append the lines from first onwards to the soft-wrap indices of a buffer, or rebuild them if the document was
+  /// replaced. Every pane showing the buffer has one of its own
+  void updateWrapIndices(std::size_t index, std::size_t first, bool rebuild);
+
+  /// Splice the runs of lines an edit replaced into the soft-wrap indices of a buffer, or rebuild them if the edit
+  /// didn't say which runs it replaced
+  void spliceWrapIndices(std::size_t index, std::span<Replaced const> runs);
+
+  /// Get the column a pane's cursor is shown at, with tabs expanded. Only the chunk of the line around the cursor is
+  /// read
+  auto renderedColumn(Pane const& pane) -> std::int64_t;
+
+  /// Read a paste and insert it at the cursors of the focused pane
+  void paste();
+
+  /// Apply an edit at every cursor of the focused pane at once, as a single step of its buffer's history
+  /// \param[in] edit Called with the document and the cursors, sorted, to make the edit and report what it changed
+  template <typename Edit>
+  void editAtCursors(Edit const& edit);
+
+  /// Add a cursor on the line below the last cursor of the focused pane, which the view then follows
+  void addCursorBelow();
+
+  /// Undo or redo an edit of the buffer shown in the focused pane
+  void stepHistory(bool forward);
+
+  /// Check whether a buffer can be edited, which it can't while lines are still being added to it or if it isn't text
+  [[nodiscard]] static auto editable(Buffer const& buffer) noexcept -> bool;
+
+  /// Handle a key pressed while a replace-all or a filter is being typed into the status line, or shown there
+  void promptKey(int keyPressed);
+
+  /// Show only those lines in the focused pane that contain a text, out of the lines it shows
+  void addFilter(std::string const& pattern);
+
+  /// Get the row of a pane a line is shown on, counting only the lines its filter found, or else those the folds of
+  /// its buffer leave visible. Not for panes that soft-wrap
+  [[nodiscard]] auto rowOf(Pane const& pane, std::size_t line) const noexcept -> std::size_t;
+
+  /// Get the line shown on a row of a pane that doesn't soft-wrap
+  [[nodiscard]] auto lineAt(Pane const& pane, std::size_t row) const noexcept -> std::size_t;
+
+  /// Check whether a line isn't shown by a pane that doesn't soft-wrap, as it was folded away or left out by a filter
+  [[nodiscard]] auto hidden(Pane const& pane, std::size_t line) const noexcept -> bool;
+
+  /// Replace another batch of the lines a replace-all changes, and swap the result into the buffer once all of them
+  /// are
+  void applyReplacement();
+
+  /// Put the lines of the buffer shown in the focused pane in another order, from its first cursor to its last, or all
+  /// of them with a single cursor
+  void reorder(LineOrder order);
+
+  /// Stop lining up the panes that show a diff, keeping the line at the top of each where it is
+  void dropDiff(std::shared_ptr<LineDiff> diff);
+
+  /// Stop lining up the panes that show a diff one side of which is the document of a buffer
+  void undiff(std::size_t index);
+
+  /// Bring everything that depends on the document of a buffer up to date after it was edited
+  void edited(std::size_t index);
+
+  /// Rebuild what depends on where the lines of a buffer are, after lines may have been added or removed anywhere, but
+  /// for the soft-wrap indices
+  void reindex(std::size_t index);
+
+  /// Bring everything that depends on the document of a buffer up to date after an edit that only changed some of
+  /// its lines
+  void edited(std::size_t index, Changed const& changed);
+
+  /// Bring everything that depends on the document of a buffer up to date after a run of its lines was replaced
+  void edited(std::size_t index, Replaced const& replaced);
+
+  /// Change which lines of a buffer are folded away, keeping the same line at the top of the panes that show it
+  /// \param[in] change Called to change the fold index, and returns whether any line was folded or unfolded
+  template <typename Change>
+  void refold(std::size_t index, Change const& change);
+
+  /// Bring the filters of the panes that show a buffer up to date, once for each filter that panes share
+  /// \param[in] update Called with each filter, and returns whether the lines it found or their rows may have changed
+  template <typename Update>
+  void refilter(std::size_t index, Update const& update);
+
+  /// Unfold the ranges that hide the cursors of a pane, e.g. after an edit put one there
+  void revealCursors(Pane& pane);
+
+  /// Draw some of the rows of a pane
+  void drawPaneRows(Pane const& pane, int first, int count);
+
+  /// Draw the rows of a pane that show the lines changed by the last edit of its buffer
+  void drawChangedLines(Pane const& pane);
+
+  /// Draw the line numbers of a pane that changed since they were last drawn
+  void drawGutter(Pane& pane);
+
+  /// Draw the status line, unless it would show the same as it already does
+  void drawStatusLine();
+
+  /// Format what the document in the focused pane is made of into the status line
+  /// \returns The number of bytes at the start of the status line that are left aligned
+  auto formatStatistics() -> std::size_t;
+
+  /// Format what the status line asks for into it, along with what a replace-all found so far
+  /// \returns The number of bytes at the start of the status line that are left aligned
+  auto formatPrompt() -> std::size_t;
+
+  /// Show the other cursors of a pane, after drawing the rows they were shown on last time again
+  /// \param[in] pane The pane
+  /// \param[in] drawn Whether any of the pane was drawn in this frame, which may have drawn over its marks
+  /// \param[in] full Whether all of the pane was drawn in this frame, which leaves no old marks to remove
+  void drawMarks(Pane& pane, bool drawn, bool full);
+
+  /// Store where a pane is in its buffer, for the next pane that switches to it
+  void remember(Pane& pane) noexcept;
+
+  /// Get a buffer for a newly opened document, which is the current one if it is still empty and unused
+  auto newBuffer() -> Buffer&;
+
   Terminal::Window m_window;
+  Terminal::Capabilities m_capabilities;
+
+  // Buffers hold loaders and threads that cannot be moved, so each one is allocated separately
+  std::vector<std::unique_ptr<Buffer>> m_buffers;
+  bool m_pristine {true};
+
+  Layout m_layout;
 
-  std::vector<std::string> m_row;
-  std::vector<std::string> m_render;
-  Cursor m_cursor {};
-  Offset m_off {};
-  [[maybe_unused]] int m_rx {};
+  // Set when the panes have to be fitted to the window again, and the separators between them drawn again
+  bool m_rearrange {true};
+  bool m_separatorsDrawn {};
+
+  // What the gutters show, and the numbers of the rows of a gutter, kept to reuse their capacity
+  LineNumbers m_lineNumbers {LineNumbers::Absolute};
+  std::vector<std::size_t> m_numbers;
+
+  // The lines at the top of the panes while folds are changed, kept to reuse its capacity
+  std::vector<std::size_t> m_topLines;
+
+  // The column of the focused pane's cursor on its line, with tabs expanded
+  std::int64_t m_rx {};
   ScreenBuffer m_buffer;
+
+  // The set of file descriptors waited on, rebuilt in place for every wait
+  std::vector<pollfd> m_pollSet;
+
+  // Set by Ctrl-Q, to leave the main loop once the current key has been handled
+  bool m_quit {};
+
+  // The text of the last paste, kept to reuse its capacity
+  std::string m_paste;
+
+  // Every cursor of the focused pane while they are being edited, and the marks the other cursors of a pane are
+  // shown with, kept to reuse their capacity
+  std::vector<Cursor> m_cursors;
+  std::vector<Pane::Mark> m_marks;
+
+  // The status line as it is about to be drawn, and as it was last drawn. The latter is cleared when the whole
+  // screen has to be drawn again
+  std::string m_status;
+  std::string m_statusShown;
+
+  // The number of bytes at the start of the status line that are left aligned, after which text typed into it goes
+  std::size_t m_statusLeft {};
+
+  // What the status line is asking for, if anything: the text a replace-all replaces, what it is replaced with, and
+  // whether to replace the matches found, the text a filter looks for, or how to order lines. Keys go to the status
+  // line until it stops asking
+  enum class Prompt
+  {
+    None,
+    Pattern,
+    Replacement,
+    Preview,
+    Applying,
+    Filter,
+    Order
+  };
+
+  Prompt m_prompt {Prompt::None};
+  std::string m_pattern;
+  std::string m_replacement;
+
+  // Documents are counted for the status line in the background
+  WorkerPool m_workers;
+
+  // The matches of a replace-all are found in the background too, in the buffer it was started on
+  ReplaceAll m_replace;
+  std::size_t m_replacing {};
+
+  // Frames are written to the terminal on a thread of their own
+  FrameWriter m_writer {STDOUT_FILENO};
 };
 }   // namespace Kilo::editor
 
@@ -0,0 +1,475 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "BracketIndex.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Kilo::editor {
+
+namespace {
+
+// The lowest level of a piece without any brackets
+constexpr auto NoBracket = std::numeric_limits<std::int32_t>::max();
+
+constexpr auto isOpener(char c) noexcept -> bool
+{
+  return c == '(' or c == '[' or c == '{';
+}
+
+constexpr auto isBracket(char c) noexcept -> bool
+{
+  return isOpener(c) or c == ')' or c == ']' or c == '}';
+}
+
+constexpr auto closerOf(char opener) noexcept -> char
+{
+  return opener == '(' ? ')' : opener == '[' ? ']' : '}';
+}
+
+/// Call a function with the offset of every bracket of a text and the bracket, in order, until it returns false
+template <typename Visit>
+void forEachBracket(std::string_view text, Visit const& visit)
+{
+  std::size_t offset {};
+
+#if defined(__SSE2__)
+  constexpr std::size_t Width = sizeof(__m128i);
+
+  // "(" and ")" only differ in their lowest bit. "[" and "{", and "]" and "}", only differ in the bit that tells
+  // upper from lower case letters
+  auto const parenthesis = _mm_set1_epi8('(');
+  auto const opening = _mm_set1_epi8('[');
+  auto const closing = _mm_set1_epi8(']');
+  auto const lowestBit = _mm_set1_epi8(static_cast<char>(0xFE));
+  auto const caseBit = _mm_set1_epi8(static_cast<char>(0xDF));
+
+  for (; offset + Width <= text.size(); offset += Width) {
+    auto const block = _mm_loadu_si128(reinterpret_cast<__m128i const*>(text.data() + offset));
+    auto const square = _mm_and_si128(block, caseBit);
+    auto const brackets = _mm_or_si128(_mm_cmpeq_epi8(_mm_and_si128(block, lowestBit), parenthesis),
+                                       _mm_or_si128(_mm_cmpeq_epi8(square, opening), _mm_cmpeq_epi8(square, closing)));
+
+    for (auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(brackets)); mask != 0; mask &= mask - 1) {
+      auto const at = offset + static_cast<std::size_t>(std::countr_zero(mask));
+
+      if (!visit(at, text[at])) {
+        return;
+      }
+    }
+  }
+#endif
+
+  for (; offset < text.size(); offset++) {
+    if (isBracket(text[offset]) and !visit(offset, text[offset])) {
+      return;
+    }
+  }
+}
+
+}   // namespace
+
+BracketIndex::BracketIndex(std::size_t chunkLines) : m_chunkLines(std::max(chunkLines, std::size_t {1}))
+{
+  index();
+}
+
+void BracketIndex::replaced(WorkerPool& workers, Document const& document, std::size_t first)
+{
+  first = std::min({first, m_lineCount, document.lineCount()});
+
+  std::erase_if(m_blocks, [first](Block const& block) { return block.line >= first; });
+  m_indexed = std::min(m_indexed, first);
+  m_lineCount = document.lineCount();
+  restart(workers, document);
+}
+
+void BracketIndex::changed(WorkerPool& workers, Document const& document, Changed const& changed)
+{
+  if (changed.lines.empty() and !changed.lineCount) {
+    return;
+  }
+
+  auto const lineCount = document.lineCount();
+  auto const replaced = replacedLines(changed, m_lineCount, lineCount);
+
+  // Lines that were already classified are classified again along with those that weren't
+  if (!m_ready) {
+    std::erase_if(m_blocks, [&replaced](Block const& block) { return block.line >= replaced.first; });
+    m_indexed = std::min(m_indexed, replaced.first);
+    m_lineCount = lineCount;
+    restart(workers, document);
+    return;
+  }
+
+  if (changed.lineCount) {
+    reclassify(document, replaced);
+  }
+  else {
+    reclassify(document, changed.lines);
+  }
+
+  m_lineCount = lineCount;
+  m_indexed = lineCount;
+}
+
+auto BracketIndex::collect() -> bool
+{
+  // Chunks of lines that changed again while they were being classified were dropped by restarting
+  m_jobs.collect([this](Result& result) { m_arrived.push_back(std::move(result)); });
+
+  // Chunks are taken in in order, as soon as every chunk before them is in
+  std::ranges::sort(m_arrived, {}, &Result::first);
+  auto taken = m_arrived.begin();
+
+  for (; taken != m_arrived.end() and taken->first == m_indexed; ++taken) {
+    m_blocks.insert(m_blocks.end(), taken->blocks.begin(), taken->blocks.end());
+    m_indexed += taken->count;
+  }
+
+  m_arrived.erase(m_arrived.begin(), taken);
+
+  if (m_ready or m_indexed < m_lineCount) {
+    return false;
+  }
+
+  m_ready = true;
+  index();
+  return true;
+}
+
+auto BracketIndex::match(Document const& document, Cursor const& at) const -> std::optional<Cursor>
+{
+  if (!m_ready or at.y < 0 or at.x < 0 or static_cast<std::size_t>(at.y) >= document.lineCount()) {
+    return std::nullopt;
+  }
+
+  auto const line = static_cast<std::size_t>(at.y);
+  auto const byte = static_cast<std::size_t>(at.x);
+  auto const text = document.line(line);
+
+  if (byte >= text.size() or !isBracket(text[byte])) {
+    return std::nullopt;
+  }
+
+  // An opening bracket is closed by the first bracket after it on its level or lower, and a closing bracket was
+  // opened by the last one before it
+  auto const block = blockAt(line, byte);
+  auto const opener = isOpener(text[byte]);
+  auto const depth = depthAt(document, block, byte);
+  auto const bound = opener ? depth + 1 : depth;
+  auto found = seek(document, block, opener ? byte + 1 : byte, bound, opener);
+
+  if (!found) {
+    auto const other = search(1, 0, m_leaves, opener ? block + 1 : block, 0, bound, opener);
+
+    if (other != None) {
+      found = seek(document, other, opener ? 0 : std::string_view::npos, bound, opener);
+    }
+  }
+
+  if (!found) {
+    return std::nullopt;
+  }
+
+  // Only a bracket of the same kind pairs up
+  auto const other = document.line(static_cast<std::size_t>(found->y))[static_cast<std::size_t>(found->x)];
+  return (opener ? closerOf(text[byte]) == other : closerOf(other) == text[byte]) ? found : std::nullopt;
+}
+
+auto BracketIndex::enclosing(Document const& document, Cursor const& at) const -> std::optional<Cursor>
+{
+  if (!m_ready or at.y < 0 or at.x < 0) {
+    return std::nullopt;
+  }
+
+  auto const line = static_cast<std::size_t>(at.y);
+  auto const byte = static_cast<std::size_t>(at.x);
+  auto const block = blockAt(line, byte);
+
+  if (block == None) {
+    return std::nullopt;
+  }
+
+  // The scope is opened by the last bracket before the position on the level it is on
+  auto const until = m_blocks[block].line == line ? byte : std::string_view::npos;
+  auto const depth = depthAt(document, block, until);
+
+  if (auto const found = seek(document, block, until, depth, false)) {
+    return found;
+  }
+
+  auto const other = search(1, 0, m_leaves, block, 0, depth, false);
+  return other == None ? std::nullopt : seek(document, other, std::string_view::npos, depth, false);
+}
+
+auto BracketIndex::work(Job const& job, Document const& document) -> Result
+{
+  auto result = Result {.first = job.first, .count = job.count, .blocks = {}};
+  classify(document, job.first, job.count, result.blocks);
+  return result;
+}
+
+void BracketIndex::classify(Document const& document, std::size_t first, std::size_t count,
+                            std::vector<Block>& blocks)
+{
+  for (auto line = first; line < first + count; line++) {
+    auto const text = document.line(line);
+
+    for (std::size_t byte = 0; byte < text.size(); byte += BlockBytes) {
+      if (auto const block = classify(text.substr(byte, BlockBytes), line, byte); block.low != NoBracket) {
+        blocks.push_back(block);
+      }
+    }
+  }
+}
+
+auto BracketIndex::classify(std::string_view piece, std::size_t line, std::size_t byte) noexcept -> Block
+{
+  auto block = Block {
+    .line = line, .byte = byte, .size = static_cast<std::uint32_t>(piece.size()), .depth = 0, .low = NoBracket};
+
+  forEachBracket(piece, [&block](std::size_t, char c) {
+    auto const opener = isOpener(c);
+    block.low = std::min(block.low, opener ? block.depth + 1 : block.depth);
+    block.depth += opener ? 1 : -1;
+    return true;
+  });
+
+  return block;
+}
+
+void BracketIndex::reclassify(Document const& document, std::vector<std::size_t> const& lines)
+{
+  auto const onLine = [this](std::size_t line) {
+    return std::ranges::equal_range(m_blocks, line, {}, &Block::line);
+  };
+
+  m_classified.clear();
+  auto resized = false;
+
+  for (auto const line : lines) {
+    auto const before = m_classified.size();
+    classify(document, line, 1, m_classified);
+    resized = resized or m_classified.size() - before != onLine(line).size();
+  }
+
+  // Lines that are still cut into as many blocks with brackets as before only change the paths from those blocks to
+  // the root of the tree
+  if (!resized) {
+    auto next = m_classified.begin();
+
+    for (auto const line : lines) {
+      for (auto& block : onLine(line)) {
+        block = *next++;
+        update(static_cast<std::size_t>(&block - m_blocks.data()));
+      }
+    }
+
+    return;
+  }
+
+  // Otherwise the blocks are merged with those of the other lines in a single pass
+  m_spliced.clear();
+  auto kept = m_blocks.begin();
+  auto next = m_classified.begin();
+
+  for (auto const line : lines) {
+    auto const [begin, end] = std::ranges::equal_range(kept, m_blocks.end(), line, {}, &Block::line);
+    m_spliced.insert(m_spliced.end(), kept, begin);
+
+    for (; next != m_classified.end() and next->line == line; ++next) {
+      m_spliced.push_back(*next);
+    }
+
+    kept = end;
+  }
+
+  m_spliced.insert(m_spliced.end(), kept, m_blocks.end());
+  m_blocks.swap(m_spliced);
+  index();
+}
+
+void BracketIndex::reclassify(Document const& document, Replaced const& replaced)
+{
+  auto const [first, removed, added] = replaced;
+  auto const begin = std::ranges::lower_bound(m_blocks, first, {}, &Block::line);
+  auto const end = std::ranges::lower_bound(begin, m_blocks.end(), first + removed, {}, &Block::line);
+
+  // The blocks after the run move along with their lines
+  for (auto block = end; block != m_blocks.end(); ++block) {
+    block->line = block->line - removed + added;
+  }
+
+  m_classified.clear();
+  classify(document, first, added, m_classified);
+  m_blocks.insert(m_blocks.erase(begin, end), m_classified.begin(), m_classified.end());
+  index();
+}
+
+void BracketIndex::restart(WorkerPool& workers, Document const& document)
+{
+  m_jobs.restart();
+  m_arrived.clear();
+  m_posted.clear();
+
+  for (auto first = m_indexed; first < m_lineCount; first += m_chunkLines) {
+    m_posted.push_back(Job {.first = first, .count = std::min(m_chunkLines, m_lineCount - first)});
+  }
+
+  m_jobs.post(workers, document, m_posted);
+  m_ready = m_posted.empty();
+
+  if (m_ready) {
+    index();
+  }
+}
+
+void BracketIndex::index()
+{
+  m_leaves = std::bit_ceil(std::max(m_blocks.size(), std::size_t {1}));
+  m_depths.assign(2 * m_leaves, 0);
+  m_lows.assign(2 * m_leaves, Unreached);
+
+  for (std::size_t block = 0; block < m_blocks.size(); block++) {
+    m_depths[m_leaves + block] = m_blocks[block].depth;
+    m_lows[m_leaves + block] = m_blocks[block].low;
+  }
+
+  for (auto node = m_leaves; node-- > 1;) {
+    m_depths[node] = m_depths[2 * node] + m_depths[2 * node + 1];
+    m_lows[node] = std::min(m_lows[2 * node], m_depths[2 * node] + m_lows[2 * node + 1]);
+  }
+}
+
+void BracketIndex::update(std::size_t block) noexcept
+{
+  auto node = m_leaves + block;
+  m_depths[node] = m_blocks[block].depth;
+  m_lows[node] = m_blocks[block].low;
+
+  for (node /= 2; node > 0; node /= 2) {
+    m_depths[node] = m_depths[2 * node] + m_depths[2 * node + 1];
+    m_lows[node] = std::min(m_lows[2 * node], m_depths[2 * node] + m_lows[2 * node + 1]);
+  }
+}
+
+auto BracketIndex::depthBefore(std::size_t block) const noexcept -> std::int64_t
+{
+  std::int64_t depth {};
+
+  // Every left sibling on the path up from the leaf covers blocks before it
+  for (auto node = m_leaves + block; node > 1; node /= 2) {
+    if (node % 2 == 1) {
+      depth += m_depths[node - 1];
+    }
+  }
+
+  return depth;
+}
+
+auto BracketIndex::blockAt(std::size_t line, std::size_t byte) const noexcept -> std::size_t
+{
+  auto const after = std::ranges::upper_bound(m_blocks, std::pair {line, byte}, {}, [](Block const& block) {
+    return std::pair {block.line, block.byte};
+  });
+
+  return after == m_blocks.begin() ? None : static_cast<std::size_t>(after - m_blocks.begin()) - 1;
+}
+
+auto BracketIndex::seek(Document const& document, std::size_t block, std::size_t until, std::int64_t bound,
+                        bool forward) const -> std::optional<Cursor>
+{
+  auto const& [line, byte, size, change, low] = m_blocks[block];
+  auto depth = depthBefore(block);
+  std::optional<Cursor> found;
+
+  forEachBracket(document.line(line).substr(byte, size), [&](std::size_t offset, char c) {
+    auto const at = byte + offset;
+    auto const level = isOpener(c) ? depth + 1 : depth;
+    depth += isOpener(c) ? 1 : -1;
+
+    if (forward ? at < until : at >= until) {
+      return forward;
+    }
+
+    if (level <= bound) {
+      found = Cursor {.x = static_cast<std::int64_t>(at), .y = static_cast<std::int64_t>(line)};
+    }
+
+    return !(forward and found);
+  });
+
+  return found;
+}
+
+auto BracketIndex::search(std::size_t node, std::size_t low, std::size_t high, std::size_t from, std::int64_t depth,
+                          std::int64_t bound, bool forward) const noexcept -> std::size_t
+{
+  // Subtrees wholly on the side searched are skipped if none of their brackets is low enough
+  auto const outside = forward ? high <= from : low >= from;
+  auto const inside = forward ? low >= from : high <= from;
+
+  if (outside or (inside and depth + m_lows[node] > bound)) {
+    return None;
+  }
+
+  if (high - low == 1) {
+    return low;
+  }
+
+  auto const middle = low + (high - low) / 2;
+  auto const left = [&] { return search(2 * node, low, middle, from, depth, bound, forward); };
+  auto const right = [&] {
+    return search(2 * node + 1, middle, high, from, depth + m_depths[2 * node], bound, forward);
+  };
+
+  auto const found = forward ? left() : right();
+  return found != None ? found : forward ? right() : left();
+}
+
+auto BracketIndex::depthAt(Document const& document, std::size_t block, std::size_t until) const -> std::int64_t
+{
+  auto const& [line, byte, size, change, low] = m_blocks[block];
+  auto depth = depthBefore(block);
+
+  forEachBracket(document.line(line).substr(byte, size), [&](std::size_t offset, char c) {
+    if (byte + offset >= until) {
+      return false;
+    }
+
+    depth += isOpener(c) ? 1 : -1;
+    return true;
+  });
+
+  return depth;
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,230 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BRACKET_INDEX_HPP
+#define BRACKET_INDEX_HPP
+
+#include "Editor/Cursor/Cursor.hpp"
+#include "Editor/Document/Document.hpp"
+#include "Editor/MultiCursor/MultiCursor.hpp"
+#include "Editor/WorkerPool/BackgroundJobs.hpp"
+#include "Editor/WorkerPool/WorkerPool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace Kilo::editor {
+
+// Where the brackets of a document are, and how deeply they are nested.
+//
+// Lines are cut into blocks of up to BlockBytes bytes, so that even a single
+// line of minified JSON is many blocks. Each block that holds a bracket keeps
+// how much deeper it leaves the nesting and the lowest level of any of its
+// brackets, where an opening bracket is on the level inside it and a closing
+// one on the level inside the pair it closes. A pair of brackets is on the
+// same level, with every bracket between them on a higher one.
+//
+// The blocks are kept in a segment tree of those sums and minimums, which
+// finds the next or previous block that has a bracket on a level no higher
+// than some other bracket in logarithmic time. Matching a bracket, or finding
+// the one that opens the scope around a position, then only reads the block
+// it starts in and the block the answer is in.
+//
+// Blocks are classified sixteen bytes at a time with SSE2. The whole
+// document is classified by workers in the background, in chunks of lines.
+// Edits after that only classify the lines they changed, and the tree is
+// updated along the paths from their blocks to the root, or rebuilt from the
+// blocks when lines were added or removed.
+//
+// Brackets in comments and string literals count like any other.
+
+class BracketIndex
+{
+public:
+  /// The most bytes of a line in a block
+  static constexpr std::size_t BlockBytes = 4096;
+
+  /// The number of lines classified by a worker at a time
+  static constexpr std::size_t ChunkLines = 16 * 1024;
+
+  /// Create the index of an empty document
+  /// \param[in] chunkLines The number of lines classified by a worker at a time
+  explicit BracketIndex(std::size_t chunkLines = ChunkLines);
+
+  BracketIndex(BracketIndex const&) = delete;
+  auto operator=(BracketIndex const&) -> BracketIndex& = delete;
+  BracketIndex(BracketIndex&&) = delete;
+  auto operator=(BracketIndex&&) -> BracketIndex& = delete;
+
+  /// Classify the lines from some line onwards in the background, after they were replaced, e.g. by appending lines
+  /// \param[in] workers The workers that classify the lines
+  /// \param[in] document The document after the edit
+  /// \param[in] first The first line that may have changed. Every line before it is the same as before
+  void replaced(WorkerPool& workers, Document const& document, std::size_t first);
+
+  /// Classify the lines changed by an edit at several cursors. Once the index is ready, this only reads the changed
+  /// lines, right away
+  /// \param[in] workers The workers that classify the lines if the index isn't ready yet
+  /// \param[in] document The document after the edit
+  /// \param[in] changed What the edit changed
+  void changed(WorkerPool& workers, Document const& document, Changed const& changed);
+
+  /// Take in the chunks that workers have classified
+  /// \returns true if the index became ready
+  auto collect() -> bool;
+
+  /// Check whether every line has been classified since it last changed. Nothing is found until it has
+  [[nodiscard]] constexpr auto ready() const noexcept -> bool
+  {
+    return m_ready;
+  }
+
+  /// Find the bracket that pairs up with the one at a position
+  /// \param[in] document The document, which must be the one last classified
+  /// \param[in] at The position of the bracket
+  /// \returns The position of the other bracket, or nothing if there is no bracket at the position, it isn't paired
+  /// up, or it is paired with the wrong kind of bracket
+  [[nodiscard]] auto match(Document const& document, Cursor const& at) const -> std::optional<Cursor>;
+
+  /// Find the opening bracket of the innermost scope around a position. A bracket at the position isn't part of it
+  /// \param[in] document The document, which must be the one last classified
+  /// \param[in] at The position
+  /// \returns The position of the bracket, or nothing if the position is outside every scope
+  [[nodiscard]] auto enclosing(Document const& document, Cursor const& at) const -> std::optional<Cursor>;
+
+  /// Get the number of blocks that hold a bracket
+  [[nodiscard]] auto blockCount() const noexcept -> std::size_t
+  {
+    return m_blocks.size();
+  }
+
+private:
+  /// A piece of a line with at least one bracket in it
+  struct Block
+  {
+    std::size_t line;
+    /// The first byte of the piece on its line
+    std::size_t byte;
+    std::uint32_t size;
+    /// How much deeper the nesting is after the piece than before it
+    std::int32_t depth;
+    /// The lowest level of a bracket of the piece, relative to the depth before it
+    std::int32_t low;
+  };
+
+  struct Job
+  {
+    std::size_t first;
+    std::size_t count;
+  };
+
+  struct Result
+  {
+    std::size_t first;
+    std::size_t count;
+    std::vector<Block> blocks;
+  };
+
+  static constexpr auto None = std::numeric_limits<std::size_t>::max();
+  static constexpr auto Unreached = std::numeric_limits<std::int64_t>::max() / 4;
+
+  /// Classify the lines of a chunk
+  static auto work(Job const& job, Document const& document) -> Result;
+
+  /// Cut some lines into blocks and append those with a bracket to a list
+  static void classify(Document const& document, std::size_t first, std::size_t count, std::vector<Block>& blocks);
+
+  /// Classify a piece of a line
+  static auto classify(std::string_view piece, std::size_t line, std::size_t byte) noexcept -> Block;
+
+  /// Classify the lines changed by an edit that kept the number of lines
+  void reclassify(Document const& document, std::vector<std::size_t> const& lines);
+
+  /// Classify a run of lines that replaced another
+  void reclassify(Document const& document, Replaced const& replaced);
+
+  /// Drop what workers are still classifying, and have the lines from the first one not classified yet on classified
+  /// again
+  void restart(WorkerPool& workers, Document const& document);
+
+  /// Rebuild the tree over the blocks
+  void index();
+
+  /// Update the tree after a block changed
+  void update(std::size_t block) noexcept;
+
+  /// Get the depth of the nesting before a block
+  [[nodiscard]] auto depthBefore(std::size_t block) const noexcept -> std::int64_t;
+
+  /// Get the last block that starts at or before a position
+  /// \returns The index of the block, or None
+  [[nodiscard]] auto blockAt(std::size_t line, std::size_t byte) const noexcept -> std::size_t;
+
+  /// Find the first bracket of a block on or after a byte, or the last one before it, on a level no higher than a
+  /// bound
+  /// \param[in] until The byte, or one past the last byte of the line if the block is on a line before it
+  [[nodiscard]] auto seek(Document const& document, std::size_t block, std::size_t until, std::int64_t bound,
+                          bool forward) const -> std::optional<Cursor>;
+
+  /// Find the first block from an index on, or the last one before it, with a bracket on a level no higher than a
+  /// bound
+  /// \returns The index of the block, or None
+  [[nodiscard]] auto search(std::size_t node, std::size_t low, std::size_t high, std::size_t from,
+                            std::int64_t depth, std::int64_t bound, bool forward) const noexcept -> std::size_t;
+
+  /// Get the depth of the nesting at a byte of a block, which is past every bracket before the byte
+  [[nodiscard]] auto depthAt(Document const& document, std::size_t block, std::size_t until) const -> std::int64_t;
+
+  std::size_t m_chunkLines;
+  std::size_t m_lineCount {};
+
+  // The lines before this one have been classified, and their blocks are in m_blocks
+  std::size_t m_indexed {};
+  bool m_ready {true};
+
+  std::vector<Block> m_blocks;
+
+  // The sums and minimums of the blocks, with their leaves starting at m_leaves
+  std::vector<std::int64_t> m_depths;
+  std::vector<std::int64_t> m_lows;
+  std::size_t m_leaves {};
+
+  // The chunks being classified. Restarted whenever what the workers are classifying is out of date, and destroying
+  // them waits for those the workers have started on
+  BackgroundJobs<Job, Result> m_jobs {work};
+
+  // Chunks that came back before the ones ahead of them, and blocks being classified again, kept to reuse their
+  // capacity
+  std::vector<Result> m_arrived;
+  std::vector<Job> m_posted;
+  std::vector<Block> m_classified;
+  std::vector<Block> m_spliced;
+};
+
+}   // namespace Kilo::editor
+
+#endif
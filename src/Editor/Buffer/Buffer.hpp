@@ -0,0 +1,115 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BUFFER_HPP
+#define BUFFER_HPP
+
+#include "Editor/BracketIndex/BracketIndex.hpp"
+#include "Editor/ColumnIndex/ColumnIndex.hpp"
+#include "Editor/Cursor/Cursor.hpp"
+#include "Editor/Document/Document.hpp"
+#include "Editor/FileFollower/FileFollower.hpp"
+#include "Editor/FoldIndex/FoldIndex.hpp"
+#include "Editor/GzipReader/GzipReader.hpp"
+#include "Editor/History/History.hpp"
+#include "Editor/Offset/Offset.hpp"
+#include "Editor/Statistics/Statistics.hpp"
+#include "Editor/StreamLoader/StreamLoader.hpp"
+#include "Editor/TextScanner/TextScanner.hpp"
+#include "Editor/WrapIndex/WrapIndex.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace Kilo::editor {
+
+// Everything that belongs to one open document rather than to the editor as a
+// whole. Switching between buffers only changes which of them is drawn, so
+// nothing has to be read or rendered again.
+//
+// Panes showing a buffer have a cursor, offset and soft-wrap index of their
+// own. Those kept here are where the buffer was left when it was last shown,
+// and are picked up again by the next pane that switches to it.
+//
+// Documents share their nodes when copied, so buffers opened on the same file
+// start out with a single copy of its lines between them, as long as the
+// buffer already open on it holds what is on disk.
+
+struct Buffer
+{
+  // The canonical path of the file, or empty if the document came from a stream
+  std::filesystem::path path;
+
+  // Set for files that can't be written back the way they were read, such as compressed ones, which are only shown
+  bool readOnly {};
+
+  Document document;
+  Document rendered;
+
+  // The line ending and encoding of the file, which it is saved with again
+  TextFormat format;
+
+  // Incremented whenever the document changes, so that panes know to draw it again
+  std::uint64_t generation {};
+
+  // The generation the document was at when it was last read from its file or saved to it. Until the generation
+  // moves on, the document holds what is on disk
+  std::uint64_t savedGeneration {};
+
+  // The lines the edit that led to the current generation changed, if that was all it changed. A pane that showed
+  // the generation before only has to draw these again. Empty if any line may have changed or moved
+  std::vector<std::size_t> changedLines;
+
+  // Where the columns of long lines start, recorded as they are shown. Cleared whenever existing lines change
+  ColumnIndex columns;
+
+  History history;
+
+  // What the document is made of, counted in the background and shown on the status line
+  DocumentStatistics statistics;
+
+  // Where the brackets of the document are, classified in the background
+  BracketIndex brackets;
+
+  // The ranges of lines that can be folded away, worked out when the first one is folded. Panes that don't soft-wrap
+  // count their rows in the lines these leave visible
+  FoldIndex folds;
+
+  Cursor cursor {};
+  Offset offset {};
+  std::optional<WrapIndex> wrap;
+
+  // Only engaged while the document is still being streamed in, and while it is being decompressed for that
+  std::optional<GzipReader> gzip;
+  std::optional<StreamLoader> loader;
+
+  // Only engaged while the file is being followed
+  std::optional<FileFollower> follower;
+};
+
+}   // namespace Kilo::editor
+
+#endif
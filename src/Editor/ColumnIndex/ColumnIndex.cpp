@@ -0,0 +1,170 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ColumnIndex.hpp"
+
+#include "Utilities/Constants.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Kilo::editor {
+
+namespace {
+
+/// Find the first tab in a range of a line
+/// \return The end of the range if there is none
+auto nextTab(std::string_view text, std::size_t from, std::size_t to) noexcept -> std::size_t
+{
+  auto const* tab = static_cast<char const*>(std::memchr(text.data() + from, '\t', to - from));
+  return tab == nullptr ? to : static_cast<std::size_t>(tab - text.data());
+}
+
+/// The column just past a tab that starts at the given column
+constexpr auto pastTab(std::size_t column) noexcept -> std::size_t
+{
+  constexpr auto stop = static_cast<std::size_t>(KiloTabStop);
+  return column + stop - column % stop;
+}
+
+/// Find the byte of a line that covers a column, scanning forward from a known position
+auto seek(std::string_view text, ColumnIndex::Position from, std::size_t column) noexcept -> ColumnIndex::Position
+{
+  auto [byte, current] = from;
+
+  while (byte < text.size()) {
+    // Every byte takes up at least one column, so the column is reached within this many bytes
+    auto const limit = std::min(text.size(), byte + (column - current) + 1);
+    auto const tab = nextTab(text, byte, limit);
+
+    if (column < current + (tab - byte)) {
+      return {.byte = byte + (column - current), .column = column};
+    }
+
+    if (tab == limit) {
+      current += tab - byte;
+      byte = tab;
+      continue;
+    }
+
+    current += tab - byte;
+
+    if (column < pastTab(current)) {
+      return {.byte = tab, .column = current};
+    }
+
+    current = pastTab(current);
+    byte = tab + 1;
+  }
+
+  return {.byte = text.size(), .column = current};
+}
+
+}   // namespace
+
+auto ColumnIndex::columnOf(std::size_t line, std::string_view text, std::size_t byte) -> std::size_t
+{
+  byte = std::min(byte, text.size());
+
+  if (text.size() <= ChunkSize) {
+    return advance(text, {.byte = 0, .column = 0}, byte);
+  }
+
+  auto const& chunks = chunksUpTo(line, text, byte);
+  auto const chunk = byte / ChunkSize;
+
+  return advance(text, {.byte = chunk * ChunkSize, .column = chunks[chunk]}, byte);
+}
+
+auto ColumnIndex::locate(std::size_t line, std::string_view text, std::size_t column) -> Position
+{
+  if (text.size() <= ChunkSize) {
+    return seek(text, {.byte = 0, .column = 0}, column);
+  }
+
+  // Record chunks until one starts past the column, or the line runs out of them
+  auto const* chunks = &chunksUpTo(line, text, 0);
+
+  while (chunks->back() <= column and chunks->size() * ChunkSize <= text.size()) {
+    chunks = &chunksUpTo(line, text, chunks->size() * ChunkSize);
+  }
+
+  auto const chunk = static_cast<std::size_t>(std::ranges::upper_bound(*chunks, column) - chunks->begin() - 1);
+
+  return seek(text, {.byte = chunk * ChunkSize, .column = (*chunks)[chunk]}, column);
+}
+
+auto ColumnIndex::width(std::size_t line, std::string_view text) -> std::size_t
+{
+  return columnOf(line, text, text.size());
+}
+
+void ColumnIndex::clear() noexcept
+{
+  m_chunks.clear();
+}
+
+void ColumnIndex::forget(std::size_t line) noexcept
+{
+  m_chunks.erase(line);
+}
+
+auto ColumnIndex::advance(std::string_view text, Position from, std::size_t byte) noexcept -> std::size_t
+{
+  auto [current, column] = from;
+
+  while (current < byte) {
+    auto const tab = nextTab(text, current, byte);
+    column += tab - current;
+
+    if (tab == byte) {
+      break;
+    }
+
+    column = pastTab(column);
+    current = tab + 1;
+  }
+
+  return column;
+}
+
+auto ColumnIndex::chunksUpTo(std::size_t line, std::string_view text, std::size_t byte)
+  -> std::vector<std::size_t> const&
+{
+  auto& chunks = m_chunks[line];
+
+  if (chunks.empty()) {
+    chunks.push_back(0);
+  }
+
+  auto const last = std::min(byte, text.size()) / ChunkSize;
+
+  while (chunks.size() <= last) {
+    auto const start = (chunks.size() - 1) * ChunkSize;
+    chunks.push_back(advance(text, {.byte = start, .column = chunks.back()}, start + ChunkSize));
+  }
+
+  return chunks;
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,104 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef COLUMN_INDEX_HPP
+#define COLUMN_INDEX_HPP
+
+#include <cstddef>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Kilo::editor {
+
+// Tabs make the column a byte of a line is shown at depend on everything
+// before it on the line. Working that out from the start of the line on every
+// keystroke and every frame costs time proportional to the length of the line,
+// which for minified files and single-line dumps can be hundreds of megabytes.
+//
+// Long lines are therefore split into chunks of a fixed number of bytes, and
+// the column each chunk starts at is recorded the first time it is needed.
+// Mapping between bytes and columns is then a binary search over the chunks
+// followed by a scan of at most one of them. Chunks are only recorded as far
+// into a line as has been asked for, so showing the start of a huge line
+// doesn't read the rest of it.
+//
+// Lines no longer than a chunk are scanned directly and never recorded.
+
+class ColumnIndex
+{
+public:
+  /// The number of bytes of a line between two recorded columns
+  static constexpr std::size_t ChunkSize = 4096;
+
+  /// A byte of a line together with the column it starts at
+  struct Position
+  {
+    std::size_t byte;
+    std::size_t column;
+  };
+
+  /// Get the column a byte of a line is shown at
+  /// \param[in] line The number of the line in the document
+  /// \param[in] text The contents of the line
+  /// \param[in] byte The offset of the byte within the line, which may be one past its end
+  [[nodiscard]] auto columnOf(std::size_t line, std::string_view text, std::size_t byte) -> std::size_t;
+
+  /// Find the byte of a line that covers a column. A tab covers every column up to the next tab stop, so the column
+  /// the byte starts at may be smaller than the one asked for
+  /// \param[in] line The number of the line in the document
+  /// \param[in] text The contents of the line
+  /// \param[in] column The column
+  /// \return One past the end of the line if the line is narrower than the column
+  [[nodiscard]] auto locate(std::size_t line, std::string_view text, std::size_t column) -> Position;
+
+  /// Get the number of columns a line takes up
+  /// \param[in] line The number of the line in the document
+  /// \param[in] text The contents of the line
+  [[nodiscard]] auto width(std::size_t line, std::string_view text) -> std::size_t;
+
+  /// Forget the columns recorded for every line, for when lines have changed
+  void clear() noexcept;
+
+  /// Forget the columns recorded for one line, for when only that line has changed
+  /// \param[in] line The number of the line in the document
+  void forget(std::size_t line) noexcept;
+
+  /// Advance from a position on a line to a later byte of it
+  /// \param[in] text The contents of the line
+  /// \param[in] from A byte of the line together with the column it starts at
+  /// \param[in] byte The byte to stop at, which may be one past the end of the line
+  /// \return The column the byte starts at
+  [[nodiscard]] static auto advance(std::string_view text, Position from, std::size_t byte) noexcept -> std::size_t;
+
+private:
+  /// Record the starting columns of the chunks of a line up to and including the chunk containing a byte
+  auto chunksUpTo(std::size_t line, std::string_view text, std::size_t byte) -> std::vector<std::size_t> const&;
+
+  /// The column each recorded chunk of a long line starts at, by line
+  std::unordered_map<std::size_t, std::vector<std::size_t>> m_chunks;
+};
+
+}   // namespace Kilo::editor
+
+#endif
@@ -24,7 +24,9 @@
 #ifndef CURSOR_HPP
 #define CURSOR_HPP
 
+#include <compare>
 #include <cstdint>
+#include <tuple>
 
 namespace Kilo::editor {
 
@@ -32,6 +34,14 @@ struct Cursor
 {
   std::int64_t x{};
   std::int64_t y{};
+
+  friend constexpr auto operator==(Cursor const&, Cursor const&) -> bool = default;
+
+  /// Cursors are ordered from the top of the document down, and from left to right along a line
+  friend constexpr auto operator<=>(Cursor const& a, Cursor const& b) noexcept
+  {
+    return std::tie(a.y, a.x) <=> std::tie(b.y, b.x);
+  }
 };
 
 } // namespace Kilo::editor
@@ -0,0 +1,652 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "Document.hpp"
+
+#include "Memory/Memory.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Kilo::editor {
+
+namespace {
+
+// The number of lines in a leaf and the number of children of an inner node
+// are kept between these bounds, except for the root. A leaf is also split
+// once its text grows past MaxLeafBytes, so that editing a line never has to
+// move more than a few kilobytes
+constexpr std::size_t MaxLeafLines = 256;
+constexpr std::size_t MinLeafLines = MaxLeafLines / 4;
+constexpr std::size_t MaxLeafBytes = 16 * 1024;
+constexpr std::size_t MinLeafBytes = MaxLeafBytes / 4;
+constexpr std::size_t MaxChildren = 16;
+constexpr std::size_t MinChildren = MaxChildren / 4;
+
+/// Make sure a line fits in a document before any of it is touched
+void checkLength(std::size_t bytes)
+{
+  if (bytes > Document::MaxLineBytes) {
+    throw std::length_error("The line is too long");
+  }
+}
+
+}   // namespace
+
+// A leaf doesn't store its lines as separate strings. Their text is packed
+// back to back into a single blob, and ends[j] records where line j stops
+// within it. That costs four bytes per line on top of the text itself, and
+// line j is still found in constant time once we have reached its leaf.
+// Newlines are implied and not stored.
+
+struct Document::Node
+{
+  using Ptr = std::shared_ptr<Node>;
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  bool leaf {true};
+  std::size_t lines {};
+  std::size_t bytes {};
+  std::pmr::vector<Ptr> children;
+  std::pmr::string blob;
+  std::pmr::vector<std::uint32_t> ends;
+
+  explicit Node(allocator_type alloc = memory::lineStorage()) : children(alloc), blob(alloc), ends(alloc)
+  {
+  }
+
+  // Copying a pmr container would otherwise allocate the copy from the default resource
+  Node(Node const& other, allocator_type alloc = memory::lineStorage())
+    : leaf(other.leaf)
+    , lines(other.lines)
+    , bytes(other.bytes)
+    , children(other.children, alloc)
+    , blob(other.blob, alloc)
+    , ends(other.ends, alloc)
+  {
+  }
+
+  Node(Node&&) = delete;
+  auto operator=(Node const&) -> Node& = delete;
+  auto operator=(Node&&) -> Node& = delete;
+  ~Node() = default;
+
+  /// Create a node allocated from the line storage
+  template<typename... Args>
+  static auto make(Args&&... args) -> Ptr
+  {
+    return std::allocate_shared<Node>(allocator_type(memory::lineStorage()), std::forward<Args>(args)...);
+  }
+
+  /// Get the number of lines of a leaf or the number of children of an inner node
+  [[nodiscard]] auto size() const noexcept -> std::size_t
+  {
+    return leaf ? ends.size() : children.size();
+  }
+
+  [[nodiscard]] auto overfull() const noexcept -> bool
+  {
+    if (leaf) {
+      return ends.size() > MaxLeafLines or (ends.size() > 1 and blob.size() > MaxLeafBytes);
+    }
+
+    return children.size() > MaxChildren;
+  }
+
+  [[nodiscard]] auto underfull() const noexcept -> bool
+  {
+    if (leaf) {
+      return ends.size() < MinLeafLines and blob.size() < MinLeafBytes;
+    }
+
+    return children.size() < MinChildren;
+  }
+
+  /// Get the position within the blob at which a line of a leaf starts
+  [[nodiscard]] auto start(std::size_t j) const noexcept -> std::size_t
+  {
+    return j == 0 ? 0 : ends[j - 1];
+  }
+
+  /// Get a line of a leaf
+  [[nodiscard]] auto text(std::size_t j) const noexcept -> std::string_view
+  {
+    return std::string_view(blob).substr(start(j), ends[j] - start(j));
+  }
+
+  /// Move the ends of the lines of a leaf from line j onwards by delta bytes
+  void shiftEnds(std::size_t j, std::ptrdiff_t delta) noexcept
+  {
+    for (auto it = ends.begin() + static_cast<std::ptrdiff_t>(j); it != ends.end(); ++it) {
+      *it = static_cast<std::uint32_t>(static_cast<std::ptrdiff_t>(*it) + delta);
+    }
+  }
+
+  /// Find the child of an inner node that holds a line
+  /// \param[in] index The index of the line within this node. On return, its index within the child
+  /// \returns The position of the child
+  [[nodiscard]] auto childFor(std::size_t& index) const noexcept -> std::size_t
+  {
+    std::size_t k = 0;
+
+    for (; k + 1 < children.size() and index >= children[k]->lines; k++) {
+      index -= children[k]->lines;
+    }
+
+    return k;
+  }
+
+  /// Recompute the line and byte counts of a node from its contents
+  void recount() noexcept
+  {
+    if (leaf) {
+      lines = ends.size();
+      bytes = blob.size() + lines;
+      return;
+    }
+
+    lines = 0;
+    bytes = 0;
+
+    for (auto const& child : children) {
+      lines += child->lines;
+      bytes += child->bytes;
+    }
+  }
+
+  /// Move everything from position at onwards into a new node
+  /// \returns The new node, which becomes the right sibling of this one
+  auto split(std::size_t at) -> Ptr
+  {
+    assert(at > 0 and at < size() and "Both halves of a split must be non-empty");
+
+    auto right = make();
+    right->leaf = leaf;
+
+    if (leaf) {
+      auto const cut = start(at);
+
+      right->blob.assign(blob, cut);
+      right->ends.assign(ends.begin() + static_cast<std::ptrdiff_t>(at), ends.end());
+      right->shiftEnds(0, -static_cast<std::ptrdiff_t>(cut));
+
+      // Give back the room the leaf grew into before it was split
+      blob.resize(cut);
+      blob.shrink_to_fit();
+      ends.resize(at);
+      ends.shrink_to_fit();
+    }
+    else {
+      right->children.assign(std::make_move_iterator(children.begin() + static_cast<std::ptrdiff_t>(at)),
+                             std::make_move_iterator(children.end()));
+      children.resize(at);
+    }
+
+    recount();
+    right->recount();
+
+    return right;
+  }
+
+  /// Find where to split an overfull node
+  /// \param[in] inserted The position that was just filled. Nodes that grow at the end, e.g. while a file is
+  /// loaded, are split just before it so that they are left full rather than half-empty
+  [[nodiscard]] auto splitPoint(std::size_t inserted) const noexcept -> std::size_t
+  {
+    if (inserted + 1 == size()) {
+      return inserted;
+    }
+
+    if (!leaf or ends.size() > MaxLeafLines) {
+      return size() / 2;
+    }
+
+    // Too many bytes rather than too many lines: split at the line nearest to the middle of the text
+    auto const middle = std::ranges::lower_bound(ends, static_cast<std::uint32_t>(blob.size() / 2));
+    return std::clamp<std::size_t>(static_cast<std::size_t>(middle - ends.begin()), 1, size() - 1);
+  }
+
+  /// Merge an underfull child with one of its siblings, splitting the result again if it is too large
+  /// \param[in] k The position of the underfull child
+  void rebalance(std::size_t k)
+  {
+    if (children.size() < 2) {
+      return;
+    }
+
+    auto const left = k + 1 < children.size() ? k : k - 1;
+    auto& l = mutate(children[left]);
+    auto const& r = *children[left + 1];
+
+    if (l.leaf) {
+      auto const base = static_cast<std::ptrdiff_t>(l.blob.size());
+      auto const first = l.ends.size();
+
+      l.blob += r.blob;
+      l.ends.insert(l.ends.end(), r.ends.begin(), r.ends.end());
+      l.shiftEnds(first, base);
+    }
+    else {
+      l.children.insert(l.children.end(), r.children.begin(), r.children.end());
+    }
+
+    l.recount();
+
+    if (l.overfull()) {
+      children[left + 1] = l.split(l.size() / 2);
+    }
+    else {
+      children.erase(children.begin() + static_cast<std::ptrdiff_t>(left) + 1);
+    }
+  }
+
+  /// Make sure nobody else can see a node before it is modified
+  /// \param[in] node The node about to be modified. It is replaced by a copy if it is shared
+  /// \returns The node, which may now be modified
+  static auto mutate(Ptr& node) -> Node&
+  {
+    if (node.use_count() > 1) {
+      node = make(*node);
+    }
+
+    return *node;
+  }
+
+  /// Insert a line into the subtree rooted at node
+  /// \returns The new right sibling of node if node had to be split, nullptr otherwise
+  static auto insert(Ptr& node, std::size_t index, std::string_view text) -> Ptr
+  {
+    auto& n = mutate(node);
+    auto inserted = index;
+
+    if (n.leaf) {
+      // The ends of the lines would wrap around. Leaves are split long before this, so only lines of gigabytes get here
+      if (n.blob.size() + text.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error("The line is too long for the lines around it");
+      }
+
+      auto const at = n.start(index);
+
+      n.blob.insert(at, text);
+      n.ends.insert(n.ends.begin() + static_cast<std::ptrdiff_t>(index), static_cast<std::uint32_t>(at));
+      n.shiftEnds(index, static_cast<std::ptrdiff_t>(text.size()));
+    }
+    else {
+      auto const k = n.childFor(index);
+
+      if (auto sibling = insert(n.children[k], index, text)) {
+        n.children.insert(n.children.begin() + static_cast<std::ptrdiff_t>(k) + 1, std::move(sibling));
+        inserted = k + 1;
+      }
+      else {
+        inserted = k;
+      }
+    }
+
+    n.lines += 1;
+    n.bytes += text.size() + 1;
+
+    return n.overfull() ? n.split(n.splitPoint(inserted)) : nullptr;
+  }
+
+  /// Remove a line from the subtree rooted at node
+  static void erase(Ptr& node, std::size_t index)
+  {
+    auto& n = mutate(node);
+
+    if (n.leaf) {
+      auto const at = n.start(index);
+      auto const length = n.ends[index] - at;
+
+      n.blob.erase(at, length);
+      n.ends.erase(n.ends.begin() + static_cast<std::ptrdiff_t>(index));
+      n.shiftEnds(index, -static_cast<std::ptrdiff_t>(length));
+
+      n.lines -= 1;
+      n.bytes -= length + 1;
+      return;
+    }
+
+    auto const k = n.childFor(index);
+    auto const before = n.children[k]->bytes;
+
+    erase(n.children[k], index);
+
+    n.lines -= 1;
+    n.bytes -= before - n.children[k]->bytes;
+
+    if (n.children[k]->underfull()) {
+      n.rebalance(k);
+    }
+  }
+
+  /// Replace the text of a line in the subtree rooted at node
+  /// \returns The new right sibling of node if node had to be split, nullptr otherwise
+  static auto replace(Ptr& node, std::size_t index, std::string_view text) -> Ptr
+  {
+    auto& n = mutate(node);
+    auto replaced = index;
+
+    if (n.leaf) {
+      auto const at = n.start(index);
+      auto const length = n.ends[index] - at;
+
+      if (n.blob.size() - length + text.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error("The line is too long for the lines around it");
+      }
+
+      n.blob.replace(at, length, text);
+      n.shiftEnds(index, static_cast<std::ptrdiff_t>(text.size()) - static_cast<std::ptrdiff_t>(length));
+      n.bytes = n.bytes - length + text.size();
+    }
+    else {
+      auto const k = n.childFor(index);
+
+      if (auto sibling = replace(n.children[k], index, text)) {
+        n.children.insert(n.children.begin() + static_cast<std::ptrdiff_t>(k) + 1, std::move(sibling));
+      }
+
+      replaced = k;
+      n.recount();
+    }
+
+    return n.overfull() ? n.split(n.splitPoint(replaced)) : nullptr;
+  }
+
+  /// Count the lines two trees have in common at their start, or at their end, up to a limit
+  /// \param[in] fromEnd Whether to count from the end
+  static auto common(Node const* a, Node const* b, bool fromEnd, std::size_t limit) -> std::size_t
+  {
+    // The subtrees that cover what is left of each tree, with the next one last, and how many lines of the next one
+    // have been counted. Only leaves are ever counted in part
+    std::vector<Node const*> left {a};
+    std::vector<Node const*> right {b};
+    std::size_t l = 0;
+    std::size_t r = 0;
+    std::size_t count = 0;
+
+    auto const open = [fromEnd](std::vector<Node const*>& pending) {
+      auto const* node = pending.back();
+      pending.pop_back();
+
+      if (fromEnd) {
+        for (auto const& child : node->children) {
+          pending.push_back(child.get());
+        }
+      }
+      else {
+        for (auto it = node->children.rbegin(); it != node->children.rend(); ++it) {
+          pending.push_back(it->get());
+        }
+      }
+    };
+
+    auto const text = [fromEnd](Node const* leaf, std::size_t j) {
+      return leaf->text(fromEnd ? leaf->ends.size() - 1 - j : j);
+    };
+
+    while (count < limit and !left.empty() and !right.empty()) {
+      auto const* x = left.back();
+      auto const* y = right.back();
+
+      // A subtree both trees share, reached at the same line of it, holds the same lines from there on
+      if (x == y and l == r) {
+        count += x->lines - l;
+        left.pop_back();
+        right.pop_back();
+        l = 0;
+        r = 0;
+      }
+      else if (x->lines == 0) {
+        left.pop_back();
+      }
+      else if (y->lines == 0) {
+        right.pop_back();
+      }
+      // The larger subtree is opened first, so that both sides come down to subtrees of about the same size
+      else if (!x->leaf and (y->leaf or x->lines >= y->lines)) {
+        open(left);
+      }
+      else if (!y->leaf) {
+        open(right);
+      }
+      else if (text(x, l) != text(y, r)) {
+        break;
+      }
+      else {
+        count++;
+
+        if (++l == x->lines) {
+          left.pop_back();
+          l = 0;
+        }
+
+        if (++r == y->lines) {
+          right.pop_back();
+          r = 0;
+        }
+      }
+    }
+
+    return std::min(count, limit);
+  }
+};
+
+Document::Document(std::initializer_list<std::string_view> lines)
+{
+  for (auto const line : lines) {
+    append(line);
+  }
+}
+
+auto Document::lineCount() const noexcept -> std::size_t
+{
+  return m_root ? m_root->lines : 0;
+}
+
+auto Document::byteCount() const noexcept -> std::size_t
+{
+  return m_root ? m_root->bytes : 0;
+}
+
+auto Document::line(std::size_t index) const noexcept -> std::string_view
+{
+  assert(index < lineCount() and "Line index out of range");
+
+  auto const* node = m_root.get();
+
+  while (!node->leaf) {
+    node = node->children[node->childFor(index)].get();
+  }
+
+  return node->text(index);
+}
+
+auto Document::lineOffset(std::size_t index) const noexcept -> std::size_t
+{
+  assert(index <= lineCount() and "Line index out of range");
+
+  if (index == lineCount()) {
+    return byteCount();
+  }
+
+  std::size_t offset = 0;
+  auto const* node = m_root.get();
+
+  while (!node->leaf) {
+    auto k = std::size_t {0};
+
+    for (; index >= node->children[k]->lines; k++) {
+      index -= node->children[k]->lines;
+      offset += node->children[k]->bytes;
+    }
+
+    node = node->children[k].get();
+  }
+
+  // Every line before this one in the leaf is followed by a newline
+  return offset + node->start(index) + index;
+}
+
+auto Document::lineAt(std::size_t offset) const noexcept -> std::size_t
+{
+  assert(offset < byteCount() and "Byte offset out of range");
+
+  std::size_t index = 0;
+  auto const* node = m_root.get();
+
+  while (!node->leaf) {
+    auto k = std::size_t {0};
+
+    for (; offset >= node->children[k]->bytes; k++) {
+      offset -= node->children[k]->bytes;
+      index += node->children[k]->lines;
+    }
+
+    node = node->children[k].get();
+  }
+
+  // Line j of the leaf ends with the newline at offset ends[j] + j, so we are after the first line for which that is
+  // not before the offset
+  auto lo = std::size_t {0};
+  auto hi = node->ends.size() - 1;
+
+  while (lo < hi) {
+    auto const mid = (lo + hi) / 2;
+
+    if (node->ends[mid] + mid < offset) {
+      lo = mid + 1;
+    }
+    else {
+      hi = mid;
+    }
+  }
+
+  return index + lo;
+}
+
+auto Document::difference(Document const& before) const -> Replaced
+{
+  auto const lines = lineCount();
+  auto const was = before.lineCount();
+
+  if (!m_root or !before.m_root) {
+    return {.first = 0, .removed = was, .added = lines};
+  }
+
+  // Lines both start with aren't counted again among those both end with
+  auto const limit = std::min(lines, was);
+  auto const head = Node::common(before.m_root.get(), m_root.get(), false, limit);
+  auto const tail = Node::common(before.m_root.get(), m_root.get(), true, limit - head);
+
+  return {.first = head, .removed = was - head - tail, .added = lines - head - tail};
+}
+
+void Document::append(std::string_view text)
+{
+  insertLine(lineCount(), text);
+}
+
+void Document::insertLine(std::size_t index, std::string_view text)
+{
+  assert(index <= lineCount() and "Line index out of range");
+  checkLength(text.size());
+
+  if (!m_root) {
+    m_root = Node::make();
+  }
+
+  growIfSplit(Node::insert(m_root, index, text));
+}
+
+void Document::eraseLine(std::size_t index)
+{
+  assert(index < lineCount() and "Line index out of range");
+
+  Node::erase(m_root, index);
+
+  // Shrink the tree by one level when the root is left with a single child
+  while (!m_root->leaf and m_root->children.size() == 1) {
+    m_root = m_root->children.front();
+  }
+}
+
+void Document::replaceLine(std::size_t index, std::string_view text)
+{
+  assert(index < lineCount() and "Line index out of range");
+  checkLength(text.size());
+
+  growIfSplit(Node::replace(m_root, index, text));
+}
+
+void Document::splitLine(std::size_t index, std::size_t column)
+{
+  auto const current = line(index);
+
+  assert(column <= current.size() and "Column out of range");
+
+  // The view is invalidated once the document is modified, so take copies of both halves first
+  auto const head = std::pmr::string(current.substr(0, column), memory::lineStorage());
+  auto const tail = std::pmr::string(current.substr(column), memory::lineStorage());
+
+  replaceLine(index, head);
+  insertLine(index + 1, tail);
+}
+
+void Document::joinLines(std::size_t index)
+{
+  assert(index + 1 < lineCount() and "There is no line to join with");
+  checkLength(line(index).size() + line(index + 1).size());
+
+  auto joined = std::pmr::string(line(index), memory::lineStorage());
+  joined += line(index + 1);
+
+  replaceLine(index, joined);
+  eraseLine(index + 1);
+}
+
+void Document::growIfSplit(std::shared_ptr<Node> sibling)
+{
+  // If the root had to be split, the tree grows by one level
+  if (sibling) {
+    auto root = Node::make();
+
+    root->leaf = false;
+    root->children.push_back(std::move(m_root));
+    root->children.push_back(std::move(sibling));
+    root->recount();
+
+    m_root = std::move(root);
+  }
+}
+
+}   // namespace Kilo::editor
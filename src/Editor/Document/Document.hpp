@@ -0,0 +1,156 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef DOCUMENT_HPP
+#define DOCUMENT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <string_view>
+
+namespace Kilo::editor {
+
+// The lines of the document being edited are kept in a B-tree ("rope of line
+// chunks"). The leaves hold runs of consecutive lines, and every node records
+// how many lines and bytes lie beneath it. Finding line i, or the byte offset
+// at which it starts, is therefore a walk from the root to a single leaf, and
+// inserting or removing a line only touches the nodes on that path instead of
+// shifting every line after it.
+//
+// Nodes are reference counted, so copying a Document is O(1) and the copies
+// share their structure. A node is cloned before it is modified if anybody
+// else can still see it.
+//
+// Nodes are allocated from memory::lineStorage() rather than from the global
+// heap. Within a leaf, lines are packed into a single buffer, so a line costs
+// a few bytes on top of its text instead of a std::string of its own.
+// Where a line ends within that buffer is kept in 32 bits, which limits a
+// line, and the lines it shares a leaf with, to 4 GiB.
+
+/// A run of lines an edit took out, and the run it put in their place
+struct Replaced
+{
+  /// The first line of both runs
+  std::size_t first {};
+  /// How many lines were taken out
+  std::size_t removed {};
+  /// How many lines were put in
+  std::size_t added {};
+};
+
+class Document
+{
+public:
+  /// The length of the longest line a document can hold
+  static constexpr std::size_t MaxLineBytes = std::numeric_limits<std::uint32_t>::max();
+
+  /// Create an empty document
+  explicit Document() noexcept = default;
+
+  /// Create a document with the given lines
+  /// \param[in] lines The lines of the document
+  Document(std::initializer_list<std::string_view> lines);
+
+  /// Get the number of lines in the document
+  [[nodiscard]] auto lineCount() const noexcept -> std::size_t;
+
+  /// Get the number of bytes in the document, counting one newline per line
+  [[nodiscard]] auto byteCount() const noexcept -> std::size_t;
+
+  /// Check whether the document has no lines
+  [[nodiscard]] auto empty() const noexcept -> bool
+  {
+    return lineCount() == 0;
+  }
+
+  /// Get a line of the document
+  /// \param[in] index The index of the line
+  /// \returns A view of the line without its newline, valid until the document is next modified
+  /// \pre index must be less than lineCount()
+  [[nodiscard]] auto line(std::size_t index) const noexcept -> std::string_view;
+
+  /// Get the byte offset at which a line starts
+  /// \param[in] index The index of the line. Passing lineCount() yields byteCount()
+  [[nodiscard]] auto lineOffset(std::size_t index) const noexcept -> std::size_t;
+
+  /// Get the line containing a byte offset
+  /// \param[in] offset The byte offset
+  /// \pre offset must be less than byteCount()
+  [[nodiscard]] auto lineAt(std::size_t offset) const noexcept -> std::size_t;
+
+  /// Find the lines in which another document differs from this one. Subtrees both share are skipped without being
+  /// read, so comparing a document with an edited copy of it costs about as much as the nodes the edit cloned
+  /// \param[in] before The other document
+  /// \returns The run of lines of the other document that would have to be replaced to turn it into this one
+  [[nodiscard]] auto difference(Document const& before) const -> Replaced;
+
+  /// Add a line to the end of the document
+  /// \param[in] text The text of the line, without a newline
+  /// \throws std::length_error if the line is longer than MaxLineBytes, or too long for the lines around it
+  void append(std::string_view text);
+
+  /// Insert a line before the line at the given index
+  /// \param[in] index The index the new line will have. Passing lineCount() appends the line
+  /// \param[in] text The text of the line, without a newline
+  /// \throws std::length_error if the line is longer than MaxLineBytes, or too long for the lines around it
+  void insertLine(std::size_t index, std::string_view text);
+
+  /// Remove a line
+  /// \param[in] index The index of the line
+  void eraseLine(std::size_t index);
+
+  /// Replace the text of a line
+  /// \param[in] index The index of the line
+  /// \param[in] text The new text of the line, without a newline
+  /// \throws std::length_error if the line is longer than MaxLineBytes, or too long for the lines around it
+  void replaceLine(std::size_t index, std::string_view text);
+
+  /// Break a line in two, as if a newline had been typed
+  /// \param[in] index The index of the line
+  /// \param[in] column The byte at which the line is broken. It becomes the first byte of the new line
+  void splitLine(std::size_t index, std::size_t column);
+
+  /// Join a line with the line after it, as if the newline between them had been deleted
+  /// \param[in] index The index of the first of the two lines
+  /// \pre index + 1 must be less than lineCount()
+  /// \throws std::length_error if the joined line would be longer than MaxLineBytes, or too long for the lines
+  /// around it
+  void joinLines(std::size_t index);
+
+private:
+  struct Node;
+
+  /// Add a level to the tree if the root was split
+  /// \param[in] sibling The new right sibling of the root, or nullptr if the root wasn't split
+  void growIfSplit(std::shared_ptr<Node> sibling);
+
+  std::shared_ptr<Node> m_root;
+};
+
+}   // namespace Kilo::editor
+
+#endif
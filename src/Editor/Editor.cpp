@@ -23,25 +23,39 @@
 
 #include "Editor.hpp"
 
+#include "ColumnIndex/ColumnIndex.hpp"
 #include "Cursor/Cursor.hpp"
+#include "Document/Document.hpp"
 #include "File/File.hpp"
+#include "FoldIndex/FoldIndex.hpp"
+#include "GzipReader/GzipReader.hpp"
+#include "LineDiff/LineDiff.hpp"
 #include "Offset/Offset.hpp"
+#include "Region/Region.hpp"
 #include "ScreenBuffer/ScreenBuffer.hpp"
+#include "StreamLoader/StreamLoader.hpp"
 #include "Terminal/Window/Window.hpp"
+#include "TextScanner/TextScanner.hpp"
 #include "Utilities/Constants.hpp"
 #include "Utilities/Utilities.hpp"
-#include <fmt/format.h>
+#include "WrapIndex/WrapIndex.hpp"
 #include <string_view>
+#include <system_error>
+
+#include <fmt/format.h>
 
 #include <algorithm>
+#include <array>
+#include <cerrno>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <fcntl.h>
 #include <filesystem>
-#include <fstream>
 #include <functional>
 #include <iostream>
 #include <optional>
+#include <span>
 #include <string>
 #include <unistd.h>
 #include <utility>
@@ -57,7 +71,7 @@ namespace Kilo::editor {
  * @param[in] window The terminal window
  */
 void processKeypress(int const keyPressed, Cursor& cursor, Terminal::Window const& window,
-                     std::vector<std::string> const& document) noexcept
+                     Document const& document) noexcept
 {
   using editor::EditorKey;
   using utilities::clearScreenAndRepositionCursor;
@@ -75,7 +89,8 @@ void processKeypress(int const keyPressed, Cursor& cursor, Terminal::Window cons
     cursor.x = 0;
   }
   else if (key == End) {
-    cursor.x = window.cols() - 1;
+    auto const line = static_cast<std::size_t>(cursor.y);
+    cursor.x = line < document.lineCount() ? static_cast<std::int64_t>(document.line(line).size()) : 0;
   }
   else if (key == PageUp or key == PageDown) {
     for (auto i = window.rows(); i > 0; i--) {
@@ -97,13 +112,13 @@ void processKeypress(int const keyPressed, Cursor& cursor, Terminal::Window cons
  * @param offset The offset from the window to the open document
  */
 void refreshScreen(ScreenBuffer& buffer, Cursor const& cursor, Offset const& offset, Terminal::Window const& window,
-                   std::vector<std::string> const& document, std::vector<std::string> const& renderedDoc)
+                   Document const& document, Document const& renderedDoc)
 {
   /*
    * Hide the cursor when painting and then move it to the home position
    */
 
-  buffer.write(EscapeSequences::HideCursorWhenRepainting).write(EscapeSequences::MoveCursorToHomePosition);
+  buffer.write(EscapeSequences::BeginRepaint);
 
   IO::File output;
 
@@ -111,9 +126,9 @@ void refreshScreen(ScreenBuffer& buffer, Cursor const& cursor, Offset const& off
 
   // We add 1 to cursor.x and cursor.y to convert from 0-indexed values to the
   // 1-indexed values that the terminal uses
-  auto const cursorPos = fmt::format("\x1b[{};{}H", (cursor.y - offset.row) + 1, (cursor.x - offset.col) + 1);
-
-  buffer.write(cursorPos).write(EscapeSequences::ShowTheCursor).flush(output);
+  buffer.moveCursorTo((cursor.y - offset.row) + 1, (cursor.x - offset.col) + 1)
+    .write(EscapeSequences::ShowTheCursor)
+    .flush(output);
 }
 
 /**
@@ -125,11 +140,11 @@ void refreshScreen(ScreenBuffer& buffer, Cursor const& cursor, Offset const& off
  * @param buffer The screen buffer
  * @param renderedDoc The version of the document being edited that is actually rendered
  */
-void drawRows(Terminal::Window const& window, Offset const& offset, std::vector<std::string> const& doc,
-              ScreenBuffer& buffer, std::vector<std::string> const& renderedDoc)
+void drawRows(Terminal::Window const& window, Offset const& offset, Document const& doc,
+              ScreenBuffer& buffer, Document const& renderedDoc)
 {
   for (std::size_t currentRow = 0; std::cmp_less(currentRow, window.rows()); currentRow++) {
-    if (auto fileRow = currentRow + offset.row; fileRow >= doc.size()) {
+    if (auto fileRow = currentRow + offset.row; fileRow >= doc.lineCount()) {
       if (doc.empty() and std::cmp_equal(currentRow, window.rows() / 3)) {
         detail::printWelcomeMessage(window.cols(), buffer);
       }
@@ -138,10 +153,10 @@ void drawRows(Terminal::Window const& window, Offset const& offset, std::vector<
       }
     }
     else {
-      detail::printLineOfDocument(renderedDoc[fileRow], buffer, window.cols(), offset.col);
+      detail::printLineOfDocument(renderedDoc.line(fileRow), buffer, window.cols(), offset.col);
     }
 
-    buffer.write(EscapeSequences::ErasePartOfLineToTheRightOfCursor);
+    buffer.eraseInLine();
 
     if (std::cmp_less(currentRow, window.rows() - 1)) {
       buffer.write("\r\n");
@@ -156,7 +171,7 @@ void drawRows(Terminal::Window const& window, Offset const& offset, std::vector<
  * @param cursor The editor cursor
  * @param document The document which is currently open
  */
-void moveCursor(editor::EditorKey key, Cursor& cursor, std::vector<std::string> const& document)
+void moveCursor(editor::EditorKey key, Cursor& cursor, Document const& document)
 {
   using enum editor::EditorKey;
 
@@ -167,16 +182,16 @@ void moveCursor(editor::EditorKey key, Cursor& cursor, std::vector<std::string>
       }
       else if (cursor.y > 0) {
         cursor.y--;
-        cursor.x = std::ssize(document[cursor.y]);
+        cursor.x = std::ssize(document.line(cursor.y));
       }
       break;
     case ArrowRight: {
-      auto currentRow = std::invoke([cy = cursor.y, &document]() -> std::optional<std::string> {
-        if (cy >= std::ssize(document)) {
+      auto currentRow = std::invoke([cy = cursor.y, &document]() -> std::optional<std::string_view> {
+        if (std::cmp_greater_equal(cy, document.lineCount())) {
           return std::nullopt;
         }
 
-        return std::make_optional(document[cy]);
+        return std::make_optional(document.line(cy));
       });
 
       if (currentRow && std::cmp_less(cursor.x, currentRow->size())) {
@@ -194,7 +209,7 @@ void moveCursor(editor::EditorKey key, Cursor& cursor, std::vector<std::string>
       }
       break;
     case ArrowDown:
-      if (std::cmp_less(cursor.y, document.size())) {
+      if (std::cmp_less(cursor.y, document.lineCount())) {
         cursor.y++;
       }
       break;
@@ -202,12 +217,12 @@ void moveCursor(editor::EditorKey key, Cursor& cursor, std::vector<std::string>
       return;
   }
 
-  auto currRow = std::invoke([&cursor, &document]() -> std::optional<std::string> {
-    if (cursor.y >= std::ssize(document)) {
+  auto currRow = std::invoke([&cursor, &document]() -> std::optional<std::string_view> {
+    if (std::cmp_greater_equal(cursor.y, document.lineCount())) {
       return std::nullopt;
     }
 
-    return std::make_optional(document[cursor.y]);
+    return std::make_optional(document.line(cursor.y));
   });
 
   auto rowlen = currRow ? currRow->length() : 0;
@@ -226,29 +241,97 @@ void moveCursor(editor::EditorKey key, Cursor& cursor, std::vector<std::string>
  * @return true If the operation was successful
  * @return false If the operation failed
  */
-bool open(std::filesystem::path const& path, std::vector<std::string>& document, std::vector<std::string>& rendered)
+auto open(std::filesystem::path const& path, Document& document, Document& rendered, TextFormat& format) -> bool
 {
   if (!std::filesystem::is_regular_file(path)) {
     return false;
   }
 
-  std::ifstream infile(path);
+  auto const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
 
-  if (!infile) {
+  if (fd == -1) {
     return false;
   }
 
-  std::string line;
+  // Files go through the same chunked reader as pipes, which is also a lot cheaper than std::getline. Compressed
+  // files are inflated on another thread while this one splits the result into lines
+  try {
+    std::optional<GzipReader> gzip;
+
+    if (GzipReader::isGzip(fd)) {
+      gzip.emplace(fd);
+    }
+
+    StreamLoader loader(gzip ? gzip->release() : fd);
+
+    while (!loader.finished()) {
+      loader.pump(document);
+    }
 
-  while (std::getline(infile, line)) {
-    document.push_back(line);
+    format = loader.format();
+  }
+  catch (std::system_error const&) {
+    return false;
   }
 
+  // Copies share their nodes, so this doesn't duplicate any lines until one of the two is modified
   rendered = document;
 
   return true;
 }
 
+auto save(std::filesystem::path const& path, Document const& document, TextFormat const& format) -> bool
+{
+  auto const fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+  if (fd == -1) {
+    return false;
+  }
+
+  // Lines are gathered into blocks, so that a document of short lines doesn't take a write for every one of them
+  constexpr std::size_t BlockSize = 64 * 1024;
+  auto const ending = format.lineEnding() == LineEnding::CrLf ? std::string_view("\r\n") : std::string_view("\n");
+
+  std::string block;
+  block.reserve(BlockSize);
+
+  auto const flush = [fd, &block] {
+    for (std::string_view rest = block; !rest.empty();) {
+      auto const written = ::write(fd, rest.data(), rest.size());
+
+      if (written == -1 and errno != EINTR) {
+        return false;
+      }
+
+      rest.remove_prefix(static_cast<std::size_t>(std::max<ssize_t>(written, 0)));
+    }
+
+    block.clear();
+    return true;
+  };
+
+  auto ok = true;
+
+  if (format.byteOrderMark) {
+    block.append(TextFormat::ByteOrderMark);
+  }
+
+  for (std::size_t i = 0; ok and i < document.lineCount(); i++) {
+    block.append(document.line(i));
+
+    if (i + 1 < document.lineCount() or format.finalNewline) {
+      block.append(ending);
+    }
+
+    if (block.size() >= BlockSize) {
+      ok = flush();
+    }
+  }
+
+  ok = ok and flush();
+  return ::close(fd) == 0 and ok;
+}
+
 /**
  * @brief Fit the cursor in the visible window
  *
@@ -281,6 +364,431 @@ void scroll(Cursor const& cursor, Offset& offset, Terminal::Window const& window
   }
 }
 
+/**
+ * @brief Build the soft-wrap index of a document
+ *
+ * @param renderedDoc The version of the document being edited that is actually rendered
+ * @param window The terminal window whose width the lines are folded to
+ * @param columns The column index of the document, which the width of each line is measured with
+ * @return The soft-wrap index of the document
+ */
+auto buildWrapIndex(Document const& renderedDoc, Terminal::Window const& window, ColumnIndex& columns) -> WrapIndex
+{
+  std::vector<std::size_t> widths;
+  widths.reserve(renderedDoc.lineCount());
+
+  // Tabs take up more than one column, so lines are folded by the columns they are shown in rather than their bytes
+  for (std::size_t i = 0; i < renderedDoc.lineCount(); i++) {
+    widths.push_back(columns.width(i, renderedDoc.line(i)));
+  }
+
+  return WrapIndex(widths, std::max(window.cols(), 1));
+}
+
+/**
+ * @brief Get the visual row the cursor is on when soft-wrap is on
+ *
+ * @param cursor The editor cursor, with x the column it is shown at rather than its byte on the line
+ * @param wrap The soft-wrap index of the document
+ * @return The visual row of the cursor
+ */
+auto wrappedRowOf(Cursor const& cursor, WrapIndex const& wrap) noexcept -> std::size_t
+{
+  auto const y = static_cast<std::size_t>(cursor.y);
+
+  // The cursor may sit on the line just past the end of the document
+  if (y >= wrap.lineCount()) {
+    return wrap.rowCount() + (y - wrap.lineCount());
+  }
+
+  auto const segment = std::min(static_cast<std::size_t>(cursor.x) / wrap.columns(), wrap.rowsOf(y) - 1);
+  return wrap.firstRowOf(y) + segment;
+}
+
+/**
+ * @brief Get the column of the window the cursor is on when soft-wrap is on
+ *
+ * @param cursor The editor cursor, with x the column it is shown at rather than its byte on the line
+ * @param wrap The soft-wrap index of the document
+ * @return The column of the window the cursor is on
+ */
+auto wrappedColumnOf(Cursor const& cursor, WrapIndex const& wrap) noexcept -> std::size_t
+{
+  auto const y = static_cast<std::size_t>(cursor.y);
+  auto const x = static_cast<std::size_t>(cursor.x);
+
+  if (y >= wrap.lineCount()) {
+    return x;
+  }
+
+  // A cursor just past the end of a line that fills its last row exactly stays on that row
+  auto const segment = std::min(x / wrap.columns(), wrap.rowsOf(y) - 1);
+  return std::min(x - segment * wrap.columns(), wrap.columns() - 1);
+}
+
+/**
+ * @brief Draw the lines of a document into one region of the screen
+ *
+ * @param region The region of the screen to draw into
+ * @param screenCols The width of the whole screen
+ * @param offset The offset from the region to the document
+ * @param buffer The screen buffer
+ * @param renderedDoc The version of the document being edited that is actually rendered
+ * @param columns The column index of the document
+ */
+void drawRegion(Region const& region, int screenCols, Offset const& offset, ScreenBuffer& buffer,
+                Document const& renderedDoc, ColumnIndex& columns)
+{
+  for (int currentRow = 0; currentRow < region.rows; currentRow++) {
+    detail::moveToRow(region, currentRow, buffer);
+
+    auto written = 0;
+
+    if (auto fileRow = static_cast<std::size_t>(currentRow + offset.row); fileRow >= renderedDoc.lineCount()) {
+      if (renderedDoc.empty() and currentRow == region.rows / 3) {
+        written = detail::printWelcomeMessage(region.cols, buffer);
+      }
+      else if (region.cols > 0) {
+        written = 1;
+        buffer.write("~");
+      }
+    }
+    else {
+      // Only the part of the line that is visible is looked at, however long the line is
+      auto const line = renderedDoc.line(fileRow);
+      auto const firstColumn = static_cast<std::size_t>(offset.col);
+      written = detail::printColumnsOfLine(line, columns.locate(fileRow, line, firstColumn), firstColumn, region.cols,
+                                           buffer);
+    }
+
+    detail::blankRestOfRow(region, screenCols, written, buffer);
+  }
+}
+
+/**
+ * @brief Draw the lines of a document left visible by its folded ranges into one region of the screen
+ *
+ * @param region The region of the screen to draw into
+ * @param screenCols The width of the whole screen
+ * @param offset The offset from the region to the document. offset.row counts visible lines only
+ * @param folds The fold index of the document
+ * @param buffer The screen buffer
+ * @param renderedDoc The version of the document being edited that is actually rendered
+ * @param columns The column index of the document
+ */
+void drawFoldedRegion(Region const& region, int screenCols, Offset const& offset, FoldIndex const& folds,
+                      ScreenBuffer& buffer, Document const& renderedDoc, ColumnIndex& columns)
+{
+  for (int currentRow = 0; currentRow < region.rows; currentRow++) {
+    detail::moveToRow(region, currentRow, buffer);
+
+    auto written = 0;
+
+    // Each row looks up the line it shows in the fold index, which takes logarithmic time however much is folded
+    if (auto fileRow = folds.lineAt(static_cast<std::size_t>(currentRow + offset.row));
+        fileRow >= renderedDoc.lineCount()) {
+      if (region.cols > 0) {
+        written = 1;
+        buffer.write("~");
+      }
+    }
+    else {
+      auto const line = renderedDoc.line(fileRow);
+      auto const firstColumn = static_cast<std::size_t>(offset.col);
+      written = detail::printColumnsOfLine(line, columns.locate(fileRow, line, firstColumn), firstColumn, region.cols,
+                                           buffer);
+
+      if (auto const hidden = folds.hiddenAfter(fileRow); hidden > 0) {
+        std::array<char, 32> marker {};
+        auto const plural = hidden == 1 ? "" : "s";
+        auto const length = static_cast<int>(
+          fmt::format_to_n(marker.data(), marker.size(), " [{} line{}]", hidden, plural).out - marker.data());
+
+        if (written + length <= region.cols) {
+          buffer.write(marker.data(), static_cast<std::size_t>(length));
+          written += length;
+        }
+      }
+    }
+
+    detail::blankRestOfRow(region, screenCols, written, buffer);
+  }
+}
+
+/**
+ * @brief Draw only some of the lines of a document into one region of the screen
+ *
+ * @param region The region of the screen to draw into
+ * @param screenCols The width of the whole screen
+ * @param offset The offset from the region to the document. offset.row counts the lines shown only
+ * @param lines The lines shown
+ * @param buffer The screen buffer
+ * @param renderedDoc The version of the document being edited that is actually rendered
+ * @param columns The column index of the document
+ */
+void drawFilteredRegion(Region const& region, int screenCols, Offset const& offset, std::span<std::size_t const> lines,
+                        ScreenBuffer& buffer, Document const& renderedDoc, ColumnIndex& columns)
+{
+  for (int currentRow = 0; currentRow < region.rows; currentRow++) {
+    detail::moveToRow(region, currentRow, buffer);
+
+    auto written = 0;
+    auto const row = static_cast<std::size_t>(currentRow + offset.row);
+
+    if (row >= lines.size() or lines[row] >= renderedDoc.lineCount()) {
+      if (region.cols > 0) {
+        written = 1;
+        buffer.write("~");
+      }
+    }
+    else {
+      auto const fileRow = lines[row];
+      auto const line = renderedDoc.line(fileRow);
+      auto const firstColumn = static_cast<std::size_t>(offset.col);
+      written = detail::printColumnsOfLine(line, columns.locate(fileRow, line, firstColumn), firstColumn, region.cols,
+                                           buffer);
+    }
+
+    detail::blankRestOfRow(region, screenCols, written, buffer);
+  }
+}
+
+/**
+ * @brief Draw one side of a diff into one region of the screen, lined up with the other side row for row
+ *
+ * @details Lines in runs that differ are coloured, red on the left and green on the right, and the rows across from
+ * lines only the other side has are filled with dashes
+ *
+ * @param region The region of the screen to draw into
+ * @param screenCols The width of the whole screen
+ * @param offset The offset from the region to the document. offset.row is a row of the diff
+ * @param diff The diff
+ * @param side The side of the diff the document is
+ * @param buffer The screen buffer
+ * @param renderedDoc The version of the document being edited that is actually rendered
+ * @param columns The column index of the document, through which only the visible part of each line is read
+ */
+void drawAlignedRegion(Region const& region, int screenCols, Offset const& offset, LineDiff const& diff, DiffSide side,
+                       ScreenBuffer& buffer, Document const& renderedDoc, ColumnIndex& columns)
+{
+  auto const colour = side == DiffSide::Left ? 31 : 32;
+
+  for (int currentRow = 0; currentRow < region.rows; currentRow++) {
+    detail::moveToRow(region, currentRow, buffer);
+
+    auto written = 0;
+    auto const row = static_cast<std::size_t>(currentRow + offset.row);
+    auto const fileRow = diff.lineAt(side, row);
+
+    if (diff.gap(side, row)) {
+      written = std::max(region.cols, 0);
+      buffer.fill(static_cast<std::size_t>(written), '-');
+    }
+    else if (fileRow >= renderedDoc.lineCount()) {
+      if (region.cols > 0) {
+        written = 1;
+        buffer.write("~");
+      }
+    }
+    else {
+      auto const changed = diff.changed(side, fileRow);
+
+      if (changed) {
+        buffer.selectGraphicRendition(colour);
+      }
+
+      auto const line = renderedDoc.line(fileRow);
+      auto const firstColumn = static_cast<std::size_t>(offset.col);
+      written = detail::printColumnsOfLine(line, columns.locate(fileRow, line, firstColumn), firstColumn, region.cols,
+                                           buffer);
+
+      if (changed) {
+        buffer.selectGraphicRendition();
+      }
+    }
+
+    detail::blankRestOfRow(region, screenCols, written, buffer);
+  }
+}
+
+/**
+ * @brief Draw the visual rows of a document into one region of the screen, with long lines folded to its width
+ *
+ * @param region The region of the screen to draw into
+ * @param screenCols The width of the whole screen
+ * @param offset The offset from the region to the document. offset.row is a visual row
+ * @param wrap The soft-wrap index of the document, folded to the width of the region
+ * @param buffer The screen buffer
+ * @param renderedDoc The version of the document being edited that is actually rendered
+ * @param columns The column index of the document
+ */
+void drawWrappedRegion(Region const& region, int screenCols, Offset const& offset, WrapIndex const& wrap,
+                       ScreenBuffer& buffer, Document const& renderedDoc, ColumnIndex& columns)
+{
+  auto const firstRow = static_cast<std::size_t>(offset.row);
+  auto pos = firstRow < wrap.rowCount() ? wrap.locate(firstRow) : WrapIndex::Position {wrap.lineCount(), 0};
+
+  for (int currentRow = 0; currentRow < region.rows; currentRow++) {
+    detail::moveToRow(region, currentRow, buffer);
+
+    auto written = 0;
+
+    if (pos.line >= wrap.lineCount()) {
+      if (renderedDoc.empty() and currentRow == region.rows / 3) {
+        written = detail::printWelcomeMessage(region.cols, buffer);
+      }
+      else if (region.cols > 0) {
+        written = 1;
+        buffer.write("~");
+      }
+    }
+    else {
+      // A tab that straddles the edge of a row is shown partly at the end of one row and partly at the start of the
+      // next
+      auto const line = renderedDoc.line(pos.line);
+      auto const firstColumn = pos.segment * wrap.columns();
+      written = detail::printColumnsOfLine(line, columns.locate(pos.line, line, firstColumn), firstColumn, region.cols,
+                                           buffer);
+
+      if (++pos.segment == wrap.rowsOf(pos.line)) {
+        pos = WrapIndex::Position {pos.line + 1, 0};
+      }
+    }
+
+    detail::blankRestOfRow(region, screenCols, written, buffer);
+  }
+}
+
+/**
+ * @brief Scroll the rows of a region of the screen up or down in place, leaving the rows scrolled in to be drawn
+ *
+ * @param region The region, which must be as wide as the screen
+ * @param rows The number of rows to scroll the contents up by, or down by if negative
+ * @param buffer The screen buffer
+ */
+void scrollRegion(Region const& region, std::int64_t rows, ScreenBuffer& buffer)
+{
+  assert(std::abs(rows) < region.rows and "Scrolling a region by its height or more leaves nothing to keep");
+
+  buffer.setScrollingMargins(region.top + 1, region.top + region.rows);
+
+  if (rows > 0) {
+    buffer.moveCursorTo(region.top + region.rows, 1);
+  }
+  else {
+    buffer.moveCursorTo(region.top + 1, 1);
+  }
+
+  for (auto i = std::abs(rows); i > 0; i--) {
+    buffer.write(rows > 0 ? EscapeSequences::Index : EscapeSequences::ReverseIndex);
+  }
+
+  buffer.write(EscapeSequences::ResetScrollingMargins);
+}
+
+/**
+ * @brief Draw the line separating two panes
+ *
+ * @param region The separator, which is either one row high or one column wide
+ * @param buffer The screen buffer
+ */
+void drawSeparator(Region const& region, ScreenBuffer& buffer)
+{
+  for (int row = 0; row < region.rows; row++) {
+    detail::moveToRow(region, row, buffer);
+
+    buffer.fill(static_cast<std::size_t>(std::max(region.cols, 0)), region.rows == 1 ? '-' : '|');
+  }
+}
+
+/**
+ * @brief Draw the status line, in reverse video across the whole of its row
+ *
+ * @param region The row the status line is drawn on
+ * @param left The text shown at the left end of the row
+ * @param right The text shown at the right end of the row, if it fits
+ * @param buffer The screen buffer
+ */
+void drawStatusLine(Region const& region, std::string_view left, std::string_view right, ScreenBuffer& buffer)
+{
+  auto const cols = static_cast<std::size_t>(std::max(region.cols, 0));
+  left = left.substr(0, cols);
+
+  if (left.size() + right.size() > cols) {
+    right = {};
+  }
+
+  detail::moveToRow(region, 0, buffer);
+  buffer.selectGraphicRendition(7).write(left).fill(cols - left.size() - right.size()).write(right);
+  buffer.selectGraphicRendition();
+}
+
+/**
+ * @brief Fit the cursor in the visible window when soft-wrap is on
+ *
+ * @param[in] cursor The cursor, with x the column it is shown at rather than its byte on the line
+ * @param[in] offset The visual row the user is currently scrolled to
+ * @param[in] window The terminal window
+ * @param[in] wrap The soft-wrap index of the document
+ */
+void scrollWrapped(Cursor const& cursor, Offset& offset, Terminal::Window const& window, WrapIndex const& wrap) noexcept
+{
+  auto const row = static_cast<std::int64_t>(wrappedRowOf(cursor, wrap));
+
+  if (row < offset.row) {
+    offset.row = row;
+  }
+
+  if (row >= offset.row + window.rows()) {
+    offset.row = row - window.rows() + 1;
+  }
+
+  // Folded lines never need to be scrolled horizontally
+  offset.col = 0;
+}
+
+/**
+ * @brief Move the cursor a screenful of visual rows up or down when soft-wrap is on
+ *
+ * @param key Either EditorKey::PageUp or EditorKey::PageDown
+ * @param cursor The editor cursor
+ * @param window The terminal window
+ * @param wrap The soft-wrap index of the document
+ * @param document The document which is currently open
+ * @param columns The column index of the document
+ */
+void pageWrapped(editor::EditorKey key, Cursor& cursor, Terminal::Window const& window, WrapIndex const& wrap,
+                 Document const& document, ColumnIndex& columns)
+{
+  assert(key == EditorKey::PageUp or key == EditorKey::PageDown);
+
+  auto const y = static_cast<std::size_t>(cursor.y);
+  auto const x = y < document.lineCount() ? columns.columnOf(y, document.line(y), static_cast<std::size_t>(cursor.x))
+                                          : static_cast<std::size_t>(cursor.x);
+  auto const shown = Cursor {.x = static_cast<std::int64_t>(x), .y = cursor.y};
+
+  auto const rows = static_cast<std::size_t>(window.rows());
+  auto const current = wrappedRowOf(shown, wrap);
+  auto const column = wrappedColumnOf(shown, wrap);
+
+  auto const target = key == EditorKey::PageUp ? current - std::min(current, rows) : current + rows;
+
+  // Paging down past the last row leaves the cursor on the line after the end of the document, just like repeatedly
+  // pressing ArrowDown would
+  if (target >= wrap.rowCount()) {
+    cursor.y = static_cast<std::int64_t>(wrap.lineCount());
+    cursor.x = 0;
+    return;
+  }
+
+  auto const [line, segment] = wrap.locate(target);
+
+  // The cursor lands on the byte shown in the same column, or on the tab that covers it
+  auto const text = document.line(line);
+  cursor.y = static_cast<std::int64_t>(line);
+  cursor.x = static_cast<std::int64_t>(columns.locate(line, text, segment * wrap.columns() + column).byte);
+}
+
 void updateRow(std::string_view row, std::string& render)
 {
   using editor::KiloTabStop;
@@ -315,14 +823,10 @@ namespace Kilo::editor::detail {
  * @param windowWidth The width of the window in which the message is to be displayed
  * @param buffer The buffer to which the message is written before being displayed
  */
-void printWelcomeMessage(int windowWidth, ScreenBuffer& buffer)
+auto printWelcomeMessage(int windowWidth, ScreenBuffer& buffer) -> int
 {
-  auto msg = fmt::format("Kilo editor -- version {}", editor::KiloVersion);
-
-  // If the message is longer than the window's width, resize it to fit
-  if (std::cmp_greater(msg.length(), windowWidth)) {
-    msg.resize(windowWidth);
-  }
+  // If the message is longer than the window's width, cut it to fit
+  auto const msg = KiloWelcomeMessage.substr(0, static_cast<std::size_t>(std::max(windowWidth, 0)));
 
   /*
    * Center the string
@@ -332,19 +836,16 @@ void printWelcomeMessage(int windowWidth, ScreenBuffer& buffer)
    * characters, except for the first character, which should be a tilde
    */
 
-  auto padding = (windowWidth - std::ssize(msg)) / 2;
+  auto const padding = (windowWidth - std::ssize(msg)) / 2;
+  auto const written = static_cast<int>(std::max(padding, std::ptrdiff_t {0}) + std::ssize(msg));
 
   if (padding > 0) {
-    buffer.write("~");
-    padding--;
-  }
-
-  while (padding > 0) {
-    buffer.write(" ");
-    padding--;
+    buffer.write("~").fill(static_cast<std::size_t>(padding - 1));
   }
 
   buffer.write(msg);
+
+  return written;
 }
 
 /**
@@ -356,7 +857,8 @@ void printWelcomeMessage(int windowWidth, ScreenBuffer& buffer)
  * @param columnOffset The column offset between the terminal window width and the document width
  * @pre The column offset must be non-negative
  */
-void printLineOfDocument(std::string const& line, ScreenBuffer& buffer, int const windowWidth, int const columnOffset)
+auto printLineOfDocument(std::string_view line, ScreenBuffer& buffer, int const windowWidth, int const columnOffset)
+  -> int
 {
   assert(columnOffset >= 0 and "Column offset must be non-negative");
 
@@ -371,6 +873,84 @@ void printLineOfDocument(std::string const& line, ScreenBuffer& buffer, int cons
   }
 
   buffer.write(&line[columnOffset], lineLen);
+
+  return static_cast<int>(lineLen);
+}
+
+/**
+ * @brief Print the columns of a line of text from the open document that fit in a row, with tabs expanded
+ *
+ * @param line The line to be printed
+ * @param from The byte that covers the first column to be printed, and the column that byte starts at
+ * @param firstColumn The first column to be printed
+ * @param width The number of columns to print at most
+ * @param buffer The screen buffer
+ * @return The number of columns written
+ */
+auto printColumnsOfLine(std::string_view line, ColumnIndex::Position from, std::size_t firstColumn, int width,
+                        ScreenBuffer& buffer) -> int
+{
+  auto const columns = static_cast<std::size_t>(std::max(width, 0));
+  auto [byte, column] = from;
+  std::size_t written {};
+
+  while (byte < line.size() and written < columns) {
+    if (line[byte] == '\t') {
+      // A tab that starts left of the first column is only partly visible
+      auto const end = column + KiloTabStop - column % KiloTabStop;
+      auto const shown = std::min(end - std::max(column, firstColumn), columns - written);
+      buffer.fill(shown);
+      written += shown;
+      column = end;
+      byte++;
+      continue;
+    }
+
+    // Never search for the next tab further than the row reaches
+    auto const visible = line.substr(byte, columns - written);
+    auto const run = std::min(visible.find('\t'), visible.size());
+    buffer.write(visible.data(), run);
+    written += run;
+    column += run;
+    byte += run;
+  }
+
+  return static_cast<int>(written);
+}
+
+/**
+ * @brief Move the cursor to the start of a row of a region
+ *
+ * @param region The region
+ * @param row The row within the region
+ * @param buffer The screen buffer
+ */
+void moveToRow(Region const& region, int row, ScreenBuffer& buffer)
+{
+  buffer.moveCursorTo(region.top + row + 1, region.left + 1);
+}
+
+/**
+ * @brief Blank the rest of a row of a region
+ *
+ * @param region The region
+ * @param screenCols The width of the whole screen
+ * @param written The number of columns of the row already written
+ * @param buffer The screen buffer
+ */
+void blankRestOfRow(Region const& region, int screenCols, int written, ScreenBuffer& buffer)
+{
+  // A row written to its last column leaves the cursor on that column, which erasing the line would blank
+  if (written >= region.cols) {
+    return;
+  }
+
+  if (region.left + region.cols >= screenCols) {
+    buffer.eraseInLine();
+    return;
+  }
+
+  buffer.fill(static_cast<std::size_t>(std::max(region.cols - written, 0)));
 }
 
 }   // namespace Kilo::editor::detail
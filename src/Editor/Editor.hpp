@@ -24,15 +24,23 @@
 #ifndef EDITOR_HPP
 #define EDITOR_HPP
 
+#include "ColumnIndex/ColumnIndex.hpp"
 #include "Cursor/Cursor.hpp"
+#include "Document/Document.hpp"
+#include "FoldIndex/FoldIndex.hpp"
+#include "LineDiff/LineDiff.hpp"
 #include "Offset/Offset.hpp"
+#include "Region/Region.hpp"
 #include "Terminal/Window/Window.hpp"
+#include "TextScanner/TextScanner.hpp"
 #include "Utilities/Constants.hpp"
-#include <string_view>
+#include "WrapIndex/WrapIndex.hpp"
 
 #include <cassert>
+#include <cstddef>
 #include <filesystem>
-#include <vector>
+#include <span>
+#include <string_view>
 
 namespace Kilo::editor {
 
@@ -49,7 +57,7 @@ class ScreenBuffer;
  * @param[in] window The terminal window
  */
 void processKeypress(int keyPressed, Cursor& cursor, Terminal::Window const& window,
-                     std::vector<std::string> const& document) noexcept;
+                     Document const& document) noexcept;
 
 /**
  * @brief Perform a screen refresh
@@ -61,7 +69,7 @@ void processKeypress(int keyPressed, Cursor& cursor, Terminal::Window const& win
  * @param offset The offset from the window to the open document
  */
 void refreshScreen(ScreenBuffer& buffer, Cursor const& cursor, Offset const& offset, Terminal::Window const& window,
-                   std::vector<std::string> const& document, std::vector<std::string> const& renderedDoc);
+                   Document const& document, Document const& renderedDoc);
 
 /**
  * @brief Draw each row of the buffer of text being edited, plus a tilde at the beginning
@@ -72,8 +80,8 @@ void refreshScreen(ScreenBuffer& buffer, Cursor const& cursor, Offset const& off
  * @param buffer The screen buffer
  * @param renderedDoc The version of the document being edited that is actually rendered
  */
-void drawRows(Terminal::Window const& window, Offset const& offset, std::vector<std::string> const& doc,
-              ScreenBuffer& buffer, std::vector<std::string> const& renderedDoc);
+void drawRows(Terminal::Window const& window, Offset const& offset, Document const& doc,
+              ScreenBuffer& buffer, Document const& renderedDoc);
 
 /**
  * @brief Move the cursor in the direction of the key pressed
@@ -82,20 +90,35 @@ void drawRows(Terminal::Window const& window, Offset const& offset, std::vector<
  * @param cursor The editor cursor
  * @param row The document which is currently open
  */
-void moveCursor(editor::EditorKey key, Cursor& cursor, std::vector<std::string> const& row);
+void moveCursor(editor::EditorKey key, Cursor& cursor, Document const& row);
 
 /**
  * @brief Open a file and write its contents to memory
  *
+ * @details Lines are loaded without their line endings, and the first one without a byte order mark, which the format
+ * of the file records so that they can be restored when it is saved
  * @param[in] path The path to the file
  * @param[in] document The buffer containing the file in memory
  * @param[in] rendered The document that is actually rendered to the window
+ * @param[out] format What kind of text the file holds
  * @return true If the operation was successful
  * @return false If the operation failed
  */
-auto open(std::filesystem::path const& path, std::vector<std::string>& document, std::vector<std::string>& rendered)
+auto open(std::filesystem::path const& path, Document& document, Document& rendered, TextFormat& format)
   -> bool;
 
+/**
+ * @brief Write a document to a file, in the format it was read in
+ *
+ * @details Every line is terminated by the line ending most lines of the file had, except the last line if the file
+ * didn't end with a newline. A byte order mark is written first if the file had one
+ * @param[in] path The path to the file, which is replaced
+ * @param[in] document The document
+ * @param[in] format The format the file was read in
+ * @return false If the file could not be written
+ */
+auto save(std::filesystem::path const& path, Document const& document, TextFormat const& format) -> bool;
+
 /**
  * @brief Fit the cursor in the visible window
  *
@@ -105,6 +128,162 @@ auto open(std::filesystem::path const& path, std::vector<std::string>& document,
  */
 void scroll(Cursor const& cursor, Offset& offset, Terminal::Window const& window) noexcept;
 
+/**
+ * @brief Build the soft-wrap index of a document
+ *
+ * @param renderedDoc The version of the document being edited that is actually rendered
+ * @param window The terminal window whose width the lines are folded to
+ * @param columns The column index of the document, which the width of each line is measured with
+ * @return The soft-wrap index of the document
+ */
+auto buildWrapIndex(Document const& renderedDoc, Terminal::Window const& window, ColumnIndex& columns) -> WrapIndex;
+
+/**
+ * @brief Get the visual row the cursor is on when soft-wrap is on
+ *
+ * @param cursor The editor cursor, with x the column it is shown at rather than its byte on the line
+ * @param wrap The soft-wrap index of the document
+ * @return The visual row of the cursor
+ */
+auto wrappedRowOf(Cursor const& cursor, WrapIndex const& wrap) noexcept -> std::size_t;
+
+/**
+ * @brief Get the column of the window the cursor is on when soft-wrap is on
+ *
+ * @param cursor The editor cursor, with x the column it is shown at rather than its byte on the line
+ * @param wrap The soft-wrap index of the document
+ * @return The column of the window the cursor is on
+ */
+auto wrappedColumnOf(Cursor const& cursor, WrapIndex const& wrap) noexcept -> std::size_t;
+
+/**
+ * @brief Fit the cursor in the visible window when soft-wrap is on
+ *
+ * @param[in] cursor The cursor, with x the column it is shown at rather than its byte on the line
+ * @param[in] offset The visual row the user is currently scrolled to
+ * @param[in] window The terminal window
+ * @param[in] wrap The soft-wrap index of the document
+ */
+void scrollWrapped(Cursor const& cursor, Offset& offset, Terminal::Window const& window,
+                   WrapIndex const& wrap) noexcept;
+
+/**
+ * @brief Move the cursor a screenful of visual rows up or down when soft-wrap is on
+ *
+ * @param key Either EditorKey::PageUp or EditorKey::PageDown
+ * @param cursor The editor cursor
+ * @param window The terminal window
+ * @param wrap The soft-wrap index of the document
+ * @param document The document which is currently open
+ * @param columns The column index of the document
+ */
+void pageWrapped(editor::EditorKey key, Cursor& cursor, Terminal::Window const& window, WrapIndex const& wrap,
+                 Document const& document, ColumnIndex& columns);
+
+/**
+ * @brief Draw the lines of a document into one region of the screen, e.g. a pane of a split layout
+ *
+ * @details Each row starts by moving the cursor into the region and is blanked up to the region's right edge only, so
+ * that whatever is shown next to the region is left alone
+ * @param region The region of the screen to draw into
+ * @param screenCols The width of the whole screen
+ * @param offset The offset from the region to the document
+ * @param buffer The screen buffer
+ * @param renderedDoc The version of the document being edited that is actually rendered
+ * @param columns The column index of the document, through which only the visible part of each line is read
+ */
+void drawRegion(Region const& region, int screenCols, Offset const& offset, ScreenBuffer& buffer,
+                Document const& renderedDoc, ColumnIndex& columns);
+
+/**
+ * @brief Draw the lines of a document left visible by its folded ranges into one region of the screen
+ *
+ * @details The first line of a folded range is followed by the number of lines it hides, if there is room for it
+ * @param region The region of the screen to draw into
+ * @param screenCols The width of the whole screen
+ * @param offset The offset from the region to the document. offset.row counts visible lines only
+ * @param folds The fold index of the document
+ * @param buffer The screen buffer
+ * @param renderedDoc The version of the document being edited that is actually rendered
+ * @param columns The column index of the document, through which only the visible part of each line is read
+ */
+void drawFoldedRegion(Region const& region, int screenCols, Offset const& offset, FoldIndex const& folds,
+                      ScreenBuffer& buffer, Document const& renderedDoc, ColumnIndex& columns);
+
+/**
+ * @brief Draw only some of the lines of a document into one region of the screen, e.g. those a filter found
+ *
+ * @param region The region of the screen to draw into
+ * @param screenCols The width of the whole screen
+ * @param offset The offset from the region to the document. offset.row counts the lines shown only
+ * @param lines The lines shown, in ascending order
+ * @param buffer The screen buffer
+ * @param renderedDoc The version of the document being edited that is actually rendered
+ * @param columns The column index of the document, through which only the visible part of each line is read
+ */
+void drawFilteredRegion(Region const& region, int screenCols, Offset const& offset, std::span<std::size_t const> lines,
+                        ScreenBuffer& buffer, Document const& renderedDoc, ColumnIndex& columns);
+
+/**
+ * @brief Draw one side of a diff into one region of the screen, lined up with the other side row for row
+ *
+ * @param region The region of the screen to draw into
+ * @param screenCols The width of the whole screen
+ * @param offset The offset from the region to the document. offset.row is a row of the diff
+ * @param diff The diff
+ * @param side The side of the diff the document is
+ * @param buffer The screen buffer
+ * @param renderedDoc The version of the document being edited that is actually rendered
+ * @param columns The column index of the document, through which only the visible part of each line is read
+ */
+void drawAlignedRegion(Region const& region, int screenCols, Offset const& offset, LineDiff const& diff, DiffSide side,
+                       ScreenBuffer& buffer, Document const& renderedDoc, ColumnIndex& columns);
+
+/**
+ * @brief Draw the visual rows of a document into one region of the screen, with long lines folded to its width
+ *
+ * @param region The region of the screen to draw into
+ * @param screenCols The width of the whole screen
+ * @param offset The offset from the region to the document. offset.row is a visual row
+ * @param wrap The soft-wrap index of the document, folded to the width of the region
+ * @param buffer The screen buffer
+ * @param renderedDoc The version of the document being edited that is actually rendered
+ * @param columns The column index of the document
+ */
+void drawWrappedRegion(Region const& region, int screenCols, Offset const& offset, WrapIndex const& wrap,
+                       ScreenBuffer& buffer, Document const& renderedDoc, ColumnIndex& columns);
+
+/**
+ * @brief Scroll the rows of a region of the screen up or down in place, leaving the rows scrolled in to be drawn
+ *
+ * @details The region is made the terminal's scrolling band and the cursor is indexed past its last row, or reverse
+ * indexed past its first, once per row. Scrolling bands always span whole rows of the screen
+ * @param region The region, which must be as wide as the screen
+ * @param rows The number of rows to scroll the contents up by, as when the view moves down the document, or down by
+ * if negative
+ * @param buffer The screen buffer
+ * @pre The number of rows must be smaller than the height of the region
+ */
+void scrollRegion(Region const& region, std::int64_t rows, ScreenBuffer& buffer);
+
+/**
+ * @brief Draw the line separating two panes
+ *
+ * @param region The separator, which is either one row high or one column wide
+ * @param buffer The screen buffer
+ */
+void drawSeparator(Region const& region, ScreenBuffer& buffer);
+
+/**
+ * @brief Draw the status line, in reverse video across the whole of its row
+ *
+ * @param region The row the status line is drawn on
+ * @param left The text shown at the left end of the row, cut off if it doesn't fit
+ * @param right The text shown at the right end of the row, if it fits next to the text on the left
+ * @param buffer The screen buffer
+ */
+void drawStatusLine(Region const& region, std::string_view left, std::string_view right, ScreenBuffer& buffer);
+
 /**
  * @brief Copies the contents of the source string into the destination string
  * @param[in] row The source string
@@ -120,8 +299,9 @@ namespace Kilo::editor::detail {
  *
  * @param windowWidth The width of the window in which the message is to be displayed
  * @param buffer The buffer to which the message is written before being displayed
+ * @return The number of columns written
  */
-void printWelcomeMessage(int windowWidth, ScreenBuffer& buffer);
+auto printWelcomeMessage(int windowWidth, ScreenBuffer& buffer) -> int;
 
 /**
  * @brief Print a line of text from the open document to the screen
@@ -130,9 +310,43 @@ void printWelcomeMessage(int windowWidth, ScreenBuffer& buffer);
  * @param buffer The screen buffer
  * @param windowWidth The width of the terminal window
  * @param columnOffset The column offset between the terminal window width and the document width
+ * @return The number of columns written
  * @pre The column offset must be non-negative
  */
-void printLineOfDocument(std::string const& line, ScreenBuffer& buffer, int windowWidth, int columnOffset);
+auto printLineOfDocument(std::string_view line, ScreenBuffer& buffer, int windowWidth, int columnOffset) -> int;
+
+/**
+ * @brief Print the columns of a line of text from the open document that fit in a row, with tabs expanded
+ *
+ * @param line The line to be printed
+ * @param from The byte that covers the first column to be printed, and the column that byte starts at
+ * @param firstColumn The first column to be printed
+ * @param width The number of columns to print at most
+ * @param buffer The screen buffer
+ * @return The number of columns written
+ */
+auto printColumnsOfLine(std::string_view line, ColumnIndex::Position from, std::size_t firstColumn, int width,
+                        ScreenBuffer& buffer) -> int;
+
+/**
+ * @brief Move the cursor to the start of a row of a region
+ *
+ * @param region The region
+ * @param row The row within the region
+ * @param buffer The screen buffer
+ */
+void moveToRow(Region const& region, int row, ScreenBuffer& buffer);
+
+/**
+ * @brief Blank the rest of a row of a region
+ *
+ * @param region The region
+ * @param screenCols The width of the whole screen. A region that reaches the right edge is blanked with a single
+ * escape sequence, anything else with spaces
+ * @param written The number of columns of the row already written
+ * @param buffer The screen buffer
+ */
+void blankRestOfRow(Region const& region, int screenCols, int written, ScreenBuffer& buffer);
 
 }   // namespace Kilo::editor::detail
 
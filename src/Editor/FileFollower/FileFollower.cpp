@@ -0,0 +1,188 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "FileFollower.hpp"
+
+#include <system_error>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <string_view>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace Kilo::editor {
+
+namespace {
+
+constexpr std::uint32_t FileEvents = IN_MODIFY | IN_MOVE_SELF | IN_DELETE_SELF;
+constexpr std::uint32_t DirectoryEvents = IN_CREATE | IN_MOVED_TO;
+
+/// Open a file for reading without blocking
+auto openForReading(std::filesystem::path const& path) -> int
+{
+  return ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+}
+
+}   // namespace
+
+FileFollower::FileFollower(std::filesystem::path path, Document& document, TextFormat const& format)
+  : m_path(std::move(path))
+  , m_inotify(::inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+{
+  if (m_inotify == -1) {
+    throw std::system_error(errno, std::system_category(), "Could not start watching the file");
+  }
+
+  auto const fd = openForReading(m_path);
+
+  if (fd == -1) {
+    auto const error = errno;
+    ::close(m_inotify);
+    throw std::system_error(error, std::system_category(), "Could not open the file");
+  }
+
+  m_loader.emplace(fd, StreamLoader::Mode::Follow);
+  m_fileWatch = ::inotify_add_watch(m_inotify, m_path.c_str(), FileEvents);
+
+  if (m_fileWatch != -1) {
+    m_directoryWatch = ::inotify_add_watch(m_inotify, std::filesystem::absolute(m_path).parent_path().c_str(),
+                                           DirectoryEvents);
+  }
+
+  // The loader closes the file on the way out, but nothing else closes the inotify instance
+  if (m_directoryWatch == -1) {
+    auto const error = errno;
+    ::close(m_inotify);
+    throw std::system_error(error, std::system_category(), "Could not start watching the file");
+  }
+
+  // Every line of the document was followed by a newline, unless the last one was cut off where the file ended when
+  // it was loaded. Such a line is read again once it is complete. The document doesn't count the byte order mark or
+  // the "\r" of "\r\n", all of which come before any line that was cut off
+  auto offset = document.byteCount() + format.droppedBytes();
+
+  if (!document.empty()) {
+    char last {};
+
+    if (::pread(fd, &last, 1, static_cast<off_t>(offset - 1)) != 1 or last != '\n') {
+      auto const line = document.lineCount() - 1;
+      offset = document.lineOffset(line) + format.droppedBytes();
+      document.eraseLine(line);
+    }
+  }
+
+  ::lseek(fd, static_cast<off_t>(offset), SEEK_SET);
+}
+
+FileFollower::~FileFollower()
+{
+  ::close(m_inotify);
+}
+
+auto FileFollower::caughtUp() const noexcept -> bool
+{
+  return m_loader->caughtUp();
+}
+
+auto FileFollower::update(Document& document, std::size_t budget) -> Update
+{
+  readEvents();
+
+  auto result = Update::Appended;
+
+  // A file that is now shorter than what we have read of it was truncated. Start again from the beginning
+  struct stat status {};
+  auto const fd = m_loader->fileDescriptor();
+  auto const truncated = ::fstat(fd, &status) == 0 and status.st_size < ::lseek(fd, 0, SEEK_CUR);
+
+  if ((m_replaced or truncated) and reopen()) {
+    document = Document();
+    result = Update::Reloaded;
+  }
+
+  m_loader->pump(document, budget);
+
+  return result;
+}
+
+void FileFollower::readEvents()
+{
+  alignas(inotify_event) std::array<char, 4096> events {};
+  auto const name = m_path.filename().native();
+
+  for (auto size = ::read(m_inotify, events.data(), events.size()); size > 0;
+       size = ::read(m_inotify, events.data(), events.size())) {
+    for (auto const* pos = events.data(); pos < events.data() + size;) {
+      inotify_event event {};
+      std::memcpy(&event, pos, sizeof(event));
+
+      if (event.wd == m_fileWatch and (event.mask & (IN_MOVE_SELF | IN_DELETE_SELF)) != 0) {
+        m_replaced = true;
+      }
+
+      if (event.wd == m_directoryWatch and event.len > 0 and std::string_view(pos + sizeof(event)).compare(name) == 0) {
+        m_replaced = true;
+      }
+
+      pos += sizeof(event) + event.len;
+    }
+  }
+}
+
+auto FileFollower::reopen() -> bool
+{
+  // If the file was deleted and hasn't been created again yet, keep what we have and wait for it to show up
+  auto const fd = openForReading(m_path);
+
+  if (fd == -1) {
+    return false;
+  }
+
+  // The old watch goes first, as a file truncated in place is the same file and would get the same watch back
+  if (m_fileWatch != -1) {
+    ::inotify_rm_watch(m_inotify, m_fileWatch);
+    m_fileWatch = -1;
+  }
+
+  auto const watch = ::inotify_add_watch(m_inotify, m_path.c_str(), FileEvents);
+
+  if (watch == -1) {
+    auto const error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::system_category(), "Could not watch the file again");
+  }
+
+  m_loader.emplace(fd, StreamLoader::Mode::Follow);
+  m_fileWatch = watch;
+  m_replaced = false;
+
+  return true;
+}
+
+}   // namespace Kilo::editor
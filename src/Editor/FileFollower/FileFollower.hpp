@@ -0,0 +1,110 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FILE_FOLLOWER_HPP
+#define FILE_FOLLOWER_HPP
+
+#include "Editor/Document/Document.hpp"
+#include "Editor/StreamLoader/StreamLoader.hpp"
+#include "Editor/TextScanner/TextScanner.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+
+namespace Kilo::editor {
+
+// Keeps a document in step with a file that is still being written to, like
+// tail -f. Changes are reported by inotify, so nothing is done while the file
+// is quiet. Only the bytes appended since the last update are read, and only
+// the lines they complete are added to the document.
+//
+// If the file shrinks (it was truncated in place, as logrotate's copytruncate
+// does) or the path starts referring to a different file (it was renamed or
+// deleted and created again), the document is loaded again from the start.
+
+class FileFollower
+{
+public:
+  /// How the document was changed by an update
+  enum class Update
+  {
+    /// Lines were added to the end of the document, if any
+    Appended,
+    /// The file was truncated or replaced, so the document was loaded again from scratch
+    Reloaded
+  };
+
+  /// Start following a file
+  /// \param[in] path The path to the file
+  /// \param[in] document The lines of the file that have been loaded so far
+  /// \param[in] format The format of the file as loaded, which tells how many of its bytes the document leaves out
+  /// \throws std::system_error if the file or the inotify instance could not be opened, or the file watched
+  /// \details Reading picks up after the last line of the document. A last line that was loaded without its newline
+  /// is taken out of the document again and read once it is complete
+  explicit FileFollower(std::filesystem::path path, Document& document, TextFormat const& format = {});
+
+  /// Destructor. Stops watching the file
+  ~FileFollower();
+
+  FileFollower(FileFollower const&) = delete;
+  auto operator=(FileFollower const&) -> FileFollower& = delete;
+  FileFollower(FileFollower&&) = delete;
+  auto operator=(FileFollower&&) -> FileFollower& = delete;
+
+  /// Get the inotify instance, which becomes readable when the file changes
+  [[nodiscard]] constexpr auto fileDescriptor() const noexcept -> int
+  {
+    return m_inotify;
+  }
+
+  /// Check whether everything written to the file so far has been read
+  [[nodiscard]] auto caughtUp() const noexcept -> bool;
+
+  /// Bring the document up to date with the file
+  /// \param[in] document The document being followed
+  /// \param[in] budget Stop after reading this many bytes, so that the caller gets a chance to repaint
+  /// \returns Whether lines were appended or the whole document was replaced
+  /// \throws std::system_error if reading from the file fails, or a file that replaced it could not be watched
+  auto update(Document& document, std::size_t budget) -> Update;
+
+private:
+  /// Read the notifications that have arrived and note whether the path was moved, deleted or created
+  void readEvents();
+
+  /// Open the file at the path again and start reading it from the beginning
+  /// \returns false if there is no file at the path right now
+  /// \throws std::system_error if the file could not be watched
+  auto reopen() -> bool;
+
+  std::filesystem::path m_path;
+  int m_inotify;
+  int m_fileWatch {-1};
+  int m_directoryWatch {-1};
+  bool m_replaced {};
+  std::optional<StreamLoader> m_loader;
+};
+
+}   // namespace Kilo::editor
+
+#endif
@@ -0,0 +1,637 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "FoldIndex.hpp"
+
+#include "Utilities/Constants.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+namespace Kilo::editor {
+
+namespace {
+
+// The ranges around an edit that are tried before giving up and working out everything it overlaps
+constexpr auto MaxAttempts = 4;
+
+// Edits that changed more lines than this are worked out as a single run of lines
+constexpr std::size_t MaxSeparateLines = 64;
+
+constexpr auto isOpener(char c) noexcept -> bool
+{
+  return c == '(' or c == '[' or c == '{';
+}
+
+constexpr auto isCloser(char c) noexcept -> bool
+{
+  return c == ')' or c == ']' or c == '}';
+}
+
+/// Find the quote that ends a string or character literal, skipping quotes escaped with a backslash
+/// \return std::string_view::npos if the literal doesn't end on the line
+auto closingQuote(std::string_view text, std::size_t opening) noexcept -> std::size_t
+{
+  for (auto byte = opening + 1; byte < text.size(); byte++) {
+    if (text[byte] == '\\') {
+      byte++;
+    }
+    else if (text[byte] == text[opening]) {
+      return byte;
+    }
+  }
+
+  return std::string_view::npos;
+}
+
+/// Search a max tree for the first or last leaf before an index whose value is larger than a bound
+auto search(std::span<std::size_t const> tree, std::size_t node, std::size_t low, std::size_t high,
+            std::size_t before, std::size_t bound, bool last) noexcept -> std::size_t
+{
+  constexpr auto none = std::numeric_limits<std::size_t>::max();
+
+  if (low >= before or tree[node] <= bound) {
+    return none;
+  }
+
+  if (high - low == 1) {
+    return low;
+  }
+
+  auto const middle = low + (high - low) / 2;
+  auto const left = [&] { return search(tree, 2 * node, low, middle, before, bound, last); };
+  auto const right = [&] { return search(tree, 2 * node + 1, middle, high, before, bound, last); };
+
+  auto const found = last ? right() : left();
+  return found != none ? found : last ? left() : right();
+}
+
+}   // namespace
+
+void FoldIndex::build(Document const& document)
+{
+  m_built = true;
+  replace(document, 0, m_shapes.size(), document.lineCount());
+}
+
+auto FoldIndex::replaced(Document const& document, std::size_t first) -> bool
+{
+  if (!m_built) {
+    return false;
+  }
+
+  auto const before = m_shapes.size();
+  auto const after = document.lineCount();
+  first = std::min({first, before, after});
+  return replace(document, first, before - first, after - first);
+}
+
+auto FoldIndex::changed(Document const& document, Changed const& changed) -> bool
+{
+  if (!m_built) {
+    return false;
+  }
+
+  if (changed.lineCount) {
+    auto const [first, removed, added] = replacedLines(changed, m_shapes.size(), document.lineCount());
+    return replace(document, first, removed, added);
+  }
+
+  // Typing that doesn't change the indentation of a line or its brackets leaves the ranges as they are
+  m_reshaped.clear();
+
+  for (auto const line : changed.lines) {
+    if (auto const shape = shapeOf(document.line(line)); shape != m_shapes[line]) {
+      m_reshaped.push_back(Reshaped {.line = line, .shape = shape});
+    }
+  }
+
+  if (m_reshaped.size() > MaxSeparateLines) {
+    auto const first = m_reshaped.front().line;
+    auto const count = m_reshaped.back().line - first + 1;
+    m_old.assign(m_shapes.begin() + static_cast<std::ptrdiff_t>(first),
+                 m_shapes.begin() + static_cast<std::ptrdiff_t>(first + count));
+
+    for (auto const& [line, shape] : m_reshaped) {
+      m_shapes[line] = shape;
+    }
+
+    rescan(first, count, count);
+  }
+  else {
+    // Each line is changed only when its turn comes, so that the lines after it are still as the ranges have them
+    for (auto const& [line, shape] : m_reshaped) {
+      m_old.assign(1, std::exchange(m_shapes[line], shape));
+      rescan(line, 1, 1);
+    }
+  }
+
+  auto const refolded = std::exchange(m_refolded, false);
+
+  if (refolded) {
+    remap();
+  }
+
+  return refolded;
+}
+
+auto FoldIndex::toggle(std::size_t line) -> std::optional<std::size_t>
+{
+  auto index = firstFrom(line);
+
+  if (index == m_ranges.size() or m_ranges[index].start != line) {
+    index = lastEndingFrom(index, line);
+
+    if (index == None) {
+      return std::nullopt;
+    }
+  }
+
+  auto& range = m_ranges[index];
+  range.collapsed = !range.collapsed;
+  m_collapsed = range.collapsed ? m_collapsed + 1 : m_collapsed - 1;
+  remap();
+
+  return range.start;
+}
+
+void FoldIndex::foldAll(bool collapse)
+{
+  for (auto& range : m_ranges) {
+    range.collapsed = collapse;
+  }
+
+  m_collapsed = collapse ? m_ranges.size() : 0;
+  remap();
+}
+
+auto FoldIndex::reveal(std::size_t line) -> bool
+{
+  auto revealed = false;
+
+  for (auto index = lastEndingFrom(firstFrom(line), line); index != None; index = lastEndingFrom(index, line)) {
+    if (auto& range = m_ranges[index]; range.collapsed) {
+      range.collapsed = false;
+      m_collapsed--;
+      revealed = true;
+    }
+  }
+
+  if (revealed) {
+    remap();
+  }
+
+  return revealed;
+}
+
+auto FoldIndex::hidden(std::size_t line) const noexcept -> bool
+{
+  return !m_visible.empty() and line < m_shapes.size() and rowOf(line + 1) == rowOf(line);
+}
+
+auto FoldIndex::rowCount() const noexcept -> std::size_t
+{
+  return m_visible.empty() ? m_shapes.size() : m_rows;
+}
+
+auto FoldIndex::rowOf(std::size_t line) const noexcept -> std::size_t
+{
+  if (m_visible.empty()) {
+    return line;
+  }
+
+  if (line >= m_shapes.size()) {
+    return m_rows + (line - m_shapes.size());
+  }
+
+  std::size_t row {};
+
+  for (auto i = line; i > 0; i -= i & (~i + 1)) {
+    row += m_visible[i];
+  }
+
+  return row;
+}
+
+auto FoldIndex::lineAt(std::size_t row) const noexcept -> std::size_t
+{
+  if (m_visible.empty()) {
+    return row;
+  }
+
+  auto const lineCount = m_shapes.size();
+
+  if (row >= m_rows) {
+    return lineCount + (row - m_rows);
+  }
+
+  // Descend the Fenwick tree to the last line with no more than row visible lines before it, which is then visible
+  std::size_t line {};
+
+  for (auto step = std::bit_floor(lineCount); step > 0; step >>= 1U) {
+    if (line + step <= lineCount and m_visible[line + step] <= row) {
+      line += step;
+      row -= m_visible[line];
+    }
+  }
+
+  return line;
+}
+
+auto FoldIndex::hiddenAfter(std::size_t line) const noexcept -> std::size_t
+{
+  if (m_visible.empty() or line >= m_shapes.size() or hidden(line)) {
+    return 0;
+  }
+
+  return lineAt(rowOf(line) + 1) - line - 1;
+}
+
+auto FoldIndex::shapeOf(std::string_view text) noexcept -> Shape
+{
+  Shape shape;
+  std::size_t byte {};
+  std::size_t column {};
+
+  for (; byte < text.size() and (text[byte] == ' ' or text[byte] == '\t'); byte++) {
+    constexpr auto stop = static_cast<std::size_t>(KiloTabStop);
+    column = text[byte] == '\t' ? column + stop - column % stop : column + 1;
+  }
+
+  if (byte == text.size()) {
+    shape.indent = Blank;
+    return shape;
+  }
+
+  shape.indent = static_cast<std::uint32_t>(std::min<std::size_t>(column, Blank - 1));
+  shape.leadingCloser = isCloser(text[byte]);
+
+  for (; byte < text.size(); byte++) {
+    auto const c = text[byte];
+
+    // Brackets in a string or character literal don't count, as long as it ends on the line. An apostrophe in a
+    // comment is taken for what it is
+    if (c == '"' or c == '\'') {
+      if (auto const end = closingQuote(text, byte); end != std::string_view::npos) {
+        byte = end;
+      }
+    }
+    else if (isOpener(c)) {
+      shape.opens++;
+    }
+    else if (isCloser(c) and shape.opens > 0) {
+      shape.opens--;
+    }
+    else if (isCloser(c)) {
+      shape.closes++;
+    }
+  }
+
+  return shape;
+}
+
+auto FoldIndex::replace(Document const& document, std::size_t first, std::size_t removed, std::size_t added) -> bool
+{
+  auto const lineCount = m_shapes.size() - removed + added;
+  auto const at = m_shapes.begin() + static_cast<std::ptrdiff_t>(first);
+  m_old.assign(at, at + static_cast<std::ptrdiff_t>(removed));
+  m_shapes.insert(m_shapes.erase(at, at + static_cast<std::ptrdiff_t>(removed)), added, Shape {});
+
+  for (auto line = first; line < first + added; line++) {
+    m_shapes[line] = shapeOf(document.line(line));
+  }
+
+  if (lineCount == 0) {
+    m_refolded = false;
+    auto const refolded = std::exchange(m_collapsed, 0) > 0;
+    m_ranges.clear();
+    m_unmatched.clear();
+    index();
+    remap();
+    return refolded;
+  }
+
+  // Ranges after the replaced lines move along with them. Those that start or end on lines that were taken out are
+  // pulled onto the first line replaced, whose ranges are worked out again
+  auto const clamp = std::min(first, lineCount - 1);
+  auto const shift = [first, removed, added, clamp](std::size_t line) {
+    return line >= first + removed ? line - removed + added : line >= first ? clamp : line;
+  };
+
+  for (auto& range : m_ranges) {
+    range.start = shift(range.start);
+    range.end = shift(range.end);
+  }
+
+  std::erase_if(m_unmatched, [first, removed](std::size_t line) { return line >= first and line < first + removed; });
+
+  for (auto& line : m_unmatched) {
+    line = shift(line);
+  }
+
+  index();
+  rescan(first, removed, added);
+
+  auto const refolded = std::exchange(m_refolded, false) or (folded() and added != removed);
+
+  if (refolded) {
+    remap();
+  }
+
+  return refolded;
+}
+
+template <typename ShapeAt>
+auto FoldIndex::scan(ShapeAt const& shapeAt, std::size_t lineCount, std::size_t from, std::size_t until, bool checked)
+  -> std::optional<std::size_t>
+{
+  m_found.clear();
+  m_brackets.clear();
+  m_indents.clear();
+  m_open.clear();
+
+  auto const base = shapeAt(from).indent == Blank ? 0U : shapeAt(from).indent;
+  auto lastNonBlank = from;
+  auto stop = lineCount;
+
+  // An indented run ends on the last line before one that isn't indented deeper than the line the run follows
+  auto const endIndented = [this, &lastNonBlank](std::uint32_t indent) {
+    for (; !m_indents.empty() and m_indents.back().indent >= indent; m_indents.pop_back()) {
+      if (lastNonBlank > m_indents.back().line) {
+        m_found.push_back(FoldRange {.start = m_indents.back().line, .end = lastNonBlank, .collapsed = false});
+      }
+    }
+  };
+
+  for (auto line = from; line < lineCount; line++) {
+    auto const& shape = shapeAt(line);
+
+    if (shape.indent == Blank) {
+      continue;
+    }
+
+    endIndented(shape.indent);
+
+    // The scan stops at a line none of the ranges found so far reach, and that doesn't close a bracket either, since
+    // which bracket that would close depends on the lines before the first
+    if (line >= until and m_brackets.empty() and m_indents.empty() and shape.closes == 0) {
+      stop = line;
+      break;
+    }
+
+    // A line indented less than the first, or closing a bracket opened before it, moves the end of the ranges around
+    // the first line
+    auto const closed = std::min<std::size_t>(shape.closes, m_brackets.size());
+
+    if (checked and line > from and (shape.indent < base or closed < shape.closes)) {
+      return std::nullopt;
+    }
+
+    for (auto i = closed; i > 0; i--) {
+      auto const open = m_brackets.back();
+      auto const end = shape.leadingCloser ? line - 1 : line;
+      m_brackets.pop_back();
+
+      if (end > open) {
+        m_found.push_back(FoldRange {.start = open, .end = end, .collapsed = false});
+      }
+    }
+
+    m_brackets.insert(m_brackets.end(), shape.opens, line);
+    m_indents.push_back(Indented {.line = line, .indent = shape.indent});
+    lastNonBlank = line;
+  }
+
+  if (stop == lineCount) {
+    endIndented(0);
+    m_open.assign(m_brackets.begin(), m_brackets.end());
+    m_open.erase(std::ranges::unique(m_open).begin(), m_open.end());
+  }
+
+  // A bracket and an indented run that start on the same line make a single range, as long as the longer of them
+  std::ranges::sort(m_found, [](FoldRange const& a, FoldRange const& b) {
+    return a.start != b.start ? a.start < b.start : a.end > b.end;
+  });
+  m_found.erase(std::ranges::unique(m_found, {}, &FoldRange::start).begin(), m_found.end());
+
+  return stop;
+}
+
+void FoldIndex::rescan(std::size_t first, std::size_t removed, std::size_t added)
+{
+  auto const lineCount = m_shapes.size();
+  auto const shapeAt = [this](std::size_t line) -> Shape const& { return m_shapes[line]; };
+
+  // Lines taken out at the end leave the line before them to start from
+  auto const changed = std::min(first, lineCount - 1);
+  auto const until = added == 0 ? changed + 1 : first + added;
+
+  // Whether the first changed line is indented deeper than the line before it decides whether that one starts a
+  // range. With nothing but blank lines before it, there are no ranges around it either
+  auto previous = None;
+
+  for (auto line = changed; line-- > 0;) {
+    if (m_shapes[line].indent != Blank) {
+      previous = line;
+      break;
+    }
+  }
+
+  if (previous == None) {
+    splice(changed, *scan(shapeAt, lineCount, changed, until, false));
+    return;
+  }
+
+  // The ranges around the edit are tried from the inside out, until one is found that the edit doesn't reach out of
+  for (auto start = previous, attempt = std::size_t {}; attempt < MaxAttempts; attempt++) {
+    if (auto const stop = scan(shapeAt, lineCount, start, until, true);
+        stop and contained(start, *stop, first, removed, added)) {
+      splice(start, *stop);
+      return;
+    }
+
+    auto const outer = lastEndingFrom(firstFrom(start), previous);
+
+    if (outer == None) {
+      break;
+    }
+
+    start = m_ranges[outer].start;
+  }
+
+  // Otherwise everything the edit overlaps is worked out again, along with brackets left open before it that it may
+  // have closed
+  auto const overlapping = firstFrom(until);
+  auto const outermost = firstEndingFrom(overlapping, previous);
+  auto from = outermost == None ? previous : std::min(previous, m_ranges[outermost].start);
+
+  if (!m_unmatched.empty() and m_unmatched.front() < from) {
+    from = m_unmatched.front();
+  }
+
+  splice(from, *scan(shapeAt, lineCount, from, std::max(until, endOf(0, overlapping)), false));
+}
+
+auto FoldIndex::contained(std::size_t from, std::size_t to, std::size_t first, std::size_t removed, std::size_t added)
+  -> bool
+{
+  // A range around the first line that ends before the last is moved by the lines in between
+  for (auto range = lastEndingFrom(firstFrom(from), from); range != None; range = lastEndingFrom(range, from)) {
+    if (m_ranges[range].end < to) {
+      return false;
+    }
+  }
+
+  // The old lines have to stay inside the ranges around them up to the same line as the new ones, or the ranges
+  // around them may have been made to end where the old lines were. What the scan found is kept aside meanwhile
+  auto const oldShapeAt = [this, first, removed, added](std::size_t line) -> Shape const& {
+    return line < first             ? m_shapes[line]
+           : line < first + removed ? m_old[line - first]
+                                    : m_shapes[line - removed + added];
+  };
+
+  auto const oldTo = to - added + removed;
+  m_kept.swap(m_found);
+  m_keptOpen.swap(m_open);
+  auto const stop = scan(oldShapeAt, m_shapes.size() - added + removed, from, oldTo, true);
+  m_kept.swap(m_found);
+  m_keptOpen.swap(m_open);
+
+  return stop == oldTo;
+}
+
+void FoldIndex::splice(std::size_t from, std::size_t to)
+{
+  auto const first = firstFrom(from);
+  auto const last = firstFrom(to);
+
+  // Both runs are sorted, so the folded ranges are carried over in a single pass
+  for (auto old = first; auto& range : m_found) {
+    for (; old < last and m_ranges[old].start <= range.start; old++) {
+      range.collapsed = range.collapsed or (m_ranges[old].collapsed and m_ranges[old].start == range.start);
+    }
+  }
+
+  auto const wasCollapsed = std::ranges::count_if(m_ranges.begin() + static_cast<std::ptrdiff_t>(first),
+                                                  m_ranges.begin() + static_cast<std::ptrdiff_t>(last),
+                                                  &FoldRange::collapsed);
+  auto const isCollapsed = std::ranges::count_if(m_found, &FoldRange::collapsed);
+  m_collapsed = m_collapsed - static_cast<std::size_t>(wasCollapsed) + static_cast<std::size_t>(isCollapsed);
+  m_refolded = m_refolded or wasCollapsed > 0;
+
+  auto const at = m_ranges.erase(m_ranges.begin() + static_cast<std::ptrdiff_t>(first),
+                                 m_ranges.begin() + static_cast<std::ptrdiff_t>(last));
+  m_ranges.insert(at, m_found.begin(), m_found.end());
+
+  auto const open = std::ranges::lower_bound(m_unmatched, from);
+  m_unmatched.insert(m_unmatched.erase(open, std::ranges::lower_bound(open, m_unmatched.end(), to)), m_open.begin(),
+                     m_open.end());
+
+  index();
+}
+
+auto FoldIndex::firstEndingFrom(std::size_t before, std::size_t line) const noexcept -> std::size_t
+{
+  return search(m_ends, 1, 0, m_leaves, before, line, false);
+}
+
+auto FoldIndex::lastEndingFrom(std::size_t before, std::size_t line) const noexcept -> std::size_t
+{
+  return search(m_ends, 1, 0, m_leaves, before, line, true);
+}
+
+auto FoldIndex::endOf(std::size_t from, std::size_t to) const noexcept -> std::size_t
+{
+  std::size_t end {};
+
+  for (from += m_leaves, to += m_leaves; from < to; from >>= 1U, to >>= 1U) {
+    if ((from & 1U) != 0) {
+      end = std::max(end, m_ends[from++]);
+    }
+
+    if ((to & 1U) != 0) {
+      end = std::max(end, m_ends[--to]);
+    }
+  }
+
+  return end;
+}
+
+auto FoldIndex::firstFrom(std::size_t line) const noexcept -> std::size_t
+{
+  return static_cast<std::size_t>(std::ranges::lower_bound(m_ranges, line, {}, &FoldRange::start) - m_ranges.begin());
+}
+
+void FoldIndex::index()
+{
+  // Leaves hold one past the last line of each range, so that an empty leaf never counts as ending on line 0
+  m_leaves = std::bit_ceil(std::max(m_ranges.size(), std::size_t {1}));
+  m_ends.assign(2 * m_leaves, 0);
+
+  for (std::size_t i {}; i < m_ranges.size(); i++) {
+    m_ends[m_leaves + i] = m_ranges[i].end + 1;
+  }
+
+  for (auto node = m_leaves; node-- > 1;) {
+    m_ends[node] = std::max(m_ends[2 * node], m_ends[2 * node + 1]);
+  }
+}
+
+void FoldIndex::remap()
+{
+  auto const lineCount = m_shapes.size();
+
+  if (m_collapsed == 0) {
+    m_visible.clear();
+    m_rows = lineCount;
+    return;
+  }
+
+  // Each line counts once unless a folded range hides it. Ranges inside a folded range hide nothing more
+  m_visible.assign(lineCount + 1, 1);
+  m_visible[0] = 0;
+  m_rows = lineCount;
+
+  for (std::size_t hiddenUpTo {}; auto const& range : m_ranges) {
+    if (!range.collapsed) {
+      continue;
+    }
+
+    for (auto line = std::max(range.start + 1, hiddenUpTo); line <= range.end; line++) {
+      m_visible[line + 1] = 0;
+      m_rows--;
+    }
+
+    hiddenUpTo = std::max(hiddenUpTo, range.end + 1);
+  }
+
+  // Build the Fenwick tree in place, by adding every node to its parent
+  for (std::size_t i = 1; i <= lineCount; i++) {
+    if (auto const parent = i + (i & (~i + 1)); parent <= lineCount) {
+      m_visible[parent] += m_visible[i];
+    }
+  }
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,242 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FOLD_INDEX_HPP
+#define FOLD_INDEX_HPP
+
+#include "Editor/Document/Document.hpp"
+#include "Editor/MultiCursor/MultiCursor.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace Kilo::editor {
+
+// The ranges of lines of a document that can be folded away, and which of
+// them are. A range starts on a line that opens a bracket and ends before the
+// line that closes it, or starts on a line followed by lines indented deeper
+// than it and ends on the last of those.
+//
+// The ranges are kept sorted by their first line, with the last line of each
+// in a max tree over them. That makes the tree an interval tree: the ranges
+// around a line are found in logarithmic time however many there are.
+//
+// The indentation and the brackets that stay open or are closed by each line
+// are kept too, so an edit only reads the lines it changed. The ranges are
+// then worked out again from the innermost range around the edit that it
+// doesn't reach out of, going further out only if it does.
+//
+// While ranges are folded, the lines still shown are counted in a Fenwick
+// tree, which maps the rows of a pane to the lines they show and back in
+// logarithmic time.
+
+/// A range of lines that can be folded away
+struct FoldRange
+{
+  /// The line that stays visible when the range is folded
+  std::size_t start {};
+  /// The last line hidden when the range is folded
+  std::size_t end {};
+  bool collapsed {};
+
+  auto operator==(FoldRange const&) const -> bool = default;
+};
+
+class FoldIndex
+{
+public:
+  /// Check whether the ranges have been worked out. Nothing is kept up to date until they are
+  [[nodiscard]] constexpr auto built() const noexcept -> bool
+  {
+    return m_built;
+  }
+
+  /// Work out the ranges of a whole document. Ranges that were folded stay folded if there still is one on their line
+  void build(Document const& document);
+
+  /// Bring the ranges up to date after the lines from first to the end of the document were replaced
+  /// \returns Whether which lines are hidden may have changed
+  auto replaced(Document const& document, std::size_t first) -> bool;
+
+  /// Bring the ranges up to date after an edit at several cursors
+  /// \returns Whether which lines are hidden may have changed
+  auto changed(Document const& document, Changed const& changed) -> bool;
+
+  /// Get the ranges, sorted by their first line
+  [[nodiscard]] auto ranges() const noexcept -> std::span<FoldRange const>
+  {
+    return m_ranges;
+  }
+
+  /// Fold the range that starts on a line, or unfold it if it is folded. If none starts there, the innermost range
+  /// around the line is folded
+  /// \returns The first line of the range, or nothing if there is no range on or around the line
+  auto toggle(std::size_t line) -> std::optional<std::size_t>;
+
+  /// Fold or unfold every range
+  void foldAll(bool collapse);
+
+  /// Unfold the ranges that hide a line
+  /// \returns Whether any were unfolded
+  auto reveal(std::size_t line) -> bool;
+
+  /// Check whether any range is folded
+  [[nodiscard]] constexpr auto folded() const noexcept -> bool
+  {
+    return m_collapsed > 0;
+  }
+
+  /// Check whether a line is hidden by a folded range
+  [[nodiscard]] auto hidden(std::size_t line) const noexcept -> bool;
+
+  /// Get the number of rows the visible lines take up
+  [[nodiscard]] auto rowCount() const noexcept -> std::size_t;
+
+  /// Get the row a line is shown on. A hidden line gets the row of the next visible line. Lines past the end of the
+  /// document get a row each past the last
+  [[nodiscard]] auto rowOf(std::size_t line) const noexcept -> std::size_t;
+
+  /// Get the line shown on a row. Rows past the last visible line get a line each past the end of the document
+  [[nodiscard]] auto lineAt(std::size_t row) const noexcept -> std::size_t;
+
+  /// Get the number of hidden lines that follow a visible line, which is how many a folded range on it hides
+  [[nodiscard]] auto hiddenAfter(std::size_t line) const noexcept -> std::size_t;
+
+private:
+  /// What a line contributes to the ranges
+  struct Shape
+  {
+    /// The column the text of the line starts at, or Blank
+    std::uint32_t indent {};
+    /// The brackets the line closes that were opened on lines before it
+    std::uint32_t closes {};
+    /// The brackets the line opens that are still open at its end
+    std::uint32_t opens {};
+    /// Whether the line starts with a closing bracket, which is then left visible when the range is folded
+    bool leadingCloser {};
+
+    auto operator==(Shape const&) const -> bool = default;
+  };
+
+  static constexpr auto Blank = std::numeric_limits<std::uint32_t>::max();
+  static constexpr auto None = std::numeric_limits<std::size_t>::max();
+
+  [[nodiscard]] static auto shapeOf(std::string_view text) noexcept -> Shape;
+
+  /// Replace a run of lines, and work out the ranges around them again
+  auto replace(Document const& document, std::size_t first, std::size_t removed, std::size_t added) -> bool;
+
+  /// Work out the ranges around a run of lines that replaced another again. The shapes of the lines taken out are in
+  /// m_old
+  void rescan(std::size_t first, std::size_t removed, std::size_t added);
+
+  /// Check whether the ranges around the lines from..to are the same as before they were replaced, because neither
+  /// the old nor the new lines reach out of them
+  [[nodiscard]] auto contained(std::size_t from, std::size_t to, std::size_t first, std::size_t removed,
+                               std::size_t added) -> bool;
+
+  /// Work out the ranges that start from a line on, until a line from until on where none of them is open
+  /// \param[in] shapeAt Gets the shape of a line
+  /// \param[in] lineCount The number of lines
+  /// \param[in] checked Whether to give up if the lines reach out of the ranges around them, e.g. by closing a
+  /// bracket opened before the first line
+  /// \returns The line the scan stopped at, or nothing if it gave up
+  template <typename ShapeAt>
+  auto scan(ShapeAt const& shapeAt, std::size_t lineCount, std::size_t from, std::size_t until, bool checked)
+    -> std::optional<std::size_t>;
+
+  /// Replace the ranges that start on the lines from..to with those found by the last scan. Ranges found on a line
+  /// that had a folded range stay folded
+  void splice(std::size_t from, std::size_t to);
+
+  /// Get the first or the last of the ranges before an index that end on or after a line
+  /// \returns The index of the range, or None
+  [[nodiscard]] auto firstEndingFrom(std::size_t before, std::size_t line) const noexcept -> std::size_t;
+  [[nodiscard]] auto lastEndingFrom(std::size_t before, std::size_t line) const noexcept -> std::size_t;
+
+  /// Get one past the last line of the ranges from..to that ends last, or 0 if there are none
+  [[nodiscard]] auto endOf(std::size_t from, std::size_t to) const noexcept -> std::size_t;
+
+  /// Get the index of the first range that starts on or after a line
+  [[nodiscard]] auto firstFrom(std::size_t line) const noexcept -> std::size_t;
+
+  /// Rebuild the interval tree
+  void index();
+
+  /// Rebuild the count of visible lines
+  void remap();
+
+  bool m_built {};
+  std::vector<Shape> m_shapes;
+  std::vector<FoldRange> m_ranges;
+
+  // The lines of brackets that are never closed, which an edit further down may close
+  std::vector<std::size_t> m_unmatched;
+
+  // The last line of the ranges plus one, with a max at every inner node. Its leaves start at m_leaves
+  std::vector<std::size_t> m_ends;
+  std::size_t m_leaves {};
+
+  // Whether each line is shown, summed in a Fenwick tree. Empty while nothing is folded
+  std::vector<std::size_t> m_visible;
+  std::size_t m_rows {};
+  std::size_t m_collapsed {};
+
+  // Set when a folded range was replaced, which may change the lines hidden
+  bool m_refolded {};
+
+  // Kept to reuse their capacity from scan to scan
+  struct Indented
+  {
+    std::size_t line;
+    std::uint32_t indent;
+  };
+
+  std::vector<std::size_t> m_brackets;
+  std::vector<Indented> m_indents;
+  std::vector<FoldRange> m_found;
+  std::vector<std::size_t> m_open;
+  std::vector<FoldRange> m_kept;
+  std::vector<std::size_t> m_keptOpen;
+
+  // The shapes of the lines an edit took out
+  std::vector<Shape> m_old;
+
+  // The lines whose shape an edit changed, with their new shape
+  struct Reshaped
+  {
+    std::size_t line;
+    Shape shape;
+  };
+
+  std::vector<Reshaped> m_reshaped;
+};
+
+}   // namespace Kilo::editor
+
+#endif
@@ -0,0 +1,149 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "FrameWriter.hpp"
+
+#include <cerrno>
+#include <system_error>
+
+#include <poll.h>
+#include <unistd.h>
+
+namespace Kilo::editor {
+
+FrameWriter::FrameWriter(int fileDescriptor)
+    : m_fd(fileDescriptor), m_writer([this](std::stop_token const& stop) { run(stop); })
+{
+}
+
+FrameWriter::~FrameWriter()
+{
+  // The last frame usually leaves the cursor where it belongs, so it is worth waiting for
+  drain();
+}
+
+void FrameWriter::submit(ScreenBuffer& frame)
+{
+  {
+    std::scoped_lock const lock(m_mutex);
+
+    if (m_error != 0) {
+      throw std::system_error(m_error, std::system_category(), "Could not write to the terminal");
+    }
+
+    if (m_full) {
+      m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // The buffer gets back the dropped frame, or the empty string of a frame written earlier
+    frame.swap(m_mailbox);
+    m_full = true;
+  }
+
+  frame.clear();
+  m_waiting.notify_one();
+}
+
+auto FrameWriter::pending() const -> bool
+{
+  std::scoped_lock const lock(m_mutex);
+  return m_full;
+}
+
+void FrameWriter::drain()
+{
+  std::unique_lock lock(m_mutex);
+  m_idle.wait(lock, [this] { return (!m_full and !m_busy) or m_error != 0; });
+}
+
+auto FrameWriter::stats() const noexcept -> Stats
+{
+  return Stats {.framesWritten = m_framesWritten.load(std::memory_order_relaxed),
+                .framesDropped = m_framesDropped.load(std::memory_order_relaxed),
+                .writeStalls = m_writeStalls.load(std::memory_order_relaxed)};
+}
+
+void FrameWriter::run(std::stop_token const& stop)
+{
+  std::unique_lock lock(m_mutex);
+
+  while (m_waiting.wait(lock, stop, [this] { return m_full; })) {
+    m_writing.swap(m_mailbox);
+    m_full = false;
+    m_busy = true;
+
+    lock.unlock();
+    auto const error = write(m_writing);
+    m_writing.clear();
+    lock.lock();
+
+    m_busy = false;
+    m_error = error;
+
+    if (error == 0) {
+      m_framesWritten.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    m_idle.notify_all();
+
+    if (error != 0) {
+      return;
+    }
+  }
+}
+
+auto FrameWriter::write(std::string const& frame) noexcept -> int
+{
+  std::size_t written {};
+
+  while (written < frame.size()) {
+    ::pollfd output {.fd = m_fd, .events = POLLOUT, .revents = 0};
+
+    // The terminal has fallen behind, so wait for it to catch up
+    if (::poll(&output, 1, 0) == 0) {
+      m_writeStalls.fetch_add(1, std::memory_order_relaxed);
+
+      while (::poll(&output, 1, -1) == -1) {
+        if (errno != EINTR) {
+          return errno;
+        }
+      }
+    }
+
+    auto const result = ::write(m_fd, frame.data() + written, frame.size() - written);
+
+    if (result == -1) {
+      if (errno == EINTR or errno == EAGAIN) {
+        continue;
+      }
+
+      return errno;
+    }
+
+    written += static_cast<std::size_t>(result);
+  }
+
+  return 0;
+}
+
+}   // namespace Kilo::editor
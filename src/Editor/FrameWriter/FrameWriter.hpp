@@ -0,0 +1,124 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FRAME_WRITER_HPP
+#define FRAME_WRITER_HPP
+
+#include "Editor/ScreenBuffer/ScreenBuffer.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Kilo::editor {
+
+// Writes frames to the terminal on a thread of its own, so that a terminal
+// or SSH connection that can't keep up never holds up reading keys.
+//
+// Frames are passed over through a mailbox that holds a single frame. When
+// the writer is still busy with an earlier frame and another one is waiting
+// for it already, the waiting frame is stale and is dropped in favour of the
+// new one. Frames only redraw what changed since the previous one, so a frame
+// that replaces another one must redraw everything; pending() tells when
+// that is the case.
+//
+// The three strings involved, the one being drawn into, the one waiting and
+// the one being written, are swapped rather than copied, and each keeps its
+// capacity, so passing frames around doesn't allocate.
+
+class FrameWriter
+{
+public:
+  /// How the writer kept up with the frames handed to it
+  struct Stats
+  {
+    std::uint64_t framesWritten;
+
+    /// Frames replaced by a newer one before they were written
+    std::uint64_t framesDropped;
+
+    /// Writes that had to wait for the terminal to accept more output
+    std::uint64_t writeStalls;
+  };
+
+  /// Start the writer
+  /// \param[in] fileDescriptor Where frames are written to. It is not closed by the writer
+  explicit FrameWriter(int fileDescriptor);
+
+  /// Destructor. Writes the frame still waiting, if any, and waits for the writer to finish
+  ~FrameWriter();
+
+  FrameWriter(FrameWriter const&) = delete;
+  auto operator=(FrameWriter const&) -> FrameWriter& = delete;
+  FrameWriter(FrameWriter&&) = delete;
+  auto operator=(FrameWriter&&) -> FrameWriter& = delete;
+
+  /// Hand a frame over to be written. The buffer is left empty, ready for the next frame
+  /// \param[in] frame The screen buffer the frame was drawn into
+  /// \throws std::system_error if writing an earlier frame failed
+  void submit(ScreenBuffer& frame);
+
+  /// Check whether the last frame handed over is still waiting to be written. If so, the next frame replaces it
+  [[nodiscard]] auto pending() const -> bool;
+
+  /// Wait until every frame handed over has been written, or writing failed
+  void drain();
+
+  /// Get how the writer kept up with the frames handed to it
+  [[nodiscard]] auto stats() const noexcept -> Stats;
+
+private:
+  void run(std::stop_token const& stop);
+
+  /// Write a whole frame, waiting for the terminal whenever it can't take more
+  /// \returns 0 on success, or the error that occurred
+  auto write(std::string const& frame) noexcept -> int;
+
+  int m_fd;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable_any m_waiting;
+  std::condition_variable m_idle;
+
+  // Guarded by m_mutex
+  std::string m_mailbox;
+  bool m_full {};
+  bool m_busy {};
+  int m_error {};
+
+  // Only touched by the writer
+  std::string m_writing;
+
+  std::atomic<std::uint64_t> m_framesWritten {};
+  std::atomic<std::uint64_t> m_framesDropped {};
+  std::atomic<std::uint64_t> m_writeStalls {};
+
+  std::jthread m_writer;
+};
+
+}   // namespace Kilo::editor
+
+#endif
@@ -0,0 +1,169 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Gutter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace Kilo::editor {
+
+namespace {
+
+// Enough for the digits of any std::size_t and the blank column after them
+constexpr std::size_t MaxWidth = 24;
+
+// The digits of 00 to 99, so that numbers are formatted two digits at a time
+constexpr auto DigitPairs = [] {
+  std::array<char, 200> pairs {};
+
+  for (std::size_t i = 0; i < 100; i++) {
+    pairs[2 * i] = static_cast<char>('0' + i / 10);
+    pairs[2 * i + 1] = static_cast<char>('0' + i % 10);
+  }
+
+  return pairs;
+}();
+
+}   // namespace
+
+auto Gutter::widthFor(std::size_t lineCount) noexcept -> int
+{
+  // Room for at least three digits, so that the text doesn't move while a short document grows
+  auto digits = 1;
+
+  for (auto n = lineCount; n >= 10; n /= 10) {
+    digits++;
+  }
+
+  return std::max(digits, 3) + 1;
+}
+
+void Gutter::place(Region const& region)
+{
+  if (region != m_region) {
+    m_region = region;
+    invalidate();
+  }
+}
+
+void Gutter::invalidate() noexcept
+{
+  m_shown.assign(m_shown.size(), Unknown);
+}
+
+void Gutter::scroll(std::int64_t rows) noexcept
+{
+  auto const count = std::ssize(m_shown);
+  rows = std::clamp(rows, -count, count);
+
+  if (rows > 0) {
+    std::shift_left(m_shown.begin(), m_shown.end(), rows);
+    std::fill(m_shown.end() - rows, m_shown.end(), Unknown);
+  }
+  else if (rows < 0) {
+    std::shift_right(m_shown.begin(), m_shown.end(), -rows);
+    std::fill(m_shown.begin(), m_shown.begin() - rows, Unknown);
+  }
+}
+
+void Gutter::draw(std::span<std::size_t const> numbers, ScreenBuffer& buffer)
+{
+  auto const width = static_cast<std::size_t>(std::clamp(m_region.cols, 0, static_cast<int>(MaxWidth)));
+
+  if (width == 0) {
+    return;
+  }
+
+  m_shown.resize(static_cast<std::size_t>(std::max(m_region.rows, 0)), Unknown);
+
+  std::array<char, MaxWidth> before {};
+  std::array<char, MaxWidth> after {};
+
+  for (std::size_t row = 0; row < m_shown.size(); row++) {
+    auto const number = row < numbers.size() ? numbers[row] : Blank;
+    auto& shown = m_shown[row];
+
+    if (shown == number) {
+      continue;
+    }
+
+    // The last column is always blank, and sets the numbers apart from the text
+    auto const field = std::span(after).first(width - 1);
+    formatNumber(number, field);
+    after[width - 1] = ' ';
+
+    std::size_t first {};
+    auto last = width;
+
+    if (shown != Unknown) {
+      formatNumber(shown, std::span(before).first(width - 1));
+      before[width - 1] = ' ';
+
+      while (first < last and before[first] == after[first]) {
+        first++;
+      }
+
+      while (last > first and before[last - 1] == after[last - 1]) {
+        last--;
+      }
+    }
+
+    shown = number;
+
+    if (first < last) {
+      buffer.moveCursorTo(m_region.top + static_cast<std::int64_t>(row) + 1,
+                          m_region.left + static_cast<std::int64_t>(first) + 1)
+        .write(after.data() + first, last - first);
+    }
+  }
+}
+
+void formatNumber(std::size_t number, std::span<char> field) noexcept
+{
+  auto end = field.size();
+
+  if (number != Gutter::Blank) {
+    while (number >= 100 and end >= 2) {
+      std::memcpy(field.data() + end - 2, DigitPairs.data() + 2 * (number % 100), 2);
+      number /= 100;
+      end -= 2;
+    }
+
+    if (number >= 10 and end >= 2) {
+      std::memcpy(field.data() + end - 2, DigitPairs.data() + 2 * number, 2);
+      end -= 2;
+    }
+    else if (end >= 1) {
+      field[--end] = static_cast<char>('0' + number % 10);
+    }
+  }
+
+  std::fill_n(field.begin(), end, ' ');
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,107 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GUTTER_HPP
+#define GUTTER_HPP
+
+#include "Editor/Region/Region.hpp"
+#include "Editor/ScreenBuffer/ScreenBuffer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace Kilo::editor {
+
+/// What the gutter to the left of each pane shows
+enum class LineNumbers
+{
+  Off,
+  /// The number of the line on each row
+  Absolute,
+  /// How far each line is from the cursor, with the line of the cursor showing its own number
+  Relative
+};
+
+// The column of line numbers to the left of a pane. It is as wide as the
+// largest line number of the document needs, plus a blank column to set it
+// apart from the text.
+//
+// The gutter remembers the number it shows on each row, so drawing it again
+// only writes the digits that differ. Scrolling by a line in absolute mode
+// or moving the cursor in relative mode changes every number, but most of
+// them only in their last digit.
+
+class Gutter
+{
+public:
+  /// Shown on rows that have no number, i.e. below the end of the document and on the rows a long line was folded
+  /// onto
+  static constexpr std::size_t Blank = std::numeric_limits<std::size_t>::max();
+
+  /// Get the number of columns the gutter of a document takes up
+  /// \param[in] lineCount The number of lines in the document
+  [[nodiscard]] static auto widthFor(std::size_t lineCount) noexcept -> int;
+
+  /// Get where the gutter is
+  [[nodiscard]] constexpr auto region() const noexcept -> Region const&
+  {
+    return m_region;
+  }
+
+  /// Move the gutter. If it moved or changed size, every row is drawn again
+  /// \param[in] region Where the gutter is. No columns means it isn't shown
+  void place(Region const& region);
+
+  /// Forget what the rows show, e.g. because the screen was cleared, so that every row is drawn again
+  void invalidate() noexcept;
+
+  /// Move what the rows show along with the rows the terminal scrolled
+  /// \param[in] rows The number of rows scrolled up, or down if negative
+  void scroll(std::int64_t rows) noexcept;
+
+  /// Draw the numbers of the rows, writing only the digits that differ from what is shown already
+  /// \param[in] numbers The number of each row, or Blank. Rows beyond these are blank
+  /// \param[in] buffer The screen buffer
+  void draw(std::span<std::size_t const> numbers, ScreenBuffer& buffer);
+
+private:
+  // Forces a row to be drawn whatever it shows
+  static constexpr std::size_t Unknown = Blank - 1;
+
+  Region m_region {};
+
+  // What each row shows
+  std::vector<std::size_t> m_shown;
+};
+
+/// Write a number right-aligned into a field, padded with spaces on the left
+/// \param[in] number The number, or Gutter::Blank to leave the field blank
+/// \param[out] field The field. Leading digits that don't fit are cut off
+void formatNumber(std::size_t number, std::span<char> field) noexcept;
+
+}   // namespace Kilo::editor
+
+#endif
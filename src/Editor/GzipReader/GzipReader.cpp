@@ -0,0 +1,167 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "GzipReader.hpp"
+
+#include <system_error>
+#include <zlib.h>
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utility>
+
+namespace Kilo::editor {
+
+namespace {
+
+constexpr std::size_t ChunkSize = 64 * 1024;
+
+/// Send all of a buffer, waiting for the reader as needed
+/// \returns false if the reader has gone away
+auto sendAll(int socket, unsigned char const* data, std::size_t size) noexcept -> bool
+{
+  while (size > 0) {
+    auto const sent = ::send(socket, data, size, MSG_NOSIGNAL);
+
+    if (sent == -1 and errno == EINTR) {
+      continue;
+    }
+
+    if (sent <= 0) {
+      return false;
+    }
+
+    data += sent;
+    size -= static_cast<std::size_t>(sent);
+  }
+
+  return true;
+}
+
+/// Inflate a file into a socket until it ends, the data turns out to be corrupt, or we are asked to stop
+void decompress(std::stop_token const& stop, int input, int output) noexcept
+{
+  z_stream stream {};
+
+  // 32 added to the window bits makes zlib detect the gzip header by itself
+  if (::inflateInit2(&stream, 15 + 32) != Z_OK) {
+    return;
+  }
+
+  std::array<unsigned char, ChunkSize> in {};
+  std::array<unsigned char, ChunkSize> out {};
+  auto status = Z_OK;
+
+  while (!stop.stop_requested()) {
+    auto const got = ::read(input, in.data(), in.size());
+
+    if (got == -1 and errno == EINTR) {
+      continue;
+    }
+
+    if (got <= 0) {
+      break;
+    }
+
+    stream.next_in = in.data();
+    stream.avail_in = static_cast<unsigned>(got);
+
+    while (stream.avail_in > 0 and !stop.stop_requested()) {
+      // Archives made by concatenating gzip files consist of several members, each ending the stream on its own
+      if (status == Z_STREAM_END) {
+        ::inflateReset(&stream);
+      }
+
+      stream.next_out = out.data();
+      stream.avail_out = static_cast<unsigned>(out.size());
+      status = ::inflate(&stream, Z_NO_FLUSH);
+
+      if (status != Z_OK and status != Z_STREAM_END and status != Z_BUF_ERROR) {
+        ::inflateEnd(&stream);
+        return;
+      }
+
+      if (!sendAll(output, out.data(), out.size() - stream.avail_out)) {
+        ::inflateEnd(&stream);
+        return;
+      }
+    }
+  }
+
+  ::inflateEnd(&stream);
+}
+
+}   // namespace
+
+auto GzipReader::isGzip(int fileDescriptor) noexcept -> bool
+{
+  std::array<unsigned char, 2> magic {};
+  return ::pread(fileDescriptor, magic.data(), magic.size(), 0) == 2 and magic[0] == 0x1f and magic[1] == 0x8b;
+}
+
+GzipReader::GzipReader(int fileDescriptor)
+  : m_input(fileDescriptor)
+{
+  std::array<int, 2> ends {};
+
+  if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, ends.data()) == -1) {
+    auto const error = errno;
+    ::close(m_input);
+    throw std::system_error(error, std::system_category(), "Could not create a stream to decompress into");
+  }
+
+  m_output = ends[0];
+  m_workerEnd = ends[1];
+
+  // Shutting down its end when it is done is what tells the reader that the stream has ended
+  m_worker = std::jthread([input = m_input, output = m_workerEnd](std::stop_token const& stop) {
+    decompress(stop, input, output);
+    ::shutdown(output, SHUT_WR);
+  });
+}
+
+GzipReader::~GzipReader()
+{
+  // A worker waiting for the reader to make room would never see the stop request. Shutting down its end of the
+  // socket wakes it up
+  m_worker.request_stop();
+  ::shutdown(m_workerEnd, SHUT_RDWR);
+  m_worker.join();
+
+  ::close(m_workerEnd);
+  ::close(m_input);
+
+  if (m_output != -1) {
+    ::close(m_output);
+  }
+}
+
+auto GzipReader::release() noexcept -> int
+{
+  return std::exchange(m_output, -1);
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,74 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GZIP_READER_HPP
+#define GZIP_READER_HPP
+
+#include <thread>
+
+namespace Kilo::editor {
+
+// Decompresses a gzip file on a worker thread and hands the result over as a
+// stream, so that it can be loaded by a StreamLoader exactly like a pipe. The
+// first lines can then be shown while the rest of the archive is still being
+// inflated, and nothing is written to disk.
+//
+// The worker writes into one end of a socket pair and the loader reads from
+// the other. The kernel buffers in between bound how far the worker gets
+// ahead; once they are full it waits for the loader to catch up.
+
+class GzipReader
+{
+public:
+  /// Check whether a file starts with the gzip magic bytes
+  /// \param[in] fileDescriptor The file to check. Its file offset isn't changed
+  [[nodiscard]] static auto isGzip(int fileDescriptor) noexcept -> bool;
+
+  /// Start decompressing a file
+  /// \param[in] fileDescriptor The compressed file. The reader takes ownership of it
+  /// \throws std::system_error if the socket pair could not be created
+  explicit GzipReader(int fileDescriptor);
+
+  /// Destructor. Stops the worker if it is still decompressing and waits for it to finish
+  ~GzipReader();
+
+  GzipReader(GzipReader const&) = delete;
+  auto operator=(GzipReader const&) -> GzipReader& = delete;
+  GzipReader(GzipReader&&) = delete;
+  auto operator=(GzipReader&&) -> GzipReader& = delete;
+
+  /// Take the stream the decompressed bytes can be read from
+  /// \returns The file descriptor, which the caller takes ownership of, or -1 if it has already been taken
+  /// \details The stream ends when the whole file has been decompressed, or where the compressed data is corrupt
+  [[nodiscard]] auto release() noexcept -> int;
+
+private:
+  int m_output;
+  int m_workerEnd;
+  int m_input;
+  std::jthread m_worker;
+};
+
+}   // namespace Kilo::editor
+
+#endif
@@ -0,0 +1,68 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "History.hpp"
+
+#include <utility>
+
+namespace Kilo::editor {
+
+void History::record(Document const& document, Cursor const& cursor)
+{
+  m_redo.clear();
+  m_undo.push_back(Step {.document = document, .cursor = cursor});
+
+  if (m_undo.size() > Depth) {
+    m_undo.pop_front();
+  }
+}
+
+auto History::undo(Document& document, Cursor& cursor) -> std::optional<Replaced>
+{
+  if (m_undo.empty()) {
+    return std::nullopt;
+  }
+
+  auto& step = m_undo.back();
+  m_redo.push_back(Step {.document = std::exchange(document, std::move(step.document)),
+                         .cursor = std::exchange(cursor, step.cursor)});
+  m_undo.pop_back();
+
+  return document.difference(m_redo.back().document);
+}
+
+auto History::redo(Document& document, Cursor& cursor) -> std::optional<Replaced>
+{
+  if (m_redo.empty()) {
+    return std::nullopt;
+  }
+
+  auto& step = m_redo.back();
+  m_undo.push_back(Step {.document = std::exchange(document, std::move(step.document)),
+                         .cursor = std::exchange(cursor, step.cursor)});
+  m_redo.pop_back();
+
+  return document.difference(m_undo.back().document);
+}
+
+}   // namespace Kilo::editor
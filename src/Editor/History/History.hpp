@@ -0,0 +1,80 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef HISTORY_HPP
+#define HISTORY_HPP
+
+#include "Editor/Cursor/Cursor.hpp"
+#include "Editor/Document/Document.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <vector>
+
+namespace Kilo::editor {
+
+// Undo and redo for one buffer. Copying a Document only copies its root and
+// the copies share their nodes, so each step keeps the whole document as it
+// was before an edit. What a step costs is the nodes the edit went on to
+// clone, however large the document or the edit. Undoing an edit is then a
+// matter of swapping documents, whatever the edit did, and the lines the swap
+// replaced are found from the nodes the two documents don't share.
+
+class History
+{
+public:
+  /// The number of steps that can be undone. Older ones are forgotten
+  static constexpr std::size_t Depth = 1000;
+
+  /// Remember the state of a buffer before an edit, as one step. Whatever could have been redone is forgotten
+  /// \param[in] document The document before the edit
+  /// \param[in] cursor Where the cursor was before the edit
+  void record(Document const& document, Cursor const& cursor);
+
+  /// Go back to the state before the last edit
+  /// \param[in,out] document The document, which is replaced by the one before the edit
+  /// \param[in,out] cursor The cursor, which is put back where it was before the edit
+  /// \returns The run of lines the document had replaced, or nothing if there is nothing to undo
+  auto undo(Document& document, Cursor& cursor) -> std::optional<Replaced>;
+
+  /// Go forward to the state after the last edit undone
+  /// \param[in,out] document The document
+  /// \param[in,out] cursor The cursor
+  /// \returns The run of lines the document had replaced, or nothing if there is nothing to redo
+  auto redo(Document& document, Cursor& cursor) -> std::optional<Replaced>;
+
+private:
+  struct Step
+  {
+    Document document;
+    Cursor cursor;
+  };
+
+  std::deque<Step> m_undo;
+  std::vector<Step> m_redo;
+};
+
+}   // namespace Kilo::editor
+
+#endif
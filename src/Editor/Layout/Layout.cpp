@@ -0,0 +1,184 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Layout.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace Kilo::editor {
+
+struct Layout::Node
+{
+  // Leaves hold a pane, inner nodes two children
+  std::unique_ptr<Pane> pane;
+  Split split {};
+  std::unique_ptr<Node> first;
+  std::unique_ptr<Node> second;
+  Node* parent {};
+};
+
+auto Layout::leafOf(Node& node, Pane const* pane) noexcept -> Node*
+{
+  if (node.pane) {
+    return node.pane.get() == pane ? &node : nullptr;
+  }
+
+  auto* leaf = leafOf(*node.first, pane);
+  return leaf ? leaf : leafOf(*node.second, pane);
+}
+
+Layout::Layout()
+  : m_root(std::make_unique<Node>())
+{
+  m_root->pane = std::make_unique<Pane>();
+  collect();
+}
+
+Layout::~Layout() = default;
+Layout::Layout(Layout&&) noexcept = default;
+auto Layout::operator=(Layout&&) noexcept -> Layout& = default;
+
+void Layout::split(Split how)
+{
+  auto* leaf = leafOf(*m_root, m_panes[m_focused]);
+  assert(leaf != nullptr);
+
+  // The leaf becomes an inner node, with the pane it held moving into its first child
+  auto first = std::make_unique<Node>();
+  first->pane = std::move(leaf->pane);
+  first->parent = leaf;
+
+  auto second = std::make_unique<Node>();
+  second->pane = std::make_unique<Pane>(*first->pane);
+  second->pane->drawn.reset();
+  second->pane->gutter.invalidate();
+  second->parent = leaf;
+
+  auto const* added = second->pane.get();
+
+  leaf->split = how;
+  leaf->first = std::move(first);
+  leaf->second = std::move(second);
+
+  collect();
+  m_focused = static_cast<std::size_t>(std::ranges::find(m_panes, added) - m_panes.begin());
+}
+
+auto Layout::close() -> bool
+{
+  if (m_panes.size() == 1) {
+    return false;
+  }
+
+  auto* leaf = leafOf(*m_root, m_panes[m_focused]);
+  auto* parent = leaf->parent;
+  assert(parent != nullptr);
+
+  // The sibling takes the place of the parent. Nodes never move in memory, so its own children still point at it
+  auto sibling = std::move(parent->first.get() == leaf ? parent->second : parent->first);
+  sibling->parent = parent->parent;
+
+  if (parent->parent == nullptr) {
+    m_root = std::move(sibling);
+  }
+  else {
+    auto& slot = parent->parent->first.get() == parent ? parent->parent->first : parent->parent->second;
+    slot = std::move(sibling);
+  }
+
+  auto const closed = m_focused;
+  collect();
+  m_focused = closed % m_panes.size();
+
+  // Every pane may have moved, so none of them can rely on what is on the screen
+  for (auto* pane : m_panes) {
+    pane->drawn.reset();
+  }
+
+  return true;
+}
+
+void Layout::focusNext() noexcept
+{
+  m_focused = (m_focused + 1) % m_panes.size();
+}
+
+void Layout::arrange(Region const& area)
+{
+  m_separators.clear();
+  arrange(*m_root, area);
+}
+
+void Layout::arrange(Node& node, Region const& area)
+{
+  if (node.pane) {
+    node.pane->area = area;
+    node.pane->region = area;
+    return;
+  }
+
+  // The first half gets the smaller share of an odd size, and the separator takes up the cell in the middle
+  auto first = area;
+  auto second = area;
+  auto separator = area;
+
+  if (node.split == Split::Horizontal) {
+    first.rows = std::max(area.rows - 1, 0) / 2;
+    separator.top = area.top + first.rows;
+    separator.rows = area.rows > 0 ? 1 : 0;
+    second.top = separator.top + separator.rows;
+    second.rows = area.rows - first.rows - separator.rows;
+  }
+  else {
+    first.cols = std::max(area.cols - 1, 0) / 2;
+    separator.left = area.left + first.cols;
+    separator.cols = area.cols > 0 ? 1 : 0;
+    second.left = separator.left + separator.cols;
+    second.cols = area.cols - first.cols - separator.cols;
+  }
+
+  m_separators.push_back(separator);
+  arrange(*node.first, first);
+  arrange(*node.second, second);
+}
+
+void Layout::collect()
+{
+  m_panes.clear();
+  collect(*m_root);
+}
+
+void Layout::collect(Node& node)
+{
+  if (node.pane) {
+    m_panes.push_back(node.pane.get());
+    return;
+  }
+
+  collect(*node.first);
+  collect(*node.second);
+}
+
+}   // namespace Kilo::editor
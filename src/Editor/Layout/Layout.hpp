@@ -0,0 +1,205 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LAYOUT_HPP
+#define LAYOUT_HPP
+
+#include "Editor/Cursor/Cursor.hpp"
+#include "Editor/Gutter/Gutter.hpp"
+#include "Editor/Offset/Offset.hpp"
+#include "Editor/Region/Region.hpp"
+#include "Editor/WrapIndex/WrapIndex.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Kilo::editor {
+
+class LineDiff;
+class LineFilter;
+enum class DiffSide : std::uint8_t;
+
+/// A view onto one of the open buffers, shown in its own region of the screen
+struct Pane
+{
+  /// What a pane showed when it was last drawn. If nothing of this has changed since, the pane doesn't need to be
+  /// drawn again
+  struct Drawn
+  {
+    std::size_t buffer;
+    std::uint64_t generation;
+    Offset offset;
+    Region region;
+    bool wrapped;
+
+    friend constexpr auto operator==(Drawn const&, Drawn const&) -> bool = default;
+
+    /// Get the number of rows the pane was scrolled down by since it was drawn, or up by if negative
+    /// \returns Nothing unless the pane was scrolled vertically and nothing else about it changed
+    [[nodiscard]] constexpr auto scrolledBy(Drawn const& now) const noexcept -> std::optional<std::int64_t>
+    {
+      auto unscrolled = now;
+      unscrolled.offset.row = offset.row;
+
+      if (unscrolled != *this or now.offset.row == offset.row) {
+        return std::nullopt;
+      }
+
+      return now.offset.row - offset.row;
+    }
+  };
+
+  // The index of the buffer shown
+  std::size_t buffer {};
+  Cursor cursor {};
+  Offset offset {};
+
+  // The part of the screen the pane was given, which its gutter and the region its text is shown in divide between
+  // them
+  Region area {};
+  Region region {};
+  Gutter gutter;
+
+  // The cursors besides the one above while several places are edited at once, sorted from the top of the document
+  // down
+  std::vector<Cursor> cursors;
+
+  /// One of those cursors as it is shown on the screen, in inverse video, or the bracket matching the one at the
+  /// cursor, in bold and underlined
+  struct Mark
+  {
+    int row;
+    int col;
+    char shown;
+    bool bracket {};
+
+    friend constexpr auto operator==(Mark const&, Mark const&) -> bool = default;
+  };
+
+  // Where those cursors were shown when the pane was last drawn, relative to its region
+  std::vector<Mark> marks;
+
+  // Only engaged while soft-wrap is on. Lines are folded to the width of the
+  // pane, so two panes on the same buffer can't share one
+  std::optional<WrapIndex> wrap;
+
+  // Only engaged while the pane shows just the lines a filter found, which its rows are mapped to instead of to the
+  // lines the folds of its buffer leave visible. A pane that is split shares its filter with the new one until either
+  // of them filters differently. Panes that show a filter don't soft-wrap
+  std::shared_ptr<LineFilter> filter;
+
+  // Only engaged while the pane is lined up row for row with another pane that shows the other side of a diff, which
+  // its rows are mapped to instead. Panes that show a diff neither soft-wrap nor filter, and the diff is dropped as
+  // soon as either of its documents changes
+  std::shared_ptr<LineDiff> diff;
+  DiffSide side {};
+
+  std::optional<Drawn> drawn;
+};
+
+// The screen is divided between panes by a binary tree. Every inner node
+// splits its region in two, either into a top and a bottom half or into a
+// left and a right half, with a one cell wide separator in between. The
+// leaves are the panes.
+
+class Layout
+{
+public:
+  /// How a pane is split in two
+  enum class Split
+  {
+    /// One pane above the other
+    Horizontal,
+    /// The panes side by side
+    Vertical
+  };
+
+  /// Create a layout of a single pane showing the first buffer
+  explicit Layout();
+
+  /// Destructor
+  ~Layout();
+
+  Layout(Layout const&) = delete;
+  auto operator=(Layout const&) -> Layout& = delete;
+  Layout(Layout&&) noexcept;
+  auto operator=(Layout&&) noexcept -> Layout&;
+
+  /// Get the pane that has the focus
+  [[nodiscard]] auto focused() noexcept -> Pane&
+  {
+    return *m_panes[m_focused];
+  }
+
+  /// Get every pane, from the top left to the bottom right
+  [[nodiscard]] auto panes() const noexcept -> std::span<Pane* const>
+  {
+    return m_panes;
+  }
+
+  /// Get the separators between the panes, as arranged by the last call to arrange()
+  [[nodiscard]] auto separators() const noexcept -> std::span<Region const>
+  {
+    return m_separators;
+  }
+
+  /// Split the focused pane in two
+  /// \param[in] how Whether the new pane goes below or to the right of the focused one
+  /// \details The new pane shows the same buffer at the same position and takes the focus. Call arrange() afterwards
+  void split(Split how);
+
+  /// Close the focused pane and give its space to its sibling
+  /// \returns false if the pane is the only one, which can't be closed
+  /// \details The focus moves on to the next pane. Call arrange() afterwards
+  auto close() -> bool;
+
+  /// Move the focus on to the next pane, going back to the first after the last
+  void focusNext() noexcept;
+
+  /// Divide an area of the screen between the panes
+  /// \param[in] area The area, usually the whole terminal window
+  void arrange(Region const& area);
+
+private:
+  struct Node;
+
+  /// Find the leaf holding a pane
+  static auto leafOf(Node& node, Pane const* pane) noexcept -> Node*;
+
+  void arrange(Node& node, Region const& area);
+  void collect();
+  void collect(Node& node);
+
+  std::unique_ptr<Node> m_root;
+  std::vector<Pane*> m_panes;
+  std::vector<Region> m_separators;
+  std::size_t m_focused {};
+};
+
+}   // namespace Kilo::editor
+
+#endif
@@ -0,0 +1,370 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "LineDiff.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <string_view>
+#include <utility>
+
+namespace Kilo::editor {
+
+namespace {
+
+auto start(DiffHunk const& hunk, DiffSide side) noexcept -> std::size_t
+{
+  return side == DiffSide::Left ? hunk.left : hunk.right;
+}
+
+auto count(DiffHunk const& hunk, DiffSide side) noexcept -> std::size_t
+{
+  return side == DiffSide::Left ? hunk.leftCount : hunk.rightCount;
+}
+
+auto height(DiffHunk const& hunk) noexcept -> std::size_t
+{
+  return std::max(hunk.leftCount, hunk.rightCount);
+}
+
+// Count the hunks that start at or above a line of one side
+auto hunksAbove(std::span<DiffHunk const> hunks, DiffSide side, std::size_t line) noexcept -> std::size_t
+{
+  auto const first = [side](DiffHunk const& hunk) { return start(hunk, side); };
+  return static_cast<std::size_t>(std::ranges::upper_bound(hunks, line, {}, first) - hunks.begin());
+}
+
+/// A line with the hash of its text, which tells most lines apart without comparing their text
+struct HashedLine
+{
+  std::size_t hash;
+  std::string_view text;
+
+  friend auto operator==(HashedLine const& left, HashedLine const& right) noexcept -> bool
+  {
+    return left.hash == right.hash and left.text == right.text;
+  }
+};
+
+auto hashed(Document const& document, std::size_t first, std::size_t last) -> std::vector<HashedLine>
+{
+  std::vector<HashedLine> lines;
+  lines.reserve(last - first);
+
+  for (auto i = first; i < last; i++) {
+    auto const text = document.line(i);
+    lines.push_back({.hash = std::hash<std::string_view> {}(text), .text = text});
+  }
+
+  return lines;
+}
+
+// Myers' algorithm over hashed lines, with the space linear in the number of them. Hunks are found from the
+// top down, in the lines of the documents the numbers were taken from
+class Myers
+{
+public:
+  using Index = std::ptrdiff_t;
+
+  Myers(std::span<HashedLine const> left, std::span<HashedLine const> right, std::size_t skipped,
+        std::vector<DiffHunk>& hunks)
+    : m_left(left)
+    , m_right(right)
+    , m_skipped(skipped)
+    , m_hunks(hunks)
+    , m_forward(left.size() + right.size() + 3)
+    , m_backward(left.size() + right.size() + 3)
+  {
+  }
+
+  // Diff the lines from leftBegin to leftEnd with those from rightBegin to rightEnd
+  void compare(Index leftBegin, Index leftEnd, Index rightBegin, Index rightEnd)
+  {
+    while (leftBegin < leftEnd and rightBegin < rightEnd and equal(leftBegin, rightBegin)) {
+      leftBegin++;
+      rightBegin++;
+    }
+
+    while (leftBegin < leftEnd and rightBegin < rightEnd and equal(leftEnd - 1, rightEnd - 1)) {
+      leftEnd--;
+      rightEnd--;
+    }
+
+    if (leftBegin == leftEnd or rightBegin == rightEnd) {
+      if (leftBegin != leftEnd or rightBegin != rightEnd) {
+        add(leftBegin, leftEnd, rightBegin, rightEnd);
+      }
+
+      return;
+    }
+
+    // Neither side starts or ends with a line of the other, so the middle of the edit script is strictly between them
+    auto const [leftMiddle, rightMiddle] = middle(leftBegin, leftEnd, rightBegin, rightEnd);
+    assert(leftMiddle != leftBegin or rightMiddle != rightBegin);
+    assert(leftMiddle != leftEnd or rightMiddle != rightEnd);
+
+    compare(leftBegin, leftMiddle, rightBegin, rightMiddle);
+    compare(leftMiddle, leftEnd, rightMiddle, rightEnd);
+  }
+
+private:
+  [[nodiscard]] auto equal(Index left, Index right) const noexcept -> bool
+  {
+    return m_left[static_cast<std::size_t>(left)] == m_right[static_cast<std::size_t>(right)];
+  }
+
+  // Have a search reach one more diagonal on either side, unless it is at the edge of the graph already, in which
+  // case it steps back one, keeping to every other diagonal. The diagonal past a new one is read before it is reached,
+  // and starts out as no further than it could be
+  static void extend(Index* furthest, Index& min, Index& max, Index first, Index last, Index unreached) noexcept
+  {
+    if (min > first) {
+      furthest[--min - 1] = unreached;
+    }
+    else {
+      ++min;
+    }
+
+    if (max < last) {
+      furthest[++max + 1] = unreached;
+    }
+    else {
+      --max;
+    }
+  }
+
+  // Find a point on a shortest path through the edit graph halfway along it, searching forward from the top left
+  // corner and backward from the bottom right one, one edit at a time, until the two searches meet on a diagonal.
+  // Diagonals are numbered by x - y, and each search keeps the furthest x it got to on each diagonal it reached
+  auto middle(Index leftBegin, Index leftEnd, Index rightBegin, Index rightEnd) -> std::pair<Index, Index>
+  {
+    auto const n = leftEnd - leftBegin;
+    auto const m = rightEnd - rightBegin;
+    auto const delta = n - m;
+    auto const odd = delta % 2 != 0;
+
+    // Diagonals run from -m to n, and one past either end is read as well
+    auto* const forward = m_forward.data() + m + 1;
+    auto* const backward = m_backward.data() + m + 1;
+
+    auto const same = [this, leftBegin, rightBegin](Index x, Index y) {
+      return equal(leftBegin + x, rightBegin + y);
+    };
+
+    forward[0] = 0;
+    backward[delta] = n;
+
+    auto forwardMin = Index {0};
+    auto forwardMax = Index {0};
+    auto backwardMin = delta;
+    auto backwardMax = delta;
+
+    while (true) {
+      extend(forward, forwardMin, forwardMax, -m, n, -1);
+
+      for (auto d = forwardMax; d >= forwardMin; d -= 2) {
+        auto x = forward[d - 1] < forward[d + 1] ? forward[d + 1] : forward[d - 1] + 1;
+        auto y = x - d;
+
+        while (x < n and y < m and same(x, y)) {
+          x++;
+          y++;
+        }
+
+        forward[d] = x;
+
+        if (odd and backwardMin <= d and d <= backwardMax and backward[d] <= x) {
+          return {leftBegin + x, rightBegin + y};
+        }
+      }
+
+      extend(backward, backwardMin, backwardMax, -m, n, std::numeric_limits<Index>::max());
+
+      for (auto d = backwardMax; d >= backwardMin; d -= 2) {
+        auto x = backward[d - 1] < backward[d + 1] ? backward[d - 1] : backward[d + 1] - 1;
+        auto y = x - d;
+
+        while (x > 0 and y > 0 and same(x - 1, y - 1)) {
+          x--;
+          y--;
+        }
+
+        backward[d] = x;
+
+        if (!odd and forwardMin <= d and d <= forwardMax and x <= forward[d]) {
+          return {leftBegin + x, rightBegin + y};
+        }
+      }
+    }
+  }
+
+  // Runs are found in order, so one that touches the last is joined to it, e.g. lines taken out right before others
+  // are put in
+  void add(Index leftBegin, Index leftEnd, Index rightBegin, Index rightEnd)
+  {
+    auto const hunk = DiffHunk {.left = m_skipped + static_cast<std::size_t>(leftBegin),
+                                .leftCount = static_cast<std::size_t>(leftEnd - leftBegin),
+                                .right = m_skipped + static_cast<std::size_t>(rightBegin),
+                                .rightCount = static_cast<std::size_t>(rightEnd - rightBegin)};
+
+    if (!m_hunks.empty()) {
+      auto& last = m_hunks.back();
+
+      if (last.left + last.leftCount == hunk.left and last.right + last.rightCount == hunk.right) {
+        last.leftCount += hunk.leftCount;
+        last.rightCount += hunk.rightCount;
+        return;
+      }
+    }
+
+    m_hunks.push_back(hunk);
+  }
+
+  std::span<HashedLine const> m_left;
+  std::span<HashedLine const> m_right;
+  std::size_t m_skipped;
+  std::vector<DiffHunk>& m_hunks;
+
+  std::vector<Index> m_forward;
+  std::vector<Index> m_backward;
+};
+
+}   // namespace
+
+auto diffLines(Document const& left, Document const& right) -> std::vector<DiffHunk>
+{
+  auto const leftCount = left.lineCount();
+  auto const rightCount = right.lineCount();
+
+  std::size_t prefix = 0;
+
+  while (prefix < leftCount and prefix < rightCount and left.line(prefix) == right.line(prefix)) {
+    prefix++;
+  }
+
+  std::size_t suffix = 0;
+
+  while (prefix + suffix < leftCount and prefix + suffix < rightCount and
+         left.line(leftCount - suffix - 1) == right.line(rightCount - suffix - 1)) {
+    suffix++;
+  }
+
+  auto const leftLines = hashed(left, prefix, leftCount - suffix);
+  auto const rightLines = hashed(right, prefix, rightCount - suffix);
+
+  std::vector<DiffHunk> hunks;
+  Myers(leftLines, rightLines, prefix, hunks)
+    .compare(0, std::ssize(leftLines), 0, std::ssize(rightLines));
+  return hunks;
+}
+
+LineDiff::LineDiff(Document const& left, Document const& right)
+  : m_hunks(diffLines(left, right))
+  , m_lineCount {left.lineCount(), right.lineCount()}
+{
+  // Between hunks, both sides show the same number of lines, so a hunk starts on the row of its first line on the
+  // left, moved down by the gaps the left side has above it
+  std::size_t gaps = 0;
+  m_rows.reserve(m_hunks.size());
+
+  for (auto const& hunk : m_hunks) {
+    m_rows.push_back(hunk.left + gaps);
+    gaps += height(hunk) - hunk.leftCount;
+  }
+}
+
+auto LineDiff::rowCount() const noexcept -> std::size_t
+{
+  return rowOf(DiffSide::Left, lineCount(DiffSide::Left));
+}
+
+auto LineDiff::rowOf(DiffSide side, std::size_t line) const noexcept -> std::size_t
+{
+  // The last hunk that starts at or above the line, which is below it if the hunk has no lines on this side
+  auto const above = hunksAbove(m_hunks, side, line);
+
+  if (above == 0) {
+    return line;
+  }
+
+  auto const index = above - 1;
+  auto const& hunk = m_hunks[index];
+  auto const first = start(hunk, side);
+  auto const end = first + count(hunk, side);
+
+  return line < end ? m_rows[index] + (line - first) : m_rows[index] + height(hunk) + (line - end);
+}
+
+auto LineDiff::lineAt(DiffSide side, std::size_t row) const noexcept -> std::size_t
+{
+  auto const after = std::ranges::upper_bound(m_rows, row);
+
+  if (after == m_rows.begin()) {
+    return row;
+  }
+
+  auto const index = static_cast<std::size_t>(after - m_rows.begin() - 1);
+  auto const& hunk = m_hunks[index];
+  auto const within = row - m_rows[index];
+  auto const first = start(hunk, side);
+  auto const lines = count(hunk, side);
+
+  return within < lines            ? first + within
+         : within < height(hunk)   ? first + lines
+                                   : first + lines + (within - height(hunk));
+}
+
+auto LineDiff::gap(DiffSide side, std::size_t row) const noexcept -> bool
+{
+  auto const after = std::ranges::upper_bound(m_rows, row);
+
+  if (after == m_rows.begin()) {
+    return false;
+  }
+
+  auto const index = static_cast<std::size_t>(after - m_rows.begin() - 1);
+  auto const within = row - m_rows[index];
+  return within >= count(m_hunks[index], side) and within < height(m_hunks[index]);
+}
+
+auto LineDiff::changed(DiffSide side, std::size_t line) const noexcept -> bool
+{
+  auto const above = hunksAbove(m_hunks, side, line);
+  return above > 0 and line < start(m_hunks[above - 1], side) + count(m_hunks[above - 1], side);
+}
+
+auto LineDiff::changedLines(DiffSide side) const noexcept -> std::size_t
+{
+  std::size_t lines = 0;
+
+  for (auto const& hunk : m_hunks) {
+    lines += count(hunk, side);
+  }
+
+  return lines;
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,131 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LINE_DIFF_HPP
+#define LINE_DIFF_HPP
+
+#include "Editor/Document/Document.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Kilo::editor {
+
+// Compares two documents line by line, and lines them up side by side.
+//
+// The lines both documents start and end with are skipped first, comparing
+// their text directly, which the standard library does with memcmp a vector
+// at a time. The lines left between them are hashed once, so that from then
+// on the text of two lines is only compared when their hashes are equal.
+// Those are diffed with Myers' algorithm in linear space: a search from
+// either end finds the middle snake of a shortest edit script, and the lines
+// on either side of it are diffed the same way (Myers, "An O(ND) Difference
+// Algorithm and Its Variations", section 4b). The time taken grows with the
+// number of lines between the common start and end times the number of lines
+// changed.
+//
+// Side by side, the lines of both documents are shown on rows, the same on
+// both sides between the runs of lines that differ. Where one document has
+// more lines in a run than the other, the other side has gaps on the rows
+// left over. Rows are worked out from the runs, which are few next to the
+// lines, so nothing is kept per line.
+
+/// The two documents of a diff
+enum class DiffSide : std::uint8_t
+{
+  Left,
+  Right
+};
+
+/// A run of lines of the left document that the right document has another run of lines in place of. Either run may
+/// be empty
+struct DiffHunk
+{
+  std::size_t left;
+  std::size_t leftCount;
+  std::size_t right;
+  std::size_t rightCount;
+
+  friend constexpr auto operator==(DiffHunk const&, DiffHunk const&) -> bool = default;
+};
+
+/// Find the fewest lines to take out of one document and put into it to make another
+/// \param[in] left The document before
+/// \param[in] right The document after
+/// \returns The runs of lines they differ in, from the top down. Runs that touch are joined
+auto diffLines(Document const& left, Document const& right) -> std::vector<DiffHunk>;
+
+class LineDiff
+{
+public:
+  /// Diff two documents
+  /// \param[in] left The document shown on the left
+  /// \param[in] right The document shown on the right
+  explicit LineDiff(Document const& left, Document const& right);
+
+  /// Get the runs of lines the documents differ in
+  [[nodiscard]] auto hunks() const noexcept -> std::span<DiffHunk const>
+  {
+    return m_hunks;
+  }
+
+  /// Get the number of lines of one side
+  [[nodiscard]] auto lineCount(DiffSide side) const noexcept -> std::size_t
+  {
+    return m_lineCount[static_cast<std::size_t>(side)];
+  }
+
+  /// Get the number of rows both sides are shown on
+  [[nodiscard]] auto rowCount() const noexcept -> std::size_t;
+
+  /// Get the row a line of one side is shown on
+  [[nodiscard]] auto rowOf(DiffSide side, std::size_t line) const noexcept -> std::size_t;
+
+  /// Get the line of one side shown on a row
+  /// \returns The line, or the first line below the row when the side has a gap on it
+  [[nodiscard]] auto lineAt(DiffSide side, std::size_t row) const noexcept -> std::size_t;
+
+  /// Check whether one side has a gap on a row, across from a line only the other side has
+  [[nodiscard]] auto gap(DiffSide side, std::size_t row) const noexcept -> bool;
+
+  /// Check whether a line of one side is in a run of lines that differ
+  [[nodiscard]] auto changed(DiffSide side, std::size_t line) const noexcept -> bool;
+
+  /// Get the number of lines of one side in runs of lines that differ
+  [[nodiscard]] auto changedLines(DiffSide side) const noexcept -> std::size_t;
+
+private:
+  std::vector<DiffHunk> m_hunks;
+
+  // The row each hunk starts on
+  std::vector<std::size_t> m_rows;
+
+  std::array<std::size_t, 2> m_lineCount;
+};
+
+}   // namespace Kilo::editor
+
+#endif
@@ -0,0 +1,234 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "LineFilter.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+namespace Kilo::editor {
+
+auto containsAll(std::string_view line, std::span<std::string const> patterns) noexcept -> bool
+{
+  return std::ranges::all_of(patterns, [line](std::string const& pattern) {
+    return line.find(pattern) != std::string_view::npos;
+  });
+}
+
+LineFilter::LineFilter(std::vector<std::string> patterns, std::size_t chunkBytes)
+  : m_chunkBytes(std::max(chunkBytes, std::size_t {1}))
+  , m_patterns(std::make_shared<std::vector<std::string> const>(std::move(patterns)))
+{
+}
+
+void LineFilter::replaced(WorkerPool& workers, Document const& document, std::size_t first)
+{
+  search(workers, document, first, nullptr);
+}
+
+void LineFilter::within(WorkerPool& workers, Document const& document, std::span<std::size_t const> candidates)
+{
+  search(workers, document, 0, std::make_shared<std::vector<std::size_t> const>(candidates.begin(), candidates.end()));
+}
+
+auto LineFilter::changed(WorkerPool& workers, Document const& document, Changed const& changed) -> bool
+{
+  auto const lineCount = document.lineCount();
+  auto const upTo = searchedUpTo();
+
+  // Lines that were changed in place are searched again right away if they have been searched already. Lines the
+  // search going on hasn't got to yet are searched again by it. A line may have stopped matching a text another
+  // filter looked for, so that filter's lines are no longer the only ones searched
+  if (!changed.lineCount) {
+    auto moved = false;
+
+    for (auto const line : changed.lines) {
+      if (line >= upTo) {
+        search(workers, document, upTo, nullptr);
+        break;
+      }
+
+      auto const at = std::ranges::lower_bound(m_lines, line);
+      auto const shown = at != m_lines.end() and *at == line;
+
+      if (containsAll(document.line(line), *m_patterns) == shown) {
+        continue;
+      }
+
+      if (shown) {
+        m_lines.erase(at);
+      }
+      else {
+        m_lines.insert(at, line);
+      }
+
+      moved = true;
+    }
+
+    return moved;
+  }
+
+  // The lines below an edit that added or removed lines move up or down by as many, but the search going on reads the
+  // document from before the edit and has to start over
+  auto const [first, removed, added] = replacedLines(changed, m_lineCount, lineCount);
+
+  if (!complete() or added > EditLines) {
+    search(workers, document, first, nullptr);
+    return true;
+  }
+
+  auto const begin = std::ranges::lower_bound(m_lines, first) - m_lines.begin();
+  auto const end = std::ranges::lower_bound(m_lines, first + removed) - m_lines.begin();
+
+  for (auto line = m_lines.begin() + end; line != m_lines.end(); ++line) {
+    *line = *line - removed + added;
+  }
+
+  m_found.clear();
+
+  for (auto line = first; line < first + added; line++) {
+    if (containsAll(document.line(line), *m_patterns)) {
+      m_found.push_back(line);
+    }
+  }
+
+  auto const at = m_lines.erase(m_lines.begin() + begin, m_lines.begin() + end);
+  m_lines.insert(at, m_found.begin(), m_found.end());
+  m_lineCount = lineCount;
+  return true;
+}
+
+auto LineFilter::collect() -> bool
+{
+  m_jobs.collect([this](Result& result) {
+    m_chunks[result.chunk].lines = std::move(result.lines);
+    m_chunks[result.chunk].searched = true;
+    m_pending--;
+  });
+
+  // Lines are only added once every chunk before theirs has been searched, so that they are added in order
+  auto const found = m_lines.size();
+
+  for (; m_next < m_chunks.size() and m_chunks[m_next].searched; m_next++) {
+    auto& lines = m_chunks[m_next].lines;
+    m_lines.insert(m_lines.end(), lines.begin(), lines.end());
+    std::vector<std::size_t>().swap(lines);
+  }
+
+  return m_lines.size() != found;
+}
+
+auto LineFilter::rowOf(std::size_t line) const noexcept -> std::size_t
+{
+  if (line >= m_lineCount) {
+    return m_lines.size() + (line - m_lineCount);
+  }
+
+  return static_cast<std::size_t>(std::ranges::lower_bound(m_lines, line) - m_lines.begin());
+}
+
+auto LineFilter::lineAt(std::size_t row) const noexcept -> std::size_t
+{
+  return row < m_lines.size() ? m_lines[row] : m_lineCount + (row - m_lines.size());
+}
+
+auto LineFilter::hidden(std::size_t line) const noexcept -> bool
+{
+  return line < m_lineCount and !std::ranges::binary_search(m_lines, line);
+}
+
+void LineFilter::search(WorkerPool& workers, Document const& document, std::size_t first,
+                        std::shared_ptr<std::vector<std::size_t> const> candidates)
+{
+  // Lines the search going on hadn't got to yet are searched along with the rest
+  auto const lineCount = document.lineCount();
+  first = std::min({first, searchedUpTo(), lineCount});
+
+  // Jobs queued for an earlier search would search lines that have changed since
+  m_jobs.restart();
+  m_lines.erase(std::ranges::lower_bound(m_lines, first), m_lines.end());
+  m_lineCount = lineCount;
+  m_chunks.clear();
+  m_next = 0;
+
+  // Chunks end at the end of a line, so that each of them takes around the same time however long the lines are.
+  // Chunks without any of the candidates are left out
+  for (auto begin = first; begin < lineCount;) {
+    auto const end = document.lineOffset(begin) + m_chunkBytes;
+    auto const last = end >= document.byteCount() ? lineCount : std::max(begin + 1, document.lineAt(end));
+
+    if (!candidates or std::ranges::lower_bound(*candidates, begin) != std::ranges::lower_bound(*candidates, last)) {
+      m_chunks.push_back(Chunk {.first = begin, .last = last, .searched = false, .lines = {}});
+    }
+
+    begin = last;
+  }
+
+  m_pending = m_chunks.size();
+  m_posted.clear();
+
+  for (std::size_t chunk = 0; chunk < m_chunks.size(); chunk++) {
+    m_posted.push_back(Job {.chunk = chunk,
+                            .first = m_chunks[chunk].first,
+                            .last = m_chunks[chunk].last,
+                            .patterns = m_patterns,
+                            .candidates = candidates});
+  }
+
+  m_jobs.post(workers, document, m_posted);
+}
+
+auto LineFilter::searchedUpTo() const noexcept -> std::size_t
+{
+  return complete() ? m_lineCount : m_chunks[m_next].first;
+}
+
+auto LineFilter::work(Job const& job, Document const& document) -> Result
+{
+  auto result = Result {.chunk = job.chunk, .lines = {}};
+  auto const& patterns = *job.patterns;
+
+  if (job.candidates) {
+    auto const& candidates = *job.candidates;
+
+    for (auto line = std::ranges::lower_bound(candidates, job.first); line != candidates.end() and *line < job.last;
+         ++line) {
+      if (containsAll(document.line(*line), patterns)) {
+        result.lines.push_back(*line);
+      }
+    }
+  }
+  else {
+    for (auto line = job.first; line < job.last; line++) {
+      if (containsAll(document.line(line), patterns)) {
+        result.lines.push_back(line);
+      }
+    }
+  }
+
+  return result;
+}
+
+}   // namespace Kilo::editor
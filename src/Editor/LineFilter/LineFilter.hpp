@@ -0,0 +1,199 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LINE_FILTER_HPP
+#define LINE_FILTER_HPP
+
+#include "Editor/Document/Document.hpp"
+#include "Editor/MultiCursor/MultiCursor.hpp"
+#include "Editor/WorkerPool/BackgroundJobs.hpp"
+#include "Editor/WorkerPool/WorkerPool.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Kilo::editor {
+
+// The lines of a document that contain every one of some texts, like the
+// lines :g/text/ would act on in vi. A pane that shows only these lines maps
+// its rows to them instead of to every line of the document.
+//
+// Only the numbers of the lines are kept, in order, and never their text.
+// The lines are split into chunks of around the same number of bytes, which
+// workers search at once. The lines found in a chunk are added once every
+// chunk before it has been searched too, so that the lines found so far are
+// always the first of them and can be shown while the rest are searched.
+//
+// Filters are stacked by adding texts. A filter with one text more only has
+// to search the lines the filter without it found, if it found them all.
+
+/// Check whether a line contains every one of some texts
+[[nodiscard]] auto containsAll(std::string_view line, std::span<std::string const> patterns) noexcept -> bool;
+
+class LineFilter
+{
+public:
+  /// The number of bytes in a chunk when the document is split up
+  static constexpr std::size_t ChunkBytes = 4 * 1024 * 1024;
+
+  /// The number of lines an edit may add that are searched right away rather than by the workers
+  static constexpr std::size_t EditLines = 4 * 1024;
+
+  /// Create a filter that hasn't found any lines yet
+  /// \param[in] patterns The texts every line shown contains
+  /// \param[in] chunkBytes The number of bytes in a chunk. A chunk always has at least one line
+  explicit LineFilter(std::vector<std::string> patterns, std::size_t chunkBytes = ChunkBytes);
+
+  LineFilter(LineFilter const&) = delete;
+  auto operator=(LineFilter const&) -> LineFilter& = delete;
+  LineFilter(LineFilter&&) = delete;
+  auto operator=(LineFilter&&) -> LineFilter& = delete;
+
+  /// Search the lines from some line onwards again, e.g. after lines were appended. The lines found before it are
+  /// kept
+  /// \param[in] workers The workers that search the chunks
+  /// \param[in] document The document after the edit
+  /// \param[in] first The first line that may have changed
+  void replaced(WorkerPool& workers, Document const& document, std::size_t first);
+
+  /// Search only some of the lines of a document, such as those a filter with fewer texts found
+  /// \param[in] workers The workers that search the chunks
+  /// \param[in] document The document
+  /// \param[in] candidates The lines searched, in ascending order
+  void within(WorkerPool& workers, Document const& document, std::span<std::size_t const> candidates);
+
+  /// Bring the lines found up to date after an edit at several cursors
+  /// \param[in] workers The workers that search the chunks
+  /// \param[in] document The document after the edit
+  /// \param[in] changed What the edit changed
+  /// \returns true if the lines found changed, or which rows they are on
+  auto changed(WorkerPool& workers, Document const& document, Changed const& changed) -> bool;
+
+  /// Take in the lines of the chunks that workers have finished with
+  /// \returns true if any line was added
+  auto collect() -> bool;
+
+  /// Get the texts every line shown contains
+  [[nodiscard]] auto patterns() const noexcept -> std::span<std::string const>
+  {
+    return *m_patterns;
+  }
+
+  /// Get the lines found so far, in ascending order
+  [[nodiscard]] auto lines() const noexcept -> std::span<std::size_t const>
+  {
+    return m_lines;
+  }
+
+  /// Check whether every chunk has been searched since it last changed
+  [[nodiscard]] auto complete() const noexcept -> bool
+  {
+    return m_next == m_chunks.size();
+  }
+
+  /// Get the number of chunks of the search going on, or of the last one
+  [[nodiscard]] auto chunkCount() const noexcept -> std::size_t
+  {
+    return m_chunks.size();
+  }
+
+  /// Get the number of chunks of the search going on that haven't been searched yet
+  [[nodiscard]] constexpr auto pending() const noexcept -> std::size_t
+  {
+    return m_pending;
+  }
+
+  /// Get the row a line is shown on. A line that isn't shown gets the row of the next line found, or the row after the
+  /// last one if there is none. Lines past the end of the document get a row each past that
+  [[nodiscard]] auto rowOf(std::size_t line) const noexcept -> std::size_t;
+
+  /// Get the line shown on a row. Rows past the last line found get a line each past the end of the document
+  [[nodiscard]] auto lineAt(std::size_t row) const noexcept -> std::size_t;
+
+  /// Check whether a line of the document isn't shown, including a line that hasn't been searched yet
+  [[nodiscard]] auto hidden(std::size_t line) const noexcept -> bool;
+
+private:
+  struct Chunk
+  {
+    std::size_t first;
+    std::size_t last;
+
+    bool searched;
+    std::vector<std::size_t> lines;
+  };
+
+  struct Job
+  {
+    std::size_t chunk;
+    std::size_t first;
+    std::size_t last;
+    std::shared_ptr<std::vector<std::string> const> patterns;
+    std::shared_ptr<std::vector<std::size_t> const> candidates;
+  };
+
+  struct Result
+  {
+    std::size_t chunk;
+    std::vector<std::size_t> lines;
+  };
+
+  /// Search the lines of a chunk
+  static auto work(Job const& job, Document const& document) -> Result;
+
+  /// Search the lines from some line onwards, dropping the search going on and the lines found from there
+  /// \param[in] candidates The only lines searched, or null to search all of them
+  void search(WorkerPool& workers, Document const& document, std::size_t first,
+              std::shared_ptr<std::vector<std::size_t> const> candidates);
+
+  /// Get the first line that the lines found so far don't cover
+  [[nodiscard]] auto searchedUpTo() const noexcept -> std::size_t;
+
+  std::size_t m_chunkBytes;
+  std::shared_ptr<std::vector<std::string> const> m_patterns;
+
+  std::vector<std::size_t> m_lines;
+  std::size_t m_lineCount {};
+
+  // The chunks of the search going on, the next of them whose lines are added to those found, and the number of them
+  // that haven't been searched yet
+  std::vector<Chunk> m_chunks;
+  std::size_t m_next {};
+  std::size_t m_pending {};
+
+  // The chunks being searched. Restarted by every search, and destroying them waits for those the workers have
+  // started on
+  BackgroundJobs<Job, Result> m_jobs {work};
+
+  // Kept to reuse their capacity
+  std::vector<Job> m_posted;
+  std::vector<std::size_t> m_found;
+};
+
+}   // namespace Kilo::editor
+
+#endif
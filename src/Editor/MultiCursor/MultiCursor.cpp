@@ -0,0 +1,263 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "MultiCursor.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+
+namespace Kilo::editor {
+
+namespace {
+
+/// Get where a cursor is on a line, if it is past the end of the line
+auto clampedColumn(Cursor const& cursor, std::string_view line) noexcept -> std::size_t
+{
+  return static_cast<std::size_t>(std::clamp<std::int64_t>(cursor.x, 0, std::ssize(line)));
+}
+
+/// Remember that a line was changed, unless it already is
+void touch(Changed& changed, std::size_t line)
+{
+  if (changed.lines.empty() or changed.lines.back() != line) {
+    changed.lines.push_back(line);
+  }
+}
+
+}   // namespace
+
+void normalize(std::vector<Cursor>& cursors)
+{
+  std::ranges::sort(cursors);
+
+  auto const duplicates = std::ranges::unique(cursors);
+  cursors.erase(duplicates.begin(), duplicates.end());
+}
+
+auto replacedLines(Changed const& changed, std::size_t before, std::size_t after) noexcept -> Replaced
+{
+  auto const& lines = changed.lines;
+
+  if (!changed.lineCount) {
+    return lines.empty() ? Replaced {} : Replaced {lines.front(), lines.back() - lines.front() + 1,
+                                                   lines.back() - lines.front() + 1};
+  }
+
+  if (auto const& runs = changed.runs; !runs.empty()) {
+    auto const first = runs.front().first;
+    auto const end = runs.back().first + runs.back().added;
+    return {first, end - first + before - after, end - first};
+  }
+
+  if (auto const contiguous = !lines.empty() and lines.back() - lines.front() + 1 == lines.size();
+      contiguous and before + lines.size() >= after and lines.front() + (before + lines.size() - after) <= before) {
+    return {lines.front(), before + lines.size() - after, lines.size()};
+  }
+
+  auto const first = std::min({lines.empty() ? 0 : lines.front(), before, after});
+  return {first, before - first, after - first};
+}
+
+auto changedBy(Replaced const& replaced) -> Changed
+{
+  auto changed = Changed {.lines = std::vector<std::size_t>(replaced.added),
+                          .lineCount = replaced.removed != replaced.added,
+                          .runs = {}};
+  std::iota(changed.lines.begin(), changed.lines.end(), replaced.first);
+
+  if (changed.lineCount) {
+    changed.runs.push_back(replaced);
+  }
+
+  return changed;
+}
+
+auto insertAt(Document& document, std::span<Cursor> cursors, std::string_view text) -> Changed
+{
+  Changed changed;
+  std::string line;
+  std::string current;
+
+  // The number of lines the edit has added above the cursors still to be handled
+  std::int64_t added {};
+
+  for (std::size_t i = 0; i < cursors.size();) {
+    auto const original = cursors[i].y;
+    auto const first = std::min(static_cast<std::size_t>(original + added), document.lineCount());
+
+    // The cursor can be just past the last line, where typing starts a new one
+    auto const appended = first == document.lineCount();
+
+    if (appended) {
+      document.append({});
+      changed.lineCount = true;
+    }
+
+    // Copy the line, since views of it don't survive changing the document
+    line.assign(document.line(first));
+    current.clear();
+
+    auto row = first;
+    std::size_t copied {};
+
+    auto const write = [&document, &changed, &current, first](std::size_t at) {
+      if (at == first) {
+        document.replaceLine(at, current);
+      }
+      else {
+        document.insertLine(at, current);
+      }
+
+      touch(changed, at);
+    };
+
+    // Every cursor on the line, each of which splits it into more lines if the text has line breaks
+    for (; i < cursors.size() and cursors[i].y == original; i++) {
+      auto const column = clampedColumn(cursors[i], line);
+      current.append(line, copied, column - copied);
+      copied = column;
+
+      for (std::size_t start {};;) {
+        auto const end = text.find_first_of("\r\n", start);
+        current.append(text.substr(start, end - start));
+
+        if (end == std::string_view::npos) {
+          break;
+        }
+
+        write(row++);
+        current.clear();
+
+        auto const crlf = text[end] == '\r' and end + 1 < text.size() and text[end + 1] == '\n';
+        start = end + (crlf ? 2 : 1);
+      }
+
+      cursors[i] = Cursor {.x = std::ssize(current), .y = static_cast<std::int64_t>(row)};
+    }
+
+    current.append(line, copied);
+    write(row);
+    changed.runs.push_back(Replaced {.first = first, .removed = appended ? 0U : 1U, .added = row - first + 1});
+
+    added += static_cast<std::int64_t>(row - first);
+  }
+
+  changed.lineCount = changed.lineCount or added != 0;
+  return changed;
+}
+
+auto eraseAt(Document& document, std::span<Cursor> cursors, Direction direction) -> Changed
+{
+  Changed changed;
+  std::string merged;
+  auto const backward = direction == Direction::Backward;
+
+  // The number of lines the edit has removed above the cursors still to be handled
+  std::int64_t removed {};
+
+  for (std::size_t i = 0; i < cursors.size();) {
+    auto row = static_cast<std::size_t>(cursors[i].y - removed);
+
+    // There is nothing to delete on the line past the last one. Backspace there goes back to the end of the last line
+    if (row >= document.lineCount()) {
+      auto const previous = backward and document.lineCount() > 0;
+      auto const line = previous ? document.lineCount() - 1 : document.lineCount();
+      auto const column = previous ? std::ssize(document.line(line)) : 0;
+
+      for (; i < cursors.size(); i++) {
+        cursors[i] = Cursor {.x = column, .y = static_cast<std::int64_t>(line)};
+      }
+
+      break;
+    }
+
+    // The line everything that is left of the lines joined together ends up on
+    auto target = row;
+    merged.clear();
+
+    if (backward and cursors[i].x <= 0 and row > 0) {
+      target = row - 1;
+      merged.assign(document.line(target));
+    }
+
+    while (true) {
+      auto const original = cursors[i].y;
+      auto const line = document.line(row);
+
+      // Everything before this byte of the line has been copied or deleted
+      std::size_t copied {};
+      auto joinNext = false;
+
+      for (; i < cursors.size() and cursors[i].y == original; i++) {
+        auto const column = clampedColumn(cursors[i], line);
+
+        if (backward and column > copied) {
+          merged.append(line.substr(copied, column - 1 - copied));
+          copied = column;
+        }
+        else if (!backward and column < line.size() and column >= copied) {
+          merged.append(line.substr(copied, column - copied));
+          copied = column + 1;
+        }
+        else if (!backward and column == line.size()) {
+          merged.append(line.substr(std::min(copied, line.size())));
+          copied = line.size();
+          joinNext = true;
+        }
+
+        cursors[i] = Cursor {.x = std::ssize(merged), .y = static_cast<std::int64_t>(target)};
+      }
+
+      merged.append(line.substr(std::min(copied, line.size())));
+
+      if (!joinNext or row + 1 >= document.lineCount()) {
+        break;
+      }
+
+      // The line below may have cursors of its own, which carry on along the joined line
+      row++;
+
+      if (i == cursors.size() or static_cast<std::size_t>(cursors[i].y - removed) != row) {
+        merged.append(document.line(row));
+        break;
+      }
+    }
+
+    document.replaceLine(target, merged);
+
+    for (auto joined = target; joined < row; joined++) {
+      document.eraseLine(target + 1);
+    }
+
+    removed += static_cast<std::int64_t>(row - target);
+    changed.lineCount = changed.lineCount or row != target;
+    changed.runs.push_back(Replaced {.first = target, .removed = row - target + 1, .added = 1});
+    touch(changed, target);
+  }
+
+  return changed;
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,102 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MULTI_CURSOR_HPP
+#define MULTI_CURSOR_HPP
+
+#include "Editor/Cursor/Cursor.hpp"
+#include "Editor/Document/Document.hpp"
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace Kilo::editor {
+
+// Edits made at several cursors at once. The cursors are sorted, so an edit
+// is applied to all of them in a single pass down the document. Each line
+// with a cursor on it is written back once, however many cursors it has, and
+// the cursors after an edit are moved along by the lines and bytes it added
+// or removed before them as the pass goes, rather than by a search afterwards.
+
+/// What an edit at several cursors changed
+struct Changed
+{
+  /// The lines whose text changed, in ascending order and numbered as they are after the edit
+  std::vector<std::size_t> lines;
+
+  /// Whether lines were added or removed, which moves every line below the first of them
+  bool lineCount {};
+
+  /// The runs of lines the edit replaced, one for each line it had cursors on, top to bottom and starting on the line
+  /// they start on after the edit. Lines between them didn't change, even if they moved
+  std::vector<Replaced> runs;
+};
+
+/// Work out which run of lines an edit replaced
+/// \param[in] changed What the edit changed
+/// \param[in] before How many lines the document had before the edit
+/// \param[in] after How many lines it has now
+/// \returns The run from the first line the edit replaced to the last. Without the runs of the edit, an edit at a
+/// single cursor changes a contiguous run of lines, which together with the change in the line count tells how many
+/// lines it took out, while edits that are spread out may have moved every line after the first of them, so the run
+/// is everything from there to the end
+auto replacedLines(Changed const& changed, std::size_t before, std::size_t after) noexcept -> Replaced;
+
+/// Describe the replacement of a run of lines as the change an edit made
+/// \param[in] replaced The run of lines
+/// \returns Every line put in as changed, and the run itself if it moved the lines below it
+auto changedBy(Replaced const& replaced) -> Changed;
+
+/// Which side of each cursor a byte is deleted from
+enum class Direction
+{
+  /// The byte before the cursor, as Backspace does. At the start of a line, the line is joined to the one above
+  Backward,
+  /// The byte under the cursor, as Delete does. At the end of a line, the line below is joined to it
+  Forward
+};
+
+/// Sort cursors and drop all but one of those in the same place
+/// \param[in,out] cursors The cursors
+void normalize(std::vector<Cursor>& cursors);
+
+/// Insert text at every cursor
+/// \param[in,out] document The document being edited
+/// \param[in,out] cursors The cursors, sorted by normalize(). Each one ends up just after the text inserted at it
+/// \param[in] text The text. Lines may be broken by "\n", "\r\n" or a lone "\r"
+/// \returns What the edit changed
+auto insertAt(Document& document, std::span<Cursor> cursors, std::string_view text) -> Changed;
+
+/// Delete a byte next to every cursor
+/// \param[in,out] document The document being edited
+/// \param[in,out] cursors The cursors, sorted by normalize(). Cursors may end up in the same place, e.g. when two
+/// lines are joined
+/// \param[in] direction Which side of each cursor to delete from
+/// \returns What the edit changed
+auto eraseAt(Document& document, std::span<Cursor> cursors, Direction direction) -> Changed;
+
+}   // namespace Kilo::editor
+
+#endif
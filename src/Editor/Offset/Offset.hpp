@@ -32,6 +32,8 @@ struct Offset
 {
   std::int64_t row{};
   std::int64_t col{};
+
+  friend constexpr auto operator==(Offset const&, Offset const&) -> bool = default;
 };
 
 } // namespace Kilo::editor
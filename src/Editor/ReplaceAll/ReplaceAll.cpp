@@ -0,0 +1,200 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ReplaceAll.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+namespace Kilo::editor {
+
+auto replaceLines(Document const& document, std::size_t first, std::size_t count, std::string_view pattern,
+                  std::string_view replacement, std::vector<std::size_t>& lines, std::vector<std::size_t>& ends,
+                  std::string& text) -> std::size_t
+{
+  std::size_t matches {};
+
+  for (auto index = first; index < first + count; index++) {
+    auto const line = document.line(index);
+    auto at = line.find(pattern);
+
+    // Most lines have no match, and cost a single search
+    if (at == std::string_view::npos) {
+      continue;
+    }
+
+    std::size_t from {};
+
+    while (at != std::string_view::npos) {
+      text.append(line.substr(from, at - from)).append(replacement);
+      from = at + pattern.size();
+      at = line.find(pattern, from);
+      matches++;
+    }
+
+    text.append(line.substr(from));
+    lines.push_back(index);
+    ends.push_back(text.size());
+  }
+
+  return matches;
+}
+
+ReplaceAll::ReplaceAll(std::size_t chunkBytes) : m_chunkBytes(std::max(chunkBytes, std::size_t {1})) {}
+
+void ReplaceAll::start(WorkerPool& workers, Document const& document, std::string_view pattern,
+                       std::string_view replacement)
+{
+  cancel();
+  m_started = true;
+  m_searched = document;
+
+  // Matches are found within lines, so a text spanning lines would never match
+  auto const valid = !pattern.empty() and pattern.find('\n') == std::string_view::npos and
+                     replacement.find('\n') == std::string_view::npos;
+  auto const lineCount = valid ? document.lineCount() : 0;
+
+  // Chunks end at the end of a line, so that each of them takes around the same time however long the lines are
+  for (std::size_t first {}; first < lineCount;) {
+    auto const end = document.lineOffset(first) + m_chunkBytes;
+    auto const last = end >= document.byteCount() ? lineCount : std::max(first + 1, document.lineAt(end));
+
+    m_chunks.push_back(
+      Chunk {.first = first, .count = last - first, .matches = 0, .lines = {}, .ends = {}, .text = {}});
+    first = last;
+  }
+
+  m_pending = m_chunks.size();
+  m_posted.clear();
+
+  for (std::size_t chunk = 0; chunk < m_chunks.size(); chunk++) {
+    m_posted.push_back(Job {.chunk = chunk,
+                            .first = m_chunks[chunk].first,
+                            .count = m_chunks[chunk].count,
+                            .pattern = std::string(pattern),
+                            .replacement = std::string(replacement)});
+  }
+
+  m_jobs.post(workers, document, m_posted);
+}
+
+void ReplaceAll::cancel()
+{
+  // Jobs already running are dropped when they are collected
+  m_jobs.restart();
+
+  m_started = false;
+  m_chunks.clear();
+  m_pending = 0;
+  m_matches = 0;
+  m_lines = 0;
+  m_searched = Document();
+  m_replaced = Document();
+  m_applying = false;
+  m_chunk = 0;
+  m_line = 0;
+}
+
+auto ReplaceAll::collect() -> bool
+{
+  auto updated = false;
+
+  m_jobs.collect([this, &updated](Result& result) {
+    auto& chunk = m_chunks[result.chunk];
+    chunk.matches = result.matches;
+    chunk.lines = std::move(result.lines);
+    chunk.ends = std::move(result.ends);
+    chunk.text = std::move(result.text);
+
+    m_pending--;
+    m_matches += chunk.matches;
+    m_lines += chunk.lines.size();
+    updated = true;
+  });
+
+  return updated;
+}
+
+auto ReplaceAll::preview() const noexcept -> std::optional<ReplacedLine>
+{
+  auto const chunk = std::ranges::find_if(m_chunks, [](Chunk const& chunk) { return !chunk.lines.empty(); });
+
+  if (chunk == m_chunks.end()) {
+    return std::nullopt;
+  }
+
+  return ReplacedLine {.line = chunk->lines.front(), .text = std::string_view(chunk->text).substr(0, chunk->ends[0])};
+}
+
+auto ReplaceAll::apply(std::size_t budget) -> bool
+{
+  // The copy shares its nodes with the document searched, and only those on the path to a line that is replaced are
+  // copied
+  if (!std::exchange(m_applying, true)) {
+    m_replaced = m_searched;
+  }
+
+  for (; m_chunk < m_chunks.size(); m_chunk++, m_line = 0) {
+    auto& chunk = m_chunks[m_chunk];
+
+    for (; m_line < chunk.lines.size(); m_line++) {
+      if (budget-- == 0) {
+        return false;
+      }
+
+      auto const begin = m_line == 0 ? 0 : chunk.ends[m_line - 1];
+      auto const text = std::string_view(chunk.text).substr(begin, chunk.ends[m_line] - begin);
+      m_replaced.replaceLine(chunk.lines[m_line], text);
+    }
+
+    // The text of the chunk is in the document now
+    std::string().swap(chunk.text);
+  }
+
+  return true;
+}
+
+auto ReplaceAll::take(Document& document) -> Changed
+{
+  Changed changed {.lines = {}, .lineCount = false, .runs = {}};
+  changed.lines.reserve(m_lines);
+
+  for (auto const& chunk : m_chunks) {
+    changed.lines.insert(changed.lines.end(), chunk.lines.begin(), chunk.lines.end());
+  }
+
+  document = std::move(m_replaced);
+  cancel();
+  return changed;
+}
+
+auto ReplaceAll::work(Job const& job, Document const& document) -> Result
+{
+  auto result = Result {.chunk = job.chunk, .matches = 0, .lines = {}, .ends = {}, .text = {}};
+  result.matches =
+    replaceLines(document, job.first, job.count, job.pattern, job.replacement, result.lines, result.ends, result.text);
+  return result;
+}
+
+}   // namespace Kilo::editor
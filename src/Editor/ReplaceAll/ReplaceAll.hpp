@@ -0,0 +1,217 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef REPLACE_ALL_HPP
+#define REPLACE_ALL_HPP
+
+#include "Editor/Document/Document.hpp"
+#include "Editor/MultiCursor/MultiCursor.hpp"
+#include "Editor/WorkerPool/BackgroundJobs.hpp"
+#include "Editor/WorkerPool/WorkerPool.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Kilo::editor {
+
+// Replaces every match of a text throughout a document, as one edit.
+//
+// The document is split into chunks of around the same number of bytes, and
+// workers find the matches in each chunk at once. A worker writes the lines
+// it changed, with their replacements made, one after another into a string
+// of its own, so that nothing is done line by line on the main thread until
+// the replacement is applied. The counts and the first line changed can be
+// shown as the chunks come in, before anything has been replaced.
+//
+// Applying the replacement only touches the lines that changed. They are
+// replaced in batches in a copy of the document, which shares every other
+// line with it, and the copy is only swapped in once all of them are. Until
+// then the document stays as it was, so the swap is a single edit that is
+// undone in one step.
+
+/// A line changed by replacing every match in it
+struct ReplacedLine
+{
+  std::size_t line;
+
+  /// The text of the line after the replacement
+  std::string_view text;
+};
+
+/// Replace every match of a text in some lines of a document, from left to right without overlapping
+/// \param[in] document The document
+/// \param[in] first The first line searched
+/// \param[in] count The number of lines searched
+/// \param[in] pattern The text replaced, which must not be empty or contain a newline
+/// \param[in] replacement The text it is replaced with, which must not contain a newline
+/// \param[out] lines The number of every line that changed is appended to this, in order
+/// \param[out] ends The end of the text of every line that changed within text is appended to this
+/// \param[out] text The text of every line that changed is appended to this, after the replacement
+/// \returns The number of matches
+auto replaceLines(Document const& document, std::size_t first, std::size_t count, std::string_view pattern,
+                  std::string_view replacement, std::vector<std::size_t>& lines, std::vector<std::size_t>& ends,
+                  std::string& text) -> std::size_t;
+
+class ReplaceAll
+{
+public:
+  /// The number of bytes in a chunk when the document is split up
+  static constexpr std::size_t ChunkBytes = 4 * 1024 * 1024;
+
+  /// Create a replacement that hasn't been started
+  /// \param[in] chunkBytes The number of bytes in a chunk. A chunk always has at least one line
+  explicit ReplaceAll(std::size_t chunkBytes = ChunkBytes);
+
+  ReplaceAll(ReplaceAll const&) = delete;
+  auto operator=(ReplaceAll const&) -> ReplaceAll& = delete;
+  ReplaceAll(ReplaceAll&&) = delete;
+  auto operator=(ReplaceAll&&) -> ReplaceAll& = delete;
+
+  /// Start finding the matches of a text in a document, dropping whatever was found before
+  /// \param[in] workers The workers that search the chunks
+  /// \param[in] document The document, which is searched as it is now
+  /// \param[in] pattern The text replaced
+  /// \param[in] replacement The text it is replaced with. Nothing is found if either contains a newline, or the
+  /// pattern is empty
+  void start(WorkerPool& workers, Document const& document, std::string_view pattern, std::string_view replacement);
+
+  /// Drop the search and whatever it found, including any replacement being applied
+  void cancel();
+
+  /// Take in the chunks that workers have finished with
+  /// \returns true if any was taken in
+  auto collect() -> bool;
+
+  /// Check whether a search was started and not cancelled since
+  [[nodiscard]] constexpr auto started() const noexcept -> bool
+  {
+    return m_started;
+  }
+
+  /// Check whether every chunk has been searched
+  [[nodiscard]] constexpr auto complete() const noexcept -> bool
+  {
+    return m_pending == 0;
+  }
+
+  /// Get the number of chunks the document is split into
+  [[nodiscard]] constexpr auto chunkCount() const noexcept -> std::size_t
+  {
+    return m_chunks.size();
+  }
+
+  /// Get the number of chunks still waiting to be searched
+  [[nodiscard]] constexpr auto pending() const noexcept -> std::size_t
+  {
+    return m_pending;
+  }
+
+  /// Get the number of matches found so far
+  [[nodiscard]] constexpr auto matches() const noexcept -> std::size_t
+  {
+    return m_matches;
+  }
+
+  /// Get the number of lines found so far that the replacement changes
+  [[nodiscard]] constexpr auto lines() const noexcept -> std::size_t
+  {
+    return m_lines;
+  }
+
+  /// Get the first line the replacement changes among the chunks searched so far
+  [[nodiscard]] auto preview() const noexcept -> std::optional<ReplacedLine>;
+
+  /// Replace some more of the lines that change, in a copy of the document that was searched
+  /// \param[in] budget The number of lines replaced at most
+  /// \returns true once every line has been replaced
+  /// \pre complete() must be true
+  auto apply(std::size_t budget) -> bool;
+
+  /// Take the document with every line replaced, once apply() has returned true, and end the replacement
+  /// \param[out] document The document after the replacement
+  /// \returns The lines that changed
+  auto take(Document& document) -> Changed;
+
+private:
+  struct Chunk
+  {
+    std::size_t first;
+    std::size_t count;
+
+    std::size_t matches;
+    std::vector<std::size_t> lines;
+    std::vector<std::size_t> ends;
+    std::string text;
+  };
+
+  struct Job
+  {
+    std::size_t chunk;
+    std::size_t first;
+    std::size_t count;
+    std::string pattern;
+    std::string replacement;
+  };
+
+  struct Result
+  {
+    std::size_t chunk;
+    std::size_t matches;
+    std::vector<std::size_t> lines;
+    std::vector<std::size_t> ends;
+    std::string text;
+  };
+
+  /// Search the lines of a chunk
+  static auto work(Job const& job, Document const& document) -> Result;
+
+  std::size_t m_chunkBytes;
+  bool m_started {};
+
+  std::vector<Chunk> m_chunks;
+  std::size_t m_pending {};
+  std::size_t m_matches {};
+  std::size_t m_lines {};
+
+  // The document searched, and the copy of it the replacement is applied to once it is, up to the chunk and the line
+  // in it that is replaced next
+  Document m_searched;
+  Document m_replaced;
+  bool m_applying {};
+  std::size_t m_chunk {};
+  std::size_t m_line {};
+
+  // The chunks being searched. Restarted by every search started or cancelled, and destroying them waits for those
+  // the workers have started on
+  BackgroundJobs<Job, Result> m_jobs {work};
+
+  // Kept to reuse its capacity
+  std::vector<Job> m_posted;
+};
+
+}   // namespace Kilo::editor
+
+#endif
@@ -25,19 +25,40 @@
 #define SCREEN_BUFFER_HPP
 
 #include "File/File.hpp"
+#include "Utilities/Constants.hpp"
+#include <fmt/format.h>
 #include <string>
 #include <string_view>
 
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
 namespace Kilo::editor {
 // In order to avoid making multiple ::write() calls anytime we need to refresh
 // the screen, we will do one big ::write() at the end to make sure the entire
 // screen updates at once. This is accomplished by the use of a buffer to which
 // strings will be appended, and then this buffer will be written out at the
 // end.
+//
+// Commands for the terminal are written through typed member functions.
+// Parameterized ones are formatted straight into the buffer, which keeps its
+// capacity from one frame to the next, so drawing a frame no larger than the
+// previous one doesn't allocate.
 
 class ScreenBuffer
 {
 public:
+  /// What part of the line the cursor is on to erase
+  enum class Erase : std::uint8_t
+  {
+    ToTheRight = 0,
+    ToTheLeft = 1,
+    WholeLine = 2
+  };
+
   explicit constexpr ScreenBuffer() noexcept = default;
 
   /// @brief Append the given C-string to the buffer
@@ -60,6 +81,74 @@ public:
     return *this;
   }
 
+  /// @brief Append a run of the same character, e.g. padding
+  /// @param[in] count The number of characters
+  /// @param[in] character The character
+  constexpr auto fill(std::size_t count, char character = ' ') -> ScreenBuffer&
+  {
+    m_buffer.append(count, character);
+    return *this;
+  }
+
+  /// @brief Move the cursor to a position on the screen (CUP)
+  /// @param[in] row The row, counting from 1
+  /// @param[in] col The column, counting from 1
+  auto moveCursorTo(std::int64_t row, std::int64_t col) -> ScreenBuffer&
+  {
+    fmt::format_to(std::back_inserter(m_buffer), "\x1b[{};{}H", row, col);
+    return *this;
+  }
+
+  /// @brief Erase part of the line the cursor is on (EL)
+  /// @param[in] what The part of the line to erase
+  auto eraseInLine(Erase what = Erase::ToTheRight) -> ScreenBuffer&
+  {
+    if (what == Erase::ToTheRight) {
+      return write(EscapeSequences::ErasePartOfLineToTheRightOfCursor);
+    }
+
+    fmt::format_to(std::back_inserter(m_buffer), "\x1b[{}K", static_cast<int>(what));
+    return *this;
+  }
+
+  /// @brief Confine scrolling to a band of rows of the screen (DECSTBM). The terminal moves the cursor home
+  /// @param[in] top The first row of the band, counting from 1
+  /// @param[in] bottom The last row of the band, counting from 1
+  auto setScrollingMargins(std::int64_t top, std::int64_t bottom) -> ScreenBuffer&
+  {
+    fmt::format_to(std::back_inserter(m_buffer), "\x1b[{};{}r", top, bottom);
+    return *this;
+  }
+
+  /// @brief Set the attributes of the characters written after this (SGR). No parameters resets them
+  /// @param[in] parameters The attributes, e.g. 7 for inverse video or 38, 5, n for a foreground colour
+  template <std::integral... Parameters>
+  auto selectGraphicRendition(Parameters... parameters) -> ScreenBuffer&
+  {
+    m_buffer.append("\x1b[");
+
+    if constexpr (sizeof...(parameters) > 0) {
+      auto separator = std::string_view {};
+      ((fmt::format_to(std::back_inserter(m_buffer), "{}{}", std::exchange(separator, ";"), parameters)), ...);
+    }
+
+    m_buffer.push_back('m');
+    return *this;
+  }
+
+  /// @brief Exchange the contents of the buffer with a string, e.g. to hand a finished frame over without copying it
+  /// @param[in] other The string
+  constexpr void swap(std::string& other) noexcept
+  {
+    m_buffer.swap(other);
+  }
+
+  /// @brief Empty the buffer, keeping its capacity for the next frame
+  constexpr void clear() noexcept
+  {
+    m_buffer.clear();
+  }
+
   /// @brief Get the size of the buffer
   /// @returns The size of the buffer
   [[nodiscard]] constexpr auto size() const noexcept -> std::size_t
@@ -0,0 +1,290 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "SortLines.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Kilo::editor {
+
+namespace {
+
+// Below this many lines, handing out runs costs more than sorting them on one thread
+constexpr std::size_t MinParallel = std::size_t {1} << 16;
+
+// A run of at most this share of the document is rewritten line by line in place, rather than rebuilding the
+// whole document
+constexpr std::size_t InPlaceShare = 8;
+
+/// A line with where it was in the run, which orders repeats of a line by how far down they were
+struct Entry
+{
+  std::string_view text;
+  std::size_t index;
+};
+
+// Run a task for every number below a count, the first on this thread and the rest on the workers, and wait for
+// all of them. The rest go ahead of whatever the workers have queued, as this thread is held up until they finish
+template <typename Task>
+void runEach(WorkerPool& workers, std::size_t count, Task const& task)
+{
+  // Shared with the tasks, so that the last of them to finish doesn't notify after the wait has returned
+  struct Latch
+  {
+    std::mutex mutex;
+    std::condition_variable done;
+    std::size_t left {};
+  };
+
+  auto const latch = std::make_shared<Latch>();
+  latch->left = count;
+
+  auto const finish = [](Latch& latch) {
+    std::scoped_lock const lock(latch.mutex);
+
+    if (--latch.left == 0) {
+      latch.done.notify_all();
+    }
+  };
+
+  for (std::size_t i = 1; i < count; i++) {
+    workers.postFirst([&task, latch, finish, i] {
+      task(i);
+      finish(*latch);
+    });
+  }
+
+  task(0);
+  finish(*latch);
+
+  std::unique_lock lock(latch->mutex);
+  latch->done.wait(lock, [&latch] { return latch->left == 0; });
+}
+
+// Find how many of the first items of a merge of two sorted runs come from the first run, where items of the first
+// run come before equal items of the second
+template <typename T, typename Less>
+auto mergePath(std::span<T const> a, std::span<T const> b, std::size_t items, Less const& less) -> std::size_t
+{
+  auto low = items > b.size() ? items - b.size() : 0;
+  auto high = std::min(items, a.size());
+
+  while (low < high) {
+    auto const middle = low + (high - low) / 2;
+
+    if (less(b[items - middle - 1], a[middle])) {
+      high = middle;
+    }
+    else {
+      low = middle + 1;
+    }
+  }
+
+  return low;
+}
+
+// Merge sort items on the workers and this thread. Each sorts a run of the items, and then pairs of runs are merged
+// until one is left, each merge split into as many pieces as there are threads to go round
+template <typename T, typename Less>
+void parallelSort(WorkerPool& workers, std::span<T> items, Less const& less)
+{
+  auto const threads = workers.size() + 1;
+
+  if (threads == 1 or items.size() < MinParallel) {
+    std::sort(items.begin(), items.end(), less);
+    return;
+  }
+
+  std::vector<std::size_t> bounds;
+
+  for (std::size_t i = 0; i <= threads; i++) {
+    bounds.push_back(items.size() * i / threads);
+  }
+
+  runEach(workers, threads, [&](std::size_t run) {
+    std::sort(items.begin() + static_cast<std::ptrdiff_t>(bounds[run]),
+              items.begin() + static_cast<std::ptrdiff_t>(bounds[run + 1]), less);
+  });
+
+  std::vector<T> buffer(items.size());
+  std::span<T> from = items;
+  std::span<T> to = buffer;
+
+  while (bounds.size() > 2) {
+    auto const runs = bounds.size() - 1;
+    auto const pairs = (runs + 1) / 2;
+    auto const pieces = (threads + pairs - 1) / pairs;
+
+    runEach(workers, pairs * pieces, [&](std::size_t task) {
+      auto const pair = task / pieces;
+      auto const piece = task % pieces;
+      auto const begin = bounds[2 * pair];
+      auto const middle = bounds[std::min(2 * pair + 1, runs)];
+      auto const end = bounds[std::min(2 * pair + 2, runs)];
+
+      auto const a = std::span<T const>(from.subspan(begin, middle - begin));
+      auto const b = std::span<T const>(from.subspan(middle, end - middle));
+      auto const start = (end - begin) * piece / pieces;
+      auto const stop = (end - begin) * (piece + 1) / pieces;
+      auto const aStart = mergePath(a, b, start, less);
+      auto const aStop = mergePath(a, b, stop, less);
+
+      std::merge(a.begin() + static_cast<std::ptrdiff_t>(aStart), a.begin() + static_cast<std::ptrdiff_t>(aStop),
+                 b.begin() + static_cast<std::ptrdiff_t>(start - aStart),
+                 b.begin() + static_cast<std::ptrdiff_t>(stop - aStop),
+                 to.begin() + static_cast<std::ptrdiff_t>(begin + start), less);
+    });
+
+    std::vector<std::size_t> merged;
+
+    for (std::size_t i = 0; i < bounds.size(); i += 2) {
+      merged.push_back(bounds[i]);
+    }
+
+    if (merged.back() != items.size()) {
+      merged.push_back(items.size());
+    }
+
+    bounds = std::move(merged);
+    std::swap(from, to);
+  }
+
+  if (from.data() != items.data()) {
+    runEach(workers, threads, [&](std::size_t part) {
+      auto const begin = items.size() * part / threads;
+      auto const end = items.size() * (part + 1) / threads;
+      std::copy(from.begin() + static_cast<std::ptrdiff_t>(begin), from.begin() + static_cast<std::ptrdiff_t>(end),
+                items.begin() + static_cast<std::ptrdiff_t>(begin));
+    });
+  }
+}
+
+// Leave out every line that repeats one above it. Sorting the lines with where they were brings each line next to
+// its repeats, the first of them in front
+void uniqueLines(WorkerPool& workers, std::vector<std::string_view>& lines)
+{
+  std::vector<Entry> entries;
+  entries.reserve(lines.size());
+
+  for (std::size_t i = 0; i < lines.size(); i++) {
+    entries.push_back({.text = lines[i], .index = i});
+  }
+
+  parallelSort(workers, std::span(entries), [](Entry const& left, Entry const& right) {
+    auto const order = left.text.compare(right.text);
+    return order < 0 or (order == 0 and left.index < right.index);
+  });
+
+  std::vector<bool> kept(lines.size());
+
+  for (std::size_t i = 0; i < entries.size(); i++) {
+    kept[entries[i].index] = i == 0 or entries[i].text != entries[i - 1].text;
+  }
+
+  std::size_t next = 0;
+
+  for (std::size_t i = 0; i < lines.size(); i++) {
+    if (kept[i]) {
+      lines[next++] = lines[i];
+    }
+  }
+
+  lines.resize(next);
+}
+
+}   // namespace
+
+void sortLines(WorkerPool& workers, std::span<std::string_view> lines)
+{
+  parallelSort(workers, lines, std::less<std::string_view> {});
+}
+
+auto reorderLines(WorkerPool& workers, Document& document, std::size_t first, std::size_t count, LineOrder order)
+  -> std::size_t
+{
+  assert(first + count <= document.lineCount() and "Line range out of range");
+
+  // The copy keeps the text of the views alive however the document is changed
+  Document const before = document;
+
+  std::vector<std::string_view> lines;
+  lines.reserve(count);
+
+  for (std::size_t i = 0; i < count; i++) {
+    lines.push_back(before.line(first + i));
+  }
+
+  switch (order) {
+    case LineOrder::Sorted:
+      sortLines(workers, lines);
+      break;
+    case LineOrder::Unique:
+      uniqueLines(workers, lines);
+      break;
+    case LineOrder::Reversed:
+      std::reverse(lines.begin(), lines.end());
+      break;
+  }
+
+  if (count <= before.lineCount() / InPlaceShare) {
+    for (std::size_t i = 0; i < lines.size(); i++) {
+      if (lines[i] != before.line(first + i)) {
+        document.replaceLine(first + i, lines[i]);
+      }
+    }
+
+    for (std::size_t i = lines.size(); i < count; i++) {
+      document.eraseLine(first + lines.size());
+    }
+
+    return lines.size();
+  }
+
+  Document rebuilt;
+
+  for (std::size_t i = 0; i < first; i++) {
+    rebuilt.append(before.line(i));
+  }
+
+  for (auto const line : lines) {
+    rebuilt.append(line);
+  }
+
+  for (std::size_t i = first + count; i < before.lineCount(); i++) {
+    rebuilt.append(before.line(i));
+  }
+
+  document = std::move(rebuilt);
+
+  return lines.size();
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,78 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SORT_LINES_HPP
+#define SORT_LINES_HPP
+
+#include "Editor/Document/Document.hpp"
+#include "Editor/WorkerPool/WorkerPool.hpp"
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+namespace Kilo::editor {
+
+// Puts a run of lines of a document in another order: sorted, with repeated
+// lines left out, or reversed.
+//
+// Nothing is copied to be sorted. The lines are sorted as views of their text
+// in a copy of the document, which shares its nodes with the document and
+// keeps the text alive while the document is rebuilt in the new order. The
+// views are sorted by a merge sort: the workers and the calling thread each
+// sort a run of them, and the runs are then merged in pairs, with every merge
+// split between all of them along the merge path, until one run is left.
+//
+// Sorting blocks the calling thread until it is done, which leaves the
+// document as it was before or after the whole edit, so it is undone in one
+// step.
+
+/// The orders lines can be put in
+enum class LineOrder
+{
+  /// Sorted by their bytes
+  Sorted,
+  /// In the same order, leaving out every line that repeats one above it
+  Unique,
+  /// Last to first
+  Reversed,
+};
+
+/// Sort views of lines by their bytes, on the workers and the calling thread at once
+/// \param[in] workers The workers that sort and merge runs of the views
+/// \param[in,out] lines The views
+void sortLines(WorkerPool& workers, std::span<std::string_view> lines);
+
+/// Put a run of lines of a document in another order
+/// \param[in] workers The workers that sort the lines
+/// \param[in,out] document The document
+/// \param[in] first The first line of the run
+/// \param[in] count The number of lines in the run
+/// \param[in] order The order the lines are put in
+/// \returns The number of lines in the run afterwards, which is only fewer when repeated lines are left out
+auto reorderLines(WorkerPool& workers, Document& document, std::size_t first, std::size_t count, LineOrder order)
+  -> std::size_t;
+
+}   // namespace Kilo::editor
+
+#endif
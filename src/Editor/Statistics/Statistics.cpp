@@ -0,0 +1,254 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Statistics.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+namespace Kilo::editor {
+
+auto Statistics::operator+=(Statistics const& other) noexcept -> Statistics&
+{
+  lines += other.lines;
+  words += other.words;
+  bytes += other.bytes;
+  longestLine = std::max(longestLine, other.longestLine);
+  nonAscii += other.nonAscii;
+  return *this;
+}
+
+auto Statistics::nonAsciiRatio() const noexcept -> double
+{
+  return bytes == 0 ? 0.0 : static_cast<double>(nonAscii) / static_cast<double>(bytes);
+}
+
+auto countLines(Document const& document, std::size_t first, std::size_t count) -> Statistics
+{
+  auto statistics = Statistics {.lines = count, .words = 0, .bytes = 0, .longestLine = 0, .nonAscii = 0};
+
+  for (auto index = first; index < first + count; index++) {
+    auto const line = document.line(index);
+    statistics.bytes += line.size() + 1;
+    statistics.longestLine = std::max(statistics.longestLine, line.size());
+
+    // Words can't run on past the end of a line. Counting where they start rather than branching on each byte lets
+    // the compiler vectorise the loop
+    auto blank = true;
+
+    for (auto const c : line) {
+      auto const byte = static_cast<unsigned char>(c);
+      auto const isBlank = byte == ' ' or (byte >= '\t' and byte <= '\r');
+      statistics.words += static_cast<std::size_t>(blank and !isBlank);
+      statistics.nonAscii += static_cast<std::size_t>(byte >> 7U);
+      blank = isBlank;
+    }
+  }
+
+  return statistics;
+}
+
+DocumentStatistics::DocumentStatistics(std::size_t chunkLines) : m_chunkLines(std::max(chunkLines, std::size_t {1})) {}
+
+void DocumentStatistics::replaced(WorkerPool& workers, Document const& document, std::size_t first)
+{
+  auto const since = m_nextTicket;
+  first = std::min({first, m_lineCount, document.lineCount()});
+
+  replace(first, m_lineCount - first, document.lineCount() - first);
+  m_lineCount = document.lineCount();
+  dispatch(workers, document, since);
+}
+
+void DocumentStatistics::changed(WorkerPool& workers, Document const& document, Changed const& changed)
+{
+  auto const since = m_nextTicket;
+  auto const& lines = changed.lines;
+  auto const lineCount = document.lineCount();
+
+  if (!changed.lineCount) {
+    // The changed lines are sorted, so the chunks they are in are found in a single pass
+    auto chunk = m_chunks.begin();
+    std::size_t start {};
+
+    for (auto const line : lines) {
+      while (chunk != m_chunks.end() and start + chunk->lines <= line) {
+        start += chunk->lines;
+        ++chunk;
+      }
+
+      if (chunk == m_chunks.end()) {
+        break;
+      }
+
+      if (chunk->ticket < since) {
+        touch(*chunk);
+      }
+    }
+  }
+  else {
+    // An edit at a single cursor replaced a run of lines, while edits at several cursors may have moved everything
+    // after the first of them
+    auto const [first, removed, added] = replacedLines(changed, m_lineCount, lineCount);
+    replace(first, removed, added);
+  }
+
+  m_lineCount = lineCount;
+  dispatch(workers, document, since);
+}
+
+auto DocumentStatistics::collect() -> bool
+{
+  auto updated = false;
+
+  m_jobs.collect([this, &updated](Result const& result) {
+    // A chunk that changed again while it was being counted has a newer ticket, and its count is dropped
+    auto const chunk = std::ranges::find(m_chunks, result.ticket, &Chunk::ticket);
+
+    if (chunk != m_chunks.end()) {
+      chunk->counted = result.statistics;
+      chunk->ticket = 0;
+      updated = true;
+    }
+  });
+
+  if (updated) {
+    total();
+  }
+
+  return updated;
+}
+
+auto DocumentStatistics::work(Job const& job, Document const& document) -> Result
+{
+  return Result {.ticket = job.ticket, .statistics = countLines(document, job.first, job.count)};
+}
+
+void DocumentStatistics::replace(std::size_t first, std::size_t removed, std::size_t added)
+{
+  if (m_chunks.empty()) {
+    m_chunks.push_back(Chunk {.lines = 0, .counted = {}, .ticket = 0});
+  }
+
+  // The chunks the first and last of the lines taken out are in. Lines added at the end go into the last chunk
+  std::size_t start {};
+  std::size_t firstChunk {};
+
+  while (firstChunk + 1 < m_chunks.size() and start + m_chunks[firstChunk].lines <= first) {
+    start += m_chunks[firstChunk++].lines;
+  }
+
+  auto lastChunk = firstChunk;
+  auto end = start + m_chunks[firstChunk].lines;
+
+  while (lastChunk + 1 < m_chunks.size() and end < first + removed) {
+    end += m_chunks[++lastChunk].lines;
+  }
+
+  // Every one of the chunks is counted again, so it doesn't matter which of them the lines are added to or taken
+  // from, only that they add up
+  m_chunks[lastChunk].lines += added;
+
+  for (auto chunk = lastChunk + 1; chunk-- > firstChunk and removed > 0;) {
+    auto const taken = std::min(removed, m_chunks[chunk].lines);
+    m_chunks[chunk].lines -= taken;
+    removed -= taken;
+  }
+
+  for (auto chunk = firstChunk; chunk <= lastChunk; chunk++) {
+    touch(m_chunks[chunk]);
+  }
+
+  auto const begin = m_chunks.begin() + static_cast<std::ptrdiff_t>(firstChunk);
+  auto const stop = m_chunks.begin() + static_cast<std::ptrdiff_t>(lastChunk + 1);
+  auto const emptied = std::distance(std::remove_if(begin, stop, [](Chunk const& chunk) { return chunk.lines == 0; }),
+                                     stop);
+  m_chunks.erase(stop - emptied, stop);
+  lastChunk -= static_cast<std::size_t>(emptied);
+
+  // A chunk that grew too large is split, so that the lines it gained are counted by several workers. Whatever it
+  // counted before stays with its first part
+  for (auto chunk = firstChunk; chunk <= lastChunk and chunk < m_chunks.size(); chunk++) {
+    if (m_chunks[chunk].lines > 2 * m_chunkLines) {
+      auto const rest = m_chunks[chunk].lines - m_chunkLines;
+      m_chunks[chunk].lines = m_chunkLines;
+      m_chunks.insert(m_chunks.begin() + static_cast<std::ptrdiff_t>(chunk + 1),
+                      Chunk {.lines = rest, .counted = {}, .ticket = 0});
+      touch(m_chunks[chunk + 1]);
+      lastChunk++;
+    }
+  }
+}
+
+void DocumentStatistics::touch(Chunk& chunk) noexcept
+{
+  chunk.ticket = m_nextTicket++;
+}
+
+void DocumentStatistics::dispatch(WorkerPool& workers, Document const& document, std::uint64_t since)
+{
+  // Jobs queued for chunks that changed again, or are gone, count lines that have changed since
+  m_tickets.clear();
+
+  for (auto const& chunk : m_chunks) {
+    if (chunk.ticket != 0 and chunk.ticket < since) {
+      m_tickets.push_back(chunk.ticket);
+    }
+  }
+
+  std::ranges::sort(m_tickets);
+  m_jobs.dropIf([this](Job const& job) { return !std::ranges::binary_search(m_tickets, job.ticket); });
+
+  m_posted.clear();
+  std::size_t first {};
+
+  for (auto const& chunk : m_chunks) {
+    if (chunk.ticket >= since) {
+      m_posted.push_back(Job {.ticket = chunk.ticket, .first = first, .count = chunk.lines});
+    }
+
+    first += chunk.lines;
+  }
+
+  m_jobs.post(workers, document, m_posted);
+  total();
+}
+
+void DocumentStatistics::total() noexcept
+{
+  m_totals = Statistics {};
+  m_pending = 0;
+
+  for (auto const& chunk : m_chunks) {
+    m_totals += chunk.counted;
+    m_pending += static_cast<std::size_t>(chunk.ticket != 0);
+  }
+
+  // Lines are counted by the chunks themselves, so their number is right even while they are being counted
+  m_totals.lines = m_lineCount;
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,194 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef STATISTICS_HPP
+#define STATISTICS_HPP
+
+#include "Editor/Document/Document.hpp"
+#include "Editor/MultiCursor/MultiCursor.hpp"
+#include "Editor/WorkerPool/BackgroundJobs.hpp"
+#include "Editor/WorkerPool/WorkerPool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Kilo::editor {
+
+// Counts of what a document is made of, kept up to date as it is edited.
+//
+// The lines are split into chunks of around the same number of lines, each of
+// which is counted on its own by a worker and added up with the others. An
+// edit only has the chunks it touched counted again. Lines added or removed
+// change the size of the chunk they were in, rather than moving the chunks
+// after it, so those are left alone. Chunks that grew too large are split.
+//
+// Until a chunk has been counted again, the totals include its counts from
+// before the edit, so they change by little while workers catch up.
+
+/// What some lines of a document are made of
+struct Statistics
+{
+  std::size_t lines;
+
+  /// Runs of bytes other than blanks
+  std::size_t words;
+
+  /// The bytes of the lines, counting one newline per line
+  std::size_t bytes;
+
+  /// The length of the longest line in bytes, without its newline
+  std::size_t longestLine;
+
+  /// The bytes with the high bit set, which are part of characters outside ASCII
+  std::size_t nonAscii;
+
+  /// Add the counts of lines that come after these
+  auto operator+=(Statistics const& other) noexcept -> Statistics&;
+
+  auto operator==(Statistics const&) const -> bool = default;
+
+  /// Get the share of the bytes that are part of characters outside ASCII
+  [[nodiscard]] auto nonAsciiRatio() const noexcept -> double;
+};
+
+/// Count what some lines of a document are made of
+/// \param[in] document The document
+/// \param[in] first The first line counted
+/// \param[in] count The number of lines counted
+/// \pre first + count must not be more than document.lineCount()
+auto countLines(Document const& document, std::size_t first, std::size_t count) -> Statistics;
+
+class DocumentStatistics
+{
+public:
+  /// The number of lines in a chunk when the document is split up
+  static constexpr std::size_t ChunkLines = 64 * 1024;
+
+  /// Create the statistics of an empty document
+  /// \param[in] chunkLines The number of lines in a chunk. A chunk that grows to twice as many is split
+  explicit DocumentStatistics(std::size_t chunkLines = ChunkLines);
+
+  DocumentStatistics(DocumentStatistics const&) = delete;
+  auto operator=(DocumentStatistics const&) -> DocumentStatistics& = delete;
+  DocumentStatistics(DocumentStatistics&&) = delete;
+  auto operator=(DocumentStatistics&&) -> DocumentStatistics& = delete;
+
+  /// Count the chunks changed by an edit that replaced the lines from some line onwards, e.g. by appending lines
+  /// \param[in] workers The workers that count the chunks
+  /// \param[in] document The document after the edit
+  /// \param[in] first The first line that may have changed. Every line before it is the same as before
+  void replaced(WorkerPool& workers, Document const& document, std::size_t first);
+
+  /// Count the chunks changed by an edit at several cursors
+  /// \param[in] workers The workers that count the chunks
+  /// \param[in] document The document after the edit
+  /// \param[in] changed What the edit changed
+  void changed(WorkerPool& workers, Document const& document, Changed const& changed);
+
+  /// Take in the counts of the chunks that workers have finished with
+  /// \returns true if the totals changed
+  auto collect() -> bool;
+
+  /// Get the counts of the whole document. The number of lines is always exact, the rest only once complete()
+  [[nodiscard]] constexpr auto totals() const noexcept -> Statistics
+  {
+    return m_totals;
+  }
+
+  /// Check whether every chunk has been counted since it last changed
+  [[nodiscard]] constexpr auto complete() const noexcept -> bool
+  {
+    return m_pending == 0;
+  }
+
+  /// Get the number of chunks the lines are split into
+  [[nodiscard]] constexpr auto chunkCount() const noexcept -> std::size_t
+  {
+    return m_chunks.size();
+  }
+
+  /// Get the number of chunks still waiting to be counted since they last changed
+  [[nodiscard]] constexpr auto pending() const noexcept -> std::size_t
+  {
+    return m_pending;
+  }
+
+private:
+  struct Chunk
+  {
+    std::size_t lines;
+
+    // The counts of the chunk as it was last counted, which are out of date while it is counted again
+    Statistics counted;
+
+    // Set while the chunk is being counted, to match the counts that come back with it. 0 otherwise
+    std::uint64_t ticket;
+  };
+
+  struct Job
+  {
+    std::uint64_t ticket;
+    std::size_t first;
+    std::size_t count;
+  };
+
+  struct Result
+  {
+    std::uint64_t ticket;
+    Statistics statistics;
+  };
+
+  /// Count the lines of a chunk
+  static auto work(Job const& job, Document const& document) -> Result;
+
+  /// Replace some lines and count the chunks they were in again
+  void replace(std::size_t first, std::size_t removed, std::size_t added);
+
+  /// Count a chunk again, as its lines changed
+  void touch(Chunk& chunk) noexcept;
+
+  /// Hand the chunks touched since a ticket was handed out to the workers, dropping the jobs they replace
+  void dispatch(WorkerPool& workers, Document const& document, std::uint64_t since);
+
+  /// Add up the counts of every chunk
+  void total() noexcept;
+
+  std::size_t m_chunkLines;
+  std::vector<Chunk> m_chunks;
+  std::size_t m_lineCount {};
+  std::size_t m_pending {};
+  std::uint64_t m_nextTicket {1};
+  Statistics m_totals {};
+
+  // The chunks being counted. Destroying them waits for those the workers have started on
+  BackgroundJobs<Job, Result> m_jobs {work};
+
+  // Kept to reuse their capacity
+  std::vector<Job> m_posted;
+  std::vector<std::uint64_t> m_tickets;
+};
+
+}   // namespace Kilo::editor
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "StreamLoader.hpp"
+
+#include <system_error>
+
+#include <cerrno>
+#include <cstring>
+#include <string_view>
+#include <unistd.h>
+#include <utility>
+
+namespace Kilo::editor {
+
+StreamLoader::StreamLoader(int fileDescriptor, Mode mode)
+  : m_fd(fileDescriptor)
+  , m_mode(mode)
+  , m_chunk(std::make_unique_for_overwrite<char[]>(ChunkSize))
+{
+}
+
+StreamLoader::~StreamLoader()
+{
+  ::close(m_fd);
+}
+
+auto StreamLoader::pump(Document& document, std::size_t budget) -> std::size_t
+{
+  std::size_t lines = 0;
+  std::size_t total = 0;
+
+  m_caughtUp = false;
+
+  while (!m_finished and total < budget) {
+    errno = 0;
+    auto const result = ::read(m_fd, m_chunk.get() + m_pending, ChunkSize - m_pending);
+
+    if (result == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      if (errno == EAGAIN or errno == EWOULDBLOCK) {
+        m_caughtUp = true;
+        break;
+      }
+
+      throw std::system_error(errno, std::system_category(), "Could not read the document");
+    }
+
+    if (result == 0) {
+      m_caughtUp = true;
+
+      if (m_mode == Mode::UntilEnd) {
+        lines += finish(document);
+      }
+
+      break;
+    }
+
+    total += static_cast<std::size_t>(result);
+    lines += consume(document, m_pending + static_cast<std::size_t>(result));
+  }
+
+  return lines;
+}
+
+auto StreamLoader::consume(Document& document, std::size_t size) -> std::size_t
+{
+  char const* pos = m_chunk.get();
+  char const* const end = m_chunk.get() + size;
+
+  // What was left over from the last read has been scanned already, and has no newline in it
+  char const* const fresh = m_chunk.get() + m_pending;
+  m_newlines.clear();
+  m_scanner.scan(std::string_view(fresh, end), m_newlines);
+
+  for (auto const newline : m_newlines) {
+    append(document, std::string_view(pos, fresh + newline), true);
+    pos = fresh + newline + 1;
+  }
+
+  auto const lines = m_newlines.size();
+  auto const rest = static_cast<std::size_t>(end - pos);
+
+  // A line that doesn't fit into the chunk is collected separately, so that
+  // the next read has somewhere to go
+  if (rest == ChunkSize) {
+    m_longLine.append(pos, rest);
+    m_pending = 0;
+  }
+  else {
+    std::memmove(m_chunk.get(), pos, rest);
+    m_pending = rest;
+  }
+
+  return lines;
+}
+
+auto StreamLoader::finish(Document& document) -> std::size_t
+{
+  m_finished = true;
+
+  // Like std::getline, treat text after the last newline as a line of its own
+  m_longLine.append(m_chunk.get(), m_pending);
+  m_pending = 0;
+
+  if (m_longLine.empty()) {
+    return 0;
+  }
+
+  append(document, {}, false);
+
+  return 1;
+}
+
+void StreamLoader::append(Document& document, std::string_view line, bool terminated)
+{
+  if (!m_longLine.empty()) {
+    m_longLine += line;
+    line = m_longLine;
+  }
+
+  if (terminated and line.ends_with('\r')) {
+    line.remove_suffix(1);
+  }
+
+  if (std::exchange(m_firstLine, false) and m_scanner.format().byteOrderMark) {
+    line.remove_prefix(TextFormat::ByteOrderMark.size());
+  }
+
+  document.append(line);
+  m_longLine.clear();
+}
+
+}   // namespace Kilo::editor
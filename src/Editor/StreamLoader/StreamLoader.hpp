@@ -0,0 +1,138 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef STREAM_LOADER_HPP
+#define STREAM_LOADER_HPP
+
+#include "Editor/Document/Document.hpp"
+#include "Editor/TextScanner/TextScanner.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Kilo::editor {
+
+// Reads a document from a file descriptor a chunk at a time, appending each
+// line to the document as soon as its newline has arrived. This lets us show
+// the start of a document that is still being written into a pipe, without
+// waiting for the end of it.
+//
+// Bytes are read into a fixed-size chunk that is reused for the whole
+// stream. Whatever is left over after the last complete line is moved to the
+// front of the chunk and completed by the next read. Only a line longer than
+// the chunk spills into a separate string.
+//
+// Each byte read is scanned once, by a TextScanner, which finds the newlines
+// and works out the line ending and encoding of the text along the way. Lines
+// are appended without their "\r\n" or "\n", or the byte order mark at the
+// start of the first one, by shortening the view of them into the chunk.
+
+class StreamLoader
+{
+public:
+  static constexpr std::size_t ChunkSize = 64 * 1024;
+
+  /// What reaching the end of the stream means
+  enum class Mode
+  {
+    /// The document is complete, and an unterminated last line is a line of its own
+    UntilEnd,
+    /// More may still be written, e.g. to a log file, so an unterminated last line is kept back until it is completed
+    Follow
+  };
+
+  /// Create a loader for a stream
+  /// \param[in] fileDescriptor The stream to read from. The loader takes ownership of it
+  /// \param[in] mode Whether the end of the stream ends the document
+  explicit StreamLoader(int fileDescriptor, Mode mode = Mode::UntilEnd);
+
+  /// Destructor. Closes the stream
+  ~StreamLoader();
+
+  StreamLoader(StreamLoader const&) = delete;
+  auto operator=(StreamLoader const&) -> StreamLoader& = delete;
+  StreamLoader(StreamLoader&&) = delete;
+  auto operator=(StreamLoader&&) -> StreamLoader& = delete;
+
+  /// Get the stream being read from, e.g. to wait for it to become readable
+  [[nodiscard]] constexpr auto fileDescriptor() const noexcept -> int
+  {
+    return m_fd;
+  }
+
+  /// Check whether the end of the stream has been reached. A followed stream never finishes
+  [[nodiscard]] constexpr auto finished() const noexcept -> bool
+  {
+    return m_finished;
+  }
+
+  /// Check whether the last pump read everything that was available, rather than stopping because of its budget
+  [[nodiscard]] constexpr auto caughtUp() const noexcept -> bool
+  {
+    return m_caughtUp;
+  }
+
+  /// Get what the text read so far looks like
+  [[nodiscard]] auto format() const noexcept -> TextFormat
+  {
+    return m_scanner.format();
+  }
+
+  /// Read what the stream has to offer and append every line it completes to the document
+  /// \param[in] document The document being loaded
+  /// \param[in] budget Stop after reading this many bytes, so that the caller gets a chance to repaint
+  /// \returns The number of lines appended to the document
+  /// \throws std::system_error if reading from the stream fails
+  /// \details Returns early without blocking if the stream is non-blocking and has nothing to read
+  auto pump(Document& document, std::size_t budget = std::numeric_limits<std::size_t>::max()) -> std::size_t;
+
+private:
+  /// Append every complete line in the first size bytes of the chunk to the document
+  auto consume(Document& document, std::size_t size) -> std::size_t;
+
+  /// Append whatever is left of an unterminated last line once the stream has ended
+  auto finish(Document& document) -> std::size_t;
+
+  /// Append a line, or the end of a line too long for the chunk, to the document
+  /// \param[in] terminated Whether the line was followed by a newline, whose "\r" is then dropped as well
+  void append(Document& document, std::string_view line, bool terminated);
+
+  int m_fd;
+  Mode m_mode;
+  std::unique_ptr<char[]> m_chunk;
+  std::size_t m_pending {};
+  std::string m_longLine;
+  TextScanner m_scanner;
+  std::vector<std::size_t> m_newlines;
+  bool m_firstLine {true};
+  bool m_finished {};
+  bool m_caughtUp {};
+};
+
+}   // namespace Kilo::editor
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "TextScanner.hpp"
+
+#include <bit>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Kilo::editor {
+
+void TextScanner::scan(std::string_view bytes, std::vector<std::size_t>& newlines)
+{
+  // The byte order mark can only be at the very start, but the first piece may be shorter than it
+  for (auto i = m_scanned; i < TextFormat::ByteOrderMark.size() and i - m_scanned < bytes.size(); i++) {
+    m_byteOrderMark = m_byteOrderMark and bytes[i - m_scanned] == TextFormat::ByteOrderMark[i];
+  }
+
+  m_scanned += bytes.size();
+  m_format.byteOrderMark = m_byteOrderMark and m_scanned >= TextFormat::ByteOrderMark.size();
+
+  if (!bytes.empty()) {
+    m_format.finalNewline = bytes.back() == '\n';
+  }
+
+  std::size_t offset {};
+
+#if defined(__SSE2__)
+  constexpr std::size_t Width = sizeof(__m128i);
+
+  auto const lf = _mm_set1_epi8('\n');
+  auto const cr = _mm_set1_epi8('\r');
+  auto const nul = _mm_setzero_si128();
+
+  for (; offset + Width <= bytes.size(); offset += Width) {
+    auto const block = _mm_loadu_si128(reinterpret_cast<__m128i const*>(bytes.data() + offset));
+
+    // Bit i of each mask is set if byte i of the block is what the mask is for. The high bits are set by anything
+    // but ASCII
+    auto const lfs = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, lf)));
+    auto const crs = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, cr)));
+    auto const nuls = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, nul)));
+    auto const high = static_cast<std::uint32_t>(_mm_movemask_epi8(block));
+
+    if (lfs != 0) {
+      // A "\n" whose previous byte is a "\r", which for the first byte of the block is the last one of the one before
+      auto const crlfs = std::popcount(lfs & (crs << 1U | (m_afterCr ? 1U : 0U)));
+      m_format.crlfLines += static_cast<std::size_t>(crlfs);
+      m_format.lfLines += static_cast<std::size_t>(std::popcount(lfs) - crlfs);
+
+      for (auto mask = lfs; mask != 0; mask &= mask - 1) {
+        newlines.push_back(offset + static_cast<std::size_t>(std::countr_zero(mask)));
+      }
+    }
+
+    m_afterCr = (crs >> (Width - 1)) != 0;
+    m_format.binary = m_format.binary or nuls != 0;
+
+    if (m_format.validUtf8 and (high != 0 or m_continuation != 0)) {
+      for (std::size_t i = 0; i < Width; i++) {
+        validate(static_cast<unsigned char>(bytes[offset + i]));
+      }
+    }
+  }
+#endif
+
+  scanBytes(bytes.substr(offset), offset, newlines);
+}
+
+auto TextScanner::format() const noexcept -> TextFormat
+{
+  auto format = m_format;
+
+  // A character cut off by the end of the text is as invalid as any other
+  format.validUtf8 = format.validUtf8 and m_continuation == 0;
+  return format;
+}
+
+void TextScanner::scanBytes(std::string_view bytes, std::size_t offset, std::vector<std::size_t>& newlines)
+{
+  for (std::size_t i = 0; i < bytes.size(); i++) {
+    auto const byte = static_cast<unsigned char>(bytes[i]);
+
+    if (byte == '\n') {
+      (m_afterCr ? m_format.crlfLines : m_format.lfLines)++;
+      newlines.push_back(offset + i);
+    }
+
+    m_afterCr = byte == '\r';
+    m_format.binary = m_format.binary or byte == '\0';
+
+    if (m_format.validUtf8 and (byte >= 0x80 or m_continuation != 0)) {
+      validate(byte);
+    }
+  }
+}
+
+void TextScanner::validate(unsigned char byte) noexcept
+{
+  if (m_continuation > 0) {
+    if (byte < m_lowest or byte > m_highest) {
+      m_format.validUtf8 = false;
+    }
+
+    m_continuation--;
+    m_lowest = 0x80;
+    m_highest = 0xBF;
+    return;
+  }
+
+  if (byte < 0x80) {
+    return;
+  }
+
+  // The lead byte says how many continuation bytes follow. Some lead bytes narrow down what the first of them can be
+  if (byte >= 0xC2 and byte <= 0xDF) {
+    m_continuation = 1;
+  }
+  else if (byte >= 0xE0 and byte <= 0xEF) {
+    m_continuation = 2;
+    m_lowest = byte == 0xE0 ? 0xA0 : 0x80;
+    m_highest = byte == 0xED ? 0x9F : 0xBF;
+  }
+  else if (byte >= 0xF0 and byte <= 0xF4) {
+    m_continuation = 3;
+    m_lowest = byte == 0xF0 ? 0x90 : 0x80;
+    m_highest = byte == 0xF4 ? 0x8F : 0xBF;
+  }
+  else {
+    m_format.validUtf8 = false;
+  }
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,131 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TEXT_SCANNER_HPP
+#define TEXT_SCANNER_HPP
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace Kilo::editor {
+
+/// How the lines of a text are terminated
+enum class LineEnding
+{
+  Lf,
+  CrLf
+};
+
+/// What kind of text a document was read from, so that it can be written back the same way
+struct TextFormat
+{
+  /// The UTF-8 encoding of U+FEFF, which some editors put at the start of UTF-8 text
+  static constexpr std::string_view ByteOrderMark {"\xEF\xBB\xBF"};
+
+  /// The number of lines terminated by "\n" alone
+  std::size_t lfLines {};
+
+  /// The number of lines terminated by "\r\n". The "\r" is dropped from the line when it is loaded, whichever ending
+  /// most lines had
+  std::size_t crlfLines {};
+
+  /// Whether the text started with a byte order mark, which is dropped from the first line when it is loaded
+  bool byteOrderMark {};
+
+  /// Whether the text is valid UTF-8, which includes plain ASCII
+  bool validUtf8 {true};
+
+  /// Whether the text contains a NUL byte, which no text file does
+  bool binary {};
+
+  /// Whether the last line was terminated as well
+  bool finalNewline {};
+
+  /// Get the line ending most lines had, which every line is written back with
+  [[nodiscard]] constexpr auto lineEnding() const noexcept -> LineEnding
+  {
+    return crlfLines > lfLines ? LineEnding::CrLf : LineEnding::Lf;
+  }
+
+  /// Get the number of lines with the other line ending, which are converted when the text is written back
+  [[nodiscard]] constexpr auto convertedLines() const noexcept -> std::size_t
+  {
+    return lineEnding() == LineEnding::CrLf ? lfLines : crlfLines;
+  }
+
+  /// Get the number of bytes of the text that were dropped from its lines, which don't count towards the size of the
+  /// document
+  [[nodiscard]] constexpr auto droppedBytes() const noexcept -> std::size_t
+  {
+    return crlfLines + (byteOrderMark ? ByteOrderMark.size() : 0);
+  }
+};
+
+// Finds the newlines of a text, and works out its TextFormat while doing so.
+// Both come out of the same pass over the text: sixteen bytes at a time are
+// compared against "\n", "\r" and NUL with SSE2, and a byte with the high bit
+// set, the only kind UTF-8 validation has to look at, shows up in the same
+// registers. Blocks of plain ASCII without a newline, the bulk of most text,
+// cost a handful of instructions.
+//
+// Text arrives in pieces, and a "\r\n" or a multi-byte character may be split
+// between two of them, so whatever is needed to carry on is kept in between.
+
+class TextScanner
+{
+public:
+  /// Scan the next piece of a text
+  /// \param[in] bytes The piece, which carries on from the one scanned last time
+  /// \param[out] newlines The offset into the piece of every newline in it is appended to this, in order
+  void scan(std::string_view bytes, std::vector<std::size_t>& newlines);
+
+  /// Get what the text scanned so far looks like
+  [[nodiscard]] auto format() const noexcept -> TextFormat;
+
+private:
+  /// Scan bytes one at a time
+  void scanBytes(std::string_view bytes, std::size_t offset, std::vector<std::size_t>& newlines);
+
+  /// Feed a byte with the high bit set, or one that should continue a multi-byte character, to the UTF-8 validator
+  void validate(unsigned char byte) noexcept;
+
+  TextFormat m_format;
+
+  // The number of bytes scanned so far, for finding the byte order mark, and whether they match it so far
+  std::size_t m_scanned {};
+  bool m_byteOrderMark {true};
+
+  // Whether the last byte scanned was a "\r", which a "\n" at the start of the next piece completes
+  bool m_afterCr {};
+
+  // The number of continuation bytes the character being validated still needs, and the range the next one has to
+  // be in, which rules out overlong encodings and surrogates
+  int m_continuation {};
+  unsigned char m_lowest {0x80};
+  unsigned char m_highest {0xBF};
+};
+
+}   // namespace Kilo::editor
+
+#endif
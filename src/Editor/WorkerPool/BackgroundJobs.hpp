@@ -0,0 +1,204 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BACKGROUND_JOBS_HPP
+#define BACKGROUND_JOBS_HPP
+
+#include "Editor/Document/Document.hpp"
+#include "Editor/WorkerPool/WorkerPool.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace Kilo::editor {
+
+// Jobs that read a document on a WorkerPool, each of which hands back a
+// result for the main thread to take in.
+//
+// Every job reads its own copy of the document, which stays the same however
+// the document is edited after it was posted. The nodes of those copies come
+// from a pool that only the main thread may allocate from or give back to, so
+// the copies are handed back with the results and only dropped when they are
+// collected. Jobs that are dropped before they start are dropped on the main
+// thread too, and the destructor waits for the jobs that are running rather
+// than leave them to drop theirs.
+//
+// Once what the jobs posted so far work on is out of date, restart() drops
+// those that haven't started, and the results of the others are dropped when
+// they come back.
+
+template <typename Job, typename Result>
+class BackgroundJobs
+{
+public:
+  /// What a job does, on whichever worker runs it
+  using Work = auto (*)(Job const& job, Document const& document) -> Result;
+
+  /// Create a queue of jobs that nothing has been posted to
+  /// \param[in] work What each job does
+  explicit BackgroundJobs(Work work) : m_shared(std::make_shared<Shared>(work)) {}
+
+  /// Destructor. Drops the jobs that haven't started, and waits for those that have
+  ~BackgroundJobs()
+  {
+    std::unique_lock lock(m_shared->mutex);
+    m_shared->jobs.clear();
+    m_shared->idle.wait(lock, [this] { return m_shared->running == 0; });
+    m_shared->results.clear();
+  }
+
+  BackgroundJobs(BackgroundJobs const&) = delete;
+  auto operator=(BackgroundJobs const&) -> BackgroundJobs& = delete;
+  BackgroundJobs(BackgroundJobs&&) = delete;
+  auto operator=(BackgroundJobs&&) -> BackgroundJobs& = delete;
+
+  /// Hand jobs over to the workers, each with a copy of a document. Jobs start in order
+  /// \param[in] workers The workers
+  /// \param[in] document The document the jobs read
+  /// \param[in] jobs The jobs, which are moved from
+  void post(WorkerPool& workers, Document const& document, std::span<Job> jobs)
+  {
+    {
+      std::scoped_lock const lock(m_shared->mutex);
+
+      for (auto& job : jobs) {
+        m_shared->jobs.push_back(Queued {.ticket = m_ticket, .job = std::move(job), .document = document});
+      }
+    }
+
+    for (std::size_t i = 0; i < jobs.size(); i++) {
+      workers.post([shared = m_shared] { run(*shared); });
+    }
+  }
+
+  /// Drop the jobs that haven't started, and the results of every job posted so far
+  void restart()
+  {
+    std::scoped_lock const lock(m_shared->mutex);
+    m_shared->jobs.clear();
+    m_ticket++;
+  }
+
+  /// Drop the jobs that haven't started that a predicate picks, e.g. because what they read has changed
+  /// \param[in] drop Called with each job that hasn't started, and returns true to drop it
+  template <typename Drop>
+  void dropIf(Drop const& drop)
+  {
+    std::scoped_lock const lock(m_shared->mutex);
+    std::erase_if(m_shared->jobs, [&drop](Queued const& queued) { return drop(queued.job); });
+  }
+
+  /// Hand the results of the jobs that have finished since the last call to a function, in the order they finished.
+  /// Those of jobs posted before the last restart() are dropped
+  /// \param[in] take Called with each result, which it may move from
+  template <typename Take>
+  void collect(Take const& take)
+  {
+    {
+      std::scoped_lock const lock(m_shared->mutex);
+      m_results.swap(m_shared->results);
+    }
+
+    for (auto& finished : m_results) {
+      if (finished.ticket == m_ticket) {
+        take(finished.result);
+      }
+    }
+
+    // This drops the copies of the document the workers read, on this thread
+    m_results.clear();
+  }
+
+private:
+  struct Queued
+  {
+    std::uint64_t ticket;
+    Job job;
+    Document document;
+  };
+
+  struct Finished
+  {
+    std::uint64_t ticket;
+    Result result;
+    Document document;
+  };
+
+  // What the workers share with the main thread. Tasks posted to the pool keep it alive
+  struct Shared
+  {
+    explicit Shared(Work work) : work(work) {}
+
+    Work work;
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::deque<Queued> jobs;
+    std::vector<Finished> results;
+    std::size_t running {};
+  };
+
+  /// Run the next job of the queue, if any is left
+  static void run(Shared& shared)
+  {
+    std::unique_lock lock(shared.mutex);
+
+    // Jobs dropped after their task was posted leave tasks with nothing to do
+    if (shared.jobs.empty()) {
+      return;
+    }
+
+    auto queued = std::move(shared.jobs.front());
+    shared.jobs.pop_front();
+    shared.running++;
+    lock.unlock();
+
+    auto result = shared.work(queued.job, queued.document);
+
+    lock.lock();
+    shared.results.push_back(
+      Finished {.ticket = queued.ticket, .result = std::move(result), .document = std::move(queued.document)});
+    shared.running--;
+    lock.unlock();
+
+    shared.idle.notify_all();
+  }
+
+  std::shared_ptr<Shared> m_shared;
+
+  // Stamped on every job posted, and incremented to drop them all
+  std::uint64_t m_ticket {};
+
+  // Kept to reuse its capacity
+  std::vector<Finished> m_results;
+};
+
+}   // namespace Kilo::editor
+
+#endif
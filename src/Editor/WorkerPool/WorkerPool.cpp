@@ -0,0 +1,120 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <system_error>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace Kilo::editor {
+
+WorkerPool::WorkerPool(std::size_t threads) : m_finished(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+  if (m_finished == -1) {
+    throw std::system_error(errno, std::system_category(), "Could not create the workers' event");
+  }
+
+  if (threads == 0) {
+    threads = std::max(std::thread::hardware_concurrency(), 1U);
+  }
+
+  m_workers.reserve(threads);
+
+  for (std::size_t i = 0; i < threads; i++) {
+    m_workers.emplace_back([this](std::stop_token const& stop) { run(stop); });
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  // Workers only stop once the queue is empty, so the tasks that haven't started are taken out first. They are
+  // dropped on this thread once the workers are done
+  std::deque<std::function<void()>> dropped;
+
+  {
+    std::scoped_lock const lock(m_mutex);
+    dropped.swap(m_tasks);
+  }
+
+  for (auto& worker : m_workers) {
+    worker.request_stop();
+  }
+
+  // Joined before the event is closed, as the last tasks to finish still signal it
+  m_workers.clear();
+  ::close(m_finished);
+}
+
+void WorkerPool::post(std::function<void()> task)
+{
+  {
+    std::scoped_lock const lock(m_mutex);
+    m_tasks.push_back(std::move(task));
+  }
+
+  m_waiting.notify_one();
+}
+
+void WorkerPool::postFirst(std::function<void()> task)
+{
+  {
+    std::scoped_lock const lock(m_mutex);
+    m_tasks.push_front(std::move(task));
+  }
+
+  m_waiting.notify_one();
+}
+
+void WorkerPool::acknowledge() noexcept
+{
+  std::uint64_t count {};
+  while (::read(m_finished, &count, sizeof(count)) == -1 and errno == EINTR) {
+  }
+}
+
+void WorkerPool::run(std::stop_token const& stop)
+{
+  std::unique_lock lock(m_mutex);
+
+  while (m_waiting.wait(lock, stop, [this] { return !m_tasks.empty(); })) {
+    auto task = std::move(m_tasks.front());
+    m_tasks.pop_front();
+
+    lock.unlock();
+    task();
+    task = nullptr;
+
+    std::uint64_t const one = 1;
+    while (::write(m_finished, &one, sizeof(one)) == -1 and errno == EINTR) {
+    }
+
+    lock.lock();
+  }
+}
+
+}   // namespace Kilo::editor
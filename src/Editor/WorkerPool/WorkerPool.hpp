@@ -0,0 +1,100 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Kilo::editor {
+
+// A fixed set of threads that run tasks handed to them in the background,
+// for work on large documents that would otherwise hold up the screen.
+//
+// Tasks report nothing back themselves. Whoever posted a task keeps the
+// result somewhere both sides can reach, and the main loop learns that there
+// is something to pick up by waiting for fileDescriptor() to become readable
+// along with the keyboard.
+
+class WorkerPool
+{
+public:
+  /// Start the workers
+  /// \param[in] threads The number of workers, or 0 for one per processor
+  /// \throws std::system_error if the file descriptor the workers signal could not be created
+  explicit WorkerPool(std::size_t threads = 0);
+
+  /// Destructor. Tasks that haven't started yet are dropped without running, and those that have are waited for
+  ~WorkerPool();
+
+  WorkerPool(WorkerPool const&) = delete;
+  auto operator=(WorkerPool const&) -> WorkerPool& = delete;
+  WorkerPool(WorkerPool&&) = delete;
+  auto operator=(WorkerPool&&) -> WorkerPool& = delete;
+
+  /// Hand a task over to be run by the next idle worker. Tasks start in the order they were posted
+  /// \param[in] task The task
+  void post(std::function<void()> task);
+
+  /// Hand a task over to be run ahead of every task still queued, for work something is waiting on
+  /// \param[in] task The task
+  void postFirst(std::function<void()> task);
+
+  /// Get the number of workers
+  [[nodiscard]] auto size() const noexcept -> std::size_t
+  {
+    return m_workers.size();
+  }
+
+  /// Get the file descriptor that becomes readable whenever a task has finished
+  [[nodiscard]] constexpr auto fileDescriptor() const noexcept -> int
+  {
+    return m_finished;
+  }
+
+  /// Make fileDescriptor() stop being readable until another task finishes
+  void acknowledge() noexcept;
+
+private:
+  void run(std::stop_token const& stop);
+
+  int m_finished;
+
+  std::mutex m_mutex;
+  std::condition_variable_any m_waiting;
+
+  // Guarded by m_mutex
+  std::deque<std::function<void()>> m_tasks;
+
+  std::vector<std::jthread> m_workers;
+};
+
+}   // namespace Kilo::editor
+
+#endif
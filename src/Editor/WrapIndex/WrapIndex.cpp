@@ -0,0 +1,344 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "WrapIndex.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <iterator>
+#include <numeric>
+#include <utility>
+
+namespace Kilo::editor {
+
+namespace {
+
+/// The range of entries a node of a Fenwick tree covers is given by the lowest set bit of its index
+constexpr auto lowestBit(std::size_t i) noexcept -> std::size_t
+{
+  return i & (~i + 1);
+}
+
+}   // namespace
+
+WrapIndex::WrapIndex(std::vector<std::size_t> const& widths, std::size_t columns) : m_columns(columns)
+{
+  assert(columns > 0 and "Lines must be folded to at least one column");
+
+  for (std::size_t first = 0; first < widths.size(); first += BlockLines) {
+    auto& block = m_blocks.emplace_back();
+    auto const begin = widths.begin() + static_cast<std::ptrdiff_t>(first);
+    block.widths.assign(begin, begin + static_cast<std::ptrdiff_t>(std::min(BlockLines, widths.size() - first)));
+    refold(block);
+  }
+
+  m_maxWidth = widths.empty() ? 0 : std::ranges::max(widths);
+  reindex();
+}
+
+auto WrapIndex::rowsOf(std::size_t line) const noexcept -> std::size_t
+{
+  auto const [block, offset] = blockOf(line);
+  return rowsFor(m_blocks[block].widths[offset]);
+}
+
+auto WrapIndex::firstRowOf(std::size_t line) const noexcept -> std::size_t
+{
+  assert(line <= lineCount());
+
+  if (line == lineCount()) {
+    return rowCount();
+  }
+
+  auto const [block, offset] = blockOf(line);
+  return m_rows.prefix(block) + m_blocks[block].rows.prefix(offset);
+}
+
+auto WrapIndex::locate(std::size_t row) const noexcept -> Position
+{
+  assert(row < rowCount() and "Row is past the end of the document");
+
+  auto const [block, rest] = m_rows.find(row);
+  auto const [offset, segment] = m_blocks[block].rows.find(rest);
+  return Position {.line = m_lines.prefix(block) + offset, .segment = segment};
+}
+
+void WrapIndex::update(std::size_t line, std::size_t width) noexcept
+{
+  auto const [index, offset] = blockOf(line);
+  auto& block = m_blocks[index];
+
+  auto const before = rowsFor(block.widths[offset]);
+  auto const after = rowsFor(width);
+
+  block.widths[offset] = width;
+  m_maxWidth = std::max(m_maxWidth, width);
+
+  if (before != after) {
+    auto const delta = static_cast<std::ptrdiff_t>(after) - static_cast<std::ptrdiff_t>(before);
+    block.rows.add(offset, delta);
+    m_rows.add(index, delta);
+  }
+}
+
+void WrapIndex::append(std::size_t width)
+{
+  // Only the last block grows, and the trees over the blocks only have a node added when a block is
+  if (m_blocks.empty() or m_blocks.back().widths.size() >= BlockLines) {
+    m_blocks.emplace_back();
+    m_lines.push_back(0);
+    m_rows.push_back(0);
+  }
+
+  auto const rows = rowsFor(width);
+  auto& block = m_blocks.back();
+
+  block.widths.push_back(width);
+  block.rows.push_back(rows);
+  m_lines.add(m_blocks.size() - 1, 1);
+  m_rows.add(m_blocks.size() - 1, static_cast<std::ptrdiff_t>(rows));
+  m_maxWidth = std::max(m_maxWidth, width);
+}
+
+void WrapIndex::insert(std::size_t line, std::size_t width)
+{
+  replace(line, 0, std::span(&width, 1));
+}
+
+void WrapIndex::erase(std::size_t line)
+{
+  replace(line, 1, {});
+}
+
+void WrapIndex::replace(std::size_t first, std::size_t removed, std::span<std::size_t const> widths)
+{
+  assert(first + removed <= lineCount());
+
+  if (removed == 0 and first == lineCount()) {
+    for (auto const width : widths) {
+      append(width);
+    }
+
+    return;
+  }
+
+  for (auto const width : widths) {
+    m_maxWidth = std::max(m_maxWidth, width);
+  }
+
+  // The run starts in one block and ends in the same one or a later one. What is left of the blocks after it is moved
+  // into the first, and the blocks between are dropped
+  auto const [index, offset] = blockOf(first);
+  auto to = Place {.index = index, .rest = offset};
+
+  if (removed > 0) {
+    to = blockOf(first + removed - 1);
+    to.rest++;
+  }
+
+  auto const [last, end] = to;
+  auto& block = m_blocks[index];
+  auto const lines = block.widths.size();
+  auto const rows = block.rows.total();
+  auto const begin = [](Block& of, std::size_t at) { return of.widths.begin() + static_cast<std::ptrdiff_t>(at); };
+
+  if (last == index) {
+    block.widths.insert(block.widths.erase(begin(block, offset), begin(block, end)), widths.begin(), widths.end());
+  }
+  else {
+    auto& tail = m_blocks[last].widths;
+    block.widths.resize(offset);
+    block.widths.insert(block.widths.end(), widths.begin(), widths.end());
+    block.widths.insert(block.widths.end(), begin(m_blocks[last], end), tail.end());
+  }
+
+  // A block that is still neither empty nor too large only changes its own tree and the paths to it in the others
+  if (last == index and !block.widths.empty() and block.widths.size() <= 2 * BlockLines) {
+    refold(block);
+    m_lines.add(index, static_cast<std::ptrdiff_t>(block.widths.size()) - static_cast<std::ptrdiff_t>(lines));
+    m_rows.add(index, static_cast<std::ptrdiff_t>(block.rows.total()) - static_cast<std::ptrdiff_t>(rows));
+    return;
+  }
+
+  // Otherwise the lines are cut into new blocks, which moves those after them
+  std::vector<Block> cut;
+
+  for (std::size_t start = 0; start < block.widths.size(); start += BlockLines) {
+    auto& piece = cut.emplace_back();
+    piece.widths.assign(begin(block, start), begin(block, std::min(start + BlockLines, block.widths.size())));
+    refold(piece);
+  }
+
+  auto const dropped = m_blocks.erase(m_blocks.begin() + static_cast<std::ptrdiff_t>(index),
+                                      m_blocks.begin() + static_cast<std::ptrdiff_t>(last + 1));
+  m_blocks.insert(dropped, std::make_move_iterator(cut.begin()), std::make_move_iterator(cut.end()));
+  reindex();
+}
+
+void WrapIndex::setColumns(std::size_t columns) noexcept
+{
+  assert(columns > 0 and "Lines must be folded to at least one column");
+
+  if (columns == m_columns) {
+    return;
+  }
+
+  auto const narrowest = std::min(columns, m_columns);
+  auto const previous = std::exchange(m_columns, columns);
+
+  if (m_maxWidth <= narrowest) {
+    return;
+  }
+
+  for (std::size_t index = 0; index < m_blocks.size(); index++) {
+    auto& block = m_blocks[index];
+    std::ptrdiff_t moved {};
+
+    for (std::size_t line = 0; line < block.widths.size(); line++) {
+      auto const width = block.widths[line];
+
+      if (width <= narrowest) {
+        continue;
+      }
+
+      auto const before = (width + previous - 1) / previous;
+      auto const after = rowsFor(width);
+
+      if (before != after) {
+        auto const delta = static_cast<std::ptrdiff_t>(after) - static_cast<std::ptrdiff_t>(before);
+        block.rows.add(line, delta);
+        moved += delta;
+      }
+    }
+
+    if (moved != 0) {
+      m_rows.add(index, moved);
+    }
+  }
+}
+
+auto WrapIndex::blockOf(std::size_t line) const noexcept -> Place
+{
+  assert(line < lineCount());
+  return m_lines.find(line);
+}
+
+auto WrapIndex::rowsFor(std::size_t width) const noexcept -> std::size_t
+{
+  // An empty line still takes up a row
+  return width == 0 ? 1 : (width + m_columns - 1) / m_columns;
+}
+
+void WrapIndex::refold(Block& block) const
+{
+  std::vector<std::size_t> rows(block.widths.size());
+  std::ranges::transform(block.widths, rows.begin(), [this](std::size_t width) { return rowsFor(width); });
+  block.rows.assign(std::move(rows));
+}
+
+void WrapIndex::reindex()
+{
+  std::vector<std::size_t> lines(m_blocks.size());
+  std::vector<std::size_t> rows(m_blocks.size());
+  std::ranges::transform(m_blocks, lines.begin(), [](Block const& block) { return block.widths.size(); });
+  std::ranges::transform(m_blocks, rows.begin(), [](Block const& block) { return block.rows.total(); });
+
+  m_lines.assign(std::move(lines));
+  m_rows.assign(std::move(rows));
+}
+
+void WrapIndex::Sums::assign(std::vector<std::size_t> counts) noexcept
+{
+  /*
+   * Build the tree in linear time: every node adds its partial sum into its
+   * parent, which is the next node whose range covers it
+   */
+
+  m_tree = std::move(counts);
+  m_total = std::accumulate(m_tree.begin(), m_tree.end(), std::size_t {});
+
+  for (std::size_t i = 1; i <= m_tree.size(); i++) {
+    if (auto const parent = i + lowestBit(i); parent <= m_tree.size()) {
+      m_tree[parent - 1] += m_tree[i - 1];
+    }
+  }
+}
+
+void WrapIndex::Sums::push_back(std::size_t count)
+{
+  // The new node covers itself and the entries in (n - lowestBit(n), n - 1], whose sum is the difference of two prefix
+  // sums
+  auto const n = m_tree.size() + 1;
+  auto const covered = prefix(n - 1) - prefix(n - lowestBit(n));
+
+  m_tree.push_back(covered + count);
+  m_total += count;
+}
+
+void WrapIndex::Sums::add(std::size_t index, std::ptrdiff_t delta) noexcept
+{
+  for (auto i = index + 1; i <= m_tree.size(); i += lowestBit(i)) {
+    m_tree[i - 1] += static_cast<std::size_t>(delta);
+  }
+
+  m_total += static_cast<std::size_t>(delta);
+}
+
+auto WrapIndex::Sums::prefix(std::size_t index) const noexcept -> std::size_t
+{
+  assert(index <= m_tree.size());
+
+  std::size_t sum = 0;
+
+  for (auto i = index; i > 0; i -= lowestBit(i)) {
+    sum += m_tree[i - 1];
+  }
+
+  return sum;
+}
+
+auto WrapIndex::Sums::find(std::size_t sum) const noexcept -> Place
+{
+  assert(sum < m_total);
+
+  /*
+   * Walk down the implicit tree, descending into the right half whenever the
+   * counts to the left of it don't reach the sum we are looking for. At the
+   * end, idx is the number of entries that lie entirely before it.
+   */
+
+  std::size_t idx = 0;
+
+  for (auto step = std::bit_floor(m_tree.size()); step > 0; step >>= 1) {
+    if (idx + step <= m_tree.size() and m_tree[idx + step - 1] <= sum) {
+      idx += step;
+      sum -= m_tree[idx - 1];
+    }
+  }
+
+  return Place {.index = idx, .rest = sum};
+}
+
+}   // namespace Kilo::editor
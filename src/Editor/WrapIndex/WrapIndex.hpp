@@ -0,0 +1,201 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef WRAP_INDEX_HPP
+#define WRAP_INDEX_HPP
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace Kilo::editor {
+
+// When soft-wrap is on, every line of the document occupies one or more rows
+// on the screen. Finding the line shown on a given screen row by summing the
+// row counts of all preceding lines is linear in the size of the document, so
+// we keep the row counts in Fenwick trees instead. Prefix sums and the
+// inverse lookup (row -> line) are then logarithmic, and changing the width of
+// a single line only touches O(log n) entries.
+//
+// A Fenwick tree can't have entries put in or taken out of the middle, so the
+// lines are split into blocks of at most a couple of BlockLines lines, each
+// with a tree of its own. The blocks have a tree of their lines and one of
+// their rows. Lines added or removed only rebuild the trees of the blocks they
+// were in, along with the trees over the blocks if blocks were split or
+// dropped, which are BlockLines times smaller than the document.
+
+class WrapIndex
+{
+public:
+  /// The number of lines a block is cut to. A block may grow to twice as many before it is cut up again
+  static constexpr std::size_t BlockLines = 1024;
+
+  /// A visual row expressed as a line of the document and a wrapped segment of that line
+  struct Position
+  {
+    std::size_t line;
+    std::size_t segment;
+  };
+
+  /// Create an empty index
+  explicit WrapIndex() noexcept = default;
+
+  /// Build an index over lines of the given widths
+  /// \param[in] widths The rendered width of each line of the document
+  /// \param[in] columns The number of columns each line is folded to
+  /// \pre columns must be greater than zero
+  explicit WrapIndex(std::vector<std::size_t> const& widths, std::size_t columns);
+
+  /// Get the number of columns lines are folded to
+  [[nodiscard]] constexpr auto columns() const noexcept -> std::size_t
+  {
+    return m_columns;
+  }
+
+  /// Get the number of lines in the index
+  [[nodiscard]] constexpr auto lineCount() const noexcept -> std::size_t
+  {
+    return m_lines.total();
+  }
+
+  /// Get the total number of visual rows
+  [[nodiscard]] constexpr auto rowCount() const noexcept -> std::size_t
+  {
+    return m_rows.total();
+  }
+
+  /// Get the number of visual rows a line occupies
+  /// \param[in] line The line of the document
+  [[nodiscard]] auto rowsOf(std::size_t line) const noexcept -> std::size_t;
+
+  /// Get the first visual row of a line
+  /// \param[in] line The line of the document. Passing lineCount() yields rowCount()
+  [[nodiscard]] auto firstRowOf(std::size_t line) const noexcept -> std::size_t;
+
+  /// Find the line and wrapped segment shown on a visual row
+  /// \param[in] row The visual row
+  /// \pre row must be less than rowCount()
+  [[nodiscard]] auto locate(std::size_t row) const noexcept -> Position;
+
+  /// Record a new width for a line, e.g. after it was edited
+  /// \param[in] line The line whose width changed
+  /// \param[in] width The new rendered width of the line
+  void update(std::size_t line, std::size_t width) noexcept;
+
+  /// Add a line to the end, e.g. while the document is still being loaded
+  /// \param[in] width The rendered width of the new line
+  void append(std::size_t width);
+
+  /// Insert a line before the given position
+  void insert(std::size_t line, std::size_t width);
+
+  /// Remove a line
+  void erase(std::size_t line);
+
+  /// Replace a run of lines with others, e.g. after an edit added or removed lines
+  /// \details This rebuilds the trees of the blocks the run starts and ends in, so it takes time in proportion to
+  /// BlockLines and the number of lines added, plus the number of blocks if they had to be cut up again
+  /// \param[in] first The first line replaced
+  /// \param[in] removed The number of lines replaced
+  /// \param[in] widths The rendered widths of the lines that replace them
+  /// \pre first + removed must not be more than lineCount()
+  void replace(std::size_t first, std::size_t removed, std::span<std::size_t const> widths);
+
+  /// Fold the lines to a new number of columns, e.g. after the terminal was resized
+  /// \details Only the entries of lines whose row count changes are updated. If the number of columns is unchanged, or
+  /// no line is wider than either the old or the new number of columns, nothing needs to be done at all
+  /// \pre columns must be greater than zero
+  void setColumns(std::size_t columns) noexcept;
+
+private:
+  /// An entry of a sequence of counts, and how far into it a sum of them reaches
+  struct Place
+  {
+    std::size_t index;
+    std::size_t rest;
+  };
+
+  /// A Fenwick tree over a sequence of counts, which can grow at its end
+  class Sums
+  {
+  public:
+    /// Take over a sequence of counts and build the tree over them in place
+    void assign(std::vector<std::size_t> counts) noexcept;
+
+    /// Add a count to the end
+    void push_back(std::size_t count);
+
+    /// Change one of the counts
+    void add(std::size_t index, std::ptrdiff_t delta) noexcept;
+
+    /// Get the sum of the counts before an index
+    [[nodiscard]] auto prefix(std::size_t index) const noexcept -> std::size_t;
+
+    /// Find the count a sum falls in
+    /// \pre sum must be less than total()
+    [[nodiscard]] auto find(std::size_t sum) const noexcept -> Place;
+
+    [[nodiscard]] constexpr auto size() const noexcept -> std::size_t
+    {
+      return m_tree.size();
+    }
+
+    [[nodiscard]] constexpr auto total() const noexcept -> std::size_t
+    {
+      return m_total;
+    }
+
+  private:
+    std::vector<std::size_t> m_tree;
+    std::size_t m_total {};
+  };
+
+  struct Block
+  {
+    std::vector<std::size_t> widths;
+    Sums rows;
+  };
+
+  /// Find the block a line is in and where in the block it is
+  /// \pre line must be less than lineCount()
+  [[nodiscard]] auto blockOf(std::size_t line) const noexcept -> Place;
+
+  [[nodiscard]] auto rowsFor(std::size_t width) const noexcept -> std::size_t;
+
+  /// Build the tree of rows of a block from the widths of its lines
+  void refold(Block& block) const;
+
+  /// Build the trees over the blocks from the blocks
+  void reindex();
+
+  std::vector<Block> m_blocks;
+  Sums m_lines;
+  Sums m_rows;
+  std::size_t m_columns {1};
+  std::size_t m_maxWidth {};
+};
+
+}   // namespace Kilo::editor
+
+#endif
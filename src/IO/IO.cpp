@@ -28,16 +28,33 @@
 
 #include <array>
 #include <cerrno>
+#include <cstddef>
+#include <fcntl.h>
+#include <string>
+#include <string_view>
 #include <unistd.h>
 
 namespace Kilo::IO {
 
+namespace {
+
+// Input read past the end of a paste, which readKey returns before reading any more
+std::string readAhead;
+std::size_t readAheadPos {};
+
+// Give up on a paste whose end marker doesn't arrive for this many reads, each of which waits for VTIME
+constexpr int PasteTimeoutReads = 10;
+
+}   // namespace
+
 int readKey()
 {
   char c {};
 
-  for (long nread = 0; nread != 1; nread = ::read(STDIN_FILENO, &c, 1)) {
-    if (nread == -1 && errno != EAGAIN) {
+  errno = 0;
+
+  while (!detail::readByte(c)) {
+    if (errno != 0 && errno != EAGAIN) {
       throw std::system_error(errno, std::system_category(), "Could not read key input from stdin");
     }
 
@@ -58,8 +75,86 @@ int readKey()
   }
 }
 
+void readPaste(std::string& text)
+{
+  using Kilo::editor::EscapeSequences;
+
+  text.assign(readAhead, readAheadPos);
+  readAhead.clear();
+  readAheadPos = 0;
+
+  std::array<char, 64 * 1024> block {};
+  std::size_t searched {};
+
+  for (auto idle = 0; idle < PasteTimeoutReads;) {
+    if (auto const end = text.find(EscapeSequences::PasteEnd, searched); end != std::string::npos) {
+      readAhead.assign(text, end + EscapeSequences::PasteEnd.size());
+      text.resize(end);
+      return;
+    }
+
+    // The marker may straddle two blocks
+    searched = text.size() < EscapeSequences::PasteEnd.size() ? 0 : text.size() - EscapeSequences::PasteEnd.size() + 1;
+
+    auto const nread = ::read(STDIN_FILENO, block.data(), block.size());
+
+    if (nread == -1 && errno != EAGAIN && errno != EINTR) {
+      throw std::system_error(errno, std::system_category(), "Could not read pasted text from stdin");
+    }
+
+    if (nread > 0) {
+      text.append(block.data(), static_cast<std::size_t>(nread));
+      idle = 0;
+    }
+    else {
+      idle++;
+    }
+  }
+}
+
+auto hasBufferedInput() noexcept -> bool
+{
+  return readAheadPos < readAhead.size();
+}
+
+int detachStdin()
+{
+  auto const data = ::fcntl(STDIN_FILENO, F_DUPFD_CLOEXEC, 0);
+
+  if (data == -1) {
+    throw std::system_error(errno, std::system_category(), "Could not duplicate stdin");
+  }
+
+  auto const tty = ::open("/dev/tty", O_RDWR | O_CLOEXEC);
+
+  if (tty == -1 or ::dup2(tty, STDIN_FILENO) == -1) {
+    auto const error = errno;
+
+    if (tty != -1) {
+      ::close(tty);
+    }
+
+    ::close(data);
+    throw std::system_error(error, std::system_category(), "Could not open the terminal");
+  }
+
+  ::close(tty);
+
+  return data;
+}
+
 namespace detail {
 
+auto readByte(char& c) noexcept -> bool
+{
+  if (hasBufferedInput()) {
+    c = readAhead[readAheadPos++];
+    return true;
+  }
+
+  return ::read(STDIN_FILENO, &c, 1) == 1;
+}
+
 /**
  * \brief Handle the processing of escape sequences read in from stdin
  *
@@ -75,11 +170,11 @@ unsigned handleEscapeSequences() noexcept
    * just pressed the Escape key and return that.
    */
 
-  if (::read(STDIN_FILENO, &seq[0], 1) != 1) {
+  if (!readByte(seq[0])) {
     return '\x1b';
   }
 
-  if (::read(STDIN_FILENO, &seq[1], 1) != 1) {
+  if (!readByte(seq[1])) {
     return '\x1b';
   }
 
@@ -96,26 +191,37 @@ unsigned handleEscapeSequences() noexcept
      */
 
     if (seq[1] >= '0' && seq[1] <= '9') {
-      if (::read(STDIN_FILENO, &seq[2], 1) != 1) {
-        return '\x1b';
-      }
+      // The start of a bracketed paste is sent as \x1b[200~, so the number may have more than one digit
+      auto number = seq[1] - '0';
+
+      do {
+        if (!readByte(seq[2])) {
+          return '\x1b';
+        }
+
+        if (seq[2] >= '0' && seq[2] <= '9') {
+          number = number * 10 + (seq[2] - '0');
+        }
+      } while (seq[2] >= '0' && seq[2] <= '9' && number < 1000);
 
       if (seq[2] == '~') {
-        switch (seq[1]) {
-          case '1':
+        switch (number) {
+          case 1:
             return static_cast<int>(Home);
-          case '3':
+          case 3:
             return static_cast<int>(Delete);
-          case '4':
+          case 4:
             return static_cast<int>(End);
-          case '5':
+          case 5:
             return static_cast<int>(PageUp);
-          case '6':
+          case 6:
             return static_cast<int>(PageDown);
-          case '7':
+          case 7:
             return static_cast<int>(Home);
-          case '8':
+          case 8:
             return static_cast<int>(End);
+          case 200:
+            return static_cast<int>(PasteStart);
         }
       }
     }
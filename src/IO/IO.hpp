@@ -24,6 +24,8 @@
 #ifndef IO_HPP
 #define IO_HPP
 
+#include <string>
+
 namespace Kilo::IO {
 
 /**
@@ -33,8 +35,43 @@ namespace Kilo::IO {
  */
 auto readKey() -> int;
 
+/**
+ * \brief Read text pasted while bracketed paste mode is on, after readKey returned EditorKey::PasteStart
+ *
+ * \details The text is read in large blocks rather than a byte at a time. Whatever follows the end of the paste in
+ * the last block is kept for readKey
+ * \param[out] text The pasted text, without the marker that ends it. Its capacity is reused
+ * \throws std::system_error if an error occured during read
+ */
+void readPaste(std::string& text);
+
+/**
+ * \brief Check whether input has already been read from stdin that readKey hasn't returned yet
+ *
+ * \details Such input doesn't make stdin readable, so it has to be checked for before waiting on stdin
+ */
+auto hasBufferedInput() noexcept -> bool;
+
+/**
+ * \brief Move a document being piped in on stdin out of the way of the terminal
+ *
+ * \details Duplicates stdin onto a new file descriptor for the document to be read from and reopens the controlling
+ * terminal as stdin, so that key input keeps working while the document streams in
+ * \return The file descriptor the document can be read from
+ * \throws std::system_error if there is no controlling terminal or stdin could not be duplicated
+ */
+auto detachStdin() -> int;
+
 namespace detail {
 
+/**
+ * \brief Read a single byte of input, taking it from the input already read ahead if there is any
+ *
+ * \param[out] c The byte read
+ * \return false if no byte arrived in time
+ */
+auto readByte(char& c) noexcept -> bool;
+
 /**
  * \brief Handle the processing of escape sequences read in from stdin
  *
@@ -0,0 +1,96 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "Memory.hpp"
+
+#include <algorithm>
+
+namespace Kilo::memory {
+
+CountingResource::CountingResource(std::pmr::memory_resource* upstream) noexcept : m_upstream(upstream)
+{
+}
+
+void CountingResource::resetStats() noexcept
+{
+  m_stats = Stats {.allocations = 0,
+                   .deallocations = 0,
+                   .bytesAllocated = 0,
+                   .bytesInUse = m_stats.bytesInUse,
+                   .peakBytesInUse = m_stats.bytesInUse};
+}
+
+auto CountingResource::do_allocate(std::size_t bytes, std::size_t alignment) -> void*
+{
+  auto* ptr = m_upstream->allocate(bytes, alignment);
+
+  m_stats.allocations++;
+  m_stats.bytesAllocated += bytes;
+  m_stats.bytesInUse += bytes;
+  m_stats.peakBytesInUse = std::max(m_stats.peakBytesInUse, m_stats.bytesInUse);
+
+  return ptr;
+}
+
+void CountingResource::do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment)
+{
+  m_upstream->deallocate(ptr, bytes, alignment);
+
+  m_stats.deallocations++;
+  m_stats.bytesInUse -= bytes;
+}
+
+auto CountingResource::do_is_equal(std::pmr::memory_resource const& other) const noexcept -> bool
+{
+  return this == &other;
+}
+
+namespace {
+
+struct LineStorage
+{
+  CountingResource upstream {std::pmr::new_delete_resource()};
+  std::pmr::unsynchronized_pool_resource pool {&upstream};
+  CountingResource requests {&pool};
+};
+
+auto storage() noexcept -> LineStorage&
+{
+  static LineStorage instance;
+  return instance;
+}
+
+}   // namespace
+
+auto lineStorage() noexcept -> std::pmr::memory_resource*
+{
+  return &storage().requests;
+}
+
+auto lineStorageStats() noexcept -> LineStorageStats
+{
+  return LineStorageStats {.requests = storage().requests.stats(), .upstream = storage().upstream.stats()};
+}
+
+}   // namespace Kilo::memory
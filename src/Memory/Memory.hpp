@@ -0,0 +1,91 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef MEMORY_HPP
+#define MEMORY_HPP
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace Kilo::memory {
+
+// A memory resource that forwards every request to another resource and keeps
+// count of them. We stack these around the resources the editor allocates
+// from, so we can tell how many requests were made and how many of them
+// actually reached the global heap.
+
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+  struct Stats
+  {
+    std::size_t allocations;
+    std::size_t deallocations;
+    std::size_t bytesAllocated;
+    std::size_t bytesInUse;
+    std::size_t peakBytesInUse;
+  };
+
+  /// Create a resource that forwards to upstream
+  /// \param[in] upstream The resource requests are forwarded to
+  explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) noexcept;
+
+  /// Get the statistics collected so far
+  [[nodiscard]] constexpr auto stats() const noexcept -> Stats
+  {
+    return m_stats;
+  }
+
+  /// Reset the counters. The number of bytes in use is kept, as that memory is still allocated
+  void resetStats() noexcept;
+
+private:
+  auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override;
+  void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+  [[nodiscard]] auto do_is_equal(std::pmr::memory_resource const& other) const noexcept -> bool override;
+
+  std::pmr::memory_resource* m_upstream;
+  Stats m_stats {};
+};
+
+struct LineStorageStats
+{
+  // The requests made by documents for nodes and lines
+  CountingResource::Stats requests;
+
+  // The requests the pool had to pass on to the global heap
+  CountingResource::Stats upstream;
+};
+
+/// Get the resource the lines of every open document are allocated from
+/// \details Lines are small and numerous, so they are carved out of the chunks of a pool instead of each getting
+/// their own allocation from the global heap
+auto lineStorage() noexcept -> std::pmr::memory_resource*;
+
+/// Get the allocation statistics of lineStorage()
+auto lineStorageStats() noexcept -> LineStorageStats;
+
+}   // namespace Kilo::memory
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Capabilities.hpp"
+
+#include <fmt/format.h>
+
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <string>
+
+#include <poll.h>
+#include <unistd.h>
+
+namespace Kilo::Terminal {
+
+namespace {
+
+constexpr int SynchronizedOutput = 2026;
+
+}   // namespace
+
+auto queryCapabilities(IO::FileInterface& file, std::chrono::milliseconds timeout) -> Capabilities
+{
+  // DECRQM for each mode, then DA1
+  auto const queries = fmt::format("\x1b[?{}$p\x1b[c", SynchronizedOutput);
+
+  if (file.write(STDOUT_FILENO, queries) != queries.size()) {
+    return {};
+  }
+
+  std::string replies;
+  std::array<char, 64> chunk {};
+  auto const deadline = std::chrono::steady_clock::now() + timeout;
+
+  while (!detail::hasDeviceAttributes(replies)) {
+    using std::chrono::duration_cast, std::chrono::milliseconds, std::chrono::steady_clock;
+    auto const left = duration_cast<milliseconds>(deadline - steady_clock::now());
+    ::pollfd input {.fd = STDIN_FILENO, .events = POLLIN, .revents = 0};
+
+    if (left.count() <= 0) {
+      return {};
+    }
+
+    if (auto const ready = ::poll(&input, 1, static_cast<int>(left.count())); ready <= 0) {
+      if (ready == -1 and errno == EINTR) {
+        continue;
+      }
+
+      return {};
+    }
+
+    auto const count = ::read(STDIN_FILENO, chunk.data(), chunk.size());
+
+    if (count > 0) {
+      replies.append(chunk.data(), static_cast<std::size_t>(count));
+    }
+  }
+
+  return Capabilities {.synchronizedOutput = detail::reportsMode(replies, SynchronizedOutput)};
+}
+
+namespace detail {
+
+auto hasDeviceAttributes(std::string_view replies) noexcept -> bool
+{
+  // CSI ? Ps ; ... c
+  auto const start = replies.rfind("\x1b[?");
+
+  return start != std::string_view::npos and replies.find('c', start) != std::string_view::npos;
+}
+
+auto reportsMode(std::string_view replies, int mode) noexcept -> bool
+{
+  // CSI ? mode ; Ps $ y, where Ps is 0 if the mode isn't recognised, 1 or 2 if it is set or reset, 3 if it is
+  // permanently set and 4 if it is permanently reset
+  std::array<char, 16> prefix {};
+  auto const end = fmt::format_to_n(prefix.data(), prefix.size(), "\x1b[?{};", mode).out;
+  auto const report = replies.find(std::string_view(prefix.data(), static_cast<std::size_t>(end - prefix.data())));
+
+  if (report == std::string_view::npos) {
+    return false;
+  }
+
+  auto const rest = replies.substr(report + static_cast<std::size_t>(end - prefix.data()));
+  int state {};
+  auto const [next, error] = std::from_chars(rest.data(), rest.data() + rest.size(), state);
+
+  return error == std::errc() and std::string_view(next, rest.data() + rest.size()).starts_with("$y")
+     and state >= 1 and state <= 3;
+}
+
+}   // namespace detail
+
+}   // namespace Kilo::Terminal
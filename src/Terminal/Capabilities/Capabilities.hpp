@@ -0,0 +1,70 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CAPABILITIES_HPP
+#define CAPABILITIES_HPP
+
+#include "File/File.hpp"
+
+#include <chrono>
+#include <string_view>
+
+namespace Kilo::Terminal {
+
+// Features beyond what every terminal supports are only used once the
+// terminal has said it has them. The terminal is asked about each of them,
+// followed by a request for its primary device attributes, which every
+// terminal answers. Whatever hasn't been answered by the time that reply
+// arrives isn't supported.
+
+struct Capabilities
+{
+  /// Whether the terminal holds back drawing between the start and the end of an update (DEC private mode 2026), so
+  /// that a frame is never shown half drawn however many writes it arrives in
+  bool synchronizedOutput {};
+};
+
+/// Ask the terminal what it supports
+/// \param[in] file The file the queries are written through
+/// \param[in] timeout How long to wait for the replies, for terminals that don't answer at all
+/// \pre The terminal must be in raw mode, so that the replies can be read as they arrive
+/// \returns Nothing supported if the terminal couldn't be asked or didn't answer
+auto queryCapabilities(IO::FileInterface& file, std::chrono::milliseconds timeout = std::chrono::milliseconds(250))
+  -> Capabilities;
+
+namespace detail {
+
+/// Check whether the replies of a terminal include its primary device attributes, which come last
+/// \param[in] replies What the terminal sent back
+auto hasDeviceAttributes(std::string_view replies) noexcept -> bool;
+
+/// Check whether the replies of a terminal report a DEC private mode as one it knows and can change (DECRPM)
+/// \param[in] replies What the terminal sent back
+/// \param[in] mode The mode
+auto reportsMode(std::string_view replies, int mode) noexcept -> bool;
+
+}   // namespace detail
+
+}   // namespace Kilo::Terminal
+
+#endif
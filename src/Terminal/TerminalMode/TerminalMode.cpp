@@ -23,6 +23,8 @@
 
 #include "TerminalMode.hpp"
 
+#include "Utilities/Constants.hpp"
+
 #include <cassert>
 #include <cerrno>
 #include <iostream>
@@ -59,6 +61,9 @@ void TerminalMode::setRawMode() &
     m_state = ttystate::Canonical;
     throw;
   }
+
+  // Pasted text is then read as a whole instead of being taken for typing
+  detail::setBracketedPaste(true);
 }
 
 void TerminalMode::setCanonicalMode() &
@@ -69,6 +74,8 @@ void TerminalMode::setCanonicalMode() &
 
   assert(m_state == ttystate::Raw && "Terminal driver currently in raw mode");
 
+  detail::setBracketedPaste(false);
+
   try {
     detail::ttyCanonicalMode(STDIN_FILENO, m_termios);
     m_state = ttystate::Canonical;
@@ -81,6 +88,14 @@ void TerminalMode::setCanonicalMode() &
 
 namespace detail {
 
+void setBracketedPaste(bool enabled) noexcept
+{
+  using editor::EscapeSequences;
+
+  auto const sequence = enabled ? EscapeSequences::EnableBracketedPaste : EscapeSequences::DisableBracketedPaste;
+  [[maybe_unused]] auto const written = ::write(STDOUT_FILENO, sequence.data(), sequence.size());
+}
+
 void getTerminalDriverSettings(int fileDescriptor, termios& buf)
 {
   assert(fileDescriptor == STDIN_FILENO and "File descriptor must be STDIN_FILENO");
@@ -72,6 +72,10 @@ private:
 
 namespace detail {
 
+/// Turn the terminal's bracketed paste mode on or off. Terminals without it ignore the request
+/// \param[in] enabled Whether to turn it on
+void setBracketedPaste(bool enabled) noexcept;
+
 /// Query fileDescriptor and write its settings to buf
 /// \param[in] fileDescriptor The file descriptor to be queried
 /// \param[in] buf Where the settings are written to
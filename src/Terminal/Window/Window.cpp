@@ -41,6 +41,24 @@ Window::Window() : m_winsize(detail::getWindowSize())
 {
 }
 
+auto Window::update() noexcept -> bool
+{
+  ::winsize ws {};
+
+  // Unlike on startup, we don't fall back to querying the cursor position here. If the terminal can't tell us its
+  // size, we keep the size we already have
+  if (::ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == -1 or ws.ws_col == 0) {
+    return false;
+  }
+
+  if (ws.ws_col == m_winsize.cols and ws.ws_row == m_winsize.rows) {
+    return false;
+  }
+
+  m_winsize = WindowSize {.cols = ws.ws_col, .rows = ws.ws_row};
+  return true;
+}
+
 namespace detail {
 
 /// Get the size of the open terminal window
@@ -40,6 +40,12 @@ public:
   /// Create a new Window object
   explicit Window();
 
+  /// Create a Window object of a fixed size without querying the terminal
+  /// \param[in] size The size of the window
+  explicit constexpr Window(WindowSize size) noexcept : m_winsize(size)
+  {
+  }
+
   /// Get the number of columns of the terminal window
   /// \returns The number of columns of the terminal window
   [[nodiscard]] constexpr auto cols() const noexcept
@@ -54,6 +60,10 @@ public:
     return m_winsize.rows;
   }
 
+  /// Query the size of the terminal window again, e.g. after it was resized
+  /// \returns true if the size of the window changed, false otherwise
+  auto update() noexcept -> bool;
+
 private:
   WindowSize m_winsize;
 };
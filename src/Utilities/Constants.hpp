@@ -26,21 +26,71 @@
 
 #include <string_view>
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
 
 namespace Kilo::editor {
 
+namespace detail {
+
+template <std::string_view const&... Parts>
+struct Joined
+{
+  static constexpr auto storage = [] {
+    std::array<char, (Parts.size() + ... + 0)> joined {};
+    auto* out = joined.data();
+    ((out = std::ranges::copy(Parts, out).out), ...);
+    return joined;
+  }();
+};
+
+}   // namespace detail
+
+// Strings that are always written together are joined at compile time, so
+// that they go into the screen buffer with a single append
+template <std::string_view const&... Parts>
+inline constexpr std::string_view joined {detail::Joined<Parts...>::storage.data(),
+                                          detail::Joined<Parts...>::storage.size()};
+
 struct EscapeSequences
 {
   static constexpr std::string_view HideCursorWhenRepainting {"\x1b[?25l"};
   static constexpr std::string_view MoveCursorToHomePosition {"\x1b[H"};
   static constexpr std::string_view ShowTheCursor {"\x1b[?25h"};
   static constexpr std::string_view ErasePartOfLineToTheRightOfCursor {"\x1b[K"};
+
+  // Move the cursor down a row, or up a row, scrolling the rows between the margins if it is already on the last or
+  // first of them
+  static constexpr std::string_view Index {"\x1b" "D"};
+  static constexpr std::string_view ReverseIndex {"\x1bM"};
+  static constexpr std::string_view ResetScrollingMargins {"\x1b[r"};
+
+  // Have the terminal mark the start and the end of pasted text, so that it can be told apart from typing
+  static constexpr std::string_view EnableBracketedPaste {"\x1b[?2004h"};
+  static constexpr std::string_view DisableBracketedPaste {"\x1b[?2004l"};
+  static constexpr std::string_view PasteEnd {"\x1b[201~"};
+
+  // Hold back drawing until the end of the update, on terminals that support synchronized output (mode 2026)
+  static constexpr std::string_view BeginSynchronizedUpdate {"\x1b[?2026h"};
+  static constexpr std::string_view EndSynchronizedUpdate {"\x1b[?2026l"};
+
+  // Hide the cursor and start painting from the top left corner
+  static constexpr std::string_view BeginRepaint = joined<HideCursorWhenRepainting, MoveCursorToHomePosition>;
+
+  // Bracket a frame so that it is shown at once
+  static constexpr std::string_view BeginSynchronizedRepaint =
+    joined<BeginSynchronizedUpdate, HideCursorWhenRepainting>;
+  static constexpr std::string_view EndSynchronizedRepaint = joined<ShowTheCursor, EndSynchronizedUpdate>;
 };
 
 // The current version of the application
 inline constexpr std::string_view KiloVersion {"0.0.1"};
 
+// The message shown in the middle of an empty document
+inline constexpr std::string_view KiloWelcomePrefix {"Kilo editor -- version "};
+inline constexpr std::string_view KiloWelcomeMessage = joined<KiloWelcomePrefix, KiloVersion>;
+
 // The size of a tab character
 inline constexpr int KiloTabStop = 8;
 
@@ -50,6 +100,7 @@ inline constexpr int KiloTabStop = 8;
 // conflict with ordinary keypresses.
 enum class EditorKey : std::uint16_t
 {
+  Backspace = 127,
   ArrowLeft = 1000,
   ArrowRight,
   ArrowUp,
@@ -58,7 +109,10 @@ enum class EditorKey : std::uint16_t
   Home,
   End,
   PageUp,
-  PageDown
+  PageDown,
+
+  // The start of text pasted while bracketed paste mode is on. The text itself is read with IO::readPaste
+  PasteStart
 };
 
 }   // namespace Kilo::editor
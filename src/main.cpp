@@ -22,16 +22,36 @@
  */
 
 #include "Application/Application.hpp"
+#include "IO/IO.hpp"
 #include "Terminal/TerminalMode/TerminalMode.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdlib>
 #include <iostream>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <unistd.h>
 
 using namespace Kilo;
 
 int main(int argc, char const* argv[])
 {
+  // "kilo -f <file>..." follows the files as they grow, like tail -f. Every file named opens in a buffer of its own
+  auto const follow = argc >= 3 && std::string_view(argv[1]) == "-f";
+  auto const paths = std::span(argv, static_cast<std::size_t>(argc)).subspan(follow ? 2 : 1);
+
+  // "kilo -", or running kilo at the end of a pipeline, reads a document from stdin, so the terminal has to be found
+  // elsewhere before it is put in raw mode
+  auto const fromStdin = std::ranges::find(paths, std::string_view("-")) != paths.end();
+  std::optional<int> stream;
+
   try {
+    if (fromStdin || (paths.empty() && ::isatty(STDIN_FILENO) == 0)) {
+      stream = IO::detachStdin();
+    }
+
     static Terminal::TerminalMode terminalMode;
     terminalMode.setRawMode();
   }
@@ -42,8 +62,26 @@ int main(int argc, char const* argv[])
 
   editor::Application app;
 
-  if (argc >= 2 && !app.open(argv[1])) {
-    return EXIT_FAILURE;
+  if (stream && !fromStdin) {
+    app.openStream(*stream);
+  }
+
+  for (auto const* path : paths) {
+    if (std::string_view(path) == "-") {
+      app.openStream(*stream);
+    }
+    else if (!app.open(path)) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Opening doesn't switch buffers, so step through all of them to turn following on, ending up at the first again
+  for (std::size_t i = 0; follow && i < app.bufferCount(); i++) {
+    if (!app.toggleFollow()) {
+      return EXIT_FAILURE;
+    }
+
+    app.cycleBuffers(1);
   }
 
   app.run();
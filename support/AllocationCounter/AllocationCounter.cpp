@@ -0,0 +1,90 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "AllocationCounter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<std::size_t> allocations {0};
+
+}   // namespace
+
+namespace Kilo::support {
+
+auto globalAllocations() noexcept -> std::size_t
+{
+  return allocations.load(std::memory_order_relaxed);
+}
+
+}   // namespace Kilo::support
+
+auto operator new(std::size_t size) -> void*
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+
+  if (auto* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+// std::pmr::new_delete_resource() asks for memory through the aligned overloads
+auto operator new(std::size_t size, std::align_val_t alignment) -> void*
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+
+  auto const align = std::max(static_cast<std::size_t>(alignment), sizeof(void*));
+
+  if (auto* ptr = std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align)) {
+    return ptr;
+  }
+
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+  std::free(ptr);
+}
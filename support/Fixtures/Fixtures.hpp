@@ -0,0 +1,89 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef FIXTURES_HPP
+#define FIXTURES_HPP
+
+#include "Editor/Document/Document.hpp"
+#include "Editor/WorkerPool/WorkerPool.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include <poll.h>
+
+namespace Kilo::support {
+
+// What the tests of the work done in the background have in common: waiting
+// for it to be done, and a document of many distinct lines to do it on.
+
+/// Take in what the workers have done until all of it is in
+/// \param[in] workers The pool the work was posted to
+/// \param[in] results What the work is collected into. Done once it is ready(), or complete() if it has no ready()
+template <typename Results>
+void finish(editor::WorkerPool& workers, Results& results)
+{
+  auto const done = [&results] {
+    if constexpr (requires { results.ready(); }) {
+      return results.ready();
+    }
+    else {
+      return results.complete();
+    }
+  };
+
+  while (!done()) {
+    ::pollfd finished {.fd = workers.fileDescriptor(), .events = POLLIN, .revents = 0};
+    ::poll(&finished, 1, 1000);
+    workers.acknowledge();
+    results.collect();
+  }
+}
+
+/// Make a document of numbered lines, "line 0", "line 1" and so on
+/// \param[in] count The number of lines
+/// \param[in] suffix Gives what is appended to the line with a number, so that some lines can be told apart
+template <typename Suffix>
+auto numbered(std::size_t count, Suffix suffix) -> editor::Document
+{
+  editor::Document document;
+
+  for (std::size_t i = 0; i < count; i++) {
+    document.append("line " + std::to_string(i) + std::string(suffix(i)));
+  }
+
+  return document;
+}
+
+/// Make a document of numbered lines, "line 0", "line 1" and so on
+/// \param[in] count The number of lines
+inline auto numbered(std::size_t count) -> editor::Document
+{
+  return numbered(count, [](std::size_t) { return std::string_view(); });
+}
+
+}   // namespace Kilo::support
+
+#endif
@@ -0,0 +1,124 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Application/Application.hpp"
+
+#include "AllocationCounter/AllocationCounter.hpp"
+#include "Editor/Buffer/Buffer.hpp"
+#include "Editor/ColumnIndex/ColumnIndex.hpp"
+#include "Terminal/Window/Window.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Kilo::editor {
+
+TEST(Application, DrawingAFrameWithNothingChangedDoesNotAllocate)
+{
+  auto const path = std::filesystem::temp_directory_path() / ("kilo-frame-" + std::to_string(::getpid()) + ".c");
+
+  {
+    std::ofstream file(path, std::ios::binary);
+
+    for (auto i = 0; i < 20; i++) {
+      file << "int main() {\n  if (x) {\n    call(a, b);\n  }\n  return 0;\n}\n";
+
+      if (i % 5 == 4) {
+        file << std::string(3 * ColumnIndex::ChunkSize, '\t') << '\n';
+      }
+    }
+  }
+
+  // Keys are read from stdin, which a pipe stands in for
+  int keys[2] {};
+  ASSERT_THAT(::pipe(keys), ::testing::Eq(0));
+  auto const terminal = ::dup(STDIN_FILENO);
+  ::dup2(keys[0], STDIN_FILENO);
+
+  // Split the screen side by side, move onto the "(" of "call(a, b)" and leave a cursor on each of the two lines above
+  std::string typed = "\x16";
+
+  for (auto i = 0; i < 8; i++) {
+    typed += "\x1b[C";
+  }
+
+  typed += "\x05\x05";
+  ASSERT_THAT(::write(keys[1], typed.data(), typed.size()), ::testing::Eq(std::ssize(typed)));
+
+  auto const output = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+  auto allocations = std::size_t {};
+
+  {
+    Application app(Terminal::WindowSize {.cols = 80, .rows = 24}, output);
+    ASSERT_THAT(app.open(path), ::testing::IsTrue());
+
+    for (auto i = 0; i < 11; i++) {
+      app.processKeypress();
+    }
+
+    // The bracket that matches the one at the cursor is only found once the bracket index is ready, and the status line
+    // only stops changing once the statistics have been counted
+    auto const& buffer = app.current();
+
+    while (!buffer.brackets.ready() or !buffer.statistics.complete()) {
+      app.waitForInput();
+    }
+
+    auto const frame = [&app] {
+      app.scroll();
+      app.refreshScreen();
+    };
+
+    // The first frames grow the screen buffers and record the chunks of the long lines. Each is given time to be
+    // written, so that the next isn't drawn in full in its place
+    for (auto i = 0; i < 3; i++) {
+      frame();
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    auto const before = support::globalAllocations();
+    frame();
+    allocations = support::globalAllocations() - before;
+  }
+
+  ::dup2(terminal, STDIN_FILENO);
+  ::close(terminal);
+  ::close(keys[0]);
+  ::close(keys[1]);
+  ::close(output);
+  std::filesystem::remove(path);
+
+  ASSERT_THAT(allocations, ::testing::Eq(0));
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,227 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/BracketIndex/BracketIndex.hpp"
+
+#include "Editor/Cursor/Cursor.hpp"
+#include "Editor/Document/Document.hpp"
+#include "Editor/MultiCursor/MultiCursor.hpp"
+#include "Editor/WorkerPool/WorkerPool.hpp"
+#include "Fixtures/Fixtures.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Kilo::editor {
+
+using support::finish;
+
+namespace {
+
+// Brackets matched with a stack, one byte at a time. A closing bracket pops whatever was opened last, and pairs up
+// with it only if they are of the same kind
+struct Matched
+{
+  std::map<Cursor, Cursor> pairs;
+  std::map<Cursor, std::optional<Cursor>> enclosing;
+};
+
+auto matchedOf(Document const& document) -> Matched
+{
+  Matched matched;
+  std::vector<std::pair<Cursor, char>> open;
+  std::string const openers = "([{";
+  std::string const closers = ")]}";
+
+  for (std::size_t line = 0; line < document.lineCount(); line++) {
+    auto const text = document.line(line);
+
+    for (std::size_t byte = 0; byte <= text.size(); byte++) {
+      auto const at = Cursor {.x = static_cast<std::int64_t>(byte), .y = static_cast<std::int64_t>(line)};
+      matched.enclosing[at] = open.empty() ? std::nullopt : std::optional(open.back().first);
+
+      if (byte == text.size()) {
+        continue;
+      }
+
+      if (auto const kind = openers.find(text[byte]); kind != std::string::npos) {
+        open.emplace_back(at, text[byte]);
+      }
+      else if (auto const closer = closers.find(text[byte]); closer != std::string::npos and !open.empty()) {
+        if (openers.find(open.back().second) == closer) {
+          matched.pairs[at] = open.back().first;
+          matched.pairs[open.back().first] = at;
+        }
+
+        open.pop_back();
+      }
+    }
+  }
+
+  return matched;
+}
+
+}   // namespace
+
+TEST(BracketIndex, MatchesBracketsOfTheSameKindAcrossLines)
+{
+  Document const document {"f(a[1, {", "  b: (2)", "}] )", "(]"};
+  BracketIndex brackets(2);
+  WorkerPool workers(2);
+
+  brackets.replaced(workers, document, 0);
+  finish(workers, brackets);
+
+  ASSERT_THAT(brackets.match(document, {.x = 1, .y = 0}), ::testing::Eq(Cursor {.x = 3, .y = 2}));
+  ASSERT_THAT(brackets.match(document, {.x = 3, .y = 2}), ::testing::Eq(Cursor {.x = 1, .y = 0}));
+  ASSERT_THAT(brackets.match(document, {.x = 7, .y = 0}), ::testing::Eq(Cursor {.x = 0, .y = 2}));
+  ASSERT_THAT(brackets.match(document, {.x = 3, .y = 0}), ::testing::Eq(Cursor {.x = 1, .y = 2}));
+  ASSERT_THAT(brackets.match(document, {.x = 5, .y = 1}), ::testing::Eq(Cursor {.x = 7, .y = 1}));
+
+  // Brackets of different kinds don't pair up, and neither does anything else
+  ASSERT_THAT(brackets.match(document, {.x = 0, .y = 3}), ::testing::Eq(std::nullopt));
+  ASSERT_THAT(brackets.match(document, {.x = 1, .y = 3}), ::testing::Eq(std::nullopt));
+  ASSERT_THAT(brackets.match(document, {.x = 0, .y = 0}), ::testing::Eq(std::nullopt));
+}
+
+TEST(BracketIndex, EnclosingFindsTheInnermostOpenBracket)
+{
+  Document const document {"{ a", "  ( b [c] d )", "}"};
+  BracketIndex brackets;
+  WorkerPool workers(1);
+
+  brackets.replaced(workers, document, 0);
+  finish(workers, brackets);
+
+  ASSERT_THAT(brackets.enclosing(document, {.x = 10, .y = 1}), ::testing::Eq(Cursor {.x = 2, .y = 1}));
+  ASSERT_THAT(brackets.enclosing(document, {.x = 2, .y = 1}), ::testing::Eq(Cursor {.x = 0, .y = 0}));
+  ASSERT_THAT(brackets.enclosing(document, {.x = 7, .y = 1}), ::testing::Eq(Cursor {.x = 6, .y = 1}));
+  ASSERT_THAT(brackets.enclosing(document, {.x = 1, .y = 2}), ::testing::Eq(std::nullopt));
+  ASSERT_THAT(brackets.enclosing(document, {.x = 0, .y = 0}), ::testing::Eq(std::nullopt));
+}
+
+TEST(BracketIndex, LongLinesAreCutIntoBlocks)
+{
+  // A single line of minified JSON, nested deeper and deeper
+  std::string json;
+
+  for (auto i = 0; i < 2000; i++) {
+    json += "{\"k\":[1,";
+  }
+
+  for (auto i = 0; i < 2000; i++) {
+    json += "2]}";
+  }
+
+  Document const document {json};
+  BracketIndex brackets;
+  WorkerPool workers(1);
+
+  brackets.replaced(workers, document, 0);
+  ASSERT_FALSE(brackets.ready());
+  finish(workers, brackets);
+
+  ASSERT_THAT(brackets.blockCount(), ::testing::Eq((json.size() + BracketIndex::BlockBytes - 1) /
+                                                   BracketIndex::BlockBytes));
+  ASSERT_THAT(brackets.match(document, {.x = 0, .y = 0}),
+              ::testing::Eq(Cursor {.x = static_cast<std::int64_t>(json.size() - 1), .y = 0}));
+  ASSERT_THAT(brackets.match(document, {.x = 8 * 1000 + 5, .y = 0}),
+              ::testing::Eq(Cursor {.x = 8 * 2000 + 3 * 999 + 1, .y = 0}));
+  ASSERT_THAT(brackets.enclosing(document, {.x = 8 * 2000, .y = 0}),
+              ::testing::Eq(Cursor {.x = 8 * 1999 + 5, .y = 0}));
+}
+
+TEST(BracketIndex, EditsGiveTheSameMatchesAsAStack)
+{
+  std::mt19937 random(46);
+  std::string const bytes = "(){}[]x ";
+  Document document;
+
+  for (auto i = 0; i < 300; i++) {
+    std::string line;
+
+    for (auto length = random() % (i == 150 ? 5000 : 12); length > 0; length--) {
+      line += bytes[random() % bytes.size()];
+    }
+
+    document.append(line);
+  }
+
+  BracketIndex brackets(16);
+  WorkerPool workers(4);
+  brackets.replaced(workers, document, 0);
+
+  std::vector<std::string> const texts {"(", ")", "{", "]", "x", "\n", "(\n)", "}\n{"};
+
+  for (auto step = 0; step < 100; step++) {
+    std::vector<Cursor> cursors;
+
+    for (auto count = random() % 3 + 1; count > 0; count--) {
+      auto const line = random() % document.lineCount();
+      auto const length = document.line(line).size();
+      cursors.push_back(Cursor {.x = static_cast<std::int64_t>(random() % (length + 1)),
+                                .y = static_cast<std::int64_t>(line)});
+    }
+
+    normalize(cursors);
+
+    auto const changed = random() % 3 == 0
+                           ? eraseAt(document, cursors, random() % 2 == 0 ? Direction::Forward : Direction::Backward)
+                           : insertAt(document, cursors, texts[random() % texts.size()]);
+
+    // The first edits come in while the document is still being classified
+    brackets.changed(workers, document, changed);
+
+    if (step >= 5) {
+      finish(workers, brackets);
+    }
+
+    if (!brackets.ready()) {
+      continue;
+    }
+
+    auto const matched = matchedOf(document);
+
+    for (auto i = 0; i < 20; i++) {
+      auto const line = random() % document.lineCount();
+      auto const length = document.line(line).size();
+      auto const at = Cursor {.x = static_cast<std::int64_t>(random() % (length + 1)),
+                              .y = static_cast<std::int64_t>(line)};
+      auto const pair = matched.pairs.find(at);
+
+      ASSERT_THAT(brackets.match(document, at),
+                  ::testing::Eq(pair == matched.pairs.end() ? std::nullopt : std::optional(pair->second)))
+        << "step " << step << " at " << at.y << ":" << at.x;
+      ASSERT_THAT(brackets.enclosing(document, at), ::testing::Eq(matched.enclosing.at(at)))
+        << "step " << step << " at " << at.y << ":" << at.x;
+    }
+  }
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,53 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Terminal/Capabilities/Capabilities.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace Kilo::Terminal::detail {
+
+TEST(reportsMode, RecognisesAModeTheTerminalCanSetOrReset)
+{
+  ASSERT_THAT(reportsMode("\x1b[?2026;2$y\x1b[?62;22c", 2026), ::testing::IsTrue());
+  ASSERT_THAT(reportsMode("\x1b[?2026;1$y", 2026), ::testing::IsTrue());
+}
+
+TEST(reportsMode, RejectsModesThatAreUnknownOrPermanentlyReset)
+{
+  ASSERT_THAT(reportsMode("\x1b[?2026;0$y\x1b[?62;22c", 2026), ::testing::IsFalse());
+  ASSERT_THAT(reportsMode("\x1b[?2026;4$y", 2026), ::testing::IsFalse());
+  ASSERT_THAT(reportsMode("\x1b[?62;22c", 2026), ::testing::IsFalse());
+  ASSERT_THAT(reportsMode("\x1b[?20262;1$y", 2026), ::testing::IsFalse());
+}
+
+TEST(hasDeviceAttributes, WaitsForTheReplyToTheLastQuery)
+{
+  ASSERT_THAT(hasDeviceAttributes(""), ::testing::IsFalse());
+  ASSERT_THAT(hasDeviceAttributes("\x1b[?2026;2$y"), ::testing::IsFalse());
+  ASSERT_THAT(hasDeviceAttributes("\x1b[?2026;2$y\x1b[?62;2"), ::testing::IsFalse());
+  ASSERT_THAT(hasDeviceAttributes("\x1b[?2026;2$y\x1b[?62;22c"), ::testing::IsTrue());
+}
+
+}   // namespace Kilo::Terminal::detail
@@ -0,0 +1,118 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/ColumnIndex/ColumnIndex.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Kilo::editor {
+
+namespace {
+
+/// Work out the column of every byte of a line the slow way
+auto columnsOf(std::string const& text) -> std::vector<std::size_t>
+{
+  std::vector<std::size_t> columns {0};
+
+  for (auto const c : text) {
+    columns.push_back(c == '\t' ? columns.back() + 8 - columns.back() % 8 : columns.back() + 1);
+  }
+
+  return columns;
+}
+
+}   // namespace
+
+TEST(ColumnIndex, TabsExpandToTheNextTabStop)
+{
+  ColumnIndex index;
+  std::string const text {"a\tbc\t\td"};
+
+  ASSERT_THAT(index.columnOf(0, text, 1), ::testing::Eq(1));
+  ASSERT_THAT(index.columnOf(0, text, 2), ::testing::Eq(8));
+  ASSERT_THAT(index.columnOf(0, text, 5), ::testing::Eq(16));
+  ASSERT_THAT(index.width(0, text), ::testing::Eq(25));
+}
+
+TEST(ColumnIndex, LocateFindsTheTabCoveringAColumn)
+{
+  ColumnIndex index;
+  std::string const text {"a\tb"};
+
+  auto const inTab = index.locate(0, text, 5);
+  ASSERT_THAT(inTab.byte, ::testing::Eq(1));
+  ASSERT_THAT(inTab.column, ::testing::Eq(1));
+
+  auto const after = index.locate(0, text, 8);
+  ASSERT_THAT(after.byte, ::testing::Eq(2));
+  ASSERT_THAT(after.column, ::testing::Eq(8));
+
+  auto const past = index.locate(0, text, 20);
+  ASSERT_THAT(past.byte, ::testing::Eq(3));
+  ASSERT_THAT(past.column, ::testing::Eq(9));
+}
+
+TEST(ColumnIndex, LongLinesAgreeWithScanningFromTheStart)
+{
+  std::string text;
+
+  for (std::size_t i = 0; text.size() < 5 * ColumnIndex::ChunkSize; i++) {
+    text += i % 7 == 0 ? '\t' : 'x';
+  }
+
+  auto const expected = columnsOf(text);
+  ColumnIndex index;
+
+  // Ask for bytes out of order, so that chunks are recorded both ahead of and behind what is asked
+  for (auto byte = text.size(); byte > 997; byte -= 997) {
+    ASSERT_THAT(index.columnOf(3, text, byte), ::testing::Eq(expected[byte]));
+  }
+
+  for (std::size_t byte = 0; byte < text.size(); byte += 613) {
+    auto const position = index.locate(3, text, expected[byte]);
+    ASSERT_THAT(position.byte, ::testing::Eq(byte));
+    ASSERT_THAT(position.column, ::testing::Eq(expected[byte]));
+  }
+
+  ASSERT_THAT(index.width(3, text), ::testing::Eq(expected.back()));
+}
+
+TEST(ColumnIndex, LinesAreIndexedSeparatelyUntilCleared)
+{
+  std::string const tabs(2 * ColumnIndex::ChunkSize, '\t');
+  std::string const plain(2 * ColumnIndex::ChunkSize, 'x');
+  ColumnIndex index;
+
+  ASSERT_THAT(index.width(0, tabs), ::testing::Eq(8 * tabs.size()));
+  ASSERT_THAT(index.width(1, plain), ::testing::Eq(plain.size()));
+
+  index.clear();
+  ASSERT_THAT(index.width(0, plain), ::testing::Eq(plain.size()));
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,253 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "Editor/Document/Document.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/mman.h>
+
+namespace Kilo::editor {
+
+namespace {
+
+void expectSameLines(Document const& doc, std::vector<std::string> const& expected)
+{
+  ASSERT_THAT(doc.lineCount(), ::testing::Eq(expected.size()));
+
+  std::size_t offset = 0;
+
+  for (std::size_t i = 0; i < expected.size(); i++) {
+    ASSERT_THAT(doc.line(i), ::testing::Eq(expected[i]));
+    ASSERT_THAT(doc.lineOffset(i), ::testing::Eq(offset));
+    offset += expected[i].size() + 1;
+  }
+
+  ASSERT_THAT(doc.byteCount(), ::testing::Eq(offset));
+}
+
+}   // namespace
+
+TEST(Document, IsEmptyWhenCreated)
+{
+  Document const doc;
+
+  ASSERT_TRUE(doc.empty());
+  ASSERT_THAT(doc.byteCount(), ::testing::Eq(0));
+}
+
+TEST(Document, CountsOneNewlinePerLine)
+{
+  Document const doc {"abc", "", "de"};
+
+  ASSERT_THAT(doc.lineCount(), ::testing::Eq(3));
+  ASSERT_THAT(doc.byteCount(), ::testing::Eq(8));
+  ASSERT_THAT(doc.lineOffset(2), ::testing::Eq(5));
+}
+
+TEST(Document, LineAtFindsTheLineContainingAnOffset)
+{
+  Document const doc {"abc", "", "de"};
+
+  ASSERT_THAT(doc.lineAt(0), ::testing::Eq(0));
+  ASSERT_THAT(doc.lineAt(3), ::testing::Eq(0));
+  ASSERT_THAT(doc.lineAt(4), ::testing::Eq(1));
+  ASSERT_THAT(doc.lineAt(7), ::testing::Eq(2));
+}
+
+TEST(Document, SplitAndJoinLinesInTheMiddleOfALargeDocument)
+{
+  Document doc;
+  std::vector<std::string> expected;
+
+  for (int i = 0; i < 10'000; i++) {
+    doc.append(std::to_string(i));
+    expected.push_back(std::to_string(i));
+  }
+
+  doc.splitLine(5000, 2);
+  expected[5000] = "50";
+  expected.insert(expected.begin() + 5001, "00");
+  expectSameLines(doc, expected);
+
+  doc.joinLines(5000);
+  expected[5000] = "5000";
+  expected.erase(expected.begin() + 5001);
+  expectSameLines(doc, expected);
+}
+
+TEST(Document, MatchesAVectorUnderRandomEdits)
+{
+  Document doc;
+  std::vector<std::string> expected;
+  std::mt19937 rng(42);
+
+  for (int step = 0; step < 20'000; step++) {
+    auto const op = rng() % 4;
+
+    if (op <= 1 or expected.empty()) {
+      auto const at = rng() % (expected.size() + 1);
+      auto text = std::string(rng() % 12, static_cast<char>('a' + step % 26));
+      doc.insertLine(at, text);
+      expected.insert(expected.begin() + static_cast<std::ptrdiff_t>(at), text);
+    }
+    else if (op == 2) {
+      auto const at = rng() % expected.size();
+      doc.eraseLine(at);
+      expected.erase(expected.begin() + static_cast<std::ptrdiff_t>(at));
+    }
+    else {
+      auto const at = rng() % expected.size();
+      auto text = std::to_string(step);
+      doc.replaceLine(at, text);
+      expected[at] = text;
+    }
+  }
+
+  expectSameLines(doc, expected);
+}
+
+TEST(Document, HandlesLinesLongerThanALeaf)
+{
+  Document doc;
+  std::vector<std::string> expected;
+
+  for (int i = 0; i < 50; i++) {
+    auto text = std::string(static_cast<std::size_t>(1000 * (i % 7)), static_cast<char>('a' + i % 26));
+    doc.insertLine(static_cast<std::size_t>(i / 2), text);
+    expected.insert(expected.begin() + i / 2, text);
+  }
+
+  doc.replaceLine(10, std::string(100'000, 'z'));
+  expected[10] = std::string(100'000, 'z');
+  expectSameLines(doc, expected);
+
+  doc.joinLines(10);
+  expected[10] += expected[11];
+  expected.erase(expected.begin() + 11);
+  expectSameLines(doc, expected);
+
+  ASSERT_THAT(doc.lineAt(doc.lineOffset(10) + 50'000), ::testing::Eq(10));
+}
+
+TEST(Document, RejectsALineLongerThanItCanHold)
+{
+  // Pages that are never touched are never backed by memory, so the line costs nothing to make
+  auto const size = Document::MaxLineBytes + 1;
+  auto* const bytes = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  ASSERT_THAT(bytes, ::testing::Ne(MAP_FAILED));
+  auto const text = std::string_view(static_cast<char const*>(bytes), size);
+
+  Document doc {"one", "two"};
+
+  ASSERT_THROW(doc.append(text), std::length_error);
+  ASSERT_THROW(doc.insertLine(1, text), std::length_error);
+  ASSERT_THROW(doc.replaceLine(0, text), std::length_error);
+  ::munmap(bytes, size);
+
+  expectSameLines(doc, {"one", "two"});
+}
+
+TEST(Document, CopiesAreNotAffectedByLaterEdits)
+{
+  Document doc;
+
+  for (int i = 0; i < 1000; i++) {
+    doc.append(std::to_string(i));
+  }
+
+  auto const snapshot = doc;
+
+  doc.replaceLine(500, "changed");
+  doc.eraseLine(0);
+
+  ASSERT_THAT(snapshot.lineCount(), ::testing::Eq(1000));
+  ASSERT_THAT(snapshot.line(0), ::testing::Eq("0"));
+  ASSERT_THAT(snapshot.line(500), ::testing::Eq("500"));
+  ASSERT_THAT(doc.line(499), ::testing::Eq("changed"));
+}
+
+TEST(Document, DifferenceFindsTheLinesAnEditReplaced)
+{
+  Document doc;
+  std::mt19937 rng(7);
+
+  for (std::size_t i = 0; i < 50'000; i++) {
+    doc.append(std::to_string(i));
+  }
+
+  for (int step = 0; step < 200; step++) {
+    auto const before = doc;
+    auto const first = rng() % (doc.lineCount() + 1);
+    auto const removed = std::min<std::size_t>(rng() % 600, doc.lineCount() - first);
+    auto const added = rng() % 600;
+
+    for (std::size_t i = 0; i < removed; i++) {
+      doc.eraseLine(first);
+    }
+
+    for (std::size_t i = 0; i < added; i++) {
+      doc.insertLine(first + i, "step " + std::to_string(step) + " line " + std::to_string(i));
+    }
+
+    auto const replaced = doc.difference(before);
+    ASSERT_THAT(replaced.first, ::testing::Eq(first));
+    ASSERT_THAT(replaced.removed, ::testing::Eq(removed));
+    ASSERT_THAT(replaced.added, ::testing::Eq(added));
+  }
+}
+
+TEST(Document, DifferenceComparesTheTextOfDocumentsThatShareNoNodes)
+{
+  auto const before = Document {"a", "b", "c", "d"};
+
+  auto const changed = Document {"a", "x", "y", "d"}.difference(before);
+  ASSERT_THAT(changed.first, ::testing::Eq(1));
+  ASSERT_THAT(changed.removed, ::testing::Eq(2));
+  ASSERT_THAT(changed.added, ::testing::Eq(2));
+
+  auto const shorter = Document {"a", "d"}.difference(before);
+  ASSERT_THAT(shorter.first, ::testing::Eq(1));
+  ASSERT_THAT(shorter.removed, ::testing::Eq(2));
+  ASSERT_THAT(shorter.added, ::testing::Eq(0));
+
+  auto const same = Document {"a", "b", "c", "d"}.difference(before);
+  ASSERT_THAT(same.removed, ::testing::Eq(0));
+  ASSERT_THAT(same.added, ::testing::Eq(0));
+
+  auto const emptied = Document().difference(before);
+  ASSERT_THAT(emptied.removed, ::testing::Eq(4));
+  ASSERT_THAT(emptied.added, ::testing::Eq(0));
+}
+
+}   // namespace Kilo::editor
@@ -23,8 +23,14 @@
 
 #include "Editor/Editor.hpp"
 
+#include "AllocationCounter/AllocationCounter.hpp"
+#include "Editor/ColumnIndex/ColumnIndex.hpp"
 #include "Editor/Cursor/Cursor.hpp"
+#include "Editor/Document/Document.hpp"
+#include "Editor/Offset/Offset.hpp"
+#include "Editor/Region/Region.hpp"
 #include "Editor/ScreenBuffer/ScreenBuffer.hpp"
+#include "Editor/TextScanner/TextScanner.hpp"
 #include "Terminal/Window/Window.hpp"
 #include "Utilities/Utilities.hpp"
 
@@ -33,6 +39,9 @@
 #include <gtest/gtest.h>
 
 #include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -45,7 +54,7 @@ TEST(processKeypress, TerminatesTheProgramIfQIsPressed)
 
   Cursor cursor {100, 100};
   Window const window;
-  std::vector<std::string> const& doc {};
+  Document const doc {};
 
   auto key = utilities::ctrlKey('q');
   ASSERT_EXIT(processKeypress(key, cursor, window, doc), ::testing::ExitedWithCode(0), ::testing::Eq(""));
@@ -59,7 +68,7 @@ TEST(processKeypress, MovesCursorToStartOfLineIfHomeButtonIsPressed)
   EditorKey const key = EditorKey::Home;
   Cursor cursor {100, 100};
   Window const window;
-  std::vector<std::string> const& doc {};
+  Document const doc {};
 
   processKeypress(static_cast<int>(key), cursor, window, doc);
 
@@ -72,13 +81,132 @@ TEST(processKeypress, MovesCursorToEndOfLineIfEndButtonIsPressed)
   using Terminal::Window;
 
   EditorKey const key = EditorKey::End;
-  Cursor cursor {100, 100};
+  Cursor cursor {0, 1};
   Window const window;
-  std::vector<std::string> const& doc {};
+  Document doc {};
+  doc.append("short");
+  doc.append(std::string(static_cast<std::size_t>(window.cols()) * 3, 'x'));
 
   processKeypress(static_cast<int>(key), cursor, window, doc);
 
-  ASSERT_THAT(cursor.x, ::testing::Eq(window.cols() - 1));
+  ASSERT_THAT(cursor.x, ::testing::Eq(window.cols() * 3));
+}
+
+TEST(save, WritesTheFileBackWithTheLineEndingAndByteOrderMarkItWasOpenedWith)
+{
+  auto const path = std::filesystem::temp_directory_path() / "kilo-save-test.txt";
+  std::string const contents = "\xEF\xBB\xBF" "one\r\ntwo\r\nthree";
+  std::ofstream(path, std::ios::binary) << contents;
+
+  Document doc;
+  Document rendered;
+  TextFormat format;
+
+  ASSERT_THAT(open(path, doc, rendered, format), ::testing::IsTrue());
+  ASSERT_THAT(doc.line(0), ::testing::Eq("one"));
+  ASSERT_THAT(doc.line(1), ::testing::Eq("two"));
+
+  doc.replaceLine(1, "2");
+  ASSERT_THAT(save(path, doc, format), ::testing::IsTrue());
+
+  std::ostringstream saved;
+  saved << std::ifstream(path, std::ios::binary).rdbuf();
+  std::filesystem::remove(path);
+
+  ASSERT_THAT(saved.str(), ::testing::Eq("\xEF\xBB\xBF" "one\r\n2\r\nthree"));
+}
+
+TEST(save, WritesAFileOfMixedLineEndingsBackWithTheOneMostLinesHad)
+{
+  auto const path = std::filesystem::temp_directory_path() / "kilo-save-mixed-test.txt";
+  std::ofstream(path, std::ios::binary) << "one\r\ntwo\nthree\r\n";
+
+  Document doc;
+  Document rendered;
+  TextFormat format;
+
+  ASSERT_THAT(open(path, doc, rendered, format), ::testing::IsTrue());
+  ASSERT_THAT(doc.line(0), ::testing::Eq("one"));
+  ASSERT_THAT(doc.line(1), ::testing::Eq("two"));
+  ASSERT_THAT(format.lineEnding(), ::testing::Eq(LineEnding::CrLf));
+  ASSERT_THAT(format.convertedLines(), ::testing::Eq(1));
+
+  ASSERT_THAT(save(path, doc, format), ::testing::IsTrue());
+
+  std::ostringstream saved;
+  saved << std::ifstream(path, std::ios::binary).rdbuf();
+  std::filesystem::remove(path);
+
+  ASSERT_THAT(saved.str(), ::testing::Eq("one\r\ntwo\r\nthree\r\n"));
+}
+
+TEST(drawRegion, DrawingAFrameNoLargerThanThePreviousOneDoesNotAllocate)
+{
+  Document document;
+
+  for (int i = 0; i < 100; i++) {
+    document.append(i % 10 == 0 ? std::string(3 * ColumnIndex::ChunkSize, '\t') : "a\tline\tof\ttext");
+  }
+
+  Document const empty;
+  ColumnIndex columns;
+  ColumnIndex emptyColumns;
+  ScreenBuffer buffer;
+
+  Region const left {.top = 0, .left = 0, .rows = 24, .cols = 39};
+  Region const separator {.top = 0, .left = 39, .rows = 24, .cols = 1};
+  Region const right {.top = 0, .left = 40, .rows = 24, .cols = 40};
+
+  auto const drawFrame = [&] {
+    buffer.write(EscapeSequences::BeginRepaint);
+    drawRegion(left, 80, Offset {.row = 5, .col = 2 * ColumnIndex::ChunkSize}, buffer, document, columns);
+    drawSeparator(separator, buffer);
+    drawRegion(right, 80, Offset {}, buffer, empty, emptyColumns);
+    buffer.selectGraphicRendition(1, 7).write("status").selectGraphicRendition().eraseInLine();
+    buffer.moveCursorTo(12, 40).write(EscapeSequences::ShowTheCursor);
+    buffer.clear();
+  };
+
+  // The first frame grows the screen buffer and records the chunks of the long lines
+  drawFrame();
+
+  auto const before = support::globalAllocations();
+  drawFrame();
+
+  ASSERT_THAT(support::globalAllocations() - before, ::testing::Eq(0));
+}
+
+TEST(drawWrappedRegion, FoldsLinesByTheColumnsTheirTabsTakeUp)
+{
+  // The tab covers columns 4 to 7, so it is split across the first two rows
+  Document const document {"abcd\tX"};
+  ColumnIndex columns;
+  ScreenBuffer buffer;
+
+  auto const wrap = buildWrapIndex(document, Terminal::Window(Terminal::WindowSize {.cols = 6, .rows = 3}), columns);
+  ASSERT_THAT(wrap.rowsOf(0), ::testing::Eq(2));
+
+  // Rows written up to the edge of the screen aren't erased, which would blank their last column
+  drawWrappedRegion(Region {.top = 0, .left = 0, .rows = 3, .cols = 6}, 6, Offset {}, wrap, buffer, document, columns);
+  ASSERT_THAT(std::string(buffer.c_str(), buffer.size()),
+              ::testing::Eq("\x1b[1;1Habcd  \x1b[2;1H  X\x1b[K\x1b[3;1H~\x1b[K"));
+
+  auto const x = Cursor {.x = static_cast<std::int64_t>(columns.columnOf(0, document.line(0), 5)), .y = 0};
+  ASSERT_THAT(wrappedRowOf(x, wrap), ::testing::Eq(1));
+  ASSERT_THAT(wrappedColumnOf(x, wrap), ::testing::Eq(2));
+}
+
+TEST(scrollRegion, IndexesPastTheEdgeOfTheRegionOncePerRow)
+{
+  Region const region {.top = 2, .left = 0, .rows = 10, .cols = 80};
+  ScreenBuffer up;
+  ScreenBuffer down;
+
+  scrollRegion(region, 2, up);
+  scrollRegion(region, -1, down);
+
+  ASSERT_THAT(std::string(up.c_str(), up.size()), ::testing::Eq("\x1b[3;12r\x1b[12;1H\x1b" "D\x1b" "D\x1b[r"));
+  ASSERT_THAT(std::string(down.c_str(), down.size()), ::testing::Eq("\x1b[3;12r\x1b[3;1H\x1bM\x1b[r"));
 }
 
 namespace detail {
@@ -134,6 +262,28 @@ TEST(printLineOfDocument, TruncatesTheLineIfItsLongerThanWindowWidth)
   ASSERT_THAT(buf.size(), ::testing::Eq(windowWidth));
 }
 
+TEST(printColumnsOfLine, ExpandsTabsAndShowsOnlyTheVisiblePartOfATabOnTheLeftEdge)
+{
+  std::string const line {"ab\tcd\tef"};
+  ScreenBuffer buf;
+
+  // Column 5 lies inside the first tab, which ends at column 8
+  printColumnsOfLine(line, {.byte = 2, .column = 2}, 5, 8, buf);
+
+  ASSERT_THAT(std::string(buf.c_str(), buf.size()), ::testing::Eq("   cd   "));
+}
+
+TEST(printColumnsOfLine, StopsAtTheWidthOfTheRow)
+{
+  std::string const line(1000, 'x');
+  ScreenBuffer buf;
+
+  auto const written = printColumnsOfLine(line, {.byte = 500, .column = 500}, 500, 20, buf);
+
+  ASSERT_THAT(written, ::testing::Eq(20));
+  ASSERT_THAT(buf.size(), ::testing::Eq(20));
+}
+
 }   // namespace detail
 
 }   // namespace Kilo::editor
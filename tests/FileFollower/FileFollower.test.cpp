@@ -0,0 +1,126 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/FileFollower/FileFollower.hpp"
+
+#include "Editor/Document/Document.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <unistd.h>
+
+namespace Kilo::editor {
+
+namespace {
+
+constexpr std::size_t Unlimited = static_cast<std::size_t>(-1);
+
+class FileFollowerTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_dir = std::filesystem::temp_directory_path() / ("kilo-follow-" + std::to_string(::getpid()));
+    std::filesystem::create_directories(m_dir);
+    m_path = m_dir / "app.log";
+  }
+
+  void TearDown() override
+  {
+    std::filesystem::remove_all(m_dir);
+  }
+
+  void write(std::string_view text, std::ios::openmode mode = std::ios::app) const
+  {
+    std::ofstream(m_path, mode | std::ios::binary) << text;
+  }
+
+  std::filesystem::path m_dir;
+  std::filesystem::path m_path;
+};
+
+}   // namespace
+
+TEST_F(FileFollowerTest, AppendedLinesAreAddedToTheDocument)
+{
+  write("one\ntwo\n");
+  Document doc {"one", "two"};
+  FileFollower follower(m_path, doc);
+
+  write("three\nfo");
+  ASSERT_THAT(follower.update(doc, Unlimited), ::testing::Eq(FileFollower::Update::Appended));
+  ASSERT_THAT(doc.lineCount(), ::testing::Eq(3));
+  ASSERT_THAT(doc.line(2), ::testing::Eq("three"));
+
+  write("ur\n");
+  follower.update(doc, Unlimited);
+  ASSERT_THAT(doc.lineCount(), ::testing::Eq(4));
+  ASSERT_THAT(doc.line(3), ::testing::Eq("four"));
+  ASSERT_THAT(follower.caughtUp(), ::testing::IsTrue());
+}
+
+TEST_F(FileFollowerTest, AnUnfinishedLastLineIsReadAgainOnceItIsComplete)
+{
+  write("one\ntw");
+  Document doc {"one", "tw"};
+  FileFollower follower(m_path, doc);
+
+  ASSERT_THAT(doc.lineCount(), ::testing::Eq(1));
+
+  write("o\n");
+  follower.update(doc, Unlimited);
+  ASSERT_THAT(doc.lineCount(), ::testing::Eq(2));
+  ASSERT_THAT(doc.line(1), ::testing::Eq("two"));
+}
+
+TEST_F(FileFollowerTest, TruncationReloadsTheDocument)
+{
+  write("a long first line\nand a second\n");
+  Document doc {"a long first line", "and a second"};
+  FileFollower follower(m_path, doc);
+
+  write("new\n", std::ios::trunc);
+  ASSERT_THAT(follower.update(doc, Unlimited), ::testing::Eq(FileFollower::Update::Reloaded));
+  ASSERT_THAT(doc.lineCount(), ::testing::Eq(1));
+  ASSERT_THAT(doc.line(0), ::testing::Eq("new"));
+}
+
+TEST_F(FileFollowerTest, RotationSwitchesToTheNewFile)
+{
+  write("old\n");
+  Document doc {"old"};
+  FileFollower follower(m_path, doc);
+
+  std::filesystem::rename(m_path, m_dir / "app.log.1");
+  write("fresh\nlines\n");
+
+  ASSERT_THAT(follower.update(doc, Unlimited), ::testing::Eq(FileFollower::Update::Reloaded));
+  ASSERT_THAT(doc.lineCount(), ::testing::Eq(2));
+  ASSERT_THAT(doc.line(0), ::testing::Eq("fresh"));
+}
+
+}   // namespace Kilo::editor
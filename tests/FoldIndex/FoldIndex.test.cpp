@@ -0,0 +1,164 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/FoldIndex/FoldIndex.hpp"
+
+#include "Editor/Cursor/Cursor.hpp"
+#include "Editor/Document/Document.hpp"
+#include "Editor/MultiCursor/MultiCursor.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Kilo::editor {
+
+// Shown by gtest when an assertion fails
+void PrintTo(FoldRange const& range, std::ostream* out)
+{
+  *out << range.start << ".." << range.end << (range.collapsed ? " folded" : "");
+}
+
+namespace {
+
+auto rangesOf(FoldIndex const& folds) -> std::vector<FoldRange>
+{
+  return {folds.ranges().begin(), folds.ranges().end()};
+}
+
+auto built(Document const& document) -> FoldIndex
+{
+  FoldIndex folds;
+  folds.build(document);
+  return folds;
+}
+
+}   // namespace
+
+TEST(FoldIndex, BracketsAndIndentationStartingOnTheSameLineMakeOneRange)
+{
+  Document const document {"int f() {", "  a;", "", "  b;", "}", "int g();"};
+
+  ASSERT_THAT(rangesOf(built(document)), ::testing::ElementsAre(FoldRange {.start = 0, .end = 3, .collapsed = false}));
+}
+
+TEST(FoldIndex, IndentedRunsEndOnTheirLastNonBlankLine)
+{
+  Document const document {"def f():", "    x", "", "    if y:", "\tz", "", "w"};
+
+  ASSERT_THAT(rangesOf(built(document)),
+              ::testing::ElementsAre(FoldRange {.start = 0, .end = 4, .collapsed = false},
+                                     FoldRange {.start = 3, .end = 4, .collapsed = false}));
+}
+
+TEST(FoldIndex, BracketsInLiteralsAndOnASingleLineAreIgnored)
+{
+  Document const document {"s = \"{\";", "c = '(';", "f(a[0]);", "call(a,", "b);", "x"};
+
+  // The closing line doesn't start with the bracket, so it is folded away too
+  ASSERT_THAT(rangesOf(built(document)), ::testing::ElementsAre(FoldRange {.start = 3, .end = 4, .collapsed = false}));
+}
+
+TEST(FoldIndex, FoldingHidesTheLinesAfterTheFirstAndMapsRowsAroundThem)
+{
+  Document const document {"a {", "  b", "  c", "}", "d {", "  e", "}"};
+  auto folds = built(document);
+
+  ASSERT_THAT(folds.toggle(1), ::testing::Optional(0));
+  ASSERT_TRUE(folds.folded());
+  ASSERT_TRUE(folds.hidden(2));
+  ASSERT_FALSE(folds.hidden(3));
+  ASSERT_THAT(folds.hiddenAfter(0), ::testing::Eq(2));
+  ASSERT_THAT(folds.rowCount(), ::testing::Eq(5));
+  ASSERT_THAT(folds.rowOf(3), ::testing::Eq(1));
+  ASSERT_THAT(folds.lineAt(1), ::testing::Eq(3));
+  ASSERT_THAT(folds.lineAt(6), ::testing::Eq(8));
+
+  folds.foldAll(true);
+  ASSERT_THAT(folds.rowCount(), ::testing::Eq(4));
+  ASSERT_THAT(folds.lineAt(3), ::testing::Eq(6));
+
+  ASSERT_TRUE(folds.reveal(5));
+  ASSERT_FALSE(folds.hidden(5));
+  ASSERT_TRUE(folds.hidden(1));
+
+  ASSERT_THAT(folds.toggle(0), ::testing::Optional(0));
+  ASSERT_FALSE(folds.folded());
+  ASSERT_THAT(folds.lineAt(3), ::testing::Eq(3));
+}
+
+TEST(FoldIndex, EditingOutsideAFoldKeepsItFoldedAndMovesItAlong)
+{
+  Document document {"x", "a {", "  b", "}"};
+  auto folds = built(document);
+  folds.toggle(1);
+
+  std::vector cursors {Cursor {.x = 1, .y = 0}};
+  ASSERT_TRUE(folds.changed(document, insertAt(document, cursors, "\ny")));
+
+  ASSERT_THAT(rangesOf(folds), ::testing::ElementsAre(FoldRange {.start = 2, .end = 3, .collapsed = true}));
+  ASSERT_TRUE(folds.hidden(3));
+  ASSERT_THAT(folds.rowCount(), ::testing::Eq(4));
+}
+
+TEST(FoldIndex, EditsGiveTheSameRangesAsBuildingFromScratch)
+{
+  // A document of nested blocks, edited at random with the kinds of text that change the ranges
+  std::mt19937 random(45);
+  Document document;
+
+  for (auto i = 0; i < 200; i++) {
+    auto const depth = static_cast<std::size_t>(random() % 4);
+    document.append(std::string(2 * depth, ' ') + (random() % 3 == 0 ? "if (x) {" : random() % 2 == 0 ? "}" : "y;"));
+  }
+
+  std::vector<std::string> const texts {"{", "}", "(", ")", "\n", "  ", "\t", "z", "\n  }\n", "\"{\"", "\n\n",
+                                        "\n    x\n"};
+  auto folds = built(document);
+
+  for (auto step = 0; step < 400; step++) {
+    std::vector<Cursor> cursors;
+
+    for (auto count = random() % 3 + 1; count > 0; count--) {
+      auto const line = static_cast<std::int64_t>(random() % document.lineCount());
+      auto const length = static_cast<std::int64_t>(document.line(static_cast<std::size_t>(line)).size());
+      cursors.push_back(Cursor {.x = static_cast<std::int64_t>(random() % static_cast<std::size_t>(length + 1)),
+                                .y = line});
+    }
+
+    normalize(cursors);
+
+    auto const changed = random() % 3 == 0
+                           ? eraseAt(document, cursors, random() % 2 == 0 ? Direction::Forward : Direction::Backward)
+                           : insertAt(document, cursors, texts[random() % texts.size()]);
+    folds.changed(document, changed);
+
+    ASSERT_THAT(rangesOf(folds), ::testing::Eq(rangesOf(built(document)))) << "after step " << step;
+  }
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,132 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/FrameWriter/FrameWriter.hpp"
+
+#include "Editor/ScreenBuffer/ScreenBuffer.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Kilo::editor {
+
+namespace {
+
+/// A pipe the writer writes frames into and the test reads them back from
+struct Pipe
+{
+  Pipe()
+  {
+    std::array<int, 2> fds {};
+    EXPECT_THAT(::pipe(fds.data()), ::testing::Eq(0));
+    read = fds[0];
+    write = fds[1];
+  }
+
+  /// Read exactly the given number of bytes
+  auto receive(std::size_t count) const -> std::string
+  {
+    std::string received(count, '\0');
+
+    for (std::size_t done = 0; done < count;) {
+      auto const result = ::read(read, received.data() + done, count - done);
+      EXPECT_THAT(result, ::testing::Gt(0));
+
+      if (result <= 0) {
+        break;
+      }
+
+      done += static_cast<std::size_t>(result);
+    }
+
+    return received;
+  }
+
+  ~Pipe()
+  {
+    ::close(read);
+    ::close(write);
+  }
+
+  int read;
+  int write;
+};
+
+}   // namespace
+
+TEST(FrameWriter, WritesFramesInOrderAndEmptiesTheBuffer)
+{
+  Pipe pipe;
+  FrameWriter writer(pipe.write);
+  ScreenBuffer frame;
+
+  writer.submit(frame.write("first "));
+  ASSERT_THAT(frame.size(), ::testing::Eq(0));
+  writer.drain();
+
+  writer.submit(frame.write("second"));
+  writer.drain();
+
+  ASSERT_THAT(pipe.receive(12), ::testing::Eq("first second"));
+  ASSERT_THAT(writer.stats().framesWritten, ::testing::Eq(2));
+  ASSERT_THAT(writer.stats().framesDropped, ::testing::Eq(0));
+  ASSERT_THAT(writer.pending(), ::testing::IsFalse());
+}
+
+TEST(FrameWriter, AWaitingFrameIsReplacedByANewerOne)
+{
+  Pipe pipe;
+  FrameWriter writer(pipe.write);
+  ScreenBuffer frame;
+
+  // A frame larger than the pipe can hold keeps the writer busy until the test reads it. Like a terminal the editor
+  // writes to, the pipe doesn't block, so the writer has to wait for it to have room again
+  ::fcntl(pipe.write, F_SETFL, ::fcntl(pipe.write, F_GETFL) | O_NONBLOCK);
+  std::string const large(1024 * 1024, 'x');
+  writer.submit(frame.write(large));
+
+  while (writer.pending()) {
+    std::this_thread::yield();
+  }
+
+  writer.submit(frame.write("stale"));
+  ASSERT_THAT(writer.pending(), ::testing::IsTrue());
+  writer.submit(frame.write("fresh"));
+
+  ASSERT_THAT(pipe.receive(large.size()), ::testing::Eq(large));
+  writer.drain();
+  ASSERT_THAT(pipe.receive(5), ::testing::Eq("fresh"));
+
+  auto const stats = writer.stats();
+  ASSERT_THAT(stats.framesWritten, ::testing::Eq(2));
+  ASSERT_THAT(stats.framesDropped, ::testing::Eq(1));
+  ASSERT_THAT(stats.writeStalls, ::testing::Ge(1));
+}
+
+}   // namespace Kilo::editor
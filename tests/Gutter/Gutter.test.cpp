@@ -0,0 +1,130 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/Gutter/Gutter.hpp"
+
+#include "Editor/Region/Region.hpp"
+#include "Editor/ScreenBuffer/ScreenBuffer.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Kilo::editor {
+
+namespace {
+
+auto formatted(std::size_t number, std::size_t width) -> std::string
+{
+  std::string field(width, '?');
+  formatNumber(number, field);
+  return field;
+}
+
+}   // namespace
+
+TEST(Gutter, FormatNumberRightAlignsTheDigits)
+{
+  ASSERT_THAT(formatted(0, 4), ::testing::Eq("   0"));
+  ASSERT_THAT(formatted(7, 3), ::testing::Eq("  7"));
+  ASSERT_THAT(formatted(42, 4), ::testing::Eq("  42"));
+  ASSERT_THAT(formatted(12345, 6), ::testing::Eq(" 12345"));
+  ASSERT_THAT(formatted(18446744073709551614U, 20), ::testing::Eq("18446744073709551614"));
+  ASSERT_THAT(formatted(Gutter::Blank, 3), ::testing::Eq("   "));
+}
+
+TEST(Gutter, FormatNumberCutsOffLeadingDigitsThatDontFit)
+{
+  ASSERT_THAT(formatted(12345, 3), ::testing::Eq("345"));
+  ASSERT_THAT(formatted(123, 1), ::testing::Eq("3"));
+}
+
+TEST(Gutter, IsAsWideAsTheLargestLineNumberAndABlank)
+{
+  ASSERT_THAT(Gutter::widthFor(0), ::testing::Eq(4));
+  ASSERT_THAT(Gutter::widthFor(999), ::testing::Eq(4));
+  ASSERT_THAT(Gutter::widthFor(1000), ::testing::Eq(5));
+  ASSERT_THAT(Gutter::widthFor(123456), ::testing::Eq(7));
+}
+
+TEST(Gutter, DrawsEveryRowTheFirstTime)
+{
+  Gutter gutter;
+  ScreenBuffer buffer;
+  std::vector<std::size_t> const numbers {9, 10, Gutter::Blank};
+
+  gutter.place(Region {.top = 1, .left = 0, .rows = 3, .cols = 4});
+  gutter.draw(numbers, buffer);
+
+  ASSERT_THAT(std::string(buffer.c_str()), ::testing::Eq("\x1b[2;1H  9 \x1b[3;1H 10 \x1b[4;1H    "));
+}
+
+TEST(Gutter, OnlyWritesTheDigitsThatChanged)
+{
+  Gutter gutter;
+  ScreenBuffer buffer;
+
+  gutter.place(Region {.top = 0, .left = 5, .rows = 3, .cols = 5});
+  gutter.draw(std::vector<std::size_t> {120, 121, 122}, buffer);
+  buffer.clear();
+
+  gutter.draw(std::vector<std::size_t> {121, 121, 199}, buffer);
+
+  ASSERT_THAT(std::string(buffer.c_str()), ::testing::Eq("\x1b[1;9H1\x1b[3;8H99"));
+}
+
+TEST(Gutter, ScrollingKeepsWhatTheRowsMovedAlongWithShow)
+{
+  Gutter gutter;
+  ScreenBuffer buffer;
+
+  gutter.place(Region {.top = 0, .left = 0, .rows = 3, .cols = 4});
+  gutter.draw(std::vector<std::size_t> {1, 2, 3}, buffer);
+  buffer.clear();
+
+  gutter.scroll(1);
+  gutter.draw(std::vector<std::size_t> {2, 3, 4}, buffer);
+
+  ASSERT_THAT(std::string(buffer.c_str()), ::testing::Eq("\x1b[3;1H  4 "));
+}
+
+TEST(Gutter, MovingItDrawsEveryRowAgain)
+{
+  Gutter gutter;
+  ScreenBuffer buffer;
+  std::vector<std::size_t> const numbers {1, 2};
+
+  gutter.place(Region {.top = 0, .left = 0, .rows = 2, .cols = 4});
+  gutter.draw(numbers, buffer);
+  buffer.clear();
+
+  gutter.place(Region {.top = 0, .left = 10, .rows = 2, .cols = 4});
+  gutter.draw(numbers, buffer);
+
+  ASSERT_THAT(std::string(buffer.c_str()), ::testing::Eq("\x1b[1;11H  1 \x1b[2;11H  2 "));
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,122 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/GzipReader/GzipReader.hpp"
+
+#include "Editor/Document/Document.hpp"
+#include "Editor/Editor.hpp"
+#include "Editor/TextScanner/TextScanner.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <cstddef>
+#include <fcntl.h>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+
+namespace Kilo::editor {
+
+namespace {
+
+class GzipReaderTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_path = std::filesystem::temp_directory_path() / ("kilo-gzip-" + std::to_string(::getpid()) + ".gz");
+  }
+
+  void TearDown() override
+  {
+    std::filesystem::remove(m_path);
+  }
+
+  /// Append a gzip member holding the text to the file
+  void compress(std::string_view text) const
+  {
+    auto* file = ::gzopen(m_path.c_str(), "ab");
+    ::gzwrite(file, text.data(), static_cast<unsigned>(text.size()));
+    ::gzclose(file);
+  }
+
+  std::filesystem::path m_path;
+};
+
+}   // namespace
+
+TEST_F(GzipReaderTest, IsGzipLooksAtTheMagicBytes)
+{
+  compress("text\n");
+  auto const compressed = ::open(m_path.c_str(), O_RDONLY);
+  ASSERT_THAT(GzipReader::isGzip(compressed), ::testing::IsTrue());
+  ::close(compressed);
+
+  auto const plain = ::open(__FILE__, O_RDONLY);
+  ASSERT_THAT(GzipReader::isGzip(plain), ::testing::IsFalse());
+  ::close(plain);
+}
+
+TEST_F(GzipReaderTest, OpenDecompressesGzipFiles)
+{
+  std::string text;
+
+  for (int i = 0; i < 100'000; i++) {
+    text += "line " + std::to_string(i) + '\n';
+  }
+
+  compress(text);
+
+  Document doc;
+  Document rendered;
+  TextFormat format;
+  ASSERT_THAT(open(m_path, doc, rendered, format), ::testing::IsTrue());
+  ASSERT_THAT(doc.lineCount(), ::testing::Eq(100'000));
+  ASSERT_THAT(doc.line(99'999), ::testing::Eq("line 99999"));
+}
+
+TEST_F(GzipReaderTest, ConcatenatedMembersAreReadOneAfterTheOther)
+{
+  compress("first\n");
+  compress("second\n");
+
+  Document doc;
+  Document rendered;
+  TextFormat format;
+  ASSERT_THAT(open(m_path, doc, rendered, format), ::testing::IsTrue());
+  ASSERT_THAT(doc.lineCount(), ::testing::Eq(2));
+  ASSERT_THAT(doc.line(1), ::testing::Eq("second"));
+}
+
+TEST_F(GzipReaderTest, TheWorkerStopsWhenTheReaderIsDestroyedEarly)
+{
+  compress(std::string(16 * 1024 * 1024, 'x'));
+
+  // Nothing is read from the stream, so the worker is stuck waiting for room when the reader goes away
+  GzipReader reader(::open(m_path.c_str(), O_RDONLY));
+  ::usleep(10'000);
+}
+
+}   // namespace Kilo::editor
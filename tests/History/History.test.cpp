@@ -0,0 +1,120 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/History/History.hpp"
+
+#include "Editor/Cursor/Cursor.hpp"
+#include "Editor/Document/Document.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string>
+
+namespace Kilo::editor {
+
+TEST(History, UndoRestoresTheDocumentAndCursorFromBeforeTheEdit)
+{
+  History history;
+  Document document {"one", "two"};
+  Cursor cursor {.x = 3, .y = 1};
+
+  history.record(document, cursor);
+  document.replaceLine(1, "changed");
+  document.append("three");
+  cursor = Cursor {.x = 0, .y = 2};
+
+  ASSERT_THAT(history.undo(document, cursor), ::testing::IsTrue());
+  ASSERT_THAT(document.lineCount(), ::testing::Eq(2));
+  ASSERT_THAT(document.line(1), ::testing::Eq("two"));
+  ASSERT_THAT(cursor.x, ::testing::Eq(3));
+  ASSERT_THAT(cursor.y, ::testing::Eq(1));
+  ASSERT_THAT(history.undo(document, cursor), ::testing::IsFalse());
+}
+
+TEST(History, RedoReappliesAnUndoneEditUntilTheNextEdit)
+{
+  History history;
+  Document document {"one"};
+  Cursor cursor {};
+
+  history.record(document, cursor);
+  document.replaceLine(0, "two");
+
+  ASSERT_THAT(history.undo(document, cursor), ::testing::IsTrue());
+  ASSERT_THAT(history.redo(document, cursor), ::testing::IsTrue());
+  ASSERT_THAT(document.line(0), ::testing::Eq("two"));
+
+  ASSERT_THAT(history.undo(document, cursor), ::testing::IsTrue());
+  history.record(document, cursor);
+  document.replaceLine(0, "three");
+  ASSERT_THAT(history.redo(document, cursor), ::testing::IsFalse());
+}
+
+TEST(History, OnlyTheMostRecentStepsAreKept)
+{
+  History history;
+  Document document {"0"};
+  Cursor cursor {};
+
+  for (std::size_t i = 1; i <= History::Depth + 5; i++) {
+    history.record(document, cursor);
+    document.replaceLine(0, std::to_string(i));
+  }
+
+  auto undone = 0U;
+
+  while (history.undo(document, cursor)) {
+    undone++;
+  }
+
+  ASSERT_THAT(undone, ::testing::Eq(History::Depth));
+  ASSERT_THAT(document.line(0), ::testing::Eq("5"));
+}
+
+TEST(History, UndoingOneEditOnlyReplacesTheLinesItChanged)
+{
+  History history;
+  Document document;
+  Cursor cursor {};
+
+  for (std::size_t i = 0; i < 100'000; i++) {
+    document.append(std::to_string(i));
+  }
+
+  history.record(document, cursor);
+  document.replaceLine(60'000, "typed");
+
+  auto const undone = history.undo(document, cursor);
+  ASSERT_THAT(undone, ::testing::Optional(::testing::FieldsAre(60'000, 1, 1)));
+  ASSERT_THAT(document.line(60'000), ::testing::Eq("60000"));
+
+  history.record(document, cursor);
+  document.splitLine(10, 1);
+  document.splitLine(11, 0);
+
+  ASSERT_THAT(history.undo(document, cursor), ::testing::Optional(::testing::FieldsAre(10, 3, 1)));
+  ASSERT_THAT(history.redo(document, cursor), ::testing::Optional(::testing::FieldsAre(10, 1, 3)));
+}
+
+}   // namespace Kilo::editor
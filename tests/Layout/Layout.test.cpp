@@ -0,0 +1,123 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/Layout/Layout.hpp"
+
+#include "Editor/Offset/Offset.hpp"
+#include "Editor/Region/Region.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <optional>
+
+namespace Kilo::editor {
+
+TEST(Layout, ASinglePaneFillsTheArea)
+{
+  Layout layout;
+  layout.arrange(Region {.top = 0, .left = 0, .rows = 24, .cols = 80});
+
+  ASSERT_THAT(layout.panes().size(), ::testing::Eq(1));
+  ASSERT_THAT(layout.focused().region, ::testing::Eq(Region {.top = 0, .left = 0, .rows = 24, .cols = 80}));
+  ASSERT_THAT(layout.separators().empty(), ::testing::IsTrue());
+}
+
+TEST(Layout, AHorizontalSplitStacksThePanesAroundASeparatorRow)
+{
+  Layout layout;
+  layout.split(Layout::Split::Horizontal);
+  layout.arrange(Region {.top = 0, .left = 0, .rows = 24, .cols = 80});
+
+  auto const panes = layout.panes();
+  ASSERT_THAT(panes.size(), ::testing::Eq(2));
+  ASSERT_THAT(panes[0]->region, ::testing::Eq(Region {.top = 0, .left = 0, .rows = 11, .cols = 80}));
+  ASSERT_THAT(panes[1]->region, ::testing::Eq(Region {.top = 12, .left = 0, .rows = 12, .cols = 80}));
+  ASSERT_THAT(layout.separators()[0], ::testing::Eq(Region {.top = 11, .left = 0, .rows = 1, .cols = 80}));
+
+  // The new pane takes the focus
+  ASSERT_THAT(&layout.focused(), ::testing::Eq(panes[1]));
+}
+
+TEST(Layout, SplitsNestWithinThePaneThatWasSplit)
+{
+  Layout layout;
+  layout.split(Layout::Split::Vertical);
+  layout.split(Layout::Split::Horizontal);
+  layout.arrange(Region {.top = 0, .left = 0, .rows = 10, .cols = 41});
+
+  auto const panes = layout.panes();
+  ASSERT_THAT(panes.size(), ::testing::Eq(3));
+  ASSERT_THAT(panes[0]->region, ::testing::Eq(Region {.top = 0, .left = 0, .rows = 10, .cols = 20}));
+  ASSERT_THAT(panes[1]->region, ::testing::Eq(Region {.top = 0, .left = 21, .rows = 4, .cols = 20}));
+  ASSERT_THAT(panes[2]->region, ::testing::Eq(Region {.top = 5, .left = 21, .rows = 5, .cols = 20}));
+  ASSERT_THAT(layout.separators().size(), ::testing::Eq(2));
+}
+
+TEST(Layout, ANewPaneShowsTheSamePositionOfTheSameBuffer)
+{
+  Layout layout;
+  layout.focused().buffer = 2;
+  layout.focused().cursor = Cursor {.x = 3, .y = 40};
+  layout.split(Layout::Split::Vertical);
+
+  ASSERT_THAT(layout.focused().buffer, ::testing::Eq(2));
+  ASSERT_THAT(layout.focused().cursor.y, ::testing::Eq(40));
+}
+
+TEST(Layout, ClosingAPaneGivesItsSpaceToItsSibling)
+{
+  Layout layout;
+  layout.split(Layout::Split::Vertical);
+  layout.split(Layout::Split::Horizontal);
+
+  ASSERT_THAT(layout.close(), ::testing::IsTrue());
+  layout.arrange(Region {.top = 0, .left = 0, .rows = 10, .cols = 41});
+
+  auto const panes = layout.panes();
+  ASSERT_THAT(panes.size(), ::testing::Eq(2));
+  ASSERT_THAT(panes[1]->region, ::testing::Eq(Region {.top = 0, .left = 21, .rows = 10, .cols = 20}));
+
+  ASSERT_THAT(layout.close(), ::testing::IsTrue());
+  ASSERT_THAT(layout.close(), ::testing::IsFalse());
+}
+
+TEST(Pane, ADrawnPaneWasScrolledOnlyIfNothingButItsFirstRowChanged)
+{
+  Pane::Drawn const drawn {.buffer = 0,
+                           .generation = 3,
+                           .offset = Offset {.row = 10, .col = 0},
+                           .region = Region {.top = 0, .left = 0, .rows = 24, .cols = 80},
+                           .wrapped = false};
+
+  auto down = drawn;
+  down.offset.row = 12;
+  ASSERT_THAT(drawn.scrolledBy(down), ::testing::Optional(2));
+  ASSERT_THAT(down.scrolledBy(drawn), ::testing::Optional(-2));
+
+  auto edited = down;
+  edited.generation++;
+  ASSERT_THAT(drawn.scrolledBy(edited), ::testing::Eq(std::nullopt));
+  ASSERT_THAT(drawn.scrolledBy(drawn), ::testing::Eq(std::nullopt));
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,151 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/LineDiff/LineDiff.hpp"
+
+#include "Editor/Document/Document.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Kilo::editor {
+
+namespace {
+
+auto textOf(Document const& document) -> std::vector<std::string>
+{
+  std::vector<std::string> lines;
+
+  for (std::size_t i = 0; i < document.lineCount(); i++) {
+    lines.emplace_back(document.line(i));
+  }
+
+  return lines;
+}
+
+// The length of the longest run of lines both documents have in the same order, by dynamic programming
+auto commonLines(std::vector<std::string> const& left, std::vector<std::string> const& right) -> std::size_t
+{
+  std::vector<std::vector<std::size_t>> common(left.size() + 1, std::vector<std::size_t>(right.size() + 1));
+
+  for (std::size_t i = 1; i <= left.size(); i++) {
+    for (std::size_t j = 1; j <= right.size(); j++) {
+      common[i][j] = left[i - 1] == right[j - 1] ? common[i - 1][j - 1] + 1
+                                                 : std::max(common[i - 1][j], common[i][j - 1]);
+    }
+  }
+
+  return common[left.size()][right.size()];
+}
+
+}   // namespace
+
+TEST(LineDiff, FindsTheRunsOfLinesThatDiffer)
+{
+  Document const left {"a", "b", "c", "d", "e"};
+  Document const right {"a", "x", "c", "e", "f"};
+
+  ASSERT_THAT(diffLines(left, right),
+              ::testing::ElementsAre(DiffHunk {.left = 1, .leftCount = 1, .right = 1, .rightCount = 1},
+                                     DiffHunk {.left = 3, .leftCount = 1, .right = 3, .rightCount = 0},
+                                     DiffHunk {.left = 5, .leftCount = 0, .right = 4, .rightCount = 1}));
+  ASSERT_THAT(diffLines(left, left), ::testing::IsEmpty());
+  ASSERT_THAT(diffLines(Document {}, right),
+              ::testing::ElementsAre(DiffHunk {.left = 0, .leftCount = 0, .right = 0, .rightCount = 5}));
+}
+
+TEST(LineDiff, TakesOutAndPutsInTheFewestLines)
+{
+  std::mt19937 random(50);
+
+  for (auto round = 0; round < 300; round++) {
+    Document left;
+    Document right;
+
+    for (auto i = random() % 40; i > 0; i--) {
+      left.append(std::string(1, static_cast<char>('a' + random() % 4)));
+    }
+
+    for (auto i = random() % 40; i > 0; i--) {
+      right.append(std::string(1, static_cast<char>('a' + random() % 4)));
+    }
+
+    auto const hunks = diffLines(left, right);
+    auto const before = textOf(left);
+    auto const after = textOf(right);
+
+    // Putting each run of the right document in place of the one of the left gives the right document
+    std::vector<std::string> patched;
+    std::size_t line = 0;
+    std::size_t edits = 0;
+
+    for (auto const& hunk : hunks) {
+      ASSERT_THAT(hunk.left, ::testing::Ge(line));
+      ASSERT_THAT(hunk.leftCount + hunk.rightCount, ::testing::Gt(0));
+      patched.insert(patched.end(), before.begin() + static_cast<std::ptrdiff_t>(line),
+                     before.begin() + static_cast<std::ptrdiff_t>(hunk.left));
+      patched.insert(patched.end(), after.begin() + static_cast<std::ptrdiff_t>(hunk.right),
+                     after.begin() + static_cast<std::ptrdiff_t>(hunk.right + hunk.rightCount));
+      line = hunk.left + hunk.leftCount;
+      edits += hunk.leftCount + hunk.rightCount;
+    }
+
+    patched.insert(patched.end(), before.begin() + static_cast<std::ptrdiff_t>(line), before.end());
+
+    ASSERT_THAT(patched, ::testing::Eq(after));
+    ASSERT_THAT(edits, ::testing::Eq(before.size() + after.size() - 2 * commonLines(before, after)));
+  }
+}
+
+TEST(LineDiff, LinesUpBothSidesWithGapsAcrossLinesOnlyOneHas)
+{
+  LineDiff const diff(Document {"a", "b", "c", "d"}, Document {"a", "x", "y", "c"});
+
+  // a | a
+  // b | x
+  // - | y
+  // c | c
+  // d | -
+  ASSERT_THAT(diff.rowCount(), ::testing::Eq(5));
+  ASSERT_THAT(diff.rowOf(DiffSide::Left, 2), ::testing::Eq(3));
+  ASSERT_THAT(diff.rowOf(DiffSide::Right, 2), ::testing::Eq(2));
+  ASSERT_THAT(diff.rowOf(DiffSide::Right, 4), ::testing::Eq(5));
+  ASSERT_THAT(diff.lineAt(DiffSide::Left, 2), ::testing::Eq(2));
+  ASSERT_THAT(diff.lineAt(DiffSide::Left, 3), ::testing::Eq(2));
+  ASSERT_THAT(diff.lineAt(DiffSide::Right, 4), ::testing::Eq(4));
+  ASSERT_THAT(diff.gap(DiffSide::Left, 2), ::testing::IsTrue());
+  ASSERT_THAT(diff.gap(DiffSide::Right, 2), ::testing::IsFalse());
+  ASSERT_THAT(diff.gap(DiffSide::Right, 4), ::testing::IsTrue());
+  ASSERT_THAT(diff.changed(DiffSide::Left, 1), ::testing::IsTrue());
+  ASSERT_THAT(diff.changed(DiffSide::Left, 2), ::testing::IsFalse());
+  ASSERT_THAT(diff.changed(DiffSide::Right, 2), ::testing::IsTrue());
+  ASSERT_THAT(diff.changedLines(DiffSide::Left), ::testing::Eq(2));
+  ASSERT_THAT(diff.changedLines(DiffSide::Right), ::testing::Eq(2));
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,145 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/LineFilter/LineFilter.hpp"
+
+#include "Editor/Cursor/Cursor.hpp"
+#include "Editor/Document/Document.hpp"
+#include "Editor/MultiCursor/MultiCursor.hpp"
+#include "Editor/WorkerPool/WorkerPool.hpp"
+#include "Fixtures/Fixtures.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Kilo::editor {
+
+using support::finish;
+using support::numbered;
+
+namespace {
+
+// Every third line has "fizz" in it and every fifth "buzz", so that either, both or neither can be searched for
+auto fizzBuzz(std::size_t line) -> std::string
+{
+  return std::string(line % 3 == 0 ? " fizz" : "") + (line % 5 == 0 ? " buzz" : "");
+}
+
+// The lines a filter should have found, searched one at a time
+auto expected(Document const& document, std::vector<std::string> const& patterns) -> std::vector<std::size_t>
+{
+  std::vector<std::size_t> lines;
+
+  for (std::size_t line = 0; line < document.lineCount(); line++) {
+    if (containsAll(document.line(line), patterns)) {
+      lines.push_back(line);
+    }
+  }
+
+  return lines;
+}
+
+}   // namespace
+
+TEST(LineFilter, FindsTheLinesInOrderAndMapsRowsToThem)
+{
+  auto const document = numbered(1000, fizzBuzz);
+  LineFilter filter({"fizz"}, 256);
+  WorkerPool workers(4);
+
+  filter.replaced(workers, document, 0);
+  finish(workers, filter);
+
+  ASSERT_THAT(filter.chunkCount(), ::testing::Gt(10));
+  ASSERT_THAT(filter.lines().size(), ::testing::Eq(334));
+  ASSERT_THAT(filter.lineAt(1), ::testing::Eq(3));
+  ASSERT_THAT(filter.rowOf(3), ::testing::Eq(1));
+
+  // A line that isn't shown has the row of the next line that is, and those past the end get a row each
+  ASSERT_THAT(filter.hidden(4), ::testing::IsTrue());
+  ASSERT_THAT(filter.rowOf(4), ::testing::Eq(2));
+  ASSERT_THAT(filter.lineAt(334), ::testing::Eq(1000));
+  ASSERT_THAT(filter.rowOf(1001), ::testing::Eq(335));
+  ASSERT_THAT(filter.hidden(1000), ::testing::IsFalse());
+}
+
+TEST(LineFilter, AStackedFilterOnlySearchesTheLinesTheOneBelowFound)
+{
+  auto const document = numbered(1000, fizzBuzz);
+  LineFilter fizz({"fizz"}, 256);
+  WorkerPool workers(4);
+
+  fizz.replaced(workers, document, 0);
+  finish(workers, fizz);
+
+  LineFilter fizzBuzz({"fizz", "buzz"}, 256);
+  fizzBuzz.within(workers, document, fizz.lines());
+  finish(workers, fizzBuzz);
+
+  ASSERT_THAT(fizzBuzz.lines().size(), ::testing::Eq(67));
+  ASSERT_THAT(fizzBuzz.lineAt(1), ::testing::Eq(15));
+  ASSERT_THAT(std::vector(fizzBuzz.lines().begin(), fizzBuzz.lines().end()),
+              ::testing::Eq(expected(document, {"fizz", "buzz"})));
+}
+
+TEST(LineFilter, EditsKeepTheLinesFoundUpToDate)
+{
+  auto document = numbered(200, fizzBuzz);
+  std::vector<std::string> const patterns {"zz"};
+  LineFilter filter(patterns, 64);
+  WorkerPool workers(3);
+  std::mt19937 random(48);
+
+  filter.replaced(workers, document, 0);
+
+  for (auto step = 0; step < 300; step++) {
+    // Edits come in while the lines are still being searched as well as after
+    if (step % 7 == 0) {
+      finish(workers, filter);
+    }
+
+    auto const line = static_cast<std::int64_t>(random() % document.lineCount());
+    std::vector<Cursor> cursors {{.x = 0, .y = line}};
+    auto const kind = random() % 4;
+    auto const changed = kind == 0   ? insertAt(document, cursors, "zz")
+                         : kind == 1 ? insertAt(document, cursors, "a\nz")
+                         : kind == 2 ? eraseAt(document, cursors, Direction::Forward)
+                                     : eraseAt(document, cursors, Direction::Backward);
+    filter.changed(workers, document, changed);
+
+    if (step % 50 == 0) {
+      document.append("zz appended");
+      filter.replaced(workers, document, document.lineCount() - 1);
+    }
+  }
+
+  finish(workers, filter);
+
+  ASSERT_THAT(std::vector(filter.lines().begin(), filter.lines().end()), ::testing::Eq(expected(document, patterns)));
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,78 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "Memory/Memory.hpp"
+
+#include "Editor/Document/Document.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+
+namespace Kilo::memory {
+
+TEST(CountingResource, CountsAllocationsAndBytesInUse)
+{
+  CountingResource resource;
+
+  auto* ptr = resource.allocate(64);
+  ASSERT_THAT(resource.stats().allocations, ::testing::Eq(1));
+  ASSERT_THAT(resource.stats().bytesInUse, ::testing::Eq(64));
+
+  resource.deallocate(ptr, 64);
+  ASSERT_THAT(resource.stats().deallocations, ::testing::Eq(1));
+  ASSERT_THAT(resource.stats().bytesInUse, ::testing::Eq(0));
+  ASSERT_THAT(resource.stats().peakBytesInUse, ::testing::Eq(64));
+}
+
+TEST(CountingResource, OnlySeesWhatSpillsOutOfAnArena)
+{
+  CountingResource spill;
+  std::array<std::byte, 256> scratch {};
+  std::pmr::monotonic_buffer_resource arena(scratch.data(), scratch.size(), &spill);
+
+  std::pmr::string small(&arena);
+  small.assign(100, 'x');
+  ASSERT_THAT(spill.stats().allocations, ::testing::Eq(0));
+
+  std::pmr::string large(&arena);
+  large.assign(1000, 'x');
+  ASSERT_THAT(spill.stats().allocations, ::testing::Gt(0));
+}
+
+TEST(lineStorage, DocumentsAllocateTheirLinesFromIt)
+{
+  auto const before = lineStorageStats().requests.allocations;
+
+  editor::Document doc;
+  doc.append(std::string(100, 'x'));
+
+  ASSERT_THAT(lineStorageStats().requests.allocations, ::testing::Gt(before));
+}
+
+}   // namespace Kilo::memory
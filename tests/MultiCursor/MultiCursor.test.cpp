@@ -0,0 +1,196 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/MultiCursor/MultiCursor.hpp"
+
+#include "Editor/Cursor/Cursor.hpp"
+#include "Editor/Document/Document.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace Kilo::editor {
+
+namespace {
+
+auto positions(std::vector<Cursor> const& cursors) -> std::vector<std::pair<std::int64_t, std::int64_t>>
+{
+  std::vector<std::pair<std::int64_t, std::int64_t>> result;
+
+  for (auto const& cursor : cursors) {
+    result.emplace_back(cursor.x, cursor.y);
+  }
+
+  return result;
+}
+
+}   // namespace
+
+TEST(MultiCursor, NormalizeSortsCursorsDownTheDocumentAndDropsDuplicates)
+{
+  std::vector<Cursor> cursors {{.x = 4, .y = 1}, {.x = 2, .y = 0}, {.x = 1, .y = 1}, {.x = 2, .y = 0}};
+
+  normalize(cursors);
+
+  ASSERT_THAT(positions(cursors), ::testing::ElementsAre(::testing::Pair(2, 0), ::testing::Pair(1, 1),
+                                                         ::testing::Pair(4, 1)));
+}
+
+TEST(MultiCursor, InsertingMovesLaterCursorsOnTheSameLineAlong)
+{
+  Document document {"abc", "def"};
+  std::vector<Cursor> cursors {{.x = 0, .y = 0}, {.x = 2, .y = 0}, {.x = 1, .y = 1}};
+
+  auto const changed = insertAt(document, cursors, "X");
+
+  ASSERT_THAT(document.line(0), ::testing::Eq("XabXc"));
+  ASSERT_THAT(document.line(1), ::testing::Eq("dXef"));
+  ASSERT_THAT(positions(cursors), ::testing::ElementsAre(::testing::Pair(1, 0), ::testing::Pair(4, 0),
+                                                         ::testing::Pair(2, 1)));
+  ASSERT_THAT(changed.lines, ::testing::ElementsAre(0, 1));
+  ASSERT_THAT(changed.lineCount, ::testing::IsFalse());
+}
+
+TEST(MultiCursor, InsertingLineBreaksMovesLaterCursorsDown)
+{
+  Document document {"ab", "cd"};
+  std::vector<Cursor> cursors {{.x = 1, .y = 0}, {.x = 1, .y = 1}, {.x = 0, .y = 2}};
+
+  auto const changed = insertAt(document, cursors, "-\r\n");
+
+  ASSERT_THAT(document.lineCount(), ::testing::Eq(6));
+  ASSERT_THAT(document.line(0), ::testing::Eq("a-"));
+  ASSERT_THAT(document.line(1), ::testing::Eq("b"));
+  ASSERT_THAT(document.line(2), ::testing::Eq("c-"));
+  ASSERT_THAT(document.line(3), ::testing::Eq("d"));
+  ASSERT_THAT(document.line(4), ::testing::Eq("-"));
+  ASSERT_THAT(document.line(5), ::testing::Eq(""));
+  ASSERT_THAT(positions(cursors), ::testing::ElementsAre(::testing::Pair(0, 1), ::testing::Pair(0, 3),
+                                                         ::testing::Pair(0, 5)));
+  ASSERT_THAT(changed.lines, ::testing::ElementsAre(0, 1, 2, 3, 4, 5));
+  ASSERT_THAT(changed.lineCount, ::testing::IsTrue());
+}
+
+TEST(MultiCursor, InsertingAtASingleCursorSplitsTheLineAtEveryKindOfLineBreak)
+{
+  Document document {"before", "[]", "after"};
+  std::vector<Cursor> cursors {{.x = 1, .y = 1}};
+
+  auto const changed = insertAt(document, cursors, "a\nb\r\nc\rd");
+
+  ASSERT_THAT(document.lineCount(), ::testing::Eq(6));
+  ASSERT_THAT(document.line(1), ::testing::Eq("[a"));
+  ASSERT_THAT(document.line(2), ::testing::Eq("b"));
+  ASSERT_THAT(document.line(3), ::testing::Eq("c"));
+  ASSERT_THAT(document.line(4), ::testing::Eq("d]"));
+  ASSERT_THAT(document.line(5), ::testing::Eq("after"));
+  ASSERT_THAT(positions(cursors), ::testing::ElementsAre(::testing::Pair(1, 4)));
+  ASSERT_THAT(changed.lineCount, ::testing::IsTrue());
+}
+
+TEST(MultiCursor, InsertingPastTheLastLineStartsANewOne)
+{
+  Document document {};
+  std::vector<Cursor> cursors {{.x = 0, .y = 0}};
+
+  std::ignore = insertAt(document, cursors, "text\n");
+
+  ASSERT_THAT(document.lineCount(), ::testing::Eq(2));
+  ASSERT_THAT(document.line(0), ::testing::Eq("text"));
+  ASSERT_THAT(document.line(1), ::testing::Eq(""));
+  ASSERT_THAT(positions(cursors), ::testing::ElementsAre(::testing::Pair(0, 1)));
+}
+
+TEST(MultiCursor, SpreadOutEditsOnlyReplaceTheLinesFromTheirFirstRunToTheirLast)
+{
+  Document document {"0", "1", "2", "3", "4", "5", "6", "7"};
+  std::vector<Cursor> cursors {{.x = 1, .y = 1}, {.x = 0, .y = 5}};
+
+  auto const changed = insertAt(document, cursors, "\n");
+  auto const [first, removed, added] = replacedLines(changed, 8, document.lineCount());
+
+  ASSERT_THAT(changed.runs.size(), ::testing::Eq(2));
+  ASSERT_THAT(changed.runs[1].first, ::testing::Eq(6));
+  ASSERT_THAT(first, ::testing::Eq(1));
+  ASSERT_THAT(removed, ::testing::Eq(5));
+  ASSERT_THAT(added, ::testing::Eq(7));
+}
+
+TEST(MultiCursor, BackspaceDeletesBeforeEveryCursorAndJoinsLinesAtTheirStart)
+{
+  Document document {"abc", "def", "ghi"};
+  std::vector<Cursor> cursors {{.x = 2, .y = 0}, {.x = 0, .y = 1}, {.x = 2, .y = 1}, {.x = 3, .y = 2}};
+
+  auto const changed = eraseAt(document, cursors, Direction::Backward);
+
+  ASSERT_THAT(document.lineCount(), ::testing::Eq(2));
+  ASSERT_THAT(document.line(0), ::testing::Eq("acdf"));
+  ASSERT_THAT(document.line(1), ::testing::Eq("gh"));
+  ASSERT_THAT(positions(cursors), ::testing::ElementsAre(::testing::Pair(1, 0), ::testing::Pair(2, 0),
+                                                         ::testing::Pair(3, 0), ::testing::Pair(2, 1)));
+  ASSERT_THAT(changed.lines, ::testing::ElementsAre(0, 1));
+  ASSERT_THAT(changed.lineCount, ::testing::IsTrue());
+}
+
+TEST(MultiCursor, DeleteJoinsTheNextLineTogetherWithItsCursors)
+{
+  Document document {"ab", "cd", "ef"};
+  std::vector<Cursor> cursors {{.x = 2, .y = 0}, {.x = 1, .y = 1}, {.x = 0, .y = 2}};
+
+  auto const changed = eraseAt(document, cursors, Direction::Forward);
+
+  ASSERT_THAT(document.lineCount(), ::testing::Eq(2));
+  ASSERT_THAT(document.line(0), ::testing::Eq("abc"));
+  ASSERT_THAT(document.line(1), ::testing::Eq("f"));
+  ASSERT_THAT(positions(cursors), ::testing::ElementsAre(::testing::Pair(2, 0), ::testing::Pair(3, 0),
+                                                         ::testing::Pair(0, 1)));
+  ASSERT_THAT(changed.lines, ::testing::ElementsAre(0, 1));
+}
+
+TEST(MultiCursor, EditingTheSameColumnOfManyLinesOnlyChangesThoseLines)
+{
+  constexpr std::int64_t Lines = 10'000;
+  Document document;
+  std::vector<Cursor> cursors;
+
+  for (std::int64_t i = 0; i < Lines; i++) {
+    document.append("key = value");
+    cursors.push_back(Cursor {.x = 3, .y = i});
+  }
+
+  auto const inserted = insertAt(document, cursors, ":");
+  auto const erased = eraseAt(document, cursors, Direction::Forward);
+
+  ASSERT_THAT(document.line(Lines - 1), ::testing::Eq("key:= value"));
+  ASSERT_THAT(cursors.back().x, ::testing::Eq(4));
+  ASSERT_THAT(cursors.back().y, ::testing::Eq(Lines - 1));
+  ASSERT_THAT(inserted.lines.size(), ::testing::Eq(Lines));
+  ASSERT_THAT(erased.lineCount, ::testing::IsFalse());
+}
+
+}   // namespace Kilo::editor
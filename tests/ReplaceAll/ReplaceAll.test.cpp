@@ -0,0 +1,128 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/ReplaceAll/ReplaceAll.hpp"
+
+#include "Editor/Document/Document.hpp"
+#include "Editor/WorkerPool/WorkerPool.hpp"
+#include "Fixtures/Fixtures.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Kilo::editor {
+
+using support::finish;
+using support::numbered;
+
+namespace {
+
+// Every third line has two matches of "foo"
+auto foos(std::size_t line) -> std::string_view
+{
+  return line % 3 == 0 ? " foo and foo" : "";
+}
+
+}   // namespace
+
+TEST(ReplaceAll, ReplaceLinesReplacesMatchesFromLeftToRightWithoutOverlapping)
+{
+  Document const document {"aaaaa", "none", "a-a"};
+  std::vector<std::size_t> lines;
+  std::vector<std::size_t> ends;
+  std::string text;
+
+  auto const matches = replaceLines(document, 0, document.lineCount(), "aa", "b", lines, ends, text);
+
+  ASSERT_THAT(matches, ::testing::Eq(2));
+  ASSERT_THAT(lines, ::testing::ElementsAre(0));
+  ASSERT_THAT(ends, ::testing::ElementsAre(3));
+  ASSERT_THAT(text, ::testing::Eq("bba"));
+}
+
+TEST(ReplaceAll, ReplacesEveryMatchAsOneSwapOfTheDocument)
+{
+  auto document = numbered(1000, foos);
+  auto const before = document;
+  ReplaceAll replace(256);
+  WorkerPool workers(4);
+
+  replace.start(workers, document, "foo", "quux");
+  finish(workers, replace);
+
+  ASSERT_THAT(replace.chunkCount(), ::testing::Gt(10));
+  ASSERT_THAT(replace.matches(), ::testing::Eq(2 * 334));
+  ASSERT_THAT(replace.lines(), ::testing::Eq(334));
+  ASSERT_THAT(replace.preview()->line, ::testing::Eq(0));
+  ASSERT_THAT(replace.preview()->text, ::testing::Eq("line 0 quux and quux"));
+
+  // The lines are replaced in batches, and the document stays as it was until all of them are
+  auto batches = 1;
+
+  while (!replace.apply(100)) {
+    batches++;
+  }
+
+  ASSERT_THAT(batches, ::testing::Eq(4));
+  ASSERT_THAT(document.line(3), ::testing::Eq("line 3 foo and foo"));
+
+  auto const changed = replace.take(document);
+
+  ASSERT_THAT(replace.started(), ::testing::IsFalse());
+  ASSERT_THAT(changed.lineCount, ::testing::IsFalse());
+  ASSERT_THAT(changed.lines.size(), ::testing::Eq(334));
+  ASSERT_THAT(changed.lines[1], ::testing::Eq(3));
+  ASSERT_THAT(document.lineCount(), ::testing::Eq(1000));
+  ASSERT_THAT(document.line(3), ::testing::Eq("line 3 quux and quux"));
+  ASSERT_THAT(document.line(4), ::testing::Eq("line 4"));
+  ASSERT_THAT(before.line(3), ::testing::Eq("line 3 foo and foo"));
+}
+
+TEST(ReplaceAll, StartingAgainDropsWhatWasFound)
+{
+  auto const document = numbered(1000, foos);
+  ReplaceAll replace(256);
+  WorkerPool workers(2);
+
+  replace.start(workers, document, "foo", "bar");
+  replace.start(workers, document, "line 99", "");
+  finish(workers, replace);
+
+  ASSERT_THAT(replace.matches(), ::testing::Eq(11));
+  ASSERT_THAT(replace.preview()->line, ::testing::Eq(99));
+  ASSERT_THAT(replace.preview()->text, ::testing::Eq(" foo and foo"));
+
+  // Matches never span lines
+  replace.start(workers, document, "0\nline 1", "x");
+
+  ASSERT_THAT(replace.started(), ::testing::IsTrue());
+  ASSERT_THAT(replace.complete(), ::testing::IsTrue());
+  ASSERT_THAT(replace.matches(), ::testing::Eq(0));
+  ASSERT_THAT(replace.preview().has_value(), ::testing::IsFalse());
+}
+
+}   // namespace Kilo::editor
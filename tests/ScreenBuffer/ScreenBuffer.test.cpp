@@ -50,6 +50,42 @@ TEST(ScreenBufferTest, ItsSizeIncreasesByTheLengthOfTheAppendedString)
   ASSERT_EQ(buffer.size(), 13);
 }
 
+TEST(ScreenBufferTest, IsEmptyAfterBeingCleared)
+{
+  ScreenBuffer buffer;
+  buffer.write("Hello, World!");
+
+  buffer.clear();
+
+  ASSERT_EQ(buffer.size(), 0);
+}
+
+TEST(ScreenBufferTest, FormatsParameterizedCommands)
+{
+  ScreenBuffer buffer;
+
+  buffer.moveCursorTo(12, 40).eraseInLine().eraseInLine(ScreenBuffer::Erase::WholeLine);
+  buffer.selectGraphicRendition(38, 5, 208).selectGraphicRendition();
+
+  ASSERT_THAT(std::string(buffer.c_str(), buffer.size()),
+              ::testing::Eq("\x1b[12;40H\x1b[K\x1b[2K\x1b[38;5;208m\x1b[m"));
+}
+
+TEST(ScreenBufferTest, FillsRunsOfTheSameCharacter)
+{
+  ScreenBuffer buffer;
+
+  buffer.write("~").fill(3).fill(2, '-');
+
+  ASSERT_THAT(std::string(buffer.c_str(), buffer.size()), ::testing::Eq("~   --"));
+}
+
+TEST(ScreenBufferTest, JoinsSequencesAtCompileTime)
+{
+  static_assert(EscapeSequences::BeginRepaint == "\x1b[?25l\x1b[H");
+  static_assert(KiloWelcomeMessage == "Kilo editor -- version 0.0.1");
+}
+
 class MockFileInterface : public IO::FileInterface
 {
 public:
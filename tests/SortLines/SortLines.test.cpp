@@ -0,0 +1,130 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/SortLines/SortLines.hpp"
+
+#include "Editor/Document/Document.hpp"
+#include "Editor/WorkerPool/WorkerPool.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Kilo::editor {
+
+namespace {
+
+auto textOf(Document const& document) -> std::vector<std::string>
+{
+  std::vector<std::string> lines;
+
+  for (std::size_t i = 0; i < document.lineCount(); i++) {
+    lines.emplace_back(document.line(i));
+  }
+
+  return lines;
+}
+
+}   // namespace
+
+TEST(SortLines, SortsLikeSortingOnOneThreadWithAnyNumberOfWorkers)
+{
+  std::mt19937 random(49);
+  std::vector<std::string> text;
+
+  for (std::size_t i = 0; i < 200'000; i++) {
+    text.push_back(std::to_string(random() % 50'000) + (i % 2 == 0 ? "" : " odd"));
+  }
+
+  std::vector<std::string_view> expected(text.begin(), text.end());
+  std::sort(expected.begin(), expected.end());
+
+  for (std::size_t threads = 1; threads <= 4; threads++) {
+    WorkerPool workers(threads);
+    std::vector<std::string_view> lines(text.begin(), text.end());
+
+    sortLines(workers, lines);
+
+    ASSERT_THAT(lines, ::testing::Eq(expected));
+  }
+}
+
+TEST(SortLines, ReordersARunOfLinesAndLeavesTheRestAlone)
+{
+  WorkerPool workers(2);
+  Document document {"top", "b", "a", "b", "c", "a", "bottom"};
+  auto const before = document;
+
+  ASSERT_THAT(reorderLines(workers, document, 1, 5, LineOrder::Sorted), ::testing::Eq(5));
+  ASSERT_THAT(textOf(document), ::testing::ElementsAre("top", "a", "a", "b", "b", "c", "bottom"));
+  ASSERT_THAT(before.line(1), ::testing::Eq("b"));
+
+  document = before;
+
+  ASSERT_THAT(reorderLines(workers, document, 1, 5, LineOrder::Unique), ::testing::Eq(3));
+  ASSERT_THAT(textOf(document), ::testing::ElementsAre("top", "b", "a", "c", "bottom"));
+
+  document = before;
+
+  ASSERT_THAT(reorderLines(workers, document, 0, 7, LineOrder::Reversed), ::testing::Eq(7));
+  ASSERT_THAT(textOf(document), ::testing::ElementsAre("bottom", "a", "c", "b", "a", "b", "top"));
+
+  // A short run in a long document is rewritten in place
+  Document longer;
+
+  for (std::size_t i = 0; i < 100; i++) {
+    longer.append(i == 50 or i == 52 ? "same" : std::to_string(i));
+  }
+
+  ASSERT_THAT(reorderLines(workers, longer, 49, 5, LineOrder::Unique), ::testing::Eq(4));
+  ASSERT_THAT(longer.lineCount(), ::testing::Eq(99));
+  ASSERT_THAT(longer.line(49), ::testing::Eq("49"));
+  ASSERT_THAT(longer.line(50), ::testing::Eq("same"));
+  ASSERT_THAT(longer.line(51), ::testing::Eq("51"));
+  ASSERT_THAT(longer.line(52), ::testing::Eq("53"));
+  ASSERT_THAT(longer.line(53), ::testing::Eq("54"));
+}
+
+TEST(SortLines, LeavesOutRepeatsOfLinesAboveThemInLongRuns)
+{
+  WorkerPool workers(3);
+  Document document;
+
+  for (std::size_t i = 0; i < 100'000; i++) {
+    document.append(std::to_string((i * 7) % 1000));
+  }
+
+  ASSERT_THAT(reorderLines(workers, document, 0, document.lineCount(), LineOrder::Unique), ::testing::Eq(1000));
+  ASSERT_THAT(document.lineCount(), ::testing::Eq(1000));
+
+  for (std::size_t i = 0; i < 1000; i++) {
+    ASSERT_THAT(document.line(i), ::testing::Eq(std::to_string((i * 7) % 1000)));
+  }
+}
+
+}   // namespace Kilo::editor
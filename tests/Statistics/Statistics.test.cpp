@@ -0,0 +1,154 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/Statistics/Statistics.hpp"
+
+#include "Editor/Cursor/Cursor.hpp"
+#include "Editor/Document/Document.hpp"
+#include "Editor/MultiCursor/MultiCursor.hpp"
+#include "Editor/WorkerPool/WorkerPool.hpp"
+#include "Fixtures/Fixtures.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Kilo::editor {
+
+using support::finish;
+using support::numbered;
+
+TEST(Statistics, CountLinesCountsWordsBytesAndTheLongestLine)
+{
+  Document const document {"two words", "", "  \tthree  more words ", "caf\xc3\xa9"};
+
+  auto const statistics = countLines(document, 0, document.lineCount());
+
+  ASSERT_THAT(statistics.lines, ::testing::Eq(4));
+  ASSERT_THAT(statistics.words, ::testing::Eq(6));
+  ASSERT_THAT(statistics.bytes, ::testing::Eq(document.byteCount()));
+  ASSERT_THAT(statistics.longestLine, ::testing::Eq(21));
+  ASSERT_THAT(statistics.nonAscii, ::testing::Eq(2));
+}
+
+TEST(Statistics, ChunksAddUpToTheWholeDocument)
+{
+  auto const document = numbered(100);
+  DocumentStatistics statistics(8);
+  WorkerPool workers(4);
+
+  statistics.replaced(workers, document, 0);
+  finish(workers, statistics);
+
+  ASSERT_THAT(statistics.chunkCount(), ::testing::Ge(100 / 16));
+  ASSERT_THAT(statistics.totals(), ::testing::Eq(countLines(document, 0, document.lineCount())));
+}
+
+TEST(Statistics, EditingALineOnlyCountsItsChunkAgain)
+{
+  auto document = numbered(100);
+  DocumentStatistics statistics(8);
+  WorkerPool workers(2);
+
+  statistics.replaced(workers, document, 0);
+  finish(workers, statistics);
+
+  std::vector<Cursor> cursors {{.x = 0, .y = 50}};
+  auto const changed = insertAt(document, cursors, "more words ");
+  statistics.changed(workers, document, changed);
+
+  // Until it has been counted again, the chunk keeps its old counts
+  ASSERT_THAT(statistics.pending(), ::testing::Eq(1));
+  ASSERT_THAT(statistics.totals().words, ::testing::Eq(200));
+
+  finish(workers, statistics);
+
+  ASSERT_THAT(statistics.totals().words, ::testing::Eq(202));
+}
+
+TEST(Statistics, AppendingLinesOnlyCountsTheLastChunksAgain)
+{
+  auto document = numbered(100);
+  DocumentStatistics statistics(8);
+  WorkerPool workers(2);
+
+  statistics.replaced(workers, document, 0);
+  finish(workers, statistics);
+
+  auto const chunks = statistics.chunkCount();
+  document.append("one more");
+  document.append("and another");
+  statistics.replaced(workers, document, 100);
+
+  ASSERT_THAT(statistics.pending(), ::testing::Eq(1));
+  ASSERT_THAT(statistics.totals().lines, ::testing::Eq(102));
+
+  finish(workers, statistics);
+
+  ASSERT_THAT(statistics.chunkCount(), ::testing::Eq(chunks));
+  ASSERT_THAT(statistics.totals(), ::testing::Eq(countLines(document, 0, document.lineCount())));
+}
+
+TEST(Statistics, CountsAgreeWithCountingFromScratchAfterEdits)
+{
+  auto document = numbered(200);
+  DocumentStatistics statistics(4);
+  WorkerPool workers(3);
+
+  statistics.replaced(workers, document, 0);
+
+  std::mt19937 random(7);
+  std::vector<Cursor> cursors;
+
+  for (auto round = 0; round < 200; round++) {
+    // Edits at one cursor or several, some of which add or remove lines, without waiting for the counts between them
+    cursors.clear();
+
+    for (auto i = random() % 3 + 1; i > 0 and !document.empty(); i--) {
+      auto const y = random() % document.lineCount();
+      auto const x = random() % (document.line(y).size() + 1);
+      cursors.push_back(Cursor {.x = static_cast<std::int64_t>(x), .y = static_cast<std::int64_t>(y)});
+    }
+
+    normalize(cursors);
+
+    static constexpr char const* texts[] {"x", "two words", "\n", "a\nb\nc", " \xc3\xa9"};
+    auto const changed = random() % 3 == 0
+                           ? eraseAt(document, cursors, random() % 2 == 0 ? Direction::Backward : Direction::Forward)
+                           : insertAt(document, cursors, texts[random() % 5]);
+    statistics.changed(workers, document, changed);
+
+    if (round % 10 == 0) {
+      statistics.collect();
+    }
+  }
+
+  finish(workers, statistics);
+
+  ASSERT_THAT(statistics.totals(), ::testing::Eq(countLines(document, 0, document.lineCount())));
+}
+
+}   // namespace Kilo::editor
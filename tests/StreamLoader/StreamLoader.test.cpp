@@ -0,0 +1,169 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/StreamLoader/StreamLoader.hpp"
+
+#include "Editor/Document/Document.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <fcntl.h>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <utility>
+
+namespace Kilo::editor {
+
+namespace {
+
+/// A pipe whose write end is kept by the test and whose read end is handed to the loader
+struct Pipe
+{
+  Pipe()
+  {
+    std::array<int, 2> fds {};
+    EXPECT_THAT(::pipe2(fds.data(), O_NONBLOCK), ::testing::Eq(0));
+    read = fds[0];
+    write = fds[1];
+  }
+
+  void send(std::string_view text) const
+  {
+    ASSERT_THAT(::write(write, text.data(), text.size()), ::testing::Eq(static_cast<ssize_t>(text.size())));
+  }
+
+  void close()
+  {
+    ::close(std::exchange(write, -1));
+  }
+
+  ~Pipe()
+  {
+    if (write != -1) {
+      ::close(write);
+    }
+  }
+
+  int read;
+  int write;
+};
+
+}   // namespace
+
+TEST(StreamLoader, LinesAreAppendedAsTheirNewlinesArrive)
+{
+  Pipe pipe;
+  StreamLoader loader(pipe.read);
+  Document doc;
+
+  pipe.send("first\nsec");
+  ASSERT_THAT(loader.pump(doc), ::testing::Eq(1));
+  ASSERT_THAT(doc.lineCount(), ::testing::Eq(1));
+  ASSERT_THAT(doc.line(0), ::testing::Eq("first"));
+
+  pipe.send("ond\n\nthird");
+  ASSERT_THAT(loader.pump(doc), ::testing::Eq(2));
+  ASSERT_THAT(doc.line(1), ::testing::Eq("second"));
+  ASSERT_THAT(doc.line(2), ::testing::Eq(""));
+  ASSERT_THAT(loader.finished(), ::testing::IsFalse());
+
+  pipe.close();
+  ASSERT_THAT(loader.pump(doc), ::testing::Eq(1));
+  ASSERT_THAT(doc.line(3), ::testing::Eq("third"));
+  ASSERT_THAT(loader.finished(), ::testing::IsTrue());
+}
+
+TEST(StreamLoader, ATrailingNewlineDoesNotStartAnotherLine)
+{
+  Pipe pipe;
+  StreamLoader loader(pipe.read);
+  Document doc;
+
+  pipe.send("a\nb\n");
+  pipe.close();
+  loader.pump(doc);
+
+  ASSERT_THAT(doc.lineCount(), ::testing::Eq(2));
+  ASSERT_THAT(loader.finished(), ::testing::IsTrue());
+}
+
+TEST(StreamLoader, LinesLongerThanTheChunkAreKeptWhole)
+{
+  Pipe pipe;
+  StreamLoader loader(pipe.read);
+  Document doc;
+
+  // Larger than the chunk, and larger than the pipe buffer, so it has to be sent in pieces
+  std::string const longLine(StreamLoader::ChunkSize * 2 + 123, 'x');
+
+  for (std::size_t sent = 0; sent < longLine.size(); sent += 4096) {
+    pipe.send(std::string_view(longLine).substr(sent, 4096));
+    loader.pump(doc);
+  }
+
+  pipe.send("\nshort\n");
+  pipe.close();
+  loader.pump(doc);
+
+  ASSERT_THAT(doc.lineCount(), ::testing::Eq(2));
+  ASSERT_THAT(doc.line(0), ::testing::Eq(longLine));
+  ASSERT_THAT(doc.line(1), ::testing::Eq("short"));
+}
+
+TEST(StreamLoader, LinesAreLoadedWithoutTheirLineEndingOrAByteOrderMark)
+{
+  Pipe pipe;
+  StreamLoader loader(pipe.read);
+  Document doc;
+
+  // The "\r" of the second line arrives before its "\n"
+  pipe.send("\xEF\xBB\xBF" "first\r\nsecond\r");
+  loader.pump(doc);
+  pipe.send("\nthird\n");
+  pipe.close();
+  loader.pump(doc);
+
+  ASSERT_THAT(doc.lineCount(), ::testing::Eq(3));
+  ASSERT_THAT(doc.line(0), ::testing::Eq("first"));
+  ASSERT_THAT(doc.line(1), ::testing::Eq("second"));
+  ASSERT_THAT(doc.line(2), ::testing::Eq("third"));
+  ASSERT_THAT(loader.format().byteOrderMark, ::testing::IsTrue());
+  ASSERT_THAT(loader.format().lineEnding(), ::testing::Eq(LineEnding::CrLf));
+}
+
+TEST(StreamLoader, PumpingReturnsWhenThePipeIsEmpty)
+{
+  Pipe pipe;
+  StreamLoader loader(pipe.read);
+  Document doc;
+
+  pipe.send("1\n2\n");
+  ASSERT_THAT(loader.pump(doc), ::testing::Eq(2));
+  ASSERT_THAT(loader.pump(doc), ::testing::Eq(0));
+  ASSERT_THAT(loader.finished(), ::testing::IsFalse());
+}
+
+}   // namespace Kilo::editor
@@ -0,0 +1,108 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/TextScanner/TextScanner.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Kilo::editor {
+
+namespace {
+
+auto scanned(std::string_view text) -> TextFormat
+{
+  TextScanner scanner;
+  std::vector<std::size_t> newlines;
+  scanner.scan(text, newlines);
+  return scanner.format();
+}
+
+}   // namespace
+
+TEST(TextScanner, FindsEveryNewlineAndCountsTheLineEndings)
+{
+  // Long enough for whole blocks as well as the bytes after the last of them
+  std::string const text = "first line\r\nsecond line\r\nthird\nfourth line of the text\r\n";
+
+  TextScanner scanner;
+  std::vector<std::size_t> newlines;
+  scanner.scan(text, newlines);
+
+  std::vector<std::size_t> expected;
+
+  for (auto i = text.find('\n'); i != std::string::npos; i = text.find('\n', i + 1)) {
+    expected.push_back(i);
+  }
+
+  ASSERT_THAT(newlines, ::testing::ContainerEq(expected));
+  ASSERT_THAT(scanner.format().crlfLines, ::testing::Eq(3));
+  ASSERT_THAT(scanner.format().lfLines, ::testing::Eq(1));
+  ASSERT_THAT(scanner.format().lineEnding(), ::testing::Eq(LineEnding::CrLf));
+  ASSERT_THAT(scanner.format().finalNewline, ::testing::IsTrue());
+}
+
+TEST(TextScanner, RecognizesLineEndingsAndByteOrderMarksSplitBetweenPieces)
+{
+  TextScanner scanner;
+  std::vector<std::size_t> newlines;
+
+  scanner.scan("\xEF", newlines);
+  scanner.scan("\xBB\xBF" "0123456789abcdef\r", newlines);
+  scanner.scan("\nlast", newlines);
+
+  ASSERT_THAT(newlines, ::testing::ElementsAre(0));
+  ASSERT_THAT(scanner.format().byteOrderMark, ::testing::IsTrue());
+  ASSERT_THAT(scanner.format().crlfLines, ::testing::Eq(1));
+  ASSERT_THAT(scanner.format().finalNewline, ::testing::IsFalse());
+  ASSERT_THAT(scanner.format().droppedBytes(), ::testing::Eq(4));
+}
+
+TEST(TextScanner, ValidatesUtf8AcrossBlocks)
+{
+  // The euro signs straddle the boundary between the first two blocks
+  ASSERT_THAT(scanned("plain ascii text that is long\n").validUtf8, ::testing::IsTrue());
+  ASSERT_THAT(scanned("fifteen bytes \xE2\x82\xAC and \xF0\x9F\x98\x80\n").validUtf8, ::testing::IsTrue());
+
+  ASSERT_THAT(scanned("an overlong slash \xC0\xAF in a long line\n").validUtf8, ::testing::IsFalse());
+  ASSERT_THAT(scanned("a surrogate \xED\xA0\x80 in a long line\n").validUtf8, ::testing::IsFalse());
+  ASSERT_THAT(scanned("a lone continuation byte \x80").validUtf8, ::testing::IsFalse());
+  ASSERT_THAT(scanned("cut off at the end of the text \xE2\x82").validUtf8, ::testing::IsFalse());
+  ASSERT_THAT(scanned("Latin-1 caf\xE9\n").validUtf8, ::testing::IsFalse());
+}
+
+TEST(TextScanner, TextWithANulByteIsBinary)
+{
+  using namespace std::string_view_literals;
+
+  ASSERT_THAT(scanned("no nul bytes in this text at all\n").binary, ::testing::IsFalse());
+  ASSERT_THAT(scanned("\x7f" "ELF\x02\x01\x01\0\0\0\0\0\0\0\0\0\x03\0"sv).binary, ::testing::IsTrue());
+  ASSERT_THAT(scanned("short\0"sv).binary, ::testing::IsTrue());
+}
+
+}   // namespace Kilo::editor
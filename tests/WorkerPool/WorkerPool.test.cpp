@@ -0,0 +1,210 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Editor/WorkerPool/WorkerPool.hpp"
+
+#include "Editor/Document/Document.hpp"
+#include "Editor/WorkerPool/BackgroundJobs.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+
+namespace Kilo::editor {
+
+namespace {
+
+/// Get the text of a line of the copy of the document a job read
+auto lineOf(std::size_t const& line, Document const& document) -> std::string
+{
+  return std::string(document.line(line));
+}
+
+/// Wait for a number of jobs to finish and collect their results
+auto collectAll(WorkerPool& workers, BackgroundJobs<std::size_t, std::string>& jobs, std::size_t count)
+  -> std::vector<std::string>
+{
+  std::vector<std::string> results;
+
+  while (results.size() < count) {
+    ::pollfd finished {.fd = workers.fileDescriptor(), .events = POLLIN, .revents = 0};
+    EXPECT_THAT(::poll(&finished, 1, 1000), ::testing::Eq(1));
+    workers.acknowledge();
+    jobs.collect([&results](std::string& result) { results.push_back(std::move(result)); });
+  }
+
+  return results;
+}
+
+}   // namespace
+
+TEST(WorkerPool, RunsEveryTaskAndSignalsWhenTheyFinish)
+{
+  std::atomic<int> ran {};
+  WorkerPool workers(3);
+
+  for (auto i = 0; i < 100; i++) {
+    workers.post([&ran] { ran.fetch_add(1); });
+  }
+
+  while (ran.load() < 100) {
+    ::pollfd finished {.fd = workers.fileDescriptor(), .events = POLLIN, .revents = 0};
+    ASSERT_THAT(::poll(&finished, 1, 1000), ::testing::Eq(1));
+    workers.acknowledge();
+  }
+
+  ASSERT_THAT(workers.size(), ::testing::Eq(3));
+}
+
+TEST(WorkerPool, IsNotReadableOnceAcknowledged)
+{
+  WorkerPool workers(1);
+  ::pollfd finished {.fd = workers.fileDescriptor(), .events = POLLIN, .revents = 0};
+
+  workers.post([] {});
+  ASSERT_THAT(::poll(&finished, 1, 1000), ::testing::Eq(1));
+
+  workers.acknowledge();
+  ASSERT_THAT(::poll(&finished, 1, 0), ::testing::Eq(0));
+}
+
+TEST(WorkerPool, DropsTasksThatHaveNotStartedWhenDestroyed)
+{
+  std::atomic<bool> release {};
+  std::atomic<int> ran {};
+
+  // Lets the task that holds up the only worker finish once the pool is being destroyed
+  std::jthread releaser;
+
+  {
+    WorkerPool workers(1);
+    std::atomic<bool> started {};
+
+    workers.post([&] {
+      started = true;
+      while (!release.load()) {
+        std::this_thread::yield();
+      }
+      ran.fetch_add(1);
+    });
+
+    for (auto i = 0; i < 10; i++) {
+      workers.post([&ran] { ran.fetch_add(1); });
+    }
+
+    while (!started.load()) {
+      std::this_thread::yield();
+    }
+
+    releaser = std::jthread([&release] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      release = true;
+    });
+  }
+
+  ASSERT_THAT(ran.load(), ::testing::Eq(1));
+}
+
+TEST(WorkerPool, RunsTasksPostedFirstAheadOfThoseQueued)
+{
+  std::atomic<bool> started {};
+  std::atomic<bool> release {};
+  std::mutex mutex;
+  std::vector<int> order;
+
+  {
+    WorkerPool workers(1);
+
+    workers.post([&] {
+      started = true;
+      while (!release.load()) {
+        std::this_thread::yield();
+      }
+    });
+
+    while (!started.load()) {
+      std::this_thread::yield();
+    }
+
+    for (auto i = 0; i < 3; i++) {
+      workers.post([&, i] {
+        std::scoped_lock const lock(mutex);
+        order.push_back(i);
+      });
+    }
+
+    workers.postFirst([&] {
+      std::scoped_lock const lock(mutex);
+      order.push_back(-1);
+    });
+
+    release = true;
+
+    // Tasks still queued when the pool is destroyed would be dropped
+    for (auto done = false; !done; std::this_thread::yield()) {
+      std::scoped_lock const lock(mutex);
+      done = order.size() == 4;
+    }
+  }
+
+  ASSERT_THAT(order, ::testing::ElementsAre(-1, 0, 1, 2));
+}
+
+TEST(BackgroundJobs, EveryJobReadsTheDocumentAsItWasWhenPosted)
+{
+  WorkerPool workers(2);
+  BackgroundJobs<std::size_t, std::string> jobs(lineOf);
+  Document document {"zero", "one", "two"};
+  std::vector<std::size_t> lines {0, 1, 2};
+
+  jobs.post(workers, document, lines);
+  document.replaceLine(1, "edited");
+
+  ASSERT_THAT(collectAll(workers, jobs, 3), ::testing::UnorderedElementsAre("zero", "one", "two"));
+}
+
+TEST(BackgroundJobs, RestartingDropsTheResultsOfTheJobsPostedBefore)
+{
+  WorkerPool workers(1);
+  BackgroundJobs<std::size_t, std::string> jobs(lineOf);
+  Document const document {"zero", "one", "two"};
+  std::vector<std::size_t> before {0, 1};
+  std::vector<std::size_t> after {2};
+
+  jobs.post(workers, document, before);
+  jobs.restart();
+  jobs.post(workers, document, after);
+
+  ASSERT_THAT(collectAll(workers, jobs, 1), ::testing::ElementsAre("two"));
+}
+
+}   // namespace Kilo::editor
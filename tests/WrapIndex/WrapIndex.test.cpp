@@ -0,0 +1,186 @@
+/**
+ * MIT License
+ * Copyright (c) 2023 Jimmy Givans
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "Editor/WrapIndex/WrapIndex.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace Kilo::editor {
+
+TEST(WrapIndex, EveryLineTakesUpAtLeastOneRow)
+{
+  WrapIndex const wrap({0, 3, 10}, 10);
+
+  ASSERT_THAT(wrap.rowCount(), ::testing::Eq(3));
+  ASSERT_THAT(wrap.rowsOf(0), ::testing::Eq(1));
+}
+
+TEST(WrapIndex, LongLinesAreFoldedToTheNumberOfColumns)
+{
+  WrapIndex const wrap({25, 5, 10}, 10);
+
+  ASSERT_THAT(wrap.rowsOf(0), ::testing::Eq(3));
+  ASSERT_THAT(wrap.rowCount(), ::testing::Eq(5));
+  ASSERT_THAT(wrap.firstRowOf(1), ::testing::Eq(3));
+  ASSERT_THAT(wrap.firstRowOf(3), ::testing::Eq(5));
+}
+
+TEST(WrapIndex, LocateFindsTheLineAndSegmentOfARow)
+{
+  WrapIndex const wrap({25, 5, 0, 31}, 10);
+
+  auto const first = wrap.locate(2);
+  ASSERT_THAT(first.line, ::testing::Eq(0));
+  ASSERT_THAT(first.segment, ::testing::Eq(2));
+
+  auto const second = wrap.locate(5);
+  ASSERT_THAT(second.line, ::testing::Eq(3));
+  ASSERT_THAT(second.segment, ::testing::Eq(0));
+
+  auto const last = wrap.locate(wrap.rowCount() - 1);
+  ASSERT_THAT(last.line, ::testing::Eq(3));
+  ASSERT_THAT(last.segment, ::testing::Eq(3));
+}
+
+TEST(WrapIndex, LocateIsTheInverseOfFirstRowOf)
+{
+  std::vector<std::size_t> widths;
+
+  for (std::size_t i = 0; i < 1000; i++) {
+    widths.push_back((i * 37) % 101);
+  }
+
+  WrapIndex const wrap(widths, 16);
+
+  for (std::size_t line = 0; line < widths.size(); line++) {
+    auto const pos = wrap.locate(wrap.firstRowOf(line));
+    ASSERT_THAT(pos.line, ::testing::Eq(line));
+    ASSERT_THAT(pos.segment, ::testing::Eq(0));
+  }
+}
+
+TEST(WrapIndex, UpdateChangesTheRowsOfALine)
+{
+  WrapIndex wrap({5, 5, 5}, 10);
+
+  wrap.update(1, 35);
+
+  ASSERT_THAT(wrap.rowsOf(1), ::testing::Eq(4));
+  ASSERT_THAT(wrap.rowCount(), ::testing::Eq(6));
+  ASSERT_THAT(wrap.firstRowOf(2), ::testing::Eq(5));
+}
+
+TEST(WrapIndex, InsertAndEraseShiftTheFollowingLines)
+{
+  WrapIndex wrap({5, 5}, 10);
+
+  wrap.insert(1, 20);
+  ASSERT_THAT(wrap.lineCount(), ::testing::Eq(3));
+  ASSERT_THAT(wrap.firstRowOf(2), ::testing::Eq(3));
+
+  wrap.erase(0);
+  ASSERT_THAT(wrap.lineCount(), ::testing::Eq(2));
+  ASSERT_THAT(wrap.locate(1).line, ::testing::Eq(0));
+  ASSERT_THAT(wrap.locate(2).line, ::testing::Eq(1));
+}
+
+TEST(WrapIndex, AppendingMatchesBuildingAtOnce)
+{
+  std::vector<std::size_t> const widths {3, 25, 0, 41, 10, 11, 7, 99, 1, 20, 30};
+  WrapIndex const built(widths, 10);
+  WrapIndex appended({}, 10);
+
+  for (auto const width : widths) {
+    appended.append(width);
+  }
+
+  ASSERT_THAT(appended.rowCount(), ::testing::Eq(built.rowCount()));
+
+  for (std::size_t line = 0; line <= widths.size(); line++) {
+    ASSERT_THAT(appended.firstRowOf(line), ::testing::Eq(built.firstRowOf(line)));
+  }
+}
+
+TEST(WrapIndex, ReplacingRunsMatchesBuildingAtOnce)
+{
+  // Enough lines for several blocks, so that runs span blocks, empty them and make them too large
+  std::mt19937 random(41);
+  std::vector<std::size_t> widths;
+
+  for (std::size_t i = 0; i < 5 * WrapIndex::BlockLines; i++) {
+    widths.push_back(random() % 50);
+  }
+
+  WrapIndex wrap(widths, 16);
+
+  for (auto round = 0; round < 200; round++) {
+    auto const first = random() % (widths.size() + 1);
+    auto const removed = std::min<std::size_t>(random() % (round % 10 == 0 ? 3 * WrapIndex::BlockLines : 4),
+                                               widths.size() - first);
+    std::vector<std::size_t> added(random() % (round % 7 == 0 ? 3 * WrapIndex::BlockLines : 4));
+
+    for (auto& width : added) {
+      width = random() % 50;
+    }
+
+    wrap.replace(first, removed, added);
+
+    auto const at = widths.begin() + static_cast<std::ptrdiff_t>(first);
+    widths.insert(widths.erase(at, at + static_cast<std::ptrdiff_t>(removed)), added.begin(), added.end());
+  }
+
+  WrapIndex const built(widths, 16);
+  ASSERT_THAT(wrap.lineCount(), ::testing::Eq(widths.size()));
+  ASSERT_THAT(wrap.rowCount(), ::testing::Eq(built.rowCount()));
+
+  for (std::size_t line = 0; line <= widths.size(); line++) {
+    ASSERT_THAT(wrap.firstRowOf(line), ::testing::Eq(built.firstRowOf(line)));
+  }
+
+  for (std::size_t row = 0; row < built.rowCount(); row += 7) {
+    ASSERT_THAT(wrap.locate(row).line, ::testing::Eq(built.locate(row).line));
+    ASSERT_THAT(wrap.locate(row).segment, ::testing::Eq(built.locate(row).segment));
+  }
+}
+
+TEST(WrapIndex, SetColumnsRefoldsTheLines)
+{
+  WrapIndex wrap({25, 5, 40}, 10);
+
+  wrap.setColumns(20);
+  ASSERT_THAT(wrap.rowCount(), ::testing::Eq(5));
+  ASSERT_THAT(wrap.firstRowOf(2), ::testing::Eq(3));
+
+  wrap.setColumns(5);
+  ASSERT_THAT(wrap.rowCount(), ::testing::Eq(14));
+  ASSERT_THAT(wrap.locate(13).line, ::testing::Eq(2));
+}
+
+}   // namespace Kilo::editor